@@ -0,0 +1,350 @@
+#include "AppCases.h"
+#include "Recipe.h"
+#include "DelayTask.h"
+#include "PadTask.h"
+#include "I2CVoltageTask.h"
+#include "Simulator.h"
+#include "ExperimentData.h"
+#include "CancellationToken.h"
+#include "Relais.h"
+#include "StatusLed.h"
+#include "VoltageSettler.h"
+#include "FSHelper.h"
+#include "Telemetry.h"
+#include "I2CTempTask.h"
+#include "Addresses.h"
+#include "DropletRouter.h"
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+
+/// steps of the pad sequence of the predicted recipe
+#define APP_BENCH_PAD_STEPS 10
+/// duration of a pad step
+#define APP_BENCH_PAD_MS 50
+/// setpoint of the voltage tasks of the predicted recipe
+#define APP_BENCH_VOLTAGE 60
+/// delays before / after the pads and the voltage
+#define APP_BENCH_DELAY_BEFORE_MS 200
+#define APP_BENCH_DELAY_AFTER_MS 100
+/// tasks of the loaded recipe, each DELAY_EVERY-th task is a DelayTask
+#define APP_BENCH_RECIPE_TASKS 1000
+#define APP_BENCH_RECIPE_DELAY_EVERY 50
+/// time constant of the simulated voltage controller in the voltage cases
+#define APP_BENCH_VOLTAGE_TIME_CONSTANT_MS 40
+/// gain of the simulated voltage controller in the closed loop cases: calibration error of -3% (below the band) / +3% (above the band,
+/// the capacitor has to be discharged)
+#define APP_BENCH_VOLTAGE_GAIN_LOW 0.97
+#define APP_BENCH_VOLTAGE_GAIN_HIGH 1.03
+/// max. duration of a voltage step (old implementation: at least 2.5s)
+#define APP_BENCH_SETTLE_MAX_MS 1500
+/// max. duration of a voltage step of 80V from 20V / 60V down to 40V
+#define APP_BENCH_SETTLE_LONG_MAX_MS 2500
+/// rectangular array of pads of the droplet route recipe, the droplets start in the corners and cross to the opposite corner
+#define APP_BENCH_ROUTE_ROWS 6
+#define APP_BENCH_ROUTE_COLUMNS 8
+/// duration of a step of the droplet route recipe
+#define APP_BENCH_ROUTE_STEP_MS 500
+/// rate of the internal voltage in the telemetry cases, the recording has to outlast the buffer (TELEMETRY_BUFFER_SIZE samples)
+#define APP_BENCH_TELEMETRY_RATE_HZ 500
+#define APP_BENCH_TELEMETRY_SAMPLES (2 * TELEMETRY_BUFFER_SIZE)
+/// rate of the dht11 measurements of the telemetry while an I2CTempTask measures
+#define APP_BENCH_CLIMATE_RATE_HZ 10
+/// max. difference of the measured and the predicted duration of a run (relative), in addition to one poll interval of the voltage
+/// settler (the simulator does not model when the voltage is polled)
+#define APP_BENCH_PREDICTION_TOLERANCE 0.05
+
+/*
+ * delay, pad sequence, voltage step and the same voltage again (skipped by the compiled recipe), delay
+ */
+static Recipe::Recipe_ptr createPredictedRecipe(){
+	Recipe::Recipe_ptr r = Recipe::create("bench_predict");
+	r->addTask(DelayTask::create(0, APP_BENCH_DELAY_BEFORE_MS));
+	
+	std::vector<std::vector<int>> steps;
+	for (int pad = 1; pad <= APP_BENCH_PAD_STEPS; pad++){
+		steps.push_back({pad});
+	}
+	std::vector<PadTask::PadTask_ptr> padTasks = PadTask::createSteps(steps, APP_BENCH_PAD_MS);
+	for (std::vector<PadTask::PadTask_ptr>::const_iterator cit = padTasks.cbegin(); cit != padTasks.cend(); cit++){
+		r->addTask(*cit);
+	}
+	
+	r->addTask(I2CVoltageTask::create(APP_BENCH_VOLTAGE));
+	r->addTask(I2CVoltageTask::create(APP_BENCH_VOLTAGE));
+	r->addTask(DelayTask::create(0, APP_BENCH_DELAY_AFTER_MS));
+	return r;
+}
+
+/*
+ * duration of the predicted recipe according to the model: the pad steps are played as one timeline, the relais are known after
+ * the pads (no read), the voltage ramps from 0V into the band and is checked for VOLTAGE_SETTLE_HOLD_MS, the second voltage task
+ * is skipped
+ */
+static double getModelledMs(const SimulationModel &model){
+	double voltageMs = 5 * model.i2cAccessMs + VOLTAGE_SETPOINT_ACCEPT_MS + model.relaisAccessMs
+		+ std::ceil(APP_BENCH_VOLTAGE * (1.0 - VOLTAGE_SETTLE_TOLERANCE) / model.voltageRampVPerS * 1000.0 + VOLTAGE_SETTLE_HOLD_MS);
+	return 5 * model.taskOverheadMs // recipe, delays, voltage tasks
+		+ APP_BENCH_DELAY_BEFORE_MS + model.padTimelineStartMs + APP_BENCH_PAD_STEPS * APP_BENCH_PAD_MS + voltageMs + APP_BENCH_DELAY_AFTER_MS;
+}
+
+/*
+ * pad tasks with 4 pads and a delay (whole seconds, DelayTask saves the seconds) every APP_BENCH_RECIPE_DELAY_EVERY tasks, saved
+ * by Recipe::save
+ */
+static void saveLoadedRecipe(std::string path){
+	Recipe::Recipe_ptr r = Recipe::create("bench_load");
+	for (int i = 0; i < APP_BENCH_RECIPE_TASKS; i++){
+		if (i % APP_BENCH_RECIPE_DELAY_EVERY == APP_BENCH_RECIPE_DELAY_EVERY - 1){
+			r->addTask(DelayTask::create(1));
+		}else{
+			r->addTask(PadTask::create({1 + i % 118, 1 + (i + 1) % 118, 1 + (i + 2) % 118, 1 + (i + 3) % 118}, 500));
+		}
+	}
+	r->save(path);
+}
+
+/*
+ * recipe with a DropletRoute element and the adjacency file next to it, same format as recipes/droplet_route_example.xml
+ */
+static void saveRouteRecipe(std::string folder, const std::vector<DropletRouter::Droplet> &droplets){
+	std::ofstream adjacency(FSHelper::composePath(folder, "bench_adjacency.csv"));
+	adjacency << "# " << APP_BENCH_ROUTE_ROWS << " x " << APP_BENCH_ROUTE_COLUMNS << " pads" << std::endl;
+	for (int pad = 1; pad <= APP_BENCH_ROUTE_ROWS * APP_BENCH_ROUTE_COLUMNS; pad++){
+		adjacency << pad;
+		if (pad % APP_BENCH_ROUTE_COLUMNS != 0){
+			adjacency << ";" << pad + 1;
+		}
+		if (pad + APP_BENCH_ROUTE_COLUMNS <= APP_BENCH_ROUTE_ROWS * APP_BENCH_ROUTE_COLUMNS){
+			adjacency << ";" << pad + APP_BENCH_ROUTE_COLUMNS;
+		}
+		adjacency << std::endl;
+	}
+	adjacency.close();
+	
+	tinyxml2::XMLDocument doc;
+	tinyxml2::XMLElement *recipe = doc.NewElement("Recipe");
+	recipe->SetAttribute("name", "bench_route");
+	tinyxml2::XMLElement *route = doc.NewElement("DropletRoute");
+	route->SetAttribute("duration_ms", APP_BENCH_ROUTE_STEP_MS);
+	route->SetAttribute("adjacency", "bench_adjacency.csv"); // relative to the recipe
+	route->SetAttribute("pads", APP_BENCH_ROUTE_ROWS * APP_BENCH_ROUTE_COLUMNS);
+	for (std::vector<DropletRouter::Droplet>::const_iterator cit = droplets.cbegin(); cit != droplets.cend(); cit++){
+		tinyxml2::XMLElement *droplet = doc.NewElement("Droplet");
+		droplet->SetAttribute("start", cit->start);
+		droplet->SetAttribute("goal", cit->goal);
+		route->InsertEndChild(droplet);
+	}
+	recipe->InsertEndChild(route);
+	doc.InsertEndChild(recipe);
+	doc.SaveFile(FSHelper::composePath(folder, "bench_route.xml").c_str());
+}
+
+/*
+ * switch off the supply of the boost converter and wait until the capacitor has been discharged, so each run starts at 0V like
+ * the simulation
+ */
+static void dischargeVoltage(SimulatedTransport::SimulatedTransport_ptr sim){
+	Task::relais->readRelais();
+	Task::relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, false);
+	Task::relais->writeRelais();
+	while (sim->getInternalVoltage() > 0.5){
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+}
+
+/*
+ * voltage step by I2CVoltageTask::execute on the simulated boost converter: a first task brings the capacitor to the start voltage
+ * (not measured), the second task sets the target. settle_ms: duration of execute(), error_pct: deviation of the voltage afterwards.
+ * The controller cannot lower the voltage, so a step down or a voltage above the band only ends inside the band if the task has
+ * discharged the capacitor.
+ */
+static Benchmark::Metrics settleVoltage(SimulatedTransport::SimulatedTransport_ptr sim, std::string name, unsigned int from, unsigned int to, bool closedLoop, double gain, double maxMs){
+	sim->setVoltageSlope(SIMULATED_VOLTAGE_RAMP_V_PER_S, SIMULATED_VOLTAGE_DISCHARGE_V_PER_S);
+	sim->setVoltageResponse(APP_BENCH_VOLTAGE_TIME_CONSTANT_MS, 1.0);
+	dischargeVoltage(sim);
+	I2CVoltageTask::create(from)->execute(nullptr, CancellationToken::create());
+	std::this_thread::sleep_for(std::chrono::milliseconds(10 * APP_BENCH_VOLTAGE_TIME_CONSTANT_MS)); // settled completely
+	sim->setVoltageResponse(APP_BENCH_VOLTAGE_TIME_CONSTANT_MS, gain);
+	
+	I2CVoltageTask::I2CVoltageTask_ptr task = I2CVoltageTask::create(to);
+	task->setClosedLoop(closedLoop);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	task->execute(nullptr, CancellationToken::create());
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	double error = std::fabs(sim->getInternalVoltage() - to) / to;
+	
+	if (ms > maxMs){
+		throw std::runtime_error(name + " - settling took " + FSHelper::formatDouble(ms) + "ms (max. " + FSHelper::formatDouble(maxMs) + "ms)");
+	}
+	if (error > (closedLoop ? VOLTAGE_SETTLE_CLOSED_LOOP_TOLERANCE : VOLTAGE_SETTLE_TOLERANCE)){
+		throw std::runtime_error(name + " - voltage " + FSHelper::formatDouble(sim->getInternalVoltage()) + "V instead of " + std::to_string(to) + "V");
+	}
+	return Benchmark::Metrics{{"settle_ms", ms}, {"error_pct", error * 100.0}};
+}
+
+void addAppCases(Benchmark &bench, SimulatedTransport::SimulatedTransport_ptr sim, std::string folder){
+	Task::relais = Relais::create();
+	Task::status_leds = StatusLed::create();
+	std::atexit([](){ // before the static registry of the connections is destroyed
+		Task::relais = nullptr;
+		Task::status_leds = nullptr;
+	});
+	
+	// --- recipe: loading a saved recipe from the file (the cache does not keep the recipe -> each call reads the file)
+	std::string recipePath = FSHelper::composePath(folder, "bench_load.xml");
+	saveLoadedRecipe(recipePath);
+	bench.add("recipe/Recipe::loadRecipe", APP_BENCH_RECIPE_TASKS, [recipePath](){
+		Recipe::Recipe_ptr r = Recipe::loadRecipe(recipePath, nullptr);
+		if (r == nullptr){
+			throw std::runtime_error("recipe/Recipe::loadRecipe - " + recipePath + " could not be loaded");
+		}
+		std::vector<Task::Task_ptr> tasks = r->getTasks();
+		std::size_t delays = std::count_if(tasks.cbegin(), tasks.cend(), [](const Task::Task_ptr &t){
+			return t->getType().compare("DelayTask") == 0;
+		});
+		if (tasks.size() != APP_BENCH_RECIPE_TASKS || delays != APP_BENCH_RECIPE_TASKS / APP_BENCH_RECIPE_DELAY_EVERY){
+			throw std::runtime_error("recipe/Recipe::loadRecipe - loaded " + std::to_string(tasks.size()) + " tasks (" + std::to_string(delays) + " delays)");
+		}
+		return Benchmark::Metrics{{"tasks", static_cast<double>(tasks.size())}, {"delays", static_cast<double>(delays)}};
+	});
+	
+	// --- recipe: droplet routes are planned when the recipe is loaded, the PadTasks have to form valid routes
+	const int lastRow = (APP_BENCH_ROUTE_ROWS - 1) * APP_BENCH_ROUTE_COLUMNS;
+	std::vector<DropletRouter::Droplet> droplets = {
+		{1, lastRow + APP_BENCH_ROUTE_COLUMNS},
+		{APP_BENCH_ROUTE_COLUMNS, lastRow + 1},
+		{lastRow + 1, APP_BENCH_ROUTE_COLUMNS},
+		{lastRow + APP_BENCH_ROUTE_COLUMNS, 1}
+	};
+	saveRouteRecipe(folder, droplets);
+	bench.add("recipe/DropletRoute", droplets.size(), [folder, droplets](){
+		Recipe::Recipe_ptr r = Recipe::loadRecipe(FSHelper::composePath(folder, "bench_route.xml"), nullptr);
+		if (r == nullptr){
+			throw std::runtime_error("recipe/DropletRoute - the recipe could not be loaded");
+		}
+		
+		// pads of the PadTasks -> route of each droplet
+		std::vector<DropletRouter::Route> routes;
+		for (std::vector<DropletRouter::Droplet>::const_iterator cit = droplets.cbegin(); cit != droplets.cend(); cit++){
+			routes.push_back(DropletRouter::Route{cit->start});
+		}
+		std::vector<Task::Task_ptr> tasks = r->getTasks();
+		tinyxml2::XMLDocument doc;
+		for (std::vector<Task::Task_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+			if ((*cit)->getType().compare("PadTask") != 0){
+				throw std::runtime_error("recipe/DropletRoute - " + (*cit)->getType() + " instead of a PadTask");
+			}
+			std::size_t i = 0;
+			for (tinyxml2::XMLElement *pad = (*cit)->toXMLElement(&doc)->FirstChildElement("Pad"); pad != nullptr; pad = pad->NextSiblingElement("Pad"), i++){
+				if (i < routes.size()){
+					routes[i].push_back(pad->IntAttribute("padNo"));
+				}
+			}
+			if (i != routes.size()){
+				throw std::runtime_error("recipe/DropletRoute - step with " + std::to_string(i) + " pads for " + std::to_string(routes.size()) + " droplets");
+			}
+		}
+		
+		std::string error;
+		DropletRouter::DropletRouter_ptr router = DropletRouter::createGrid(APP_BENCH_ROUTE_ROWS, APP_BENCH_ROUTE_COLUMNS);
+		if (!router->verify(droplets, routes, error)){
+			throw std::runtime_error("recipe/DropletRoute - invalid routes: " + error);
+		}
+		return Benchmark::Metrics{{"steps", static_cast<double>(tasks.size())}};
+	});
+	
+	// --- voltage: settling of the boost converter by I2CVoltageTask::execute
+	bench.add("voltage/I2CVoltageTask_50_to_60V", 1, [sim](){
+		return settleVoltage(sim, "voltage/I2CVoltageTask_50_to_60V", 50, 60, false, 1.0, APP_BENCH_SETTLE_MAX_MS);
+	});
+	bench.add("voltage/I2CVoltageTask_20_to_100V", 1, [sim](){
+		return settleVoltage(sim, "voltage/I2CVoltageTask_20_to_100V", 20, 100, false, 1.0, APP_BENCH_SETTLE_LONG_MAX_MS);
+	});
+	bench.add("voltage/I2CVoltageTask_discharge_100_to_40V", 1, [sim](){ // 100V > 1.2 * 40V -> the capacitor is discharged
+		return settleVoltage(sim, "voltage/I2CVoltageTask_discharge_100_to_40V", 100, 40, false, 1.0, APP_BENCH_SETTLE_LONG_MAX_MS);
+	});
+	bench.add("voltage/I2CVoltageTask_closed_loop_50_to_60V", 1, [sim](){ // steady below the band -> the setpoint is trimmed up
+		return settleVoltage(sim, "voltage/I2CVoltageTask_closed_loop_50_to_60V", 50, 60, true, APP_BENCH_VOLTAGE_GAIN_LOW, APP_BENCH_SETTLE_MAX_MS);
+	});
+	bench.add("voltage/I2CVoltageTask_closed_loop_above_band", 1, [sim](){ // steady above the band -> trimmed down and discharged
+		return settleVoltage(sim, "voltage/I2CVoltageTask_closed_loop_above_band", 50, 60, true, APP_BENCH_VOLTAGE_GAIN_HIGH, APP_BENCH_SETTLE_LONG_MAX_MS);
+	});
+	
+	// --- telemetry: a recording keeps all samples, also after the buffer has wrapped
+	bench.add("telemetry/recording_complete", APP_BENCH_TELEMETRY_SAMPLES, [folder](){
+		Telemetry::Telemetry_ptr telemetry = Telemetry::create();
+		Telemetry::Recording_ptr recording = telemetry->startRecording();
+		telemetry->setRate(Telemetry::CHANNEL::CHANNEL_VOLTAGE, APP_BENCH_TELEMETRY_RATE_HZ);
+		while (recording->getCount(Telemetry::CHANNEL::CHANNEL_VOLTAGE) < APP_BENCH_TELEMETRY_SAMPLES){
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		telemetry->setRate(Telemetry::CHANNEL::CHANNEL_VOLTAGE, TELEMETRY_RATE_VOLTAGE_HZ);
+		
+		std::string path = FSHelper::composePath(folder, "telemetry.csv");
+		telemetry->writeCsv(path, recording); // throws if samples are missing
+		std::ifstream file(path);
+		std::string line;
+		std::size_t lines = 0;
+		while (std::getline(file, line)){
+			lines += (line.find(";voltage;") != std::string::npos ? 1 : 0);
+		}
+		if (lines != recording->getCount(Telemetry::CHANNEL::CHANNEL_VOLTAGE)){
+			throw std::runtime_error("telemetry/recording_complete - " + std::to_string(lines) + " of " + std::to_string(recording->getCount(Telemetry::CHANNEL::CHANNEL_VOLTAGE)) + " voltage samples written");
+		}
+		return Benchmark::Metrics{{"samples", static_cast<double>(lines)}, {"lost", static_cast<double>(recording->getLost())}};
+	});
+	
+	// --- telemetry: the temperature task gets its measurement from the telemetry, which also samples the dht11 periodically
+	bench.add("telemetry/I2CTempTask_while_sampling", 1, [sim](){
+		sim->setClimate(23.4, 45); // the dht11 measures the humidity in steps of 1%
+		Telemetry::Telemetry_ptr telemetry = Telemetry::create();
+		telemetry->setRate(Telemetry::CHANNEL::CHANNEL_TEMPERATURE, APP_BENCH_CLIMATE_RATE_HZ);
+		
+		std::shared_ptr<I2CTempTask> task = std::make_shared<I2CTempTask>(I2C_ATMEGA32_SLAVE_ADDRESS);
+		task->execute(nullptr, CancellationToken::create());
+		telemetry->setRate(Telemetry::CHANNEL::CHANNEL_TEMPERATURE, TELEMETRY_RATE_CLIMATE_HZ);
+		
+		TempData::TempData_ptr t = task->getTempData();
+		if (t == nullptr || std::fabs(t->getTemperature() - 23.4) > 0.05 || std::fabs(t->getHumidity() - 45) > 0.05){
+			throw std::runtime_error("telemetry/I2CTempTask_while_sampling - no valid measurement");
+		}
+		return Benchmark::Metrics{{"temperature", t->getTemperature()}, {"humidity", t->getHumidity()}};
+	});
+	
+	// --- simulator: predicted duration of a recipe vs. the model and vs. a run on the simulated devices
+	Recipe::Recipe_ptr predicted = createPredictedRecipe();
+	bench.add("simulator/predict_recipe", predicted->getTasks().size(), [predicted](){
+		SimulationModel model;
+		SimulationResult prediction = Simulator::create(model)->simulate(predicted);
+		double expectedMs = getModelledMs(model);
+		if (std::fabs(prediction.totalS * 1000.0 - expectedMs) > 1e-6){
+			throw std::runtime_error("simulator/predict_recipe - predicted " + FSHelper::formatDouble(prediction.totalS * 1000.0) + "ms instead of " + FSHelper::formatDouble(expectedMs) + "ms");
+		}
+		return Benchmark::Metrics{{"predicted_ms", prediction.totalS * 1000.0}, {"entries", static_cast<double>(prediction.timeline.size())}};
+	});
+	bench.add("simulator/predict_vs_execute", predicted->getTasks().size(), [predicted, sim, folder](){
+		sim->setVoltageSlope(SIMULATED_VOLTAGE_RAMP_V_PER_S, SIMULATED_VOLTAGE_DISCHARGE_V_PER_S);
+		sim->setVoltageResponse(SIMULATED_VOLTAGE_TIME_CONSTANT_MS, 1.0);
+		dischargeVoltage(sim);
+		
+		double predictedMs = Simulator::create()->simulate(predicted).totalS * 1000.0;
+		ExperimentData::ExperimentData_ptr data = std::make_shared<ExperimentData>("predict", folder);
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		predicted->execute(data, CancellationToken::create());
+		double measuredMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		
+		double error = (measuredMs - predictedMs) / predictedMs;
+		if (std::fabs(measuredMs - predictedMs) > APP_BENCH_PREDICTION_TOLERANCE * predictedMs + VOLTAGE_SETTLE_MAX_INTERVAL_MS){
+			throw std::runtime_error("simulator/predict_vs_execute - run took " + FSHelper::formatDouble(measuredMs) + "ms, predicted: " + FSHelper::formatDouble(predictedMs) + "ms");
+		}
+		return Benchmark::Metrics{{"predicted_ms", predictedMs}, {"measured_ms", measuredMs}, {"error_pct", error * 100.0}};
+	});
+}
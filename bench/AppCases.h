@@ -0,0 +1,25 @@
+#pragma once
+/**
+ * @file AppCases.h
+ *
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Benchmark
+ * @brief cases of the application classes (recipes, tasks, simulator) which run against the SimulatedTransport. They need the
+ * libraries of ewodInterface (gtkmm, ...), so they are only built into portadrop_bench_app (BENCH_APP).
+ *
+ * Besides measuring, the cases check their results and throw a runtime_error if a check fails (e.g. the predicted duration of a
+ * recipe differs from the model or from the measured run).
+ */
+#include "Benchmark.h"
+#include "SimulatedTransport.h"
+
+#include <string>
+
+/**
+ * @brief add the cases of the application classes
+ * @param bench the benchmark
+ * @param sim the transport which has been set with Transport::set()
+ * @param folder temporary folder for files and experiments
+ */
+void addAppCases(Benchmark &bench, SimulatedTransport::SimulatedTransport_ptr sim, std::string folder);
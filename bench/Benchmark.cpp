@@ -0,0 +1,143 @@
+#include "Benchmark.h"
+#include "FSHelper.h"
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <malloc.h>
+
+Benchmark::Benchmark(unsigned int repetitions, std::string filter): repetitions(std::max(1u, repetitions)), filter(filter){
+	
+}
+
+void Benchmark::add(std::string name, std::size_t items, Function f){
+	Case c;
+	c.name = name;
+	c.items = items;
+	c.f = f;
+	cases.push_back(c);
+}
+
+const std::vector<Benchmark::Result>& Benchmark::run(){
+	results.clear();
+	for (std::vector<Case>::const_iterator cit = cases.cbegin(); cit != cases.cend(); cit++){
+		if (!filter.empty() && cit->name.find(filter) == std::string::npos){
+			continue;
+		}
+		
+		Result r;
+		r.name = cit->name;
+		r.items = cit->items;
+		r.failed = false;
+		
+		std::vector<double> times;
+		times.reserve(repetitions);
+		try{
+			r.metrics = cit->f(); // warm-up
+			for (unsigned int i = 0; i < repetitions; i++){
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				r.metrics = cit->f();
+				std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+				times.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+			}
+		}catch (std::exception &e){ // check failed -> continue with the next case
+			r.failed = true;
+			r.error = e.what();
+			r.min_ns = r.median_ns = r.mean_ns = r.max_ns = r.items_per_s = NAN;
+			results.push_back(r);
+			std::cout << std::left << std::setw(44) << r.name << "  FAILED: " << r.error << std::endl;
+			continue;
+		}
+		
+		std::sort(times.begin(), times.end());
+		r.min_ns = times.front();
+		r.max_ns = times.back();
+		r.median_ns = (times.size() % 2 == 1) ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+		double sum = 0;
+		for (std::vector<double>::const_iterator t = times.cbegin(); t != times.cend(); t++){
+			sum += *t;
+		}
+		r.mean_ns = sum / times.size();
+		r.items_per_s = (r.median_ns > 0) ? r.items * 1e9 / r.median_ns : 0;
+		results.push_back(r);
+		
+		std::cout << std::left << std::setw(44) << r.name << std::right << std::fixed << std::setprecision(3)
+			<< std::setw(14) << r.median_ns / 1e6 << " ms" << std::setw(16) << std::setprecision(0) << r.items_per_s << " items/s";
+		for (Metrics::const_iterator m = r.metrics.cbegin(); m != r.metrics.cend(); m++){
+			std::cout << "  " << m->first << "=" << std::setprecision(0) << m->second;
+		}
+		std::cout << std::endl;
+	}
+	return results;
+}
+
+std::size_t Benchmark::getFailures() const{
+	return std::count_if(results.cbegin(), results.cend(), [](const Result &r){
+		return r.failed;
+	});
+}
+
+void Benchmark::writeJson(std::string path) const{
+	std::ofstream file(path);
+	if (!file.is_open()){
+		throw std::runtime_error("Benchmark::writeJson - the file " + path + " cannot be opened");
+	}
+	
+	file << "{\n\t\"benchmark\": \"portadrop_bench\",\n\t\"timestamp\": \"" << escape(FSHelper::getCurrentTimestamp()) << "\",\n";
+	file << "\t\"repetitions\": " << repetitions << ",\n\t\"results\": [";
+	for (std::size_t i = 0; i < results.size(); i++){
+		const Result &r = results[i];
+		file << (i == 0 ? "\n" : ",\n");
+		file << "\t\t{\"name\": \"" << escape(r.name) << "\", \"items\": " << r.items;
+		file << ", \"min_ns\": " << formatNumber(r.min_ns) << ", \"median_ns\": " << formatNumber(r.median_ns);
+		file << ", \"mean_ns\": " << formatNumber(r.mean_ns) << ", \"max_ns\": " << formatNumber(r.max_ns);
+		file << ", \"items_per_s\": " << formatNumber(r.items_per_s) << ", \"metrics\": {";
+		for (Metrics::const_iterator m = r.metrics.cbegin(); m != r.metrics.cend(); m++){
+			file << (m == r.metrics.cbegin() ? "" : ", ") << "\"" << escape(m->first) << "\": " << formatNumber(m->second);
+		}
+		file << "}, \"failed\": " << (r.failed ? "true" : "false") << ", \"error\": \"" << escape(r.error) << "\"}";
+	}
+	file << "\n\t]\n}\n";
+	
+	if (!file.good()){
+		throw std::runtime_error("Benchmark::writeJson - writing " + path + " failed");
+	}
+}
+
+std::size_t Benchmark::getHeapUsage(){
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 info = mallinfo2();
+#else
+	struct mallinfo info = mallinfo();
+#endif
+	return info.uordblks + info.hblkhd; // small blocks + mmapped blocks
+}
+
+std::string Benchmark::escape(const std::string &s){
+	std::string e;
+	for (std::string::const_iterator cit = s.cbegin(); cit != s.cend(); cit++){
+		if (*cit == '"' || *cit == '\\'){
+			e += '\\';
+			e += *cit;
+		}else if (static_cast<unsigned char>(*cit) < 0x20){ // control characters are not allowed in json strings
+			e += ' ';
+		}else{
+			e += *cit;
+		}
+	}
+	return e;
+}
+
+std::string Benchmark::formatNumber(double d){
+	if (!std::isfinite(d)){ // json has no nan / inf
+		return "null";
+	}
+	std::ostringstream ss;
+	ss << std::setprecision(12) << d;
+	return ss.str();
+}
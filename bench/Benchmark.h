@@ -0,0 +1,103 @@
+#pragma once
+/**
+ * @file Benchmark.h
+ *
+ * @class Benchmark
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @brief runs microbenchmarks and writes the results as json. Each case is called once without measuring (warm-up, fills caches and
+ * lazily created data) and then repetitions times. The time of each call is measured with std::chrono::steady_clock; min, median,
+ * mean and max of the calls and the throughput (items per second, based on the median) are reported.
+ *
+ * A case can add metrics (e.g. allocated bytes) by returning them from its function. Cases whose name does not contain the filter are
+ * skipped. If a call throws (e.g. a check of the case failed), the case is recorded as failed with the message and the following cases
+ * are executed; the times of a failed case are null.
+ *
+ * json format:
+ * 	{"benchmark": "portadrop_bench", "timestamp": "...", "repetitions": n, "results": [
+ * 		{"name": "...", "items": n, "min_ns": t, "median_ns": t, "mean_ns": t, "max_ns": t, "items_per_s": r, "metrics": {"...": v},
+ * 		 "failed": false, "error": ""}, ...]}
+ */
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstddef>
+
+/// default no of measured calls per case
+#define BENCHMARK_REPETITIONS 20
+
+class Benchmark{
+public:
+	typedef std::map<std::string, double> Metrics;
+	typedef std::function<Metrics()> Function;
+	
+	/// the measured times of one case
+	struct Result{
+		std::string name;
+		std::size_t items;
+		double min_ns;
+		double median_ns;
+		double mean_ns;
+		double max_ns;
+		double items_per_s;
+		Metrics metrics; // returned by the last call
+		bool failed; // a call has thrown
+		std::string error; // message of the exception
+	};
+	
+	/**
+	 * @param repetitions no of measured calls per case
+	 * @param filter only cases whose name contains the filter are executed (empty: all cases)
+	 */
+	Benchmark(unsigned int repetitions = BENCHMARK_REPETITIONS, std::string filter = "");
+	
+	/**
+	 * @brief add a case
+	 * @param name unique name of the case, e.g. "csv/SpectrumCsvReader::loadSpectrum"
+	 * @param items no of items (points, lines, files, ...) which are processed by one call, used for the throughput
+	 * @param f the measured function
+	 */
+	void add(std::string name, std::size_t items, Function f);
+	
+	/**
+	 * @brief execute the cases in the order they have been added and print one line per case
+	 * @return the results of the executed cases, including the failed ones
+	 */
+	const std::vector<Result>& run();
+	
+	/**
+	 * @brief get the no of cases which failed in run()
+	 * @return no of failed cases
+	 */
+	std::size_t getFailures() const;
+	
+	/**
+	 * @brief write the results of run() to a json file
+	 * @param path path of the file
+	 *
+	 * throws a runtime_error if the file cannot be written
+	 */
+	void writeJson(std::string path) const;
+	
+	/**
+	 * @brief get the allocated heap memory of the process
+	 * @return no of bytes allocated with malloc / new which have not been freed
+	 */
+	static std::size_t getHeapUsage();
+
+private:
+	struct Case{
+		std::string name;
+		std::size_t items;
+		Function f;
+	};
+	
+	static std::string escape(const std::string &s);
+	static std::string formatNumber(double d);
+	
+	unsigned int repetitions;
+	std::string filter;
+	std::vector<Case> cases;
+	std::vector<Result> results;
+};
@@ -0,0 +1,542 @@
+/**
+ * portadrop_bench - microbenchmarks of the data and parsing hot paths (no gtk / hardware libraries needed)
+ *
+ * usage: portadrop_bench [--out <file.json>] [--filter <name>] [--repetitions <n>]
+ */
+#include "Benchmark.h"
+#include "DataP.h"
+#include "Spectrum.h"
+#include "SpectrumCsvReader.h"
+#include "TransSpect.h"
+#include "FSHelper.h"
+#include "PicoPackage.h"
+#include "MeasurementPackage.h"
+#include "Uc_Connection.h"
+#include "SimulatedTransport.h"
+#include "ActuatorService.h"
+#include "TelemetryBuffer.h"
+#include "PadGpio.h"
+#include "SerialReader.h"
+#include "DropletRouter.h"
+#include "Addresses.h"
+#ifdef BENCH_APP
+#include "AppCases.h"
+#endif
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <tinyxml2.h>
+
+/// no of spectrums / points of the DataP vs. Spectrum comparison
+#define BENCH_SPECTRUMS 1000
+#define BENCH_SPECTRUM_POINTS 500
+
+/// no of points of an optical spectrum (HR2000+)
+#define BENCH_OPTICAL_POINTS 2048
+
+/// no of files / points of a transient impedance spectrum
+#define BENCH_TRANS_FILES 1000
+#define BENCH_TRANS_POINTS 200
+
+/// no of received package lines of the pico replay
+#define BENCH_PICO_LINES 1000
+/// max. length of a line received from the pico (EmStatPico: PICO_LINE_BUFFER)
+#define BENCH_SERIAL_LINE_BUFFER 256
+/// time to wait for a line before the replay is aborted
+#define BENCH_SERIAL_TIMEOUT_MS 2000
+
+/// no of points of the plot window
+#define BENCH_PLOT_POINTS 100000
+
+/// no of pad tasks of the recipe xml file
+#define BENCH_RECIPE_TASKS 1000
+
+/// no of 4 byte register accesses (frequency registers) on the simulated i2c bus
+#define BENCH_I2C_ACCESSES 50
+
+/// no of status led / relais changes per call of the actuator cases
+#define BENCH_ACTUATOR_CHANGES 10
+
+/// pad array and droplets of the route planner: the droplets start in the corners / at the edges and cross to the opposite side
+#define BENCH_ROUTER_ROWS 10
+#define BENCH_ROUTER_COLUMNS 12
+
+/// no of samples which are added to the telemetry buffer while a gui thread reads it
+#define BENCH_TELEMETRY_SAMPLES 100000
+
+static std::mt19937 rng(42); // fixed seed -> the same data in each run
+
+static Spectrum createImpSpectrum(std::size_t n){
+	std::uniform_real_distribution<double> noise(0.9, 1.1);
+	Spectrum s;
+	s.reserve(n);
+	for (std::size_t i = 0; i < n; i++){
+		double f = std::pow(10, 1 + 5.0 * i / n);
+		s.add(f, 1e3 * noise(rng), -1e6 / f * noise(rng));
+	}
+	return s;
+}
+
+static Spectrum createOpticalSpectrum(std::size_t n){
+	std::uniform_real_distribution<double> intensity(0, 16000);
+	Spectrum s;
+	s.reserve(n);
+	for (std::size_t i = 0; i < n; i++){
+		s.add(200 + i * 0.4, intensity(rng));
+	}
+	return s;
+}
+
+/*
+ * lines as received from the pico: frequency, z real, z imag
+ * ttHHHHHHHp,MV..V
+ */
+static std::vector<std::string> createPicoLines(std::size_t n){
+	std::uniform_int_distribution<unsigned int> hex(0x7000000, 0x9000000);
+	const char prefixes[] = {'m', 'u', ' ', 'k'};
+	std::vector<std::string> lines;
+	for (std::size_t i = 0; i < n; i++){
+		char line[64];
+		std::snprintf(line, sizeof(line), "Pdc%07X%c;cc%07X%c,10,287;cd%07X%c,10,287", hex(rng), prefixes[i % 4], hex(rng), prefixes[(i + 1) % 4], hex(rng), prefixes[(i + 2) % 4]);
+		lines.push_back(line);
+	}
+	return lines;
+}
+
+static std::string createRecipeXml(std::size_t tasks){
+	tinyxml2::XMLDocument doc;
+	tinyxml2::XMLElement* recipe = doc.NewElement("Recipe");
+	recipe->SetAttribute("name", "bench");
+	recipe->SetAttribute("comment", "");
+	for (std::size_t i = 0; i < tasks; i++){
+		if (i % 50 == 49){
+			tinyxml2::XMLElement* delay = doc.NewElement("DelayTask");
+			delay->SetAttribute("name", "delay");
+			delay->SetAttribute("comment", "");
+			delay->SetAttribute("delay_time_s", 1);
+			recipe->InsertEndChild(delay);
+			continue;
+		}
+		tinyxml2::XMLElement* pad = doc.NewElement("PadTask");
+		pad->SetAttribute("name", "pad");
+		pad->SetAttribute("comment", "");
+		pad->SetAttribute("duration_ms", 500);
+		for (int p = 0; p < 4; p++){
+			tinyxml2::XMLElement* padNo = doc.NewElement("Pad");
+			padNo->SetAttribute("padNo", static_cast<int>(1 + (i + p) % 118));
+			pad->InsertEndChild(padNo);
+		}
+		recipe->InsertEndChild(pad);
+	}
+	doc.InsertEndChild(recipe);
+	
+	tinyxml2::XMLPrinter printer;
+	doc.Print(&printer);
+	return printer.CStr();
+}
+
+/*
+ * replays the pico output on a pseudo terminal: a writer thread writes the lines to the master side as fast as the pty accepts them,
+ * a SerialReader on the raw slave side receives them and each line is parsed like EmStatPico::receiveMeasurements. The latency is the
+ * time from writing a line until readLine() returned it.
+ */
+static Benchmark::Metrics replaySerial(const std::vector<std::string> &lines){
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0){
+		throw std::runtime_error("serial/pty_replay - unable to create a pseudo terminal");
+	}
+	int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+	if (slave < 0){
+		close(master);
+		throw std::runtime_error("serial/pty_replay - unable to open the pseudo terminal");
+	}
+	struct termios tio;
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio); // like the uart: no echo, no line editing
+	tcsetattr(slave, TCSANOW, &tio);
+	
+	std::vector<std::chrono::steady_clock::time_point> sent(lines.size());
+	SerialReader reader(slave);
+	reader.start();
+	std::thread writer([master, &lines, &sent](){
+		for (std::size_t i = 0; i < lines.size(); i++){
+			std::string line = lines[i] + "\n";
+			sent[i] = std::chrono::steady_clock::now();
+			for (std::size_t written = 0; written < line.size(); ){
+				ssize_t n = write(master, line.c_str() + written, line.size() - written);
+				if (n <= 0){
+					return;
+				}
+				written += n;
+			}
+		}
+		if (write(master, "\n", 1) != 1){ // empty line: end of the measurement
+			return;
+		}
+	});
+	
+	char line[BENCH_SERIAL_LINE_BUFFER];
+	std::size_t len = 0;
+	std::size_t received = 0;
+	std::size_t values = 0;
+	double latencySum_us = 0;
+	double latencyMax_us = 0;
+	PicoPackage package;
+	while (reader.readLine(line, BENCH_SERIAL_LINE_BUFFER, len, BENCH_SERIAL_TIMEOUT_MS) && len > 0){
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		if (received < sent.size()){
+			double latency_us = std::chrono::duration<double, std::micro>(now - sent[received]).count();
+			latencySum_us += latency_us;
+			latencyMax_us = std::max(latencyMax_us, latency_us);
+		}
+		if (line[0] == 'P' && package.parse(line, len)){
+			values += package.size();
+		}
+		received++;
+	}
+	writer.join();
+	close(master); // hang up, the reader thread does not wait for its poll timeout
+	reader.stop();
+	close(slave);
+	
+	if (received != lines.size()){
+		throw std::runtime_error("serial/pty_replay - " + std::to_string(received) + " of " + std::to_string(lines.size()) + " lines received");
+	}
+	return Benchmark::Metrics{{"values", static_cast<double>(values)}, {"latency_mean_us", latencySum_us / received}, {"latency_max_us", latencyMax_us}};
+}
+
+static void removeFolder(std::string folder){
+	std::vector<std::string> files = FSHelper::getFolderContent(folder); // full paths
+	for (std::vector<std::string>::const_iterator cit = files.cbegin(); cit != files.cend(); cit++){
+		if (FSHelper::folderExists(*cit)){ // e.g. experiments of the app cases
+			removeFolder(*cit);
+		}else{
+			std::remove(cit->c_str());
+		}
+	}
+	rmdir(folder.c_str());
+}
+
+int main(int argc, char *argv[]){
+	std::string out = "portadrop_bench.json";
+	std::string filter = "";
+	unsigned int repetitions = BENCHMARK_REPETITIONS;
+	for (int i = 1; i < argc; i++){
+		std::string arg = argv[i];
+		if (arg.compare("--out") == 0 && i + 1 < argc){
+			out = argv[++i];
+		}else if (arg.compare("--filter") == 0 && i + 1 < argc){
+			filter = argv[++i];
+		}else if (arg.compare("--repetitions") == 0 && i + 1 < argc){
+			repetitions = std::atoi(argv[++i]);
+		}else{
+			std::cout << "usage: " << argv[0] << " [--out <file.json>] [--filter <name>] [--repetitions <n>]" << std::endl;
+			return 1;
+		}
+	}
+	
+	char folderTemplate[] = "/tmp/portadrop_bench_XXXXXX";
+	if (mkdtemp(folderTemplate) == nullptr){
+		std::cout << "error creating the temporary folder" << std::endl;
+		return 1;
+	}
+	std::string folder = folderTemplate;
+	
+	Benchmark bench(repetitions, filter);
+	
+	// --- received pico packages: allocation free parser vs. reference parser
+	std::vector<std::string> picoLines = createPicoLines(BENCH_PICO_LINES);
+	bench.add("pico/PicoPackage::parse", picoLines.size(), [&picoLines](){
+		PicoPackage p;
+		std::size_t values = 0;
+		for (std::vector<std::string>::const_iterator cit = picoLines.cbegin(); cit != picoLines.cend(); cit++){
+			if (p.parse(cit->c_str(), cit->size())){
+				values += p.size();
+			}
+		}
+		return Benchmark::Metrics{{"values", static_cast<double>(values)}};
+	});
+	bench.add("serial/pty_replay", picoLines.size(), [&picoLines](){
+		return replaySerial(picoLines);
+	});
+	bench.add("pico/MeasurementPackage::create", picoLines.size(), [&picoLines](){
+		std::size_t values = 0;
+		for (std::vector<std::string>::const_iterator cit = picoLines.cbegin(); cit != picoLines.cend(); cit++){
+			values += MeasurementPackage::create(*cit)->getMeasurements()->size();
+		}
+		return Benchmark::Metrics{{"values", static_cast<double>(values)}};
+	});
+	
+	// --- storing spectrums: one DataP per point vs. contiguous Spectrum
+	bench.add("data/DataP::create_1000x500", BENCH_SPECTRUMS * BENCH_SPECTRUM_POINTS, [](){
+		std::size_t heap = Benchmark::getHeapUsage();
+		std::vector<std::vector<DataP::DataP_ptr>> spectrums(BENCH_SPECTRUMS);
+		for (std::size_t s = 0; s < spectrums.size(); s++){
+			for (std::size_t i = 0; i < BENCH_SPECTRUM_POINTS; i++){
+				spectrums[s].push_back(DataP::create(i, s, -static_cast<double>(i)));
+			}
+		}
+		return Benchmark::Metrics{{"heap_bytes", static_cast<double>(Benchmark::getHeapUsage() - heap)}};
+	});
+	bench.add("data/Spectrum::add_1000x500", BENCH_SPECTRUMS * BENCH_SPECTRUM_POINTS, [](){
+		std::size_t heap = Benchmark::getHeapUsage();
+		std::vector<Spectrum> spectrums(BENCH_SPECTRUMS);
+		for (std::size_t s = 0; s < spectrums.size(); s++){
+			spectrums[s].reserve(BENCH_SPECTRUM_POINTS);
+			for (std::size_t i = 0; i < BENCH_SPECTRUM_POINTS; i++){
+				spectrums[s].add(i, s, -static_cast<double>(i));
+			}
+		}
+		return Benchmark::Metrics{{"heap_bytes", static_cast<double>(Benchmark::getHeapUsage() - heap)}};
+	});
+	
+	// --- range of the plotted data (PlotWindow::setData / addData)
+	Spectrum plotData = createImpSpectrum(BENCH_PLOT_POINTS);
+	bench.add("plot/Spectrum::getRange_abs", plotData.size(), [&plotData](){
+		double x_min, x_max, y_min, y_max;
+		plotData.getRange(DataP::COMPLEX_MODE::COMPLEX_ABS, x_min, x_max, y_min, y_max);
+		return Benchmark::Metrics{{"y_max", y_max}};
+	});
+	bench.add("plot/Spectrum::getRange_phase_deg", plotData.size(), [&plotData](){
+		double x_min, x_max, y_min, y_max;
+		plotData.getRange(DataP::COMPLEX_MODE::COMPLEX_PHASE_DEG, x_min, x_max, y_min, y_max);
+		return Benchmark::Metrics{{"y_max", y_max}};
+	});
+	
+	// --- csv files
+	Spectrum optical = createOpticalSpectrum(BENCH_OPTICAL_POINTS);
+	std::string opticalPath = FSHelper::composePath(folder, "optical.csv");
+	bench.add("csv/FSHelper::save_dataPToCsv_optical", optical.size(), [&optical, &opticalPath](){
+		FSHelper::save_dataPToCsv(optical, opticalPath, true, false, false, false, "wavelength", "intensity", "timediff=0.5s");
+		return Benchmark::Metrics();
+	});
+	Spectrum imp = createImpSpectrum(BENCH_TRANS_POINTS);
+	std::string impPath = FSHelper::composePath(folder, "imp.csv");
+	bench.add("csv/FSHelper::save_dataPToCsv_imp", imp.size(), [&imp, &impPath](){
+		FSHelper::save_dataPToCsv(imp, impPath, true, true, true, true, "frequency", "impedance", "position=0\ntimediff=0.5");
+		return Benchmark::Metrics();
+	});
+	bench.add("csv/SpectrumCsvReader::loadSpectrum", optical.size(), [&opticalPath](){
+		return Benchmark::Metrics{{"points", static_cast<double>(SpectrumCsvReader::loadSpectrum(opticalPath).size())}};
+	});
+	bench.add("csv/SpectrumCsvReader::loadImpSpectrum", imp.size(), [&impPath](){
+		return Benchmark::Metrics{{"points", static_cast<double>(SpectrumCsvReader::loadImpSpectrum(impPath).size())}};
+	});
+	
+	// --- transient impedance spectrums
+	std::vector<std::string> transPaths;
+	std::vector<Spectrum> transSpectrums;
+	for (std::size_t i = 0; i < BENCH_TRANS_FILES; i++){
+		transSpectrums.push_back(createImpSpectrum(BENCH_TRANS_POINTS));
+		transPaths.push_back(FSHelper::composePath(folder, "trans_" + std::to_string(i) + ".csv"));
+		FSHelper::save_dataPToCsv(transSpectrums.back(), transPaths.back(), true, true, true, true, "frequency", "impedance", "position=" + std::to_string(i) + "\ntimediff=" + std::to_string(i * 0.5));
+	}
+	bench.add("trans/TransSpect::loadTransImpSpectrum", transPaths.size(), [&transPaths](){
+		return Benchmark::Metrics{{"spectrums", static_cast<double>(TransSpect::loadTransImpSpectrum(transPaths)->getSpectrumCount())}};
+	});
+	bench.add("trans/TransSpect::addSpectrum", transSpectrums.size(), [&transSpectrums](){
+		TransSpect::TransSpect_ptr t = TransSpect::create();
+		for (std::vector<Spectrum>::const_iterator cit = transSpectrums.cbegin(); cit != transSpectrums.cend(); cit++){
+			t->addSpectrum(*cit);
+		}
+		return Benchmark::Metrics();
+	});
+	TransSpect::TransSpect_ptr trans = TransSpect::create(transSpectrums, std::vector<double>(transSpectrums.size(), 0.5));
+	bench.add("trans/TransSpect::getTransSpect", transSpectrums.size(), [&trans](){
+		return Benchmark::Metrics{{"points", static_cast<double>(trans->getTransSpect(BENCH_TRANS_POINTS / 2, TransSpect::X_VALUE::X_TIME_DIFF).size())}};
+	});
+	bench.add("trans/TransSpect::getTimeTrace", transSpectrums.size(), [&trans](){
+		return Benchmark::Metrics{{"points", static_cast<double>(trans->getTimeTrace(BENCH_TRANS_POINTS / 2).size())}};
+	});
+	
+	// --- recipe xml files: parsing by tinyxml2 (loading the tasks by Recipe::loadRecipe: portadrop_bench_app, recipe/Recipe::loadRecipe)
+	std::string recipeXml = createRecipeXml(BENCH_RECIPE_TASKS);
+	bench.add("recipe/xml_parse", BENCH_RECIPE_TASKS, [&recipeXml](){
+		tinyxml2::XMLDocument doc;
+		if (doc.Parse(recipeXml.c_str(), recipeXml.size()) != tinyxml2::XML_SUCCESS || doc.FirstChildElement("Recipe") == nullptr){
+			throw std::runtime_error("recipe/xml_parse - parsing the recipe failed");
+		}
+		return Benchmark::Metrics();
+	});
+	
+	// --- i2c: single register accesses vs. one transaction per block on the simulated bus (100kHz)
+	SimulatedTransport::SimulatedTransport_ptr sim = SimulatedTransport::create();
+	Transport::set(sim);
+	Uc_Connection::Uc_Connection_ptr freqGen = Uc_Connection::create(I2C_ATTINY45_FREQ_SLAVE_ADDRESS);
+	bench.add("i2c/readRegister_x4", BENCH_I2C_ACCESSES, [&sim, &freqGen](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_I2C_ACCESSES; i++){
+			for (int reg = I2C_ATTINY45_FREQ_BUFFER_FREQ0; reg <= I2C_ATTINY45_FREQ_BUFFER_FREQ3; reg++){
+				freqGen->readRegister(reg);
+			}
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("i2c/readRegisters_4", BENCH_I2C_ACCESSES, [&sim, &freqGen](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_I2C_ACCESSES; i++){
+			freqGen->readRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, 4);
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("i2c/writeRegister_x4", BENCH_I2C_ACCESSES, [&sim, &freqGen](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_I2C_ACCESSES; i++){
+			for (int reg = I2C_ATTINY45_FREQ_BUFFER_FREQ0; reg <= I2C_ATTINY45_FREQ_BUFFER_FREQ3; reg++){
+				freqGen->writeRegister(reg, i);
+			}
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("i2c/writeRegisters_4", BENCH_I2C_ACCESSES, [&sim, &freqGen](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_I2C_ACCESSES; i++){
+			freqGen->writeRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, {i, i, i, i});
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("i2c/writeRegisters_4_unchanged", BENCH_I2C_ACCESSES, [&sim, &freqGen](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_I2C_ACCESSES; i++){
+			freqGen->writeRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, {0x10, 0x27, 0, 0}, true); // 10kHz, written once
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	
+	// --- actuators: status led / relais changes which are merged by the actuator service (min. 10ms between two accesses)
+	ActuatorService::ActuatorService_ptr actuators = ActuatorService::create();
+	int ledCalls = 0;
+	bench.add("actuators/writeLeds_merged", BENCH_ACTUATOR_CHANGES, [&sim, &actuators, &ledCalls](){
+		unsigned long transfers = sim->getI2CTransfers();
+		ledCalls++;
+		for (int i = 0; i < BENCH_ACTUATOR_CHANGES; i++){
+			actuators->writeLeds(i, ledCalls & 0xFF);
+		}
+		actuators->waitUntilWritten();
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("actuators/writeRelais", BENCH_ACTUATOR_CHANGES, [&sim, &actuators](){
+		unsigned long transfers = sim->getI2CTransfers();
+		for (int i = 0; i < BENCH_ACTUATOR_CHANGES; i++){
+			actuators->writeRelais(i & 0x01, 0x00);
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	bench.add("actuators/readRelais", BENCH_ACTUATOR_CHANGES, [&sim, &actuators](){
+		unsigned long transfers = sim->getI2CTransfers();
+		int low, high;
+		for (int i = 0; i < BENCH_ACTUATOR_CHANGES; i++){
+			actuators->readRelais(low, high); // shadow
+		}
+		return Benchmark::Metrics{{"transfers", static_cast<double>(sim->getI2CTransfers() - transfers)}};
+	});
+	
+	// --- pads: precomputed gpio masks (one write per mask) vs. one digitalWrite per pin
+	bench.add("pads/verify_masks", PAD_GPIO_PADS, [](){
+		std::string error;
+		if (!PadGpio::verify(error)){
+			throw std::runtime_error("pads/verify_masks - " + error);
+		}
+		return Benchmark::Metrics();
+	});
+	PadGpio::setOutputs(sim);
+	bench.add("pads/setPadHigh_pinwise", PAD_GPIO_PADS, [&sim](){
+		unsigned long writes = sim->getGpioWrites();
+		for (unsigned int pad = 1; pad <= PAD_GPIO_PADS; pad++){
+			PadGpio::setPadHighPinwise(sim, pad);
+		}
+		return Benchmark::Metrics{{"gpio_writes", static_cast<double>(sim->getGpioWrites() - writes)}};
+	});
+	bench.add("pads/setPadHigh_masks", PAD_GPIO_PADS, [&sim](){
+		unsigned long writes = sim->getGpioWrites();
+		for (unsigned int pad = 1; pad <= PAD_GPIO_PADS; pad++){
+			PadGpio::setPadHigh(sim, pad);
+		}
+		return Benchmark::Metrics{{"gpio_writes", static_cast<double>(sim->getGpioWrites() - writes)}};
+	});
+	
+	// --- droplet routes: all droplets move in the same steps vs. one droplet after another (sum of the shortest routes)
+	DropletRouter::DropletRouter_ptr router = DropletRouter::createGrid(BENCH_ROUTER_ROWS, BENCH_ROUTER_COLUMNS);
+	const int lastRow = (BENCH_ROUTER_ROWS - 1) * BENCH_ROUTER_COLUMNS;
+	std::vector<DropletRouter::Droplet> droplets = {
+		{1, lastRow + BENCH_ROUTER_COLUMNS}, // top left -> bottom right
+		{BENCH_ROUTER_COLUMNS, lastRow + 1}, // top right -> bottom left
+		{lastRow + 1, BENCH_ROUTER_COLUMNS}, // bottom left -> top right
+		{lastRow + BENCH_ROUTER_COLUMNS, 1}, // bottom right -> top left
+		{BENCH_ROUTER_COLUMNS / 2, lastRow + BENCH_ROUTER_COLUMNS / 2}, // top -> bottom
+		{lastRow + BENCH_ROUTER_COLUMNS / 2 + 3, BENCH_ROUTER_COLUMNS / 2 + 3} // bottom -> top
+	};
+	bench.add("router/plan_6_droplets", droplets.size(), [&router, &droplets](){
+		std::vector<DropletRouter::Route> routes = router->plan(droplets);
+		std::string error;
+		if (!router->verify(droplets, routes, error)){
+			throw std::runtime_error("invalid routes: " + error);
+		}
+		std::vector<std::vector<int>> steps = DropletRouter::getSteps(routes);
+		for (std::size_t t = 0; t < steps.size(); t++){ // step t: pads after t + 1 moves
+			for (std::size_t i = 0; i < routes.size(); i++){
+				if (steps[t].size() != routes.size() || steps[t][i] != routes[i][t + 1]){
+					throw std::runtime_error("step " + std::to_string(t + 1) + " differs from the route of droplet " + std::to_string(i + 1));
+				}
+			}
+		}
+		int serial = 0;
+		for (std::vector<DropletRouter::Droplet>::const_iterator cit = droplets.cbegin(); cit != droplets.cend(); cit++){
+			serial += router->getDistance(cit->start, cit->goal);
+		}
+		return Benchmark::Metrics{{"steps", static_cast<double>(steps.size())}, {"serial_steps", static_cast<double>(serial)}};
+	});
+	
+	// --- telemetry: sampler thread pushes samples, the gui thread reads them at the same time (lock-free)
+	bench.add("telemetry/push_concurrent_read", BENCH_TELEMETRY_SAMPLES, [](){
+		TelemetryBuffer buffer;
+		std::size_t received = 0;
+		std::thread reader([&buffer, &received](){
+			std::vector<TelemetryBuffer::Sample> samples;
+			unsigned long cursor = 0;
+			while (cursor < BENCH_TELEMETRY_SAMPLES){
+				samples.clear();
+				cursor = buffer.read(cursor, samples);
+				received += samples.size();
+			}
+		});
+		for (int i = 0; i < BENCH_TELEMETRY_SAMPLES; i++){
+			buffer.push(i, i);
+		}
+		reader.join();
+		return Benchmark::Metrics{{"received", static_cast<double>(received)}, {"lost", static_cast<double>(BENCH_TELEMETRY_SAMPLES - received)}};
+	});
+	
+#ifdef BENCH_APP
+	addAppCases(bench, sim, folder);
+#endif
+	
+	try{
+		bench.run(); // failed cases are part of the results
+		bench.writeJson(out);
+		std::cout << "results written to " << out << std::endl;
+	}catch (std::runtime_error &e){
+		std::cout << "error: " << e.what() << std::endl;
+		removeFolder(folder);
+		return 1;
+	}
+	removeFolder(folder);
+	
+	if (bench.getFailures() > 0){
+		std::cout << bench.getFailures() << " cases failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
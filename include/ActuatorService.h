@@ -0,0 +1,136 @@
+#pragma once
+/**
+ * @file ActuatorService.h
+ *
+ * @class ActuatorService
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Relais
+ * @see StatusLed
+ * @brief writes the status led and relais registers of the atmega32 (LEDL, LEDH, RELAISL, RELAISH) in a background thread. Relais and
+ * StatusLed share one service.
+ *
+ * The service keeps the four registers in shadow registers. A change just updates the shadow and wakes the thread. The atmega32 needs
+ * ACTUATOR_MIN_WRITE_INTERVAL_MS between two accesses, so the thread sleeps until that deadline (steady_clock) and then writes all
+ * changes which have been made in the meantime in one i2c transaction. Registers which already have the requested value are not
+ * written again (Uc_Connection::writeRegisters).
+ *
+ * Relais changes are written synchronously - writeRelais() returns when the relais have been switched. Status led changes are
+ * written asynchronously. Reading the registers uses the shadow if the registers have been written / read before.
+ */
+#include "Uc_Connection.h"
+#include "Addresses.h"
+
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+/// min. time between two accesses to the relais / led registers of the atmega32
+#define ACTUATOR_MIN_WRITE_INTERVAL_MS 10
+
+#if I2C_ATMEGA32_BUFFER_LEDH != I2C_ATMEGA32_BUFFER_LEDL + 1 || I2C_ATMEGA32_BUFFER_RELAISL != I2C_ATMEGA32_BUFFER_LEDL + 2 || I2C_ATMEGA32_BUFFER_RELAISH != I2C_ATMEGA32_BUFFER_LEDL + 3
+#error "the led and relais registers of the atmega32 need to be consecutive"
+#endif
+
+class ActuatorService{
+public:
+	typedef std::shared_ptr<ActuatorService> ActuatorService_ptr;
+	
+	/// counters of the service
+	struct Statistics{
+		unsigned long changes; // calls of writeRelais / writeLeds
+		unsigned long transactions; // i2c transactions (merged changes)
+		unsigned long reads; // reads which needed an i2c transaction
+		unsigned long errors;
+	};
+	
+	/**
+	 * @brief creates / returns the service, there is at max one service (like Uc_Connection::create)
+	 * @return smart pointer to the service
+	 */
+	static ActuatorService_ptr create();
+	
+	/**
+	 * @brief writes the remaining changes and stops the thread
+	 */
+	virtual ~ActuatorService();
+	
+	/**
+	 * @brief set the relais registers and wait until they have been written
+	 * @param low value of RELAISL
+	 * @param high value of RELAISH
+	 * @return false if writing the registers failed
+	 */
+	bool writeRelais(int low, int high);
+	
+	/**
+	 * @brief set the led registers, they are written by the thread
+	 * @param low value of LEDL
+	 * @param high value of LEDH
+	 */
+	void writeLeds(int low, int high);
+	
+	/**
+	 * @brief get the values of the relais registers
+	 * @param low value of RELAISL
+	 * @param high value of RELAISH
+	 * @param fromDevice if false, the shadow is used if the registers are known; if true, the registers are always read
+	 * @return false if reading the registers failed
+	 */
+	bool readRelais(int &low, int &high, bool fromDevice = false);
+	
+	/**
+	 * @brief get the values of the led registers
+	 * @param low value of LEDL
+	 * @param high value of LEDH
+	 * @param fromDevice if false, the shadow is used if the registers are known; if true, the registers are always read
+	 * @return false if reading the registers failed
+	 */
+	bool readLeds(int &low, int &high, bool fromDevice = false);
+	
+	/**
+	 * @brief wait until all changes have been written
+	 */
+	void waitUntilWritten();
+	
+	/**
+	 * @brief get the counters of the service
+	 * @return the counters
+	 */
+	Statistics getStatistics();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	
+	/// index of the registers in the shadow (offset to I2C_ATMEGA32_BUFFER_LEDL)
+	enum REGISTER {REG_LEDL = 0, REG_LEDH = 1, REG_RELAISL = 2, REG_RELAISH = 3, REG_COUNT = 4};
+	
+	ActuatorService();
+	void actuatorThread();
+	void change(int reg, int low, int high); // mtx must be locked
+	bool read(int reg, int &low, int &high, bool fromDevice);
+	
+	Uc_Connection::Uc_Connection_ptr conn;
+	int registers[REG_COUNT]; // requested values
+	bool dirty[REG_COUNT]; // requested values which have not been written
+	bool known[REG_COUNT]; // the atmega32 has the value of the shadow
+	unsigned long requested; // generation of the last change
+	unsigned long written; // generation of the last written change
+	bool lastWriteOk;
+	bool readRequested;
+	unsigned long readGeneration; // incremented after each read
+	bool lastReadOk;
+	bool running;
+	Clock::time_point lastAccess;
+	Statistics stats;
+	
+	std::mutex mtx;
+	std::condition_variable changed; // a change / read has been requested
+	std::condition_variable done; // a change has been written / the registers have been read
+	std::thread actuator_thread;
+	
+	static std::weak_ptr<ActuatorService> service;
+	static std::mutex serviceMtx;
+};
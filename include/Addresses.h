@@ -82,4 +82,7 @@
 //#define VOLTAGE_TASK_TIME_CORRECT_VOLT 5
 #define VOLTAGE_TASK_TIME_CORRECT_VOLT 2
 
+/// time the relais need to switch between ewod and imp measurement
+#define IMP_RELAIS_SETTLE_MS 51
+
 #define MAX_OUT_VOLT_BOOST 385
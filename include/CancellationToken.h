@@ -0,0 +1,71 @@
+#pragma once
+/**
+ * @file CancellationToken.h
+ *
+ * @class CancellationToken
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Task::execute
+ * @see Recipe
+ * @brief used to stop a running Recipe. The token is passed to Task::execute and from there to the device drivers. Instead of
+ * polling a flag with short sleeps, waits in tasks and drivers sleep on the token (condition variable) by using sleepFor() or
+ * sleepUntil(). cancel() wakes up all sleeping threads immediately, so a running experiment reacts to Stop within milliseconds
+ * without waking up the cpu while it is waiting.
+ */
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+
+class CancellationToken{
+public:
+	typedef std::shared_ptr<CancellationToken> CancellationToken_ptr;
+	typedef std::chrono::steady_clock Clock;
+	
+	/**
+	 * @brief creates a token which is not cancelled
+	 * @return smart pointer to the created object
+	 */
+	static CancellationToken_ptr create();
+	
+	/**
+	 * @brief cancel the token, all threads which are sleeping on the token are woken up
+	 */
+	void cancel();
+	
+	/**
+	 * @brief reset the token to be able to use it for the next execution
+	 */
+	void reset();
+	
+	/**
+	 * @brief check if the token has been cancelled
+	 * @return true if cancel() has been called
+	 */
+	bool isCancelled() const;
+	
+	/**
+	 * @brief sleep until the deadline has been reached or the token has been cancelled
+	 * @param deadline point in time when the sleep ends
+	 * @return false if the token has been cancelled
+	 */
+	bool sleepUntil(Clock::time_point deadline);
+	
+	/**
+	 * @brief sleep until the time has elapsed or the token has been cancelled
+	 * @param duration time to sleep
+	 * @return false if the token has been cancelled
+	 */
+	template <class Rep, class Period>
+	bool sleepFor(const std::chrono::duration<Rep, Period> &duration){
+		return sleepUntil(Clock::now() + std::chrono::duration_cast<Clock::duration>(duration));
+	}
+
+private:
+	CancellationToken();
+	
+	std::atomic<bool> cancelled;
+	std::mutex mtx;
+	std::condition_variable cancelledCondition;
+};
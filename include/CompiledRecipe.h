@@ -0,0 +1,91 @@
+#pragma once
+/**
+ * @file CompiledRecipe.h
+ *
+ * @class CompiledRecipe
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Recipe
+ * @see DeviceState
+ * @see Task::compile
+ * @brief linear instruction stream of a Recipe. Nested recipes (which are not concurrent) are flattened, so the tasks are executed
+ * without walking the recipe tree again. While compiling, the expected state of the relais, the voltage and the frequency is
+ * tracked across the tasks (Task::compile()). Each task gets ExecutionHints which tell it which relais writes, relais reads,
+ * settle delays and setpoints have no effect and are skipped. E.g. two impedance measurements in a row do not switch the relais
+ * back to ewod mode and wait for them in between, and a voltage which has already been set is not set and checked again.
+ *
+ * The CompileReport contains the skipped operations and an estimation of the time which is saved per run. Consecutive PadTasks
+ * are played as one PadTimeline.
+ */
+#include "Task.h"
+#include "ExperimentData.h"
+#include "CancellationToken.h"
+#include "DeviceState.h"
+#include "PadTask.h"
+#include "Simulator.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+class CompiledRecipe{
+public:
+	typedef std::shared_ptr<CompiledRecipe> CompiledRecipe_ptr;
+	
+	/**
+	 * @brief flattens the tasks and computes the hints of each task
+	 * @param tasks the tasks of the recipe
+	 * @return smart pointer to the created object
+	 */
+	static CompiledRecipe_ptr compile(const std::vector<Task::Task_ptr> &tasks);
+	
+	/**
+	 * @brief executes the tasks one after another
+	 * @param data contains the data which is captured during the execution of the tasks
+	 * @param token if cancelled, no further tasks are started
+	 *
+	 * If the execution is stopped while the relais are kept in imp measurement mode (ExecutionHints::keepImpRelaisOn), they are
+	 * switched back to ewod mode.
+	 */
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token);
+	
+	/**
+	 * @brief simulates the tasks one after another with their hints
+	 * @param sim the simulator
+	 */
+	void simulate(Simulator &sim);
+	
+	/**
+	 * @brief get the no of tasks of the flattened recipe
+	 * @return no of tasks
+	 */
+	std::size_t getTaskCount() const;
+	
+	/**
+	 * @brief get the hints of a task
+	 * @param i index of the task in the flattened recipe
+	 * @return the hints
+	 */
+	const ExecutionHints& getHints(std::size_t i) const;
+	
+	/**
+	 * @brief get the skipped operations and the estimated saved time per run
+	 * @return the report
+	 */
+	const CompileReport& getReport() const;
+
+private:
+	struct Step{
+		Task::Task_ptr task;
+		ExecutionHints hints;
+	};
+	
+	CompiledRecipe(const std::vector<Task::Task_ptr> &tasks);
+	void flatten(const std::vector<Task::Task_ptr> &tasks);
+	std::vector<PadTask::PadTask_ptr> getPadSequence(std::size_t i) const; // consecutive PadTasks starting at step i
+	static bool measuresImpedance(const Task::Task_ptr &task);
+	static void restoreEwodMode();
+	
+	std::vector<Step> steps;
+	CompileReport report;
+};
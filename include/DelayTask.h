@@ -42,9 +42,9 @@ public:
 	/**
 	 * @brief does nothing for the defined time
 	 * @param data object to store captured data - not used in this task
-	 * @param executeNext deterimes, if the task should be carried out or stopped
+	 * @param token cancelled to stop the delay
 	 */
-	void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the type of task as string
@@ -58,6 +58,18 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief the task does not change the state of the devices
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the delay time
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 	/**
 	 * @brief create a DelayTask from a part of a xml file
 	 * @param task_element part of a xml file
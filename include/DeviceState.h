@@ -0,0 +1,147 @@
+#pragma once
+/**
+ * @file DeviceState.h
+ *
+ * @class DeviceState
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see CompiledRecipe
+ * @see Task::compile
+ * @brief expected state of the relais, the voltage and the frequency at a certain point of a compiled recipe. The state is
+ * tracked by CompiledRecipe across the tasks (Task::compile()). At the beginning nothing is known - a value is only known if a
+ * previous task of the compiled recipe has set it. Tasks with unknown effects reset the state.
+ *
+ * Task::ExecutionHints are computed from the state, they tell a task which writes, reads and settle delays have no effect and can
+ * be skipped. CompileReport counts the skipped operations.
+ */
+#include "Relais.h"
+
+#include <string>
+
+/// estimated time of a relais read / write (min. 10ms between two accesses, see ACTUATOR_MIN_WRITE_INTERVAL_MS)
+#define RELAIS_ACCESS_TIME_MS 10
+
+class DeviceState{
+public:
+	/**
+	 * @brief init the state - nothing is known
+	 */
+	DeviceState();
+	
+	/**
+	 * @brief forget everything, used after tasks with unknown effects
+	 */
+	void reset();
+	
+	/**
+	 * @brief the relais have been read or written -> the state of the Relais object matches the microcontroller
+	 */
+	void setRelaisSynced();
+	
+	/**
+	 * @brief check if the relais have been read or written before
+	 * @return true if the relais do not need to be read
+	 */
+	bool isRelaisSynced() const;
+	
+	/**
+	 * @brief a relais has been set and written
+	 * @param r the relais
+	 * @param value value of the relais
+	 */
+	void setRelais(Relais::RELAIS r, bool value);
+	
+	/**
+	 * @brief the value of a relais is unknown
+	 * @param r the relais
+	 */
+	void forgetRelais(Relais::RELAIS r);
+	
+	/**
+	 * @brief check if a relais is known to have a value
+	 * @param r the relais
+	 * @param value expected value
+	 * @return true if the relais is known and has the value
+	 */
+	bool isRelais(Relais::RELAIS r, bool value) const;
+	
+	/**
+	 * @brief the voltage has been set
+	 * @param voltage the setpoint
+	 * @param mode the voltage mode (I2CVoltageTask::VOLTAGE_MODE)
+	 */
+	void setVoltage(unsigned int voltage, int mode);
+	
+	/**
+	 * @brief forget the voltage
+	 */
+	void forgetVoltage();
+	
+	/**
+	 * @brief check if the voltage is known to be set
+	 * @param voltage the setpoint
+	 * @param mode the voltage mode (I2CVoltageTask::VOLTAGE_MODE)
+	 * @return true if the voltage has been set to the same setpoint in the same mode
+	 */
+	bool isVoltage(unsigned int voltage, int mode) const;
+	
+	/**
+	 * @brief the frequency has been set
+	 * @param freq the frequency
+	 */
+	void setFrequency(unsigned int freq);
+	
+	/**
+	 * @brief check if the frequency is known to be set
+	 * @param freq the frequency
+	 * @return true if the frequency has been set to the same value
+	 */
+	bool isFrequency(unsigned int freq) const;
+
+private:
+	bool relaisSynced;
+	unsigned int relaisKnown; // bit mask
+	unsigned int relaisValues; // bit mask
+	bool voltageKnown;
+	unsigned int voltage;
+	int voltageMode;
+	bool frequencyKnown;
+	unsigned int frequency;
+};
+
+/// computed by Task::compile(), tells a task which operations can be skipped
+struct ExecutionHints{
+	bool relaisSynced; ///< relais are known -> readRelais() can be skipped
+	bool impRelaisOn; ///< relais are already switched to imp measurement -> no switching and settle delay
+	bool keepImpRelaisOn; ///< the next task measures the impedance as well -> do not switch back to ewod mode
+	bool sourceSet; ///< internal / external imp analyser relais is already in the right position
+	bool wireModeSet; ///< wire mode relais are already in the right position
+	bool setpointActive; ///< the voltage / frequency of the task is already set -> nothing to do
+	
+	/**
+	 * @brief init the hints - nothing is skipped
+	 */
+	ExecutionHints();
+};
+
+/// counts the operations which are skipped in each run of a compiled recipe
+struct CompileReport{
+	unsigned int tasks; ///< tasks of the flattened recipe
+	unsigned int recipes; ///< flattened nested recipes
+	unsigned int relaisWrites;
+	unsigned int relaisReads;
+	unsigned int settleDelays;
+	unsigned int setpoints;
+	unsigned long savedMs; ///< estimated time saved per run
+	
+	/**
+	 * @brief init the counters with 0
+	 */
+	CompileReport();
+	
+	/**
+	 * @brief format the report
+	 * @return e.g. "12 tasks (2 nested recipes flattened), skipped 4 relais writes, 6 relais reads, 2 settle delays, 1 setpoints -> saves ~2224ms per run"
+	 */
+	std::string to_string() const;
+};
@@ -9,7 +9,7 @@
  */
 
 #include "Timer.h"
-#include "Uc_Connection.h"
+#include "Telemetry.h"
 
 #include <gtkmm/dialog.h>
 #include <gtkmm/builder.h>
@@ -20,6 +20,9 @@
 #include <mutex>
 #include <chrono>
 
+/// update interval of the external voltage while the dialog is displayed
+#define DIALOG_EXT_VOLT_INTERVAL_MS 200
+
 class DialogExtVolt: public Gtk::Dialog{
 public:
 	
@@ -46,7 +49,7 @@ private:
 	typedef std::chrono::system_clock::time_point TimePoint;
 	
 	Timer timer;
-	Uc_Connection::Uc_Connection_ptr atmega32;
+	Telemetry::Telemetry_ptr telemetry;
 	Gtk::Button *button_close;
 	Gtk::Label *label_setpointVoltage;
 	Gtk::Label *label_actualVoltage;
@@ -79,7 +82,7 @@ private:
 	void onDispatcherEmit_mainContext();
 	
 	/**
-	 * @brief start the timer to update the external voltage
+	 * @brief start the timer to update the external voltage, the external voltage is sampled at the rate of the timer while the dialog is displayed
 	 */
 	void startTimer();
 	
@@ -0,0 +1,148 @@
+#pragma once
+/**
+ * @file DropletRouter.h
+ *
+ * @class DropletRouter
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see PadTask::createSteps
+ * @brief plans collision free routes of several droplets over the electrodes and moves them at the same time.
+ *
+ * The pad numbers do not encode the geometry of the circuit boards, so the adjacency of the pads is loaded from a file (loadAdjacency)
+ * or created for a rectangular array (createGrid). In each step a droplet stays on its pad or moves to an adjacent pad. Two droplets
+ * need a distance of at least getSeparation() pads (shortest path over the adjacent pads) - at the same step and between the new pad
+ * of one droplet and the previous pad of the other (the droplet is pulled by the new pad while the other one is still on its pad).
+ * With the default separation of 2 pads droplets are never on adjacent pads, so they do not merge.
+ *
+ * The droplets are planned one after another (prioritized planning): each route is searched with space-time A* (state: pad and step,
+ * heuristic: distance to the goal) and reserved for the following droplets. A droplet has arrived if it can stay on its goal until
+ * all reserved droplets have arrived. Droplets which have not been planned yet are obstacles on their start pad. If a droplet cannot
+ * be routed, the planning is repeated with this droplet first.
+ *
+ * getSteps() combines the routes: step n contains the pads of all droplets after n moves, so consecutive PadTasks (PadTask::createSteps)
+ * move all droplets in the same actuation cycles.
+ */
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstddef>
+
+/// default min. distance [pads] between two droplets
+#define DROPLET_ROUTER_SEPARATION 2
+/// default max. no of steps of a route
+#define DROPLET_ROUTER_MAX_STEPS 500
+
+class DropletRouter{
+public:
+	typedef std::shared_ptr<DropletRouter> DropletRouter_ptr;
+	
+	/// start and goal pad of a droplet
+	struct Droplet{
+		int start;
+		int goal;
+	};
+	
+	/// pad of the droplet in each step, front(): start, back(): goal
+	typedef std::vector<int> Route;
+	
+	/**
+	 * @brief creates a router without adjacent pads
+	 * @param pads no of pads (pads 1..pads)
+	 * @return smart pointer to the created object
+	 */
+	static DropletRouter_ptr create(unsigned int pads);
+	
+	/**
+	 * @brief creates a router for a rectangular array of pads, numbered row by row starting with 1
+	 * @param rows no of rows
+	 * @param columns no of columns
+	 * @return smart pointer to the created object
+	 */
+	static DropletRouter_ptr createGrid(unsigned int rows, unsigned int columns);
+	
+	/**
+	 * @brief creates a router with the adjacency of a file, same format as the csv recipes:
+	 * <pad>;<adjacent pad 1>;<adjacent pad 2>;...
+	 * the adjacency is symmetric - each pair needs to be listed once. Empty lines and lines starting with # are ignored
+	 * @param path the file
+	 * @param pads no of pads
+	 * @return smart pointer to the created object
+	 */
+	static DropletRouter_ptr loadAdjacency(std::string path, unsigned int pads);
+	
+	/**
+	 * @brief mark two pads as adjacent (both directions)
+	 * @param a pad 1..getPadCount()
+	 * @param b pad 1..getPadCount()
+	 */
+	void addAdjacency(int a, int b);
+	
+	/**
+	 * @brief check if two pads are adjacent
+	 * @return true if a droplet can move from a to b in one step
+	 */
+	bool isAdjacent(int a, int b) const;
+	
+	/**
+	 * @brief get the distance of two pads
+	 * @return no of moves between the pads, -1 if b cannot be reached from a
+	 */
+	int getDistance(int a, int b) const;
+	
+	/**
+	 * @brief set the min. distance between two droplets
+	 * @param separation distance [pads], at least 1 (droplets are not on the same pad)
+	 */
+	void setSeparation(unsigned int separation);
+	unsigned int getSeparation() const;
+	
+	/**
+	 * @brief set the max. no of steps of the routes
+	 * @param steps no of steps
+	 */
+	void setMaxSteps(unsigned int steps);
+	unsigned int getMaxSteps() const;
+	
+	unsigned int getPadCount() const;
+	
+	/**
+	 * @brief plan the routes of the droplets
+	 * @param droplets start and goal of each droplet
+	 * @return route of each droplet (same order as droplets), all routes have the same no of steps
+	 * @throws std::runtime_error if a pad does not exist, the starts or goals are too close or no routes have been found
+	 */
+	std::vector<Route> plan(const std::vector<Droplet> &droplets);
+	
+	/**
+	 * @brief check planned routes: each route starts / ends on the pads of its droplet, each step is a stay or a move to an adjacent pad
+	 * and all pairs of droplets keep getSeparation() at the same step and between the new pad of one and the previous pad of the other
+	 * @param droplets start and goal of each droplet
+	 * @param routes the routes, e.g. returned by plan()
+	 * @param error description of the first violation
+	 * @return true if the routes are valid
+	 */
+	bool verify(const std::vector<Droplet> &droplets, const std::vector<Route> &routes, std::string &error) const;
+	
+	/**
+	 * @brief combine the routes to steps
+	 * @param routes the routes returned by plan()
+	 * @return pads of all droplets after each move (the start is not included)
+	 */
+	static std::vector<std::vector<int>> getSteps(const std::vector<Route> &routes);
+
+private:
+	DropletRouter(unsigned int pads);
+	
+	void updateDistances() const;
+	bool findRoute(const Droplet &droplet, const std::vector<Route> &reserved, const std::vector<int> &waiting, Route &route) const;
+	bool isFree(int pad, int from, int t, const std::vector<Route> &reserved, const std::vector<int> &waiting) const;
+	bool isSeparated(int a, int b) const;
+	static int getPad(const Route &route, int t); // the droplet stays on its goal
+	
+	unsigned int pads;
+	unsigned int separation;
+	unsigned int maxSteps;
+	std::vector<std::vector<int>> adjacent; // adjacent pads of each pad, index: pad
+	mutable std::vector<int> distances; // (pads + 1) x (pads + 1), -1: not reachable
+	mutable bool distancesValid;
+};
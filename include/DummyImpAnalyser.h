@@ -19,6 +19,8 @@
 #define MIN_POINTS 1
 #define MAX_POINTS 1500
 #define MAX_POINT_AVERAGE 256
+/// time the dummy waits after a sweep
+#define DUMMY_SWEEP_DELAY_MS 500
 
 
 class DummyImpAnalyser: public ImpAnalyser{
@@ -34,12 +36,11 @@ public:
 	virtual ~DummyImpAnalyser();
 	
 	/**
-	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and stores the captured data
-	 * in a vector
-	 * @param running needs to be true to keep the meausrement running - used to stop the execution when set to false
-	 * @return the captured spectrum
+	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and passes each captured point to onPoint
+	 * @param onPoint called for each captured point
+	 * @param token used to stop the measurement when cancelled
 	 */
-	virtual std::vector<DataP::DataP_ptr> measureSpectrum(bool* running = new bool(true)) override;
+	virtual void streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token) override;
 	
 	
 	/**
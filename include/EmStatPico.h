@@ -10,12 +10,17 @@
 #include "ImpAnalyser.h"
 #include "DataP.h"
 #include "MeasurementPackage.h"
+#include "PicoPackage.h"
+#include "SerialReader.h"
 
 #include <vector>
 #include <memory>
 #include <list>
 
 #define TIMEOUT_S 10
+#define PICO_LINE_BUFFER 256
+/// max. time between two checks of the cancellation token while waiting for data
+#define PICO_CANCEL_CHECK_MS 50
 
 class EmStatPico: public ImpAnalyser{
 public:
@@ -29,12 +34,11 @@ public:
 	
 	
 	/**
-	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and stores the captured data
-	 * in a vector
-	 * @param running needs to be true to keep the meausrement running - used to stop the execution when set to false
-	 * @return the captured spectrum
+	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and passes each captured point to onPoint
+	 * @param onPoint called for each captured point
+	 * @param token used to stop the measurement when cancelled
 	 */
-	virtual std::vector<DataP::DataP_ptr> measureSpectrum(bool* running = new bool(true)) override;
+	virtual void streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the type of Impedance analyser
@@ -82,8 +86,8 @@ private:
 	static std::string formatNumber(double i);
 	
 	void startMeasurement(int fd, double f_min, double f_max, double current_min = 10e-9, double current_max = 10e-3);
-	MeasurementList_ptr receiveMeasurements(int fd);
-	bool waitForSerialData(int fd); // false -> timeout reached
+	bool receiveMeasurements(SerialReader &reader, const PointListener &onPoint, CancellationToken::CancellationToken_ptr token); // returns false if the token has been cancelled
+	void handlePackage(const PicoPackage &package, const PointListener &onPoint, unsigned int &index);
 	static int getNextCurrentRange(int current_range);
 	static int getPrevCurrentRange(int current_range);
 };
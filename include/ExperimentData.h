@@ -8,10 +8,20 @@
  * @brief the class stores data which is caputred during the execution of an experiment. The data will be stored
  * in the objects during the execute function of the Tasks. The class is used to save all the captured data
  * in the experiment folder and make the data accessible after the execution of an experiment.
+ * 
+ * All spectrums of an experiment are appended to one binary measurement file (MeasurementFile) in the measurements folder. The file is
+ * written by a MeasurementWriter in a background thread, so the recipe does not wait for the SD card. exportCSV converts that file
+ * into the csv files which have been written before (one file per spectrum).
+ * 
+ * Every file saved in the experiment folder is added to the manifest of the experiment (ExperimentManifest).
  */
 #include "DataP.h"
+#include "Spectrum.h"
 #include "Logbook.h"
 #include "TransSpect.h"
+#include "MeasurementWriter.h"
+#include "ExperimentManifest.h"
+#include "Telemetry.h"
 
 #include <vector>
 #include <mutex>
@@ -19,6 +29,7 @@
 #include <gtkmm.h>
 #include <sigc++/sigc++.h>
 #include <chrono>
+#include <cstdint>
 
 class ExperimentData{
 public:
@@ -34,20 +45,20 @@ public:
 	virtual ~ExperimentData();
 	
 	/**
-	 * @brief adds a captured Spectrum to the spectrums vector and saves the Spectrum in the experiment folder
+	 * @brief adds a captured Spectrum to the spectrums vector and saves the Spectrum in the measurement file
 	 * @param spectrum the spectrum which should be added
 	 *
 	 * called by SpectrometerTask during the execute function. 
 	 */
-	void addSpectrum(std::vector<DataP::DataP_ptr> spectrum);
+	void addSpectrum(Spectrum spectrum);
 	
 	/**
-	 * @brief adds a captured Impedance Spectrum to the impedanceMeasurements vector and saves the Impedance Spectrum in the experiment folder
+	 * @brief adds a captured Impedance Spectrum to the impedanceMeasurements vector and saves the Impedance Spectrum in the measurement file
 	 * @param spectrum the impedance spectrum which should be added
 	 *
 	 * called by HP4294ATask / NovocontrolTask during the execute function. 
 	 */
-	void addImpedanceSpectrum(std::vector<DataP::DataP_ptr> spectrum);
+	void addImpedanceSpectrum(Spectrum spectrum);
 	
 	/**
 	 * @brief add a transient impedance spectrum. on_Spec_added_listener is connected to onTransImpSpecAdded, so onTransImpSpecAdded will be
@@ -61,15 +72,15 @@ public:
 	
 	/**
 	 * @brief get the last added Spectrum
-	 * @return the last element of the spectrums vector, nullptr if vector is empty
+	 * @return the last element of the spectrums vector, empty spectrum if vector is empty
 	 */
-	std::vector<DataP::DataP_ptr> getLastSpectreDataPoints();
+	Spectrum getLastSpectreDataPoints();
 	
 	/**
 	 * @brief get the last added Impedance spectrum
-	 * @return the last element of the measured impedance vector, nullptr if vector is empty
+	 * @return the last element of the measured impedance vector, empty spectrum if vector is empty
 	 */
-	std::vector<DataP::DataP_ptr> getLastImpedanceDataPoints();
+	Spectrum getLastImpedanceDataPoints();
 	
 	/**
 	 * @brief check if there was a Spectrum added 
@@ -89,23 +100,64 @@ public:
 	 */
 	std::string getVideoPath() const;
 	
+	/**
+	 * @brief add the captured video to the manifest of the experiment
+	 * @return the path in the experiment folder where the captured video will be stored
+	 */
+	std::string addVideoFile();
+	
 	/**
 	 * @brief saves  the logfile of the experiment in the experiment folder
 	 */
 	void saveLogfile();
 	
+	/**
+	 * @brief saves the spans recorded since Trace::start() as trace.json in the experiment folder (Chrome trace event format)
+	 */
+	void saveTrace();
+	
+	/**
+	 * @brief saves the telemetry samples (voltages, frequencies, temperature) since the start of the experiment as telemetry.csv and
+	 * stops recording them
+	 *
+	 * throws a runtime_error if the file cannot be written or samples are missing (the file is written anyway)
+	 */
+	void saveTelemetry();
+	
 	/**
 	 * @brief get the path where the recipe should be stored in the project folder
 	 * @return path of the recipe
 	 */
 	std::string getRecipePath() const;
 	
+	/**
+	 * @brief add the recipe to the manifest of the experiment
+	 * @return path of the recipe
+	 */
+	std::string addRecipeFile();
+	
 	/**
 	 * @brief get the path where Measurements are stored <Project_Folder>/<Experiment_Folder>/<Measurement_Folder> - if the folder has not been created, yet it will be created
 	 * @return path of the Measurement Folder
 	 */
 	std::string getMeasurementsFolderPath();
 	
+	/**
+	 * @brief get the writer of the measurement file of the experiment - if it has not been created, yet it will be created
+	 * @return smart pointer to the writer (can be used to change the flush policy or read the counters)
+	 */
+	MeasurementWriter::MeasurementWriter_ptr getMeasurementWriter();
+	
+	/**
+	 * @brief export all spectrums of a measurement file into csv files (one file per spectrum, same format and names as the files which
+	 * have been written before the measurement file has been introduced)
+	 * @param measurementFilePath path of the measurement file
+	 * @param folderPath folder where the csv files are saved (created if it does not exist). If empty, a new folder "csv_<no>" is
+	 * created next to the measurement file and added to the manifest of the experiment
+	 * @return no of exported spectrums
+	 */
+	static unsigned int exportCSV(std::string measurementFilePath, std::string folderPath = "");
+	
 	/**
 	 * @brief sets an extern method which will be called each time a spectrum is added to a transient spectrum (can be used to update the gui)
 	 * @param listener the method which should be called when a spectrum is added to a transient spectrum
@@ -122,16 +174,21 @@ public:
 	Logbook::Logbook_ptr log;
 	
 private:
-	std::vector<std::vector<DataP::DataP_ptr>> spectrums;
+	std::vector<Spectrum> spectrums;
 	std::vector<TransSpect::TransSpect_ptr> transImpedanceMeasurements;
-	std::vector<std::vector<DataP::DataP_ptr>> impedanceMeasurements;
+	std::vector<Spectrum> impedanceMeasurements;
 	std::string projectPath;
 	std::string experimentName;
 	std::string experimentPath;
 	std::mutex spectrumsMtx;
 	std::mutex impSpectrumsMtx;
 	std::mutex transImpSpectrumsMtx;
+	ExperimentManifest::ExperimentManifest_ptr manifest;
+	MeasurementWriter::MeasurementWriter_ptr measurementWriter;
+	std::mutex measurementWriterMtx;
 	TimePoint recipeStartTime;
+	Telemetry::Telemetry_ptr telemetryService; // keeps the sampler running while the experiment records
+	Telemetry::Recording_ptr telemetry; // samples since the start of the experiment, nullptr after saveTelemetry()
 	
 	static sigc::slot<void, TransSpect::TransSpect_ptr, TransSpect::Spectrum,unsigned int, double, std::string> slot_onTransImpSpecAdded;
 	static TimePoint getCurrentTime();
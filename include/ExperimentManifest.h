@@ -0,0 +1,113 @@
+#pragma once
+/**
+ * @file ExperimentManifest.h
+ *
+ * @class ExperimentManifest
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see ExperimentData
+ * @see ListView_SavedData
+ * @brief append-only list (manifest.csv in the experiment folder) of all files which have been saved in an experiment folder. Each
+ * line contains the sequence no, the type, the time stamp and the path (relative to the experiment folder) of one file.
+ *
+ * New file names are created with a counter (per prefix), which is restored from the manifest when it is opened. So no file
+ * system calls are needed to find an unused name, and browsing an experiment only needs to read the manifest instead of listing
+ * the folders and parsing the file names.
+ */
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+
+#define EXPERIMENT_MANIFEST_NAME "manifest.csv"
+
+class ExperimentManifest{
+public:
+	typedef std::shared_ptr<ExperimentManifest> ExperimentManifest_ptr;
+	
+	/// type of a file
+	enum ENTRY_TYPE {ENTRY_MEASUREMENTS, ENTRY_CSV_EXPORT, ENTRY_LOGFILE, ENTRY_RECIPE, ENTRY_VIDEO, ENTRY_TRACE, ENTRY_TELEMETRY, ENTRY_UNKNOWN};
+	
+	/// one line of the manifest
+	struct Entry{
+		unsigned int sequenceNo;
+		ENTRY_TYPE type;
+		std::string timestamp;
+		std::string path; // relative to the experiment folder
+	};
+	
+	/**
+	 * @brief open the manifest of an experiment folder (the entries of an existing manifest are read). All callers share one object
+	 * per folder as long as it is used, so sequence numbers and counters are not allocated twice
+	 * @param experimentPath path of the experiment folder
+	 * @return smart pointer to the (already) opened manifest
+	 */
+	static ExperimentManifest_ptr open(std::string experimentPath);
+	
+	/**
+	 * @brief check if an experiment folder contains a manifest
+	 * @param experimentPath path of the experiment folder
+	 * @return true if the manifest exists
+	 */
+	static bool exists(std::string experimentPath);
+	
+	/**
+	 * @brief create a new file name using the counter of the prefix (<folder>/<prefix>_<counter>.<ending>) and add it to the manifest
+	 * @param folder folder relative to the experiment folder (empty for the experiment folder itself)
+	 * @param prefix the prefix of the file name
+	 * @param ending file ending (without '.'), empty for folders
+	 * @param type the type of the file
+	 * @return absolute path of the file
+	 */
+	std::string allocatePath(std::string folder, std::string prefix, std::string ending, ENTRY_TYPE type);
+	
+	/**
+	 * @brief add a file with a fixed name to the manifest - nothing happens if the path has already been added
+	 * @param path path relative to the experiment folder
+	 * @param type the type of the file
+	 * @return absolute path of the file
+	 */
+	std::string add(std::string path, ENTRY_TYPE type);
+	
+	/**
+	 * @brief get all entries of the manifest
+	 * @return the entries (in the order they have been added)
+	 */
+	std::vector<Entry> getEntries();
+	
+	/**
+	 * @brief get the path of the experiment folder
+	 * @return path of the experiment folder
+	 */
+	std::string getExperimentPath() const;
+	
+	/**
+	 * @brief convert a type into the string used in the manifest
+	 * @param type the type
+	 * @return the string
+	 */
+	static std::string typeToString(ENTRY_TYPE type);
+	
+	/**
+	 * @brief convert a string used in the manifest into a type
+	 * @param s the string
+	 * @return the type, ENTRY_UNKNOWN if the string is unknown
+	 */
+	static ENTRY_TYPE stringToType(const std::string &s);
+
+private:
+	ExperimentManifest(std::string experimentPath);
+	void read();
+	void append(const Entry &e); // mtx needs to be locked
+	
+	std::string experimentPath;
+	std::vector<Entry> entries;
+	std::set<std::string> paths;
+	std::map<std::string, unsigned int> counters; // prefix (incl. folder) -> next no
+	std::mutex mtx;
+	
+	static std::map<std::string, std::weak_ptr<ExperimentManifest>> instances; // experiment folder -> opened manifest
+	static std::mutex instancesMtx;
+};
@@ -8,6 +8,7 @@
  * @brief class containing static helping methods to do simple string and file system operations
  */
 #include "DataP.h"
+#include "Spectrum.h"
 
 #include <string>
 #include <vector>
@@ -76,14 +77,14 @@ public:
 	static std::string formatDouble(double d);
 	
 	/**
-	 * @brief saves a DataP vector to a csv file
+	 * @brief saves a spectrum to a csv file
 	 * @param data the data which should be saved
 	 * @param path where the csv file should be stored
 	 * @param header header of the xml file
 	 * @param x_label legend of the x axis
 	 * @param y_label legend of the y axis
 	 */
-	static void save_dataPToCsv(const std::vector<DataP::DataP_ptr> &data, std::string path, bool y_real = true, bool y_imag = true, bool y_abs = false, bool y_phase = false, std::string x_label = "x_coordinate", std::string y_label = "y_coordinate", std::string header = "");
+	static void save_dataPToCsv(const Spectrum &data, std::string path, bool y_real = true, bool y_imag = true, bool y_abs = false, bool y_phase = false, std::string x_label = "x_coordinate", std::string y_label = "y_coordinate", std::string header = "");
 	
 	/**
 	 * @brief return the content of a directory as vector of strings. The vector is sorted using numeric_string_compare function
@@ -19,7 +19,7 @@ public:
 	Freq_Test();
 	static Freq_Test_ptr create();
 	
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	virtual std::string getType() const override;
 	virtual tinyxml2::XMLElement* toXMLElement(tinyxml2::XMLDocument *doc, bool externElements = false) override;
 	
@@ -24,9 +24,11 @@
 #include "Camera_cv.h"
 #include "StatusLed.h"
 #include "TransSpect.h"
+#include "TransSpectLoader.h"
 #include "Relais.h"
 #include "PadTask.h"
 #include "Timer.h"
+#include "Telemetry.h"
 
 #include <stdexcept>
 #include <gtkmm.h> 
@@ -109,6 +111,9 @@ private:
 	Gtk::Button *button_selectProject;
 	Gtk::Button *button_selectExperiment;
 	Gtk::Button *button_selectSpectrum;
+	Gtk::Button *button_exportCSV;
+	Gtk::Button *button_cancelLoad;
+	Gtk::ProgressBar *progressbar_load;
 	Gtk::TextView *textView_gpib_message;
 	Gtk::Notebook *notebook_page_exData;
 	Gtk::Notebook *notebook_overview;
@@ -209,6 +214,7 @@ private:
 	GpibConnection *gpib;
 	StatusLed::StatusLed_ptr status_leds;
 	Relais::Relais_ptr relais;
+	Telemetry::Telemetry_ptr telemetry;
 	
 	TransientGUIHandler transientViewHandler;
 	
@@ -217,6 +223,8 @@ private:
 	Gtk::Button *buttonPadsExecute;
 	
 	Glib::Dispatcher logEventDispatcher;
+	Glib::Dispatcher transSpectLoaderDispatcher;
+	TransSpectLoader::TransSpectLoader_ptr transSpectLoader; // loads a transient spectrum from csv files in the background
 	
 	static void onTransImpSpecAdded (TransSpect::TransSpect_ptr p, TransSpect::Spectrum s, std::string path);
 	
@@ -250,6 +258,8 @@ private:
 	void on_buttonSelectProject_clicked();
 	void on_buttonSelectExperiment_clicked();
 	void on_buttonSelectSpectrum_clicked();
+	void on_buttonExportCSV_clicked();
+	void on_buttonCancelLoad_clicked();
 	void on_checkbuttonPreview_toggled();
 	void dialogSave_on_buttonSave_clicked();
 	void dialogSave_on_buttonCancel_clicked();
@@ -285,11 +295,9 @@ private:
 	
 	void updateThread();
 	
-	void setImpSpectrum(std::vector<DataP::DataP_ptr> s, std::string title = "");
-	void setSpectrum(std::vector<DataP::DataP_ptr> s, std::string title = "");
+	void setImpSpectrum(Spectrum s, std::string title = "");
+	void setSpectrum(Spectrum s, std::string title = "");
 	void setTransImpSpectrum(TransSpect::TransSpect_ptr p, std::string path = "");
-	static std::vector<DataP::DataP_ptr> loadSpectrum(std::string path);
-	static std::vector<DataP::DataP_ptr> loadImpSpectrum(std::string path);
 	
 	
 	static void *executemyrecipe(void *recipes);
@@ -300,7 +308,7 @@ public:
 	public:
 		ExecuteMyRecipeThreadData(){
 //			dispatcher();
-			executeNext = new bool(true);
+			token = CancellationToken::create();
 			finished = false;
 			error = nullptr;
 		}
@@ -309,7 +317,7 @@ public:
 		}
 		Recipe::Recipe_ptr recipe;
 		ExperimentData::ExperimentData_ptr pData;
-		bool *executeNext;
+		CancellationToken::CancellationToken_ptr token;
 		bool finished;
 		Glib::Dispatcher dispatcher;
 		std::runtime_error* error;
@@ -323,4 +331,5 @@ public:
 	void on_preview_captured(Camera_cv::Image_ptr image);
 	
 	void logEventDispatcherFunction();
+	void transSpectLoaderDispatcherFunction();
 };
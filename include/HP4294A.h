@@ -49,12 +49,11 @@ public:
 	void setBw(unsigned short bw);
 	
 	/**
-	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and stores the captured data
-	 * in a vector
-	 * @param running needs to be true to keep the meausrement running - used to stop the execution when set to false
-	 * @return the captured spectrum
+	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and passes each captured point to onPoint
+	 * @param onPoint called for each captured point
+	 * @param token used to stop the measurement when cancelled
 	 */
-	virtual std::vector<DataP::DataP_ptr> measureSpectrum(bool* running = new bool(true)) override;
+	virtual void streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the type of Impedance analyser
@@ -44,9 +44,9 @@ public:
 	/**
 	 * @brief sets the relias (if nessecarry) and transmits the new frequency. If the freq is set to 0, the relais will be switched to disable the frequency generator. No frequency will be transmitted in that case
 	 * @param data object which can be used to store captured data. Not used in this task_element
-	 * @param executeNext varialbe which is used to stop the execution
+	 * @param token used to stop the execution
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the type of the task, 'I2CFreqTask'
@@ -68,6 +68,24 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief skips the relais read if the relais are known and the whole task if the frequency is already set
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the i2c and relais accesses, no time if the frequency is already set
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 	/**
 	 * @brief create a I2CFreqTask from data defined in a xml file and return a smart pointer to the created object
 	 * @param task_element part of the xml file which contains the params of the I2CFreqTask
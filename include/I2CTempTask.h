@@ -6,6 +6,8 @@
  * @author Nils Bosbach
  * @date 10.04.2019
  * @brief This class implemnets the protocol to read the DHT11 data from atmega32 via I2C. The method execute requests the data and stores it in the class variable data, which can be read via getTempData
+ * 
+ * The DHT11 is only accessed by the Telemetry service, execute requests a sample (Telemetry::sampleNow) and waits for it.
  */
 #include "I2CTask.h"
 #include "Uc_Connection.h"
@@ -31,11 +33,11 @@ public:
 	virtual ~I2CTempTask();
 	
 	/**
-	 * @brief triggers the atmega32 to request a measurement from the DHT11 and request the mesaurement. It can be accessed via the getTempData function
+	 * @brief requests a measurement of the DHT11 from the Telemetry service and waits for the sample. It can be accessed via the getTempData function
 	 * @param data object where captured data can be stored - not used in this I2CTempTask
-	 * @param executeNext used to stop a running experiment if value is false
+	 * @param token used to stop a running experiment if cancelled
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the kind of task as string
@@ -63,6 +65,24 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief the task does not change the state of the relais, the voltage and the frequency
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the time of a temperature measurement
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 private:
 	TempData::TempData_ptr data; // pointer to the last measurement
 	bool measurementValid;
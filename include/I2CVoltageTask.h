@@ -16,6 +16,10 @@
 #include <pthread.h>
 #include <memory>
 #include <chrono>
+#include <atomic>
+
+/// time the voltage controller gets to accept a new setpoint before it is read back
+#define VOLTAGE_SETPOINT_ACCEPT_MS 1
 
 class I2CVoltageTask: public I2CTask{
 
@@ -54,10 +58,9 @@ public:
 	/**
 	 * @brief switches relais (if necessary) and transmits the new setpoint to the controller. If voltage_on is false, relais are switched to deactivate the boost converter
 	 * @param data object where captured data can be stored - not used in this I2CTempTask
-	 * @param executeNext used to stop a running experiment if value is false
-	 * @param executeNext
+	 * @param token used to stop a running experiment if cancelled
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override; // sends the request to uc
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override; // sends the request to uc
 	
 	/**
 	 * @brief get the kind of task as string
@@ -79,6 +82,24 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief skips the relais reads if the relais are known and the whole task if the voltage is already set (controller mode)
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the i2c and relais accesses, the ramp / discharge of the internal source and the check of the voltage. Takes no time if the voltage is already set
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 	/**
 	 * @brief create a I2CVoltageTask from data defined in a xml file and return a smart pointer to the created object
 	 * @param task_element part of the xml file which contains the params of the I2CFreqTask
@@ -177,6 +198,18 @@ public:
 	 */
 	bool getWaitForVoltage() const;
 	
+	/**
+	 * @brief decide whether the setpoint is trimmed until the measured voltage matches the voltage (closed loop, tolerance 1%)
+	 * @param closedLoop if true, the setpoint is trimmed by the VoltageSettler; if false, the setpoint is written once (tolerance 5%)
+	 */
+	void setClosedLoop(bool closedLoop);
+	
+	/**
+	 * @brief check whether the setpoint is trimmed until the measured voltage matches the voltage
+	 * @return true in closed loop mode
+	 */
+	bool getClosedLoop() const;
+	
 	std::string to_string() const;
 	
 	static DialogExtVolt *dialogExtVolt;
@@ -187,10 +220,15 @@ public:
 private:
 	unsigned int voltage;
 	bool waitForVoltage;
+	bool closedLoop;
 	double dutyCycle;
 	VOLTAGE_MODE mode;
 	
+	/// setpoint [V] which has been reached (VoltageSettler::isSettled) by the last task in MODE_CONTROLLER, -1 if the last task failed, has
+	/// been cancelled or has not waited for the voltage
+	static std::atomic<int> activeSetpoint;
 	
-	void setInternalVoltage(bool* executeNext);
-	void setExternalVoltage(bool* executeNext);
+	void setInternalVoltage(CancellationToken::CancellationToken_ptr token);
+	void setExternalVoltage(CancellationToken::CancellationToken_ptr token);
+	double dischargeCapacitor(CancellationToken::CancellationToken_ptr token, double current_voltage); // returns the voltage after discharging
 };
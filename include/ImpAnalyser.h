@@ -10,15 +10,21 @@
  */
 
 #include "DataP.h"
+#include "Spectrum.h"
+#include "CancellationToken.h"
 
 #include <vector>
 #include <memory>
+#include <functional>
 #include <tinyxml2.h>
 
 class ImpAnalyser {
 public:
 	typedef std::shared_ptr<ImpAnalyser> ImpAnalyser_ptr;
 	
+	/// called for each measured point of a sweep - x: frequency, y_real / y_imag: impedance, index: no of the point in the sweep
+	typedef std::function<void(double x, double y_real, double y_imag, unsigned int index)> PointListener;
+	
 	enum WIRE_MODE {TWO_WIRE=2, THREE_WIRE=3, FOUR_WIRE=4};
 	enum ANALYSER_DEVICE {ANALYSER_NOVOCONTROL, ANALYSER_HP4294A, ANALYSER_EMPICO, ANALYSER_DUMMY};
 	
@@ -54,6 +60,13 @@ public:
 	 */
 	int getPointAverage() const;
 	
+	/**
+	 * @brief get the frequency of a point of the sweep, the points are distributed logarithmically between the start and stop frequency
+	 * @param i no of the point (0, ..., getPoints()-1)
+	 * @return frequency of the point
+	 */
+	double getPointFrequency(int i) const;
+	
 	
 	/**
 	 * @brief method to get the name of the impedance analyser (specified by derived class)
@@ -132,13 +145,30 @@ public:
 	 */
 	void setWireMode(WIRE_MODE w);
 	
+	/**
+	 * @brief get the position of the relais which configure a wire mode
+	 * @param w wire mode
+	 * @param re_p_ce value of the relais R_STEUER_RE_P_CE
+	 * @param we_p_we_s value of the relais R_STEUER_WE_P_WE_S
+	 */
+	static void getWireModeRelais(WIRE_MODE w, bool &re_p_ce, bool &we_p_we_s);
+	
 	/**
 	 * @brief the method triggers the impedance analyser to measure an impedance spectrum and requests the meausred data
-	 * @param running used by Task during the execute function to stop the execution of a recipe
+	 * @param token used by Task during the execute function to stop the execution of a recipe
 	 * @return the spectrum which was captured by the impedance analyser
 	 * @see Task
+	 * @see streamSpectrum
+	 */
+	Spectrum measureSpectrum(CancellationToken::CancellationToken_ptr token = CancellationToken::create());
+	
+	/**
+	 * @brief triggers the impedance analyser to measure an impedance spectrum. Each point is passed to onPoint as soon as it has
+	 * been measured, so the caller does not have to wait for the whole sweep
+	 * @param onPoint called for each measured point (in the thread calling streamSpectrum)
+	 * @param token used by Task during the execute function to stop the execution of a recipe, waits of the device sleep on the token
 	 */
-	virtual std::vector<DataP::DataP_ptr> measureSpectrum(bool* running = new bool(true)) = 0;
+	virtual void streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token) = 0;
 	
 	/**
 	 * @brief used to save the params in a xml document
@@ -155,7 +185,7 @@ public:
 	 * @param position used for the position if spectrum is part of a transient spectrum, -1 otherwise
 	 * @param timediff used for the timedifference to the first spectrum if spectrum is part of a transient spectrum, -1 otherwise
 	 */
-	static void save_spectrumCSV(const std::vector<DataP::DataP_ptr> &spectrum, std::string path, int position = -1, double timediff = -1);
+	static void save_spectrumCSV(const Spectrum &spectrum, std::string path, int position = -1, double timediff = -1);
 	
 	
 	/**
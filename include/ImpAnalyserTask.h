@@ -30,9 +30,9 @@ public:
 	/**
 	 * @brief requests a spectrum from the impedance analyser and stores it in the ExperimentData object
 	 * @param data object where the captured data is stored
-	 * @param executeNext needs to be true to execute a task - used to stop the execution
+	 * @param token used to stop the execution
 	 */
-	void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief used to get the type of the Task
@@ -54,6 +54,30 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief get a list of all devices, which are used while the task is executed
+	 * @return the analyser, DEVICE_ATMEGA_GENERAL (impedance / source / wire mode relais) and DEVICE_ELECTRODES (the pads are switched to the analyser)
+	 */
+	virtual std::list<Task::DEVICES> getUsedDevices() override;
+	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief skips the relais writes and settle delays if the relais are already in the right position or the next task measures the impedance as well
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the sweep of the impedance analyser and the relais writes and settle delays which are not skipped
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 	/**
 	 * @brief creates an ImpAnalyserTask from the data specified in a xml file
 	 * @param task_elemmnt the part of a xml document which contain the information of the ImpAnalyserTask
@@ -8,6 +8,8 @@
  * @brief 
  */
 #include "DataP.h"
+#include "MeasurementFileReader.h"
+#include "ExperimentManifest.h"
 
 #include <gtkmm.h>
 #include <vector>
@@ -27,6 +29,24 @@ public:
 	std::vector<std::string> getSelectedTransSpectrumPaths();
 	SPECTRUM_TYPE getSelectedSpectrumType();
 	
+	/**
+	 * @brief check if the selected spectrum is stored in a measurement file (and not in a csv file)
+	 * @return true if the selected path is a measurement file
+	 */
+	bool isMeasurementFileSelected();
+	
+	/**
+	 * @brief get the index of the selected record in the measurement file
+	 * @return index of the record, -1 if no record is selected
+	 */
+	int getSelectedRecordIndex();
+	
+	/**
+	 * @brief get the number of the selected spectrum (no of the transient spectrum if a transient spectrum is selected)
+	 * @return the number, -1 if nothing is selected
+	 */
+	int getSelectedSpectrumNumber();
+	
 protected:
 	class ModelColumns : public Gtk::TreeModel::ColumnRecord{
 	public:
@@ -35,11 +55,13 @@ protected:
 			add(m_col_spectrumNumber);
 			add(m_col_spectrumType);
 			add(m_col_spectrumType_string);
+			add(m_col_recordIndex);
 		}
 		Gtk::TreeModelColumn<Glib::ustring> m_col_spectrumPath;
 		Gtk::TreeModelColumn<int> m_col_spectrumNumber;
 		Gtk::TreeModelColumn<int> m_col_spectrumType;
 		Gtk::TreeModelColumn<Glib::ustring> m_col_spectrumType_string;
+		Gtk::TreeModelColumn<int> m_col_recordIndex; // index of the record in the measurement file, -1 for csv files
 		
 	};
 	
@@ -51,5 +73,6 @@ protected:
 	void addSpectrum(std::string path, std::string filename);
 	void addImpSpectrum(std::string path, std::string filename);
 	void addTransImpSpectrum(std::string path, std::string filename);
+	void addMeasurementFile(std::string path);
 };
 
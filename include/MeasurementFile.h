@@ -0,0 +1,100 @@
+#pragma once
+/**
+ * @file MeasurementFile.h
+ *
+ * @class MeasurementFile
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see MeasurementFileReader
+ * @see MeasurementWriter
+ * @brief append-only binary file containing all spectrums of an experiment (instead of one csv file per spectrum).
+ *
+ * format (host byte order, all payloads are 8 byte aligned):
+ * - file header: FileHeader
+ * - records (chunks), appended one after the other: RecordHeader, followed by points x values, points real parts and points imaginary
+ *   parts (float64 each)
+ *
+ * Each record is written with one call, the file is only flushed by flush(). A record which has not been written completely (e.g. power
+ * loss) is ignored by the reader.
+ */
+#include "Spectrum.h"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+#define MEASUREMENT_FILE_MAGIC "PDMEAS01"
+#define MEASUREMENT_FILE_VERSION 1
+#define MEASUREMENT_FILE_RECORD_MAGIC 0x44434552 // "RECD"
+#define MEASUREMENT_FILE_NAME "measurements"
+#define MEASUREMENT_FILE_EXTENSION "pdm"
+
+class MeasurementFile{
+public:
+	typedef std::shared_ptr<MeasurementFile> MeasurementFile_ptr;
+	
+	/// type of the stored spectrum
+	enum RECORD_TYPE {RECORD_SPECTRUM = 1, RECORD_IMPEDANCE = 2, RECORD_TRANS_IMPEDANCE = 3};
+	
+	struct FileHeader{
+		char magic[8]; // MEASUREMENT_FILE_MAGIC
+		uint32_t version;
+		uint32_t headerSize; // sizeof(FileHeader)
+		double created; // unix time
+	};
+	
+	struct RecordHeader{
+		uint32_t magic; // MEASUREMENT_FILE_RECORD_MAGIC
+		uint32_t type; // RECORD_TYPE
+		uint32_t series; // no of the transient spectrum (0 for other types)
+		uint32_t position; // position of the spectrum (in the transient spectrum / in the experiment)
+		double timestamp; // seconds since the start of the experiment / transient spectrum
+		uint32_t points; // no of points of the spectrum
+		uint32_t reserved;
+	};
+	
+	/**
+	 * @brief opens (or creates) a measurement file - new records are appended
+	 * @param path path of the file
+	 * @return smart pointer to the created object
+	 */
+	static MeasurementFile_ptr create(std::string path);
+	
+	/**
+	 * @brief closes the file
+	 */
+	virtual ~MeasurementFile();
+	
+	/**
+	 * @brief append a spectrum to the file
+	 * @param type type of the spectrum
+	 * @param series no of the transient spectrum
+	 * @param position position of the spectrum
+	 * @param timestamp seconds since the start of the experiment / transient spectrum
+	 * @param s the spectrum
+	 * @return no of written bytes
+	 */
+	std::size_t append(RECORD_TYPE type, unsigned int series, unsigned int position, double timestamp, const Spectrum &s);
+	
+	/**
+	 * @brief flush the written records
+	 * @param sync call fsync after the flush (wait until the data has been written to the storage device)
+	 */
+	void flush(bool sync = false);
+	
+	/**
+	 * @brief get the path of the file
+	 * @return path of the file
+	 */
+	std::string getPath() const;
+
+private:
+	MeasurementFile(std::string path);
+	
+	std::string path;
+	FILE* file;
+	std::mutex fileMtx;
+};
@@ -0,0 +1,93 @@
+#pragma once
+/**
+ * @file MeasurementFileReader.h
+ *
+ * @class MeasurementFileReader
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see MeasurementFile
+ * @brief reads a measurement file written by MeasurementFile. The file is mapped into memory (mmap), an index of all records is built
+ * by jumping from record header to record header (the payloads are not read), so opening a file with thousands of spectrums only takes
+ * a few milliseconds. The payload of a record is only touched when the spectrum is requested.
+ */
+#include "MeasurementFile.h"
+#include "Spectrum.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+class MeasurementFileReader{
+public:
+	typedef std::shared_ptr<MeasurementFileReader> MeasurementFileReader_ptr;
+	
+	/// index entry of one record
+	struct Record{
+		MeasurementFile::RECORD_TYPE type;
+		unsigned int series;
+		unsigned int position;
+		double timestamp;
+		unsigned int points;
+		std::size_t offset; // offset of the payload in the file
+	};
+	
+	/**
+	 * @brief maps the file into memory and builds the index
+	 * @param path path of the measurement file
+	 * @return smart pointer to the created object
+	 *
+	 * throws a runtime_error if the file could not be opened or is no measurement file
+	 */
+	static MeasurementFileReader_ptr create(std::string path);
+	
+	/**
+	 * @brief unmaps the file
+	 */
+	virtual ~MeasurementFileReader();
+	
+	/**
+	 * @brief get the no of (completely written) records
+	 * @return no of records
+	 */
+	std::size_t getRecordCount() const;
+	
+	/**
+	 * @brief get the index entry of a record
+	 * @param i index of the record
+	 * @return the index entry
+	 */
+	const Record& getRecord(std::size_t i) const;
+	
+	/**
+	 * @brief get the stored spectrum of a record
+	 * @param i index of the record
+	 * @return the spectrum
+	 */
+	Spectrum getSpectrum(std::size_t i) const;
+	
+	/**
+	 * @brief get the indices of all records of one type (and one series)
+	 * @param type the type of the records
+	 * @param series no of the transient spectrum, ignored if type is not RECORD_TRANS_IMPEDANCE
+	 * @return indices of the records (in the order they have been written)
+	 */
+	std::vector<std::size_t> getRecords(MeasurementFile::RECORD_TYPE type, unsigned int series = 0) const;
+	
+	/**
+	 * @brief get the path of the file
+	 * @return path of the file
+	 */
+	std::string getPath() const;
+
+private:
+	MeasurementFileReader(std::string path);
+	
+	std::string path;
+	int fd;
+	const char* map;
+	std::size_t mapSize;
+	std::vector<Record> records;
+	
+	void buildIndex();
+};
@@ -7,6 +7,7 @@
  * @date 31.08.2019
  * @see MeasurementValue
  * @see MeasurementError
+ * @see PicoPackage
  * @brief this class represents one measurement package received by the EmStat pico potentiostat. The measurement values (e.g. frequency, voltage, ...) are stored in a list of MeasurmentValue.
  */
 #include "MeasurementValue.h"
@@ -0,0 +1,149 @@
+#pragma once
+/**
+ * @file MeasurementWriter.h
+ *
+ * @class MeasurementWriter
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see MeasurementFile
+ * @see ExperimentData
+ * @brief writes spectrums to a measurement file in a background thread. write() only puts the spectrum into a bounded queue (the
+ * spectrum itself is not copied, Spectrum shares its data), so the thread executing the recipe does not wait for the SD card.
+ *
+ * When the queue is full, write() either waits until there is space (BACKPRESSURE_BLOCK) or drops the spectrum (BACKPRESSURE_DROP).
+ * The writer thread flushes the file after each record, when the queue is empty or after a fixed interval (FLUSH_POLICY) and
+ * optionally calls fsync after each flush.
+ */
+#include "MeasurementFile.h"
+#include "Spectrum.h"
+
+#include <string>
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+/// default max. no of spectrums in the queue
+#define MEASUREMENT_WRITER_QUEUE_SIZE 256
+
+/// default interval for FLUSH_INTERVAL
+#define MEASUREMENT_WRITER_FLUSH_INTERVAL_MS 1000
+
+class MeasurementWriter{
+public:
+	typedef std::shared_ptr<MeasurementWriter> MeasurementWriter_ptr;
+	
+	/// when the file is flushed
+	enum FLUSH_POLICY {FLUSH_EACH_RECORD, FLUSH_WHEN_IDLE, FLUSH_INTERVAL};
+	
+	/// what happens if write() is called while the queue is full
+	enum BACKPRESSURE {BACKPRESSURE_BLOCK, BACKPRESSURE_DROP};
+	
+	/// counters of the writer
+	struct Statistics{
+		std::size_t queueDepth; // no of spectrums waiting in the queue
+		std::size_t maxQueueDepth;
+		unsigned long recordsWritten;
+		unsigned long recordsDropped; // dropped because the queue was full (BACKPRESSURE_DROP)
+		unsigned long writeErrors;
+		unsigned long long bytesWritten;
+		double lastWriteLatency_ms; // duration of writing (and flushing) one record
+		double maxWriteLatency_ms;
+		double avgWriteLatency_ms;
+	};
+	
+	/**
+	 * @brief opens the measurement file and starts the writer thread
+	 * @param path path of the measurement file
+	 * @param queueSize max. no of spectrums in the queue
+	 * @return smart pointer to the created object
+	 */
+	static MeasurementWriter_ptr create(std::string path, std::size_t queueSize = MEASUREMENT_WRITER_QUEUE_SIZE);
+	
+	/**
+	 * @brief writes the remaining spectrums of the queue, flushes the file and stops the writer thread
+	 */
+	virtual ~MeasurementWriter();
+	
+	/**
+	 * @brief put a spectrum into the queue
+	 * @param type type of the spectrum
+	 * @param series no of the transient spectrum
+	 * @param position position of the spectrum
+	 * @param timestamp seconds since the start of the experiment / transient spectrum
+	 * @param s the spectrum
+	 * @return false if the spectrum has been dropped because the queue was full
+	 */
+	bool write(MeasurementFile::RECORD_TYPE type, unsigned int series, unsigned int position, double timestamp, const Spectrum &s);
+	
+	/**
+	 * @brief set when the file is flushed
+	 * @param policy the flush policy
+	 * @param interval_ms interval for FLUSH_INTERVAL
+	 */
+	void setFlushPolicy(FLUSH_POLICY policy, unsigned int interval_ms = MEASUREMENT_WRITER_FLUSH_INTERVAL_MS);
+	
+	/**
+	 * @brief set if fsync is called after each flush (the data is on the SD card, not only in the page cache)
+	 * @param sync true to call fsync
+	 */
+	void setFsync(bool sync);
+	
+	/**
+	 * @brief set what happens if write() is called while the queue is full
+	 * @param b BACKPRESSURE_BLOCK (default) or BACKPRESSURE_DROP
+	 */
+	void setBackpressure(BACKPRESSURE b);
+	
+	/**
+	 * @brief wait until all spectrums of the queue have been written and the file has been flushed
+	 */
+	void waitUntilWritten();
+	
+	/**
+	 * @brief get the counters of the writer
+	 * @return the counters
+	 */
+	Statistics getStatistics();
+	
+	/**
+	 * @brief get the path of the measurement file
+	 * @return path of the file
+	 */
+	std::string getPath() const;
+
+private:
+	struct Job{
+		MeasurementFile::RECORD_TYPE type;
+		unsigned int series;
+		unsigned int position;
+		double timestamp;
+		Spectrum spectrum;
+	};
+	
+	MeasurementWriter(std::string path, std::size_t queueSize);
+	void writeThread();
+	void flush(bool sync); // queueMtx must not be locked
+	
+	MeasurementFile::MeasurementFile_ptr file;
+	std::deque<Job> queue;
+	std::size_t queueSize;
+	FLUSH_POLICY flushPolicy;
+	unsigned int flushInterval_ms;
+	bool fsyncEnabled;
+	BACKPRESSURE backpressure;
+	bool running;
+	bool busy; // a job is being written
+	bool dirty; // written records have not been flushed
+	bool flushRequested;
+	Statistics stats;
+	double latencySum_ms;
+	
+	std::mutex queueMtx;
+	std::condition_variable queueNotEmpty;
+	std::condition_variable queueNotFull;
+	std::condition_variable allWritten;
+	std::thread writer_thread;
+};
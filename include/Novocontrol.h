@@ -20,6 +20,8 @@
 #define MIN_POINTS 1
 #define MAX_POINTS 1500
 #define MAX_POINT_AVERAGE 256
+/// time between two requests of the measurement state
+#define NOVOCONTROL_POLL_INTERVAL_MS 20
 
 
 class Novocontrol: public ImpAnalyser{
@@ -35,12 +37,11 @@ public:
 	virtual ~Novocontrol();
 	
 	/**
-	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and stores the captured data
-	 * in a vector
-	 * @param running needs to be true to keep the meausrement running - used to stop the execution when set to false
-	 * @return the captured spectrum
+	 * @brief applys the params, triggers the meausrements of the points in logarithmic linear contribution and passes each captured point to onPoint
+	 * @param onPoint called for each captured point
+	 * @param token used to stop the measurement when cancelled
 	 */
-	virtual std::vector<DataP::DataP_ptr> measureSpectrum(bool* running = new bool(true)) override;
+	virtual void streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token) override;
 	
 	
 	/**
@@ -91,5 +92,5 @@ private:
 	inline void sendOKCommand(std::string command);
 	inline void applyAcVoltageAmplitude();
 	inline void applyWireMode();
-	DataP::DataP_ptr measureFreq(double freq);
+	DataP::DataP_ptr measureFreq(double freq, CancellationToken::CancellationToken_ptr token); // returns nullptr if the token has been cancelled
 };
@@ -0,0 +1,155 @@
+#pragma once
+/**
+ * @file PadGpio.h
+ *
+ * @class PadGpio
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see PadTask
+ * @see Transport
+ * @brief maps the pads to the gpio pins of the pad multiplexers and switches them.
+ *
+ * 2 circuit boards (chip select CS_1, CS_2) with 4 uc x 12 pads + 1 uc x 11 pads = 59 pads each. A pad is selected by its no on the
+ * uc (ADC_0..ADC_3) and the chip select of its board, the uc latches the address on its enable pin (EN_1..EN_5). The pcb, uc and pad
+ * numbers are computed at compile time (constexpr) and stored as BCM bit masks, one entry per pad. A pad is switched with three
+ * writePins() calls (address, enable, disable) - each sets / clears all pins of a mask at once (GPSET0 / GPCLR0).
+ *
+ * The previous implementation with one digitalWrite per pin is kept (setPadHighPinwise, setPadsLowPinwise), verify() checks that
+ * both produce the same levels whenever the multiplexers latch.
+ */
+#include "Transport.h"
+#include "Addresses.h"
+
+#include <string>
+#include <cstdint>
+
+/// no of pads (2 circuit boards)
+#define PAD_GPIO_PADS 118
+/// no of pads of one circuit board
+#define PAD_GPIO_PADS_PER_PCB 59
+/// no of pads of one uc
+#define PAD_GPIO_PADS_PER_UC 12
+/// time the address is set before / while the uc is enabled
+#define PAD_GPIO_SETUP_US 20
+/// time all ucs are enabled to clear the pads
+#define PAD_GPIO_CLEAR_US 30
+
+class PadGpio{
+public:
+	/// pins of one pad (bit n: BCM pin n)
+	struct Masks{
+		std::uint32_t address; // ADC_0..ADC_3 and CS_1 / CS_2 which are high
+		std::uint32_t enable; // EN_x of the uc
+	};
+	
+	/**
+	 * @brief get the circuit board of a pad
+	 * @param pad 1..118
+	 * @return 1, 2
+	 */
+	static constexpr int getPcb(unsigned int pad){
+		return (pad + PAD_GPIO_PADS_PER_PCB - 1) / PAD_GPIO_PADS_PER_PCB;
+	}
+	
+	/**
+	 * @brief get the uc of a pad on its circuit board
+	 * @param pad 1..118
+	 * @return 1..5
+	 */
+	static constexpr int getUc(unsigned int pad){
+		return (pad - (getPcb(pad) - 1) * PAD_GPIO_PADS_PER_PCB + PAD_GPIO_PADS_PER_UC - 1) / PAD_GPIO_PADS_PER_UC;
+	}
+	
+	/**
+	 * @brief get the no of a pad on its uc
+	 * @param pad 1..118
+	 * @return 1..12
+	 */
+	static constexpr int getPadNo(unsigned int pad){
+		return pad - ((getPcb(pad) - 1) * PAD_GPIO_PADS_PER_PCB + (getUc(pad) - 1) * PAD_GPIO_PADS_PER_UC);
+	}
+	
+	/**
+	 * @brief get the BCM bit of a pin
+	 * @param pin wiringPi number of the pin
+	 * @return bit mask
+	 */
+	static constexpr std::uint32_t bit(int pin){
+		return (1u << Transport::toBcm(pin));
+	}
+	
+	/// ADC_0..ADC_3
+	static constexpr std::uint32_t getAdcPins(){
+		return bit(GPIO_ADC_0) | bit(GPIO_ADC_1) | bit(GPIO_ADC_2) | bit(GPIO_ADC_3);
+	}
+	
+	/// CS_1, CS_2
+	static constexpr std::uint32_t getCsPins(){
+		return bit(GPIO_CS_1) | bit(GPIO_CS_2);
+	}
+	
+	/// EN_1..EN_5
+	static constexpr std::uint32_t getEnablePins(){
+		return bit(GPIO_EN_1) | bit(GPIO_EN_2) | bit(GPIO_EN_3) | bit(GPIO_EN_4) | bit(GPIO_EN_5);
+	}
+	
+	/**
+	 * @brief compute the masks of a pad
+	 * @param pad 1..118
+	 * @return the masks
+	 */
+	static constexpr Masks computeMasks(unsigned int pad){
+		return Masks{
+			((getPadNo(pad) & 0x01) ? bit(GPIO_ADC_0) : 0) | ((getPadNo(pad) & 0x02) ? bit(GPIO_ADC_1) : 0) | ((getPadNo(pad) & 0x04) ? bit(GPIO_ADC_2) : 0) |
+			((getPadNo(pad) & 0x08) ? bit(GPIO_ADC_3) : 0) | (getPcb(pad) == 1 ? bit(GPIO_CS_1) : bit(GPIO_CS_2)),
+			bit(getUc(pad) == 1 ? GPIO_EN_1 : getUc(pad) == 2 ? GPIO_EN_2 : getUc(pad) == 3 ? GPIO_EN_3 : getUc(pad) == 4 ? GPIO_EN_4 : GPIO_EN_5)
+		};
+	}
+	
+	/**
+	 * @brief get the precomputed masks of a pad
+	 * @param pad 1..118
+	 * @return the masks, empty masks if the pad does not exist
+	 */
+	static const Masks& getMasks(unsigned int pad);
+	
+	/**
+	 * @brief configure all pins as outputs
+	 * @param gpio the transport
+	 */
+	static void setOutputs(Transport::Transport_ptr gpio);
+	
+	/**
+	 * @brief activate a pad
+	 * @param gpio the transport
+	 * @param pad 1..118, other values are ignored
+	 */
+	static void setPadHigh(Transport::Transport_ptr gpio, unsigned int pad);
+	
+	/**
+	 * @brief set all pads to low level
+	 * @param gpio the transport
+	 */
+	static void setPadsLow(Transport::Transport_ptr gpio);
+	
+	/**
+	 * @brief activate a pad with one digitalWrite per pin (previous implementation)
+	 * @param gpio the transport
+	 * @param pad 1..118, other values are ignored
+	 */
+	static void setPadHighPinwise(Transport::Transport_ptr gpio, unsigned int pad);
+	
+	/**
+	 * @brief set all pads to low level with one digitalWrite per pin (previous implementation)
+	 * @param gpio the transport
+	 */
+	static void setPadsLowPinwise(Transport::Transport_ptr gpio);
+	
+	/**
+	 * @brief switch each pad with the masks and pin by pin on simulated transports and compare the levels of the pins whenever the
+	 * multiplexers latch (delayMicroseconds) and after the pad has been switched
+	 * @param error description of the first difference
+	 * @return true if the levels are identical for all pads
+	 */
+	static bool verify(std::string &error);
+};
@@ -41,12 +41,31 @@ public:
 	 */
 	static PadTask_ptr create(std::vector<int> pads, int duration_ms);
 	
+	/**
+	 * @brief create one PadTask per step, e.g. the steps of several droplets planned by the DropletRouter. Added to a recipe one
+	 * after another, the steps are played as one PadTimeline (executeSequence)
+	 * @param steps pads which are activated in each step
+	 * @param duration_ms duration of each step
+	 * @return the tasks in the order of the steps
+	 * @see DropletRouter::getSteps
+	 */
+	static std::vector<PadTask_ptr> createSteps(const std::vector<std::vector<int>> &steps, int duration_ms);
+	
 	
 	/**
 	 * @brief powers all specified pad for the set time
-	 * @param executeNext
+	 * @param token used to stop the execution
+	 * @see PadTimeline
+	 */
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
+	
+	/**
+	 * @brief executes consecutive PadTasks as one PadTimeline -> the pads of the next task are switched exactly when the previous
+	 * task has finished. The status leds are updated and the log events are added before / after the playback.
+	 * @param tasks the tasks in the order of execution
+	 * @param token used to stop the execution
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	static void executeSequence(const std::vector<PadTask_ptr> &tasks, CancellationToken::CancellationToken_ptr token);
 	
 	/**
 	 * @brief get the type of the task
@@ -60,6 +79,37 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief get a list of all devices, which are used while the task is executed
+	 * @return DEVICE_ELECTRODES and DEVICE_ATMEGA_GENERAL (relais and status leds)
+	 */
+	virtual std::list<Task::DEVICES> getUsedDevices() override;
+	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief the task switches the AC relais on
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the duration of the step and the start of the timeline
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
+	/**
+	 * @brief simulates consecutive PadTasks like executeSequence() - the timeline is started once, the steps take exactly their duration
+	 * @param tasks the steps
+	 * @param sim the simulator
+	 */
+	static void simulateSequence(const std::vector<PadTask_ptr> &tasks, Simulator &sim);
+	
 	/**
 	 * @brief create a PadTask from a String
 	 * @param s the string which should be used to create the PadTask
@@ -78,6 +128,20 @@ public:
 	 */
 	static PadTask_ptr loadPadTask(tinyxml2::XMLElement* task_element);
 	
+	/**
+	 * @brief plan the routes of several droplets (DropletRouter) and create one PadTask per step (createSteps). Format: <br>
+	 * &lt;DropletRoute duration_ms="500" adjacency="adjacency.csv" pads="118" separation="2"&gt; <br>
+	 * &nbsp;&nbsp;&lt;Droplet start="1" goal="20"/&gt; ... <br>
+	 * &lt;/DropletRoute&gt; <br>
+	 * instead of adjacency / pads, rows and columns define a rectangular array of pads (DropletRouter::createGrid). The routes are
+	 * planned when the recipe is loaded, saving the recipe saves the PadTasks.
+	 * @param task_element the DropletRoute element
+	 * @param folder relative adjacency files are loaded from this folder (folder of the recipe file)
+	 * @return the tasks in the order of the steps
+	 * @throws std::runtime_error if the adjacency cannot be loaded or no valid routes have been found
+	 */
+	static std::vector<PadTask_ptr> loadDropletRoute(tinyxml2::XMLElement* task_element, std::string folder = "");
+	
 	/**
 	 * @brief saves the task as part of a xml file
 	 * @param doc the xml document which should contain the task
@@ -86,20 +150,23 @@ public:
 	 */
 	virtual tinyxml2::XMLElement* toXMLElement(tinyxml2::XMLDocument *doc, bool externElements = false) override;
 	
-private:
-	int duration_ms;
-	std::vector<int> pads;
-	static std::mutex executeMtx;
-	static bool executing;
-	
 	/**
-	 * @brief activates an ewod pad
-	 * @param pad the pad which should be activated (range 1..116)
+	 * @brief activates an ewod pad with the precomputed gpio masks of the pad
+	 * @param pad the pad which should be activated (range 1..118)
+	 * @see PadGpio
 	 */
-	void setPadHigh(unsigned int pad);
+	static void setPadHigh(unsigned int pad);
 	
 	/**
 	 * @brief set all Pads to low level
 	 */
-	void setPadsLow();
+	static void setPadsLow();
+	
+private:
+	int duration_ms;
+	std::vector<int> pads;
+	static std::mutex executeMtx;
+	static bool executing;
+	
+	static void executeSteps(const std::vector<PadTask*> &tasks, CancellationToken::CancellationToken_ptr token);
 };
@@ -0,0 +1,115 @@
+#pragma once
+/**
+ * @file PadTimeline.h
+ *
+ * @class PadTimeline
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see PadTask
+ * @see Recipe
+ * @brief plays back a sequence of pad steps (consecutive PadTasks) with accurate timing. The start time of each step is precomputed
+ * as offset to the start of the timeline. A dedicated thread with real-time priority (SCHED_FIFO, if permitted) sleeps until the
+ * absolute deadline of the next step (clock_nanosleep with TIMER_ABSTIME on CLOCK_MONOTONIC) and switches the pads. Since the
+ * deadlines are absolute, delays of one step do not add up over the timeline.
+ *
+ * Only the gpio writes are done in the playback thread - logging and status led updates are done by the caller before / after
+ * the playback. For each step the lateness of the wake-up compared to its deadline is stored, getStatistics() summarizes it.
+ */
+#include "CancellationToken.h"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+/// priority of the playback thread (SCHED_FIFO, 1..99)
+#define PAD_TIMELINE_PRIORITY 80
+/// time between the call of play() and the deadline of the first step
+#define PAD_TIMELINE_START_DELAY_US 1000
+/// max. time between two checks of the cancellation token during a step
+#define PAD_TIMELINE_CANCEL_CHECK_MS 10
+
+class PadTimeline{
+public:
+	typedef std::shared_ptr<PadTimeline> PadTimeline_ptr;
+	
+	/// timing of the played steps (lateness of the wake-up compared to the deadline of the step)
+	struct Statistics{
+		std::size_t steps; ///< no of played steps
+		double min_us;
+		double max_us;
+		double mean_us;
+		double stddev_us;
+		bool realtime; ///< true if the playback thread was running with real-time priority
+		
+		/**
+		 * @brief format the statistics
+		 * @return e.g. "12 steps, lateness min/mean/max 21/48/95us, stddev 17us, real-time"
+		 */
+		std::string to_string() const;
+	};
+	
+	/**
+	 * @brief creates an empty timeline
+	 * @return smart pointer to the created object
+	 */
+	static PadTimeline_ptr create();
+	
+	/**
+	 * @brief append a step to the timeline
+	 * @param pads pads which are powered during the step
+	 * @param duration_ms time the pads are powered
+	 */
+	void addStep(const std::vector<int> &pads, unsigned int duration_ms);
+	
+	/**
+	 * @brief get the no of steps
+	 * @return no of steps
+	 */
+	std::size_t getStepCount() const;
+	
+	/**
+	 * @brief get the time between the start of the timeline and the start of a step
+	 * @param i index of the step
+	 * @return offset in milli seconds
+	 */
+	unsigned long getStepOffsetMs(std::size_t i) const;
+	
+	/**
+	 * @brief plays the timeline in the playback thread, the method returns when the timeline has finished or has been cancelled.
+	 * All pads are low afterwards.
+	 * @param token cancelled to stop the playback, the token is checked at least every PAD_TIMELINE_CANCEL_CHECK_MS
+	 * @return false if the playback has been cancelled
+	 */
+	bool play(CancellationToken::CancellationToken_ptr token);
+	
+	/**
+	 * @brief get the lateness of a step of the last playback
+	 * @param i index of the step
+	 * @return lateness of the wake-up in micro seconds, negative if the step has not been played
+	 */
+	double getStepLatenessUs(std::size_t i) const;
+	
+	/**
+	 * @brief get the timing statistics of the last playback
+	 * @return the statistics
+	 */
+	Statistics getStatistics() const;
+
+private:
+	struct Step{
+		std::vector<int> pads;
+		long long offset_ns; // start of the step relative to the start of the timeline
+	};
+	
+	PadTimeline();
+	void playThread(CancellationToken::CancellationToken_ptr token);
+	static bool sleepUntil(long long deadline_ns, const CancellationToken::CancellationToken_ptr &token);
+	static long long now();
+	
+	std::vector<Step> steps;
+	long long duration_ns;
+	std::vector<long long> lateness_ns; // -1 -> step has not been played
+	bool realtime;
+	bool cancelled;
+};
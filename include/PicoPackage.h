@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * @file PicoPackage.h
+ *
+ * @class PicoPackage
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see MeasurementPackage
+ * @see MeasurementValue
+ * @brief allocation free counterpart of MeasurementPackage. A received 'P' line is decoded in place (no substr, no stringstream, no
+ * shared_ptr per value) into a fixed size array of values, so a whole sweep can be decoded without touching the heap.
+ */
+#include "MeasurementValue.h"
+
+#include <cstddef>
+
+/// max. no of values of one package - the method script of EmStatPico only adds 3 (freq, z real, z imag)
+#define PICO_MAX_VALUES 8
+
+class PicoPackage{
+public:
+	
+	/// one decoded value of a package
+	struct Value{
+		MeasurementValue::MEASUREMENT_TYPE type;
+		MeasurementValue::META_STATUS status;
+		double value;
+		int range; // -1 if no current range has been received
+	};
+	
+	PicoPackage();
+	
+	/**
+	 * @brief decode a received package line in place - the line is not copied
+	 * @param line pointer to the received line (needs to start with 'P', no trailing newline)
+	 * @param len length of the line
+	 * @return false if the line could not be decoded (no package, unknown type, invalid hex / prefix, too many values)
+	 */
+	bool parse(const char* line, std::size_t len);
+	
+	/**
+	 * @brief get the no of decoded values
+	 * @return no of values of the package
+	 */
+	std::size_t size() const;
+	
+	/**
+	 * @brief get a decoded value
+	 * @param i index of the value (has to be < size())
+	 * @return the value
+	 */
+	const Value& at(std::size_t i) const;
+	
+	/**
+	 * @brief get the value of the first entry with the given type
+	 * @param type the wanted type (e.g. TYPE_VT_ZREAL)
+	 * @param value the found value is written to value
+	 * @return true if the package contains a value of that type
+	 */
+	bool getValue(MeasurementValue::MEASUREMENT_TYPE type, double &value) const;
+	
+	/**
+	 * @brief check the status of all values
+	 * @return false if at least one value reported an overload or underload
+	 */
+	bool isValid() const;
+	
+	/**
+	 * @brief get the type of a two character var type (e.g. "cc" -> TYPE_VT_ZREAL) using a lookup table
+	 * @param c0 first character
+	 * @param c1 second character
+	 * @return the type, TYPE_ERROR if unknown
+	 */
+	static MeasurementValue::MEASUREMENT_TYPE lookupType(char c0, char c1);
+	
+	/**
+	 * @brief convert a prefix (e.g. 'm') into the corresponding factor (1e-3) without throwing
+	 * @param p the prefix
+	 * @return the factor, 0 if p is no valid prefix
+	 */
+	static double prefixFactor(char p);
+	
+	/**
+	 * @brief decode a hex number of len characters
+	 * @param s first character
+	 * @param len no of characters
+	 * @param result decoded number
+	 * @return false if a character is no hex digit
+	 */
+	static bool decodeHex(const char* s, std::size_t len, unsigned int &result);
+
+private:
+	bool parseValue(const char* s, std::size_t len, Value &v);
+	
+	Value values[PICO_MAX_VALUES];
+	std::size_t count;
+};
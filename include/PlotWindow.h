@@ -8,6 +8,7 @@
  * @brief derivates from Gtk::DrawingArea and implements a plotting window.
  */
 #include "DataP.h"
+#include "Spectrum.h"
  
 #include <gtkmm/drawingarea.h>
 #include <gtkmm/builder.h>
@@ -75,15 +76,17 @@ public:
 	 * and set. If autoScl is true, scl values are calculated and set. The plot will be redrawn
 	 * @param data the data points
 	 */
-	void setData(std::vector<DataP::DataP_ptr> data);
+	void setData(Spectrum data);
 	
 	/**
 	 * @brief adds one data point to the existing ones
 	 * adds one data point, which will be plotted in the view. If autoMax is true, min / max values are calculated
 	 * and set. If autoScl is true, scl values are calculated and set. The plot will be redrawn
-	 * @param data the data point which should be added
+	 * @param x x value of the data point which should be added
+	 * @param y_real real part of the y value
+	 * @param y_imag imaginary part of the y value
 	 */
-	void addData(DataP::DataP_ptr data);
+	void addData(double x, double y_real, double y_imag = 0);
 	
 	/**
 	 * @brief set the component of the complex y coordinate, that should be displayed
@@ -110,7 +113,7 @@ protected:
 
 private:
 	enum ALIGN {LEFT, CENTER, RIGHT}; // aligment of a text element 
-	std::vector<DataP::DataP_ptr> plot_data; // stores the data (which will be plottet)
+	Spectrum plot_data; // stores the data (which will be plottet)
 	std::mutex dataMtx; //synchronizes the access on plot_data
 	
 	void init();
@@ -6,6 +6,14 @@
  * @author Nils Bosbach
  * @date 14.04.2019
  * @brief stores multiple Tasks -> group a bunch of taks to a recipe
+ * 
+ * The tasks are executed one after another. If the recipe is concurrent, the tasks are executed by a TaskGraph: tasks which do not
+ * use the same devices run at the same time, barrier tasks (e.g. DelayTask) separate the parts of the recipe.
+ * 
+ * All recipes are registered by their name, getRecipeByName() is a hash lookup. Recipes which are loaded from a file are kept in a
+ * cache (key: path, valid as long as mtime and size of the file do not change). The cache does not own the recipes: a recipe is
+ * freed when it is not used anymore, and a recipe which has been changed since it has been loaded or saved is not handed out again. Loading a recipe from a file just reads the attributes
+ * of the recipe (name, comment, concurrent), the tasks are loaded when they are needed for the first time (e.g. getTasks(), execute()).
  */
 #include "Spectrometer.h"
 #include "Task.h"
@@ -16,6 +24,9 @@
 #include <mutex>
 #include <pthread.h>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
 
 class Recipe : public Task{
 public:
@@ -62,15 +73,39 @@ public:
 	/**
 	 * @brief executes all Tasks
 	 * @param data contains the data which is captured during the execution of the recipe
-	 * @param executeNext if false the Recipe will stop after the current task
+	 * @param token if cancelled the Recipe will stop after the current task
 	 */
-	void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
-	 * @brief get all Tasks of the recipe
+	 * @brief simulates the tasks like execute() - sequential recipes are compiled, concurrent recipes are scheduled as TaskGraph
+	 * @param sim the simulator
+	 */
+	void simulate(Simulator &sim) override;
+	
+	/**
+	 * @brief set if tasks which do not use the same devices may be executed at the same time
+	 * @param concurrent true to execute the recipe by a TaskGraph, false (default) to execute the tasks one after another
+	 */
+	void setConcurrent(bool concurrent);
+	
+	/**
+	 * @brief check if tasks which do not use the same devices may be executed at the same time
+	 * @return true if the recipe is executed by a TaskGraph
+	 */
+	bool isConcurrent() const;
+	
+	/**
+	 * @brief get all Tasks of the recipe, loads the tasks if they have not been loaded yet
 	 * @return vector of all Tasks of the recipe
 	 */
-	const std::vector<Task::Task_ptr> getTasks() const;
+	const std::vector<Task::Task_ptr> getTasks();
+	
+	/**
+	 * @brief check if the tasks of the recipe have been loaded
+	 * @return false if the recipe has been loaded from a file and the tasks have not been needed yet
+	 */
+	bool isBodyLoaded() const;
 	
 	/**
 	 * @brief returns the type as std::string
@@ -118,7 +153,10 @@ public:
 	 * @param s pointer to a spectrometer
 	 * @param name name of the recipe
 	 * @param comment comment of the recipe
-	 * @return pointer to the created object.
+	 * @return pointer to the created object, the cached object if it is still used and neither the file nor the recipe has been
+	 * changed since it has been loaded
+	 * 
+	 * Only the attributes of the recipe are read, the tasks are loaded when they are needed.
 	 */
 	static Recipe_ptr loadRecipe(std::string path, Spectrometer* s, std::string name = "", std::string comment = "");
 	
@@ -178,7 +216,95 @@ private:
 	/// path to the file the Recipe was loaded from / should be saved to @todo implement save recipe
 	std::string file_path;
 	
+	/// the recipe differs from file_path (tasks or attributes changed, not saved)
 	bool changed;
-	static std::vector<std::weak_ptr<Recipe>> all_recipes;
+	
+	/// execute the tasks by a TaskGraph @see setConcurrent(bool concurrent)
+	bool concurrent;
+	
+	/// false until the tasks of a recipe which has been loaded from file_path are loaded @see loadBody()
+	std::atomic<bool> bodyLoaded;
+	
+	/// used to load the tasks only once
+	std::mutex bodyMtx;
+	
+	/// spectrometer which is passed to the SpectrometerTasks when the tasks are loaded
+	Spectrometer* spectrometer;
+	
+	/// true if the recipe is in all_recipes
+	bool registered;
+	
+	/// entry of all_recipes, the raw pointer identifies the recipe in the destructor (the weak_ptr has expired there)
+	struct RegistryEntry{
+		Recipe* recipe;
+		std::weak_ptr<Recipe> weak;
+	};
+	
+	/// entry of recipeCache, the recipe is not kept alive by the cache
+	struct CacheEntry{
+		std::int64_t mtime_ns;
+		std::int64_t size;
+		std::weak_ptr<Recipe> recipe;
+	};
+	
+	/**
+	 * @brief load the tasks from file_path if they have not been loaded yet
+	 * 
+	 * errors are logged, the recipe has no tasks then
+	 */
+	void loadBody();
+	
+	/**
+	 * @brief remove the recipe from all_recipes, all_recipesMtx has to be locked
+	 * @return the weak_ptr of the recipe
+	 */
+	std::weak_ptr<Recipe> removeFromRegistry();
+	
+	/**
+	 * @brief update the cache entry of file_path after the recipe has been saved
+	 */
+	void updateCache();
+	
+	/**
+	 * @brief create a Recipe from a file without loading its tasks
+	 * @param path the path of the file
+	 * @param s pointer to a spectrometer
+	 * @param reuse if true, an existing recipe with the name of the file's recipe is returned
+	 * @return smart pointer to the recipe, nullptr if the file is no recipe
+	 */
+	static Recipe_ptr loadRecipeHeader(std::string path, Spectrometer* s, bool reuse);
+	
+	/**
+	 * @brief read the attributes of the Recipe element of a xml file
+	 * 
+	 * Just the start tag of the element is parsed. If that fails, the whole file is parsed.
+	 * @return false if the file has no Recipe element
+	 */
+	static bool readXmlHeader(std::string path, std::string &name, std::string &comment, bool &concurrent);
+	
+	/**
+	 * @brief create the tasks defined by the child elements of a Recipe element, a DropletRoute element adds one PadTask per step
+	 * @param task_element the Recipe element
+	 * @param s pointer to a spectrometer
+	 * @param folder folder of the recipe file, relative paths of the elements are loaded from there
+	 * @return the tasks
+	 * @see PadTask::loadDropletRoute
+	 */
+	static std::vector<Task_ptr> loadTasks(tinyxml2::XMLElement* task_element, Spectrometer* s, std::string folder = "");
+	
+	/**
+	 * @brief get the modification time and the size of a file
+	 * @param path the path of the file
+	 * @param entry mtime_ns and size are set
+	 * @return false if the file does not exist
+	 */
+	static bool getFileStamp(std::string path, CacheEntry &entry);
+	
+	/// all recipes which exist at the moment, key: name of the recipe
+	static std::unordered_map<std::string, std::vector<RegistryEntry>> all_recipes;
 	static std::mutex all_recipesMtx;
+	
+	/// recipes which have been loaded from files, key: path of the file
+	static std::unordered_map<std::string, CacheEntry> recipeCache;
+	static std::mutex recipeCacheMtx;
 };
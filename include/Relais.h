@@ -7,10 +7,11 @@
  * @author Nils Bosbach
  * @date 31.07.2019
  * @brief class to control the relais connected to the atmega32 via I2C. The methods getRelais and setRelais only change the internal variable, the configuration
- * is transmitted to the uc during the writeRelais method.
+ * is transmitted to the uc during the writeRelais method. The registers are accessed via the ActuatorService.
  */
 
 #include "Uc_Connection.h"
+#include "ActuatorService.h"
 
 #include <memory>
 
@@ -40,9 +41,10 @@ public:
 	
 	/**
 	 * @brief read the current relais configuration from the uc and store it in the interial varible
+	 * @param fromDevice if false, the last written / read configuration is used (no i2c access); if true, the registers are read from the uc
 	 * @see getRelais
 	 */
-	void readRelais();
+	void readRelais(bool fromDevice = false);
 	
 	/**
 	 * @brief sends the current state of the internal relais configuration to the uc
@@ -72,13 +74,8 @@ public:
 	bool uc_is_connected();
 	
 private:
-	typedef std::chrono::system_clock::time_point TimePoint;
-	
-	TimePoint lastWrite;
 	char relais_L;
 	char relais_H;
 	Uc_Connection::Uc_Connection_ptr conn;
-	
-	inline TimePoint getCurrentTime() const;
-	inline void delay_to_last_write() const;
+	ActuatorService::ActuatorService_ptr actuators;
 };
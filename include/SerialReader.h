@@ -0,0 +1,79 @@
+#pragma once
+/**
+ * @file SerialReader.h
+ *
+ * @class SerialReader
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see EmStatPico
+ * @brief reads a serial port in a background thread. The thread waits for data using poll() and reads everything that is available
+ * with one read() call into a ring buffer. Complete lines can be taken out of the buffer with readLine.
+ *
+ * While the ring buffer is full the thread does not read the port, so the data waits in the tty buffer of the kernel (flow control)
+ * instead of being dropped. It continues as soon as readLine has made space.
+ */
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+/// size of the ring buffer in bytes
+#define SERIAL_READER_RING_SIZE 16384
+
+/// max. time the reader thread blocks in poll() before checking if it should stop
+#define SERIAL_READER_POLL_MS 50
+
+class SerialReader{
+public:
+	
+	/**
+	 * @brief init variables, the reader is not started
+	 * @param fd file descriptor of the opened serial port (e.g. returned by serialOpen)
+	 */
+	SerialReader(int fd);
+	
+	/**
+	 * @brief stops the reader thread, the file descriptor is not closed
+	 */
+	virtual ~SerialReader();
+	
+	/**
+	 * @brief start the reader thread
+	 */
+	void start();
+	
+	/**
+	 * @brief stop the reader thread and wait until it has finished
+	 */
+	void stop();
+	
+	/**
+	 * @brief take the next complete line out of the buffer. Waits until a line has been received or the timeout is reached
+	 * @param line buffer the line is copied to (without '\r' / '\n')
+	 * @param maxLen size of the buffer
+	 * @param len length of the copied line
+	 * @param timeout_ms max. time to wait for a line
+	 * @return false if no complete line has been received within the timeout or the reader has been stopped
+	 * @throws std::runtime_error if the line is longer than maxLen (the line is removed from the buffer), the ring buffer is full
+	 * without a complete line or the port has been closed
+	 */
+	bool readLine(char* line, std::size_t maxLen, std::size_t &len, int timeout_ms);
+
+private:
+	void readThread();
+	
+	int fd;
+	char ring[SERIAL_READER_RING_SIZE];
+	std::size_t head; // next write position
+	std::size_t tail; // next read position
+	std::size_t used; // no of bytes in the buffer
+	std::size_t lines; // no of complete lines in the buffer
+	bool closed; // read() returned an error / end of file
+	
+	mutable std::mutex ringMtx;
+	std::condition_variable lineReceived;
+	std::condition_variable spaceAvailable; // readLine has taken bytes out of the full buffer
+	std::atomic<bool> running;
+	std::thread reader_thread;
+};
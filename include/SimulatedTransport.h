@@ -0,0 +1,196 @@
+#pragma once
+/**
+ * @file SimulatedTransport.h
+ *
+ * @class SimulatedTransport
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Transport
+ * @see Addresses.h
+ * @brief in-memory model of the gpio pins and the microcontrollers on the i2c bus. The register maps of Addresses.h are modelled:
+ * - atmega32: relais, status leds, adc of the external voltage and the temperature / humidity measurement
+ * - attiny45 voltage controller: setpoint, mode, duty cycle and the adc of the internal voltage. While the boost converter is
+ *   supplied (relais R_STEUER_SAFETY), the voltage follows the setpoint with a first order response whose slope is limited by the
+ *   ramp; otherwise the capacitor is discharged.
+ * - attiny45 frequency generator: frequency
+ *
+ * Each i2c byte takes the configured time (default: 9 bits at 100kHz), a gpio write takes the configured time (default: no time).
+ * A writePins() call changes all pins of the masks at once and counts as one write per mask (GPSET0 / GPCLR0). The levels of the pins
+ * can be recorded whenever the program waits (delayMicroseconds), i.e. when the pad multiplexers latch the address.
+ * So the actuation and the control loops can be benchmarked without the hardware. The serial port is not modelled - use the
+ * DummyImpAnalyser instead of the EmStatPico.
+ */
+#include "Transport.h"
+
+#include <map>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+/// transfer time of one i2c byte (incl. ack) at 100kHz
+#define SIMULATED_I2C_BYTE_US 90
+/// time of a gpio write
+#define SIMULATED_GPIO_WRITE_NS 0
+/// change of the internal voltage while the boost converter is supplied
+#define SIMULATED_VOLTAGE_RAMP_V_PER_S 100
+/// change of the internal voltage while the capacitor is discharged
+#define SIMULATED_VOLTAGE_DISCHARGE_V_PER_S 200
+/// time constant of the first order response of the voltage controller
+#define SIMULATED_VOLTAGE_TIME_CONSTANT_MS 40
+
+class SimulatedTransport: public Transport{
+public:
+	typedef std::shared_ptr<SimulatedTransport> SimulatedTransport_ptr;
+	
+	/**
+	 * @brief creates the transport, all microcontrollers are connected, all pins and registers are 0
+	 * @return smart pointer to the created object
+	 */
+	static SimulatedTransport_ptr create();
+	
+	/**
+	 * @brief set the latencies
+	 * @param i2cByteUs transfer time of one i2c byte
+	 * @param gpioWriteNs time of a gpio write
+	 */
+	void setLatency(unsigned int i2cByteUs, unsigned int gpioWriteNs);
+	
+	/**
+	 * @brief set how fast the internal voltage changes
+	 * @param rampVPerS change while the boost converter is supplied
+	 * @param dischargeVPerS change while the capacitor is discharged
+	 */
+	void setVoltageSlope(double rampVPerS, double dischargeVPerS);
+	
+	/**
+	 * @brief set the response of the voltage controller to its setpoint
+	 * @param timeConstantMs time constant of the first order response, 0: the voltage ramps to the setpoint
+	 * @param gain ratio of the reached voltage and the setpoint (models a calibration error of the voltage divider)
+	 */
+	void setVoltageResponse(double timeConstantMs, double gain);
+	
+	/**
+	 * @brief set the voltage of the external source, measured by the adc of the atmega32
+	 * @param v voltage in V
+	 */
+	void setExternalVoltage(double v);
+	
+	/**
+	 * @brief set the result of the temperature / humidity measurement
+	 * @param temperature temperature in °C
+	 * @param humidity humidity in %
+	 */
+	void setClimate(double temperature, double humidity);
+	
+	/**
+	 * @brief connect / disconnect a microcontroller
+	 * @param address 7 bit slave address
+	 * @param connected if false, the transfers to the slave fail
+	 */
+	void setConnected(int address, bool connected);
+	
+	/**
+	 * @brief get the value of a register
+	 * @param address 7 bit slave address
+	 * @param reg no of the register
+	 * @return the value
+	 */
+	int getRegister(int address, int reg);
+	
+	/**
+	 * @brief get the internal voltage
+	 * @return voltage in V
+	 */
+	double getInternalVoltage();
+	
+	/**
+	 * @brief get the level of a pin without latency
+	 * @param pin wiringPi number of the pin
+	 * @return true: high
+	 */
+	bool getPin(int pin);
+	
+	/**
+	 * @brief get the levels of all pins
+	 * @return bit n: level of BCM pin n
+	 */
+	std::uint32_t getPins();
+	
+	/**
+	 * @brief start / stop recording the levels of the pins. While recording, getPins() is stored at each delayMicroseconds() call
+	 * @param record true: clear the recorded levels and start recording
+	 */
+	void recordPins(bool record);
+	
+	/**
+	 * @brief get the recorded levels of the pins
+	 * @return levels (getPins()) at each delayMicroseconds() call since recordPins(true), oldest first
+	 */
+	std::vector<std::uint32_t> getRecordedPins();
+	
+	/**
+	 * @brief get the no of gpio writes (digitalWrite, one per non-empty mask of writePins) since the transport has been created
+	 * @return no of writes
+	 */
+	unsigned long getGpioWrites();
+	
+	/**
+	 * @brief get the no of i2c transfers (i2cWrite, i2cRead, i2cWriteReg8, i2cReadBlock, i2cWriteBlock) since the transport has been created
+	 * @return no of transfers
+	 */
+	unsigned long getI2CTransfers();
+	
+	virtual void setup() override;
+	virtual void setOutput(int pin) override;
+	virtual void digitalWrite(int pin, bool value) override;
+	virtual bool digitalRead(int pin) override;
+	virtual void writePins(std::uint32_t set, std::uint32_t clear) override;
+	virtual void delayMicroseconds(unsigned int us) override;
+	virtual int i2cSetup(int address) override;
+	virtual int i2cWrite(int fd, int data) override;
+	virtual int i2cRead(int fd) override;
+	virtual int i2cWriteReg8(int fd, int reg, int data) override;
+	virtual int i2cReadBlock(int fd, int reg, unsigned char* data, int count) override;
+	virtual int i2cWriteBlock(int fd, int reg, const unsigned char* data, int count) override;
+	virtual int serialOpen(const std::string &device, int baud) override;
+	virtual void serialPuts(int fd, const std::string &s) override;
+	virtual void serialClose(int fd) override;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	
+	struct Slave{
+		unsigned char registers[256];
+		int pointer; // register which is read next
+		bool connected;
+	};
+	
+	SimulatedTransport();
+	Slave* getSlave(int address); // nullptr if the slave does not exist or is not connected
+	void onWrite(int address, int reg); // reactions of the microcontrollers
+	void onRead(int address, int reg);
+	void updateVoltage();
+	void transfer(unsigned int bytes);
+	std::uint32_t pinMask(); // mtx must be locked
+	static void wait(Clock::duration d);
+	
+	std::mutex mtx;
+	std::map<int, Slave> slaves;
+	std::map<int, bool> pins;
+	bool recording;
+	std::vector<std::uint32_t> recordedPins;
+	unsigned int i2cByteUs;
+	unsigned int gpioWriteNs;
+	double rampVPerS;
+	double dischargeVPerS;
+	double timeConstantMs;
+	double gain;
+	double voltage; // internal voltage
+	Clock::time_point lastVoltageUpdate;
+	double externalVoltage;
+	double temperature;
+	double humidity;
+	unsigned long gpioWrites;
+	unsigned long i2cTransfers;
+};
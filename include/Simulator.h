@@ -0,0 +1,202 @@
+#pragma once
+/**
+ * @file Simulator.h
+ *
+ * @class Simulator
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Task::simulate
+ * @see SimulationModel
+ * @brief runs a task (e.g. a Recipe) against modelled devices in virtual time. Nothing is sent to the devices and nobody sleeps,
+ * each task advances the virtual clock by the time it would take (Task::simulate()), based on its params and the latencies of the
+ * SimulationModel. Recipes are simulated like they are executed: sequential recipes are compiled (CompiledRecipe), so skipped relais
+ * writes and settle delays do not take any time, and concurrent recipes are scheduled as TaskGraph.
+ *
+ * The result contains a timeline with the start and duration of each task, the total duration and the time per task type. A
+ * recipe which takes hours is simulated in milliseconds of CPU time.
+ */
+#include "Task.h"
+#include "ImpAnalyser.h"
+#include "DeviceState.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstddef>
+
+/// timing of an impedance analyser
+struct SimulationAnalyserModel{
+	/// time per sweep (configuration, transfer of the data, ...)
+	double overheadMs;
+	/// time per measurement of a point
+	double msPerPoint;
+	/// min. no of periods of the measured frequency per measurement of a point
+	double periodsPerPoint;
+	
+	SimulationAnalyserModel(double overheadMs = 0, double msPerPoint = 0, double periodsPerPoint = 0);
+};
+
+/// latencies of the modelled devices, the defaults are estimations - calibrate them with measured runs
+struct SimulationModel{
+	/// overhead of each task (logging, ...)
+	double taskOverheadMs;
+	/// read / write of the relais
+	double relaisAccessMs;
+	/// switching between ewod and imp measurement mode
+	double relaisSettleMs;
+	/// read / write of an i2c register
+	double i2cAccessMs;
+	/// start of a pad timeline (once per sequence of PadTasks)
+	double padTimelineStartMs;
+	/// change of the voltage of the internal source
+	double voltageRampVPerS;
+	/// discharging of the capacitor of the internal source
+	double voltageDischargeVPerS;
+	/// temperature measurement of the atmega32
+	double tempMeasurementMs;
+	/// readout of a scan of the spectrometer (in addition to the integration time)
+	double spectrometerReadoutMs;
+	/// timing of the impedance analysers, unknown analysers take no time
+	std::map<ImpAnalyser::ANALYSER_DEVICE, SimulationAnalyserModel> analysers;
+	
+	/**
+	 * @brief init the model with the default latencies
+	 */
+	SimulationModel();
+};
+
+/// a simulated task
+struct SimulationEntry{
+	std::string name;
+	std::string type;
+	/// 0: top level, 1: task of a recipe, ...
+	unsigned int depth;
+	double startS;
+	double durationS;
+	/// false for recipes - their time is the time of their tasks
+	bool leaf;
+};
+
+/// timeline and duration of a simulated run
+struct SimulationResult{
+	std::vector<SimulationEntry> timeline;
+	/// predicted duration of the run
+	double totalS;
+	/// CPU time of the simulation
+	double cpuS;
+	/// time of the tasks (without recipes) per task type, tasks which run concurrently are counted separately
+	std::map<std::string, double> timePerType;
+	
+	/**
+	 * @brief get the predicted throughput
+	 * @return no of runs per hour
+	 */
+	double getRunsPerHour() const;
+	
+	/**
+	 * @brief timeline and summary as text
+	 * @return one line per task, followed by the total duration and the time per task type
+	 */
+	std::string to_string() const;
+};
+
+class Simulator{
+public:
+	typedef std::shared_ptr<Simulator> Simulator_ptr;
+	
+	/**
+	 * @brief creates a simulator
+	 * @param model latencies of the modelled devices
+	 * @return smart pointer to the created object
+	 */
+	static Simulator_ptr create(const SimulationModel &model = SimulationModel());
+	
+	/**
+	 * @brief simulates a run of a task, the clock and the modelled devices are reset before
+	 * @param task the task (e.g. a Recipe)
+	 * @return timeline and predicted duration
+	 */
+	SimulationResult simulate(Task::Task_ptr task);
+	
+	/**
+	 * @brief simulates a task at the current time (incl. SimulationModel::taskOverheadMs) and adds it to the timeline, used by
+	 * recipes to simulate their tasks
+	 * @param task the task
+	 * @param hints hints of the compiled recipe, the task simulates the operations which are not skipped
+	 */
+	void run(Task::Task_ptr task, const ExecutionHints &hints = ExecutionHints());
+	
+	/**
+	 * @brief get the hints of the task which is simulated at the moment (the hints of the task itself are not used, the recipe
+	 * may be executed at the same time)
+	 * @return the hints
+	 */
+	const ExecutionHints& getHints() const;
+	
+	/**
+	 * @brief adds a task to the timeline which starts at the current time, the task ends with end(). Used for tasks which are
+	 * simulated together (e.g. PadTask::simulateSequence())
+	 * @param task the task
+	 */
+	void begin(const Task &task);
+	
+	/**
+	 * @brief ends the last task which has been started with begin()
+	 */
+	void end();
+	
+	/**
+	 * @brief advance the virtual clock
+	 * @param ms time in ms
+	 */
+	void wait(double ms);
+	
+	/**
+	 * @brief get the virtual time
+	 * @return time since the start of the run in ms
+	 */
+	double getTimeMs() const;
+	
+	/**
+	 * @brief set the virtual time, used to schedule concurrent tasks
+	 * @param ms time since the start of the run in ms
+	 */
+	void setTimeMs(double ms);
+	
+	/**
+	 * @brief get the latencies of the modelled devices
+	 * @return the model
+	 */
+	const SimulationModel& getModel() const;
+	
+	/**
+	 * @brief get the time of a sweep of an impedance analyser, the measurement of each point takes at least
+	 * SimulationAnalyserModel::periodsPerPoint periods of its frequency
+	 * @param analyser the analyser with the params of the sweep
+	 * @return time of the sweep in ms
+	 */
+	double getSweepMs(const ImpAnalyser &analyser) const;
+	
+	/**
+	 * @brief get the voltage of the modelled source
+	 * @return voltage in V
+	 */
+	double getVoltage() const;
+	
+	/**
+	 * @brief set the voltage of the modelled source
+	 * @param v voltage in V
+	 */
+	void setVoltage(double v);
+
+private:
+	Simulator(const SimulationModel &model);
+	
+	SimulationModel model;
+	double timeMs;
+	double voltage;
+	ExecutionHints hints;
+	std::vector<SimulationEntry> timeline;
+	std::vector<std::size_t> open; // indices of the tasks which have not ended
+};
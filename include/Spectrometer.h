@@ -8,6 +8,7 @@
  * @brief implements the connection to the optical spectrometer
  */
 #include "DataP.h"
+#include "Spectrum.h"
 
 #include <string>
 #include <vector>
@@ -64,10 +65,10 @@ public:
 	std::vector<double> getFormattedSpectrum();
 	
 	/**
-	 * @brief request a spectrum from the spectrometer and return it as DataP array
+	 * @brief request a spectrum from the spectrometer and return it as Spectrum
 	 * @return spectrum
 	 */
-	std::vector<DataP::DataP_ptr> getFormattedSpectrum_DataPoints();
+	Spectrum getFormattedSpectrum_DataPoints();
 	
 	/**
 	 * @brief request a spectrum from the spectrometer and return it as double array
@@ -123,7 +124,7 @@ public:
 	 * @param path the full path of the destination of the spectrum
 	 * @param timediff the eleapsed seconds from the beginning of the current recipe
 	 */
-	static void save_spectrumCSV(const std::vector<DataP::DataP_ptr> &spectre, std::string path, double timediff);
+	static void save_spectrumCSV(const Spectrum &spectre, std::string path, double timediff);
 	
 	/**
 	 * @brief convert a TRIGGER_MODE to string
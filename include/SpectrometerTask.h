@@ -44,10 +44,9 @@ public:
 	/**
 	 * @brief triggers the Spectrometer to capture a Spectrum and stores a pointer to the caputed Spectrum in the ExperimentData parameter variable and the class varible
 	 * @param data pointer to an ExperimentData Object which is used to store the captured data from the execute functions during the execution of an experiment
-	 * @param executeNext if false the execution of the experiment should be stopped -> used to stop a running experiment without directly killing the thread
-	 * @param mtx mutex to synchronize the access on executeNext
+	 * @param token if cancelled the execution of the experiment should be stopped -> used to stop a running experiment without directly killing the thread
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief creates a tinyxml2::XMLElement which contains the properties of the object to save in a xml file
@@ -69,6 +68,24 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief the task does not change the state of the relais, the voltage and the frequency
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the integration time and the readout of each scan
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 private:
 	
 	Spectrometer::Spectrometer_ptr spectrometer;
@@ -0,0 +1,170 @@
+#pragma once
+/**
+ * @file Spectrum.h
+ *
+ * @class Spectrum
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see DataP
+ * @brief stores a spectrum (real x values and complex y values) in contiguous arrays (one for x, one for the real and one for the
+ * imaginary part) instead of one DataP object per point. abs and phase are only calculated when they are requested for the first time.
+ * Copying a Spectrum only copies a smart pointer - the data is shared until one of the copies is changed (copy on write).
+ */
+#include "DataP.h"
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <cstddef>
+
+class Spectrum{
+public:
+	
+	/**
+	 * @brief creates an empty spectrum (no memory is allocated)
+	 */
+	Spectrum();
+	
+	/**
+	 * @brief reserve memory for n points
+	 * @param n no of points
+	 */
+	void reserve(std::size_t n);
+	
+	/**
+	 * @brief add a point at the end of the spectrum
+	 * @param x real x value
+	 * @param y_real real part of the y value
+	 * @param y_imag imaginary part of the y value
+	 */
+	void add(double x, double y_real, double y_imag = 0);
+	
+	/**
+	 * @brief add a point given by abs and phase of the y value at the end of the spectrum
+	 * @param x real x value
+	 * @param abs absolute value of the y value
+	 * @param phase phase of the y value
+	 * @param m mode of the phase (degree or rad)
+	 */
+	void addAbsPhase(double x, double abs, double phase, DataP::COMPLEX_MODE m = DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD);
+	
+	/**
+	 * @brief replace all points of the spectrum by copying them from arrays
+	 * @param x the x values
+	 * @param y_real the real parts of the y values
+	 * @param y_imag the imaginary parts of the y values
+	 * @param n no of points
+	 */
+	void assign(const double* x, const double* y_real, const double* y_imag, std::size_t n);
+	
+	/**
+	 * @brief get the no of points
+	 * @return no of points of the spectrum
+	 */
+	std::size_t size() const;
+	
+	/**
+	 * @brief check if the spectrum contains points
+	 * @return true if the spectrum contains no points
+	 */
+	bool empty() const;
+	
+	/**
+	 * @brief get the x value of a point
+	 * @param i index of the point
+	 * @return x value of the point
+	 */
+	double getX(std::size_t i) const;
+	
+	/**
+	 * @brief get a part of the y value of a point
+	 * @param i index of the point
+	 * @param m defines which part of the y value will be returned
+	 * @return the selected part of the y value
+	 */
+	double getY(std::size_t i, DataP::COMPLEX_MODE m = DataP::COMPLEX_MODE::COMPLEX_ABS) const;
+	
+	/**
+	 * @brief get the x values as contiguous array
+	 * @return pointer to the first x value, nullptr if the spectrum is empty
+	 */
+	const double* getXData() const;
+	
+	/**
+	 * @brief get the real parts of the y values as contiguous array
+	 * @return pointer to the first real part, nullptr if the spectrum is empty
+	 */
+	const double* getRealData() const;
+	
+	/**
+	 * @brief get the imaginary parts of the y values as contiguous array
+	 * @return pointer to the first imaginary part, nullptr if the spectrum is empty
+	 */
+	const double* getImagData() const;
+	
+	/**
+	 * @brief get the range of the x values and of one component of the y values in one pass
+	 * @param m component of the y values
+	 * @param x_min smallest x value (0 if the spectrum is empty)
+	 * @param x_max largest x value (0 if the spectrum is empty)
+	 * @param y_min smallest y value (0 if the spectrum is empty)
+	 * @param y_max largest y value (0 if the spectrum is empty)
+	 */
+	void getRange(DataP::COMPLEX_MODE m, double &x_min, double &x_max, double &y_min, double &y_max) const;
+	
+	/**
+	 * @brief create a DataP object of one point
+	 * @param i index of the point
+	 * @return the created DataP
+	 */
+	DataP::DataP_ptr at(std::size_t i) const;
+	
+	/**
+	 * @brief create a semi-colon-seperated String containing the x value and selected components of the y coordinate of one point
+	 * (same format as DataP::toCsvLine)
+	 * @param i index of the point
+	 * @param real select the real part to appear in the list
+	 * @param imag select the imaginary part to appear in the list
+	 * @param abs select the absolute value to appear in the list
+	 * @param phase select the phase (in rad) to appear in the list
+	 */
+	std::string toCsvLine(std::size_t i, bool real = true, bool imag = true, bool abs = false, bool phase = false) const;
+	
+	/**
+	 * @brief create a spectrum from a DataP vector
+	 * @param data the points
+	 * @return the created spectrum
+	 */
+	static Spectrum fromDataP(const std::vector<DataP::DataP_ptr> &data);
+	
+	/**
+	 * @brief create a DataP vector containing the points of the spectrum
+	 * @return the created DataP vector
+	 */
+	std::vector<DataP::DataP_ptr> toDataP() const;
+
+private:
+	struct Data{
+		std::vector<double> x;
+		std::vector<double> y_real;
+		std::vector<double> y_imag;
+		
+		// calculated on first access - points are only appended, so the first absPhaseCount values stay valid
+		std::vector<double> y_abs;
+		std::vector<double> y_phase; // phase in rad
+		std::atomic<std::size_t> absPhaseCount;
+		std::mutex absPhaseMtx;
+		
+		Data();
+	};
+	
+	std::shared_ptr<Data> data;
+	
+	/// makes sure data is not shared with other Spectrum objects before it is changed
+	void detach();
+	
+	/// calculates y_abs and y_phase of the points which have been added since the last call
+	void calculateAbsPhase() const;
+};
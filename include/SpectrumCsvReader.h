@@ -0,0 +1,74 @@
+#pragma once
+/**
+ * @file SpectrumCsvReader.h
+ *
+ * @class SpectrumCsvReader
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see FSHelper::save_dataPToCsv
+ * @see TransSpect::loadTransImpSpectrum
+ * @brief reads spectrums from csv files (optical spectrums, impedance spectrums and the spectrums of transient impedance spectrums).
+ * The file is mapped into memory (mmap) and read in one pass: the lines and columns are found with memchr, the numbers are parsed
+ * directly from the mapped memory (no std::string per element, independent of the locale) and written into the spectrum.
+ *
+ * file format:
+ * 	position=<n>		(optional, transient impedance spectrums)
+ * 	timediff=<s>		(optional)
+ * 	<header>		columns separated by ';', unknown columns are ignored
+ * 	<data>			one line per point
+ */
+#include "Spectrum.h"
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class SpectrumCsvReader{
+public:
+	/**
+	 * @brief load an optical spectrum (columns wavelength and intensity / intensity_real)
+	 * @param path path of the csv file
+	 * @return the spectrum, empty if the file could not be opened
+	 *
+	 * throws a runtime_error if the file could not be parsed
+	 */
+	static Spectrum loadSpectrum(std::string path);
+	
+	/**
+	 * @brief load an impedance spectrum (columns frequency and impedance_real / impedance_imag or impedance_abs / impedance_phase)
+	 * @param path path of the csv file
+	 * @param position if not nullptr, the value of the position=... line is stored here (unchanged if the line does not exist)
+	 * @param timediff if not nullptr, the value of the timediff=... line is stored here (unchanged if the line does not exist)
+	 * @return the spectrum, empty if the file could not be opened
+	 *
+	 * throws a runtime_error if the file could not be parsed
+	 */
+	static Spectrum loadImpSpectrum(std::string path, int* position = nullptr, double* timediff = nullptr);
+	
+	/**
+	 * @brief parse a decimal number ([+-]digits[.digits][e[+-]digits], nan, inf). '.' and ',' are accepted as decimal point.
+	 * @param pos start of the number, set to the first character after the number
+	 * @param end end of the buffer
+	 * @param value the parsed value is stored here
+	 * @return false if there is no number at pos
+	 */
+	static bool parseDouble(const char* &pos, const char* end, double &value);
+
+private:
+	SpectrumCsvReader(std::string path);
+	virtual ~SpectrumCsvReader();
+	
+	bool isOpen() const;
+	bool getLine(const char* &begin, const char* &end);
+	void readMetaLines(const char* &begin, const char* &end, bool &gotLine, int* position, double* timediff);
+	std::vector<std::string> splitHeader(const char* begin, const char* end) const;
+	bool readRow(const std::vector<int> &slots, double* values);
+	void reserve(Spectrum &spectrum) const;
+	
+	std::string path;
+	int fd;
+	const char* map;
+	std::size_t mapSize;
+	const char* pos; // start of the next line
+	unsigned int lineNo;
+};
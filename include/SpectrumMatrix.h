@@ -0,0 +1,121 @@
+#pragma once
+/**
+ * @file SpectrumMatrix.h
+ *
+ * @class SpectrumMatrix
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see TransSpect
+ * @brief append-only 2-D matrix (time x frequency) of complex values. Each row is one captured spectrum, all rows are stored in one
+ * contiguous buffer (row after row). The time series of one frequency is a column of the matrix and can be accessed with an O(1) strided
+ * view (Column) without copying or allocating anything.
+ *
+ * Rows are only appended. When the buffer is full, a buffer with twice the capacity is created and the old rows are copied. Views keep a
+ * smart pointer to the buffer they have been created on, so they stay valid (and don't need a lock) while new rows are appended.
+ */
+#include "DataP.h"
+#include "Spectrum.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/// no of rows the buffer is created with (doubled each time it is full)
+#define SPECTRUM_MATRIX_INIT_ROWS 64
+
+class SpectrumMatrix{
+private:
+	struct Buffer{
+		std::vector<double> y_real; // rows * cols values, row after row
+		std::vector<double> y_imag;
+		std::vector<double> time; // one value per row
+		std::size_t capacity; // max. no of rows
+	};
+
+public:
+	
+	/// strided view of one column (the time series of one frequency)
+	class Column{
+	public:
+		
+		/**
+		 * @brief creates an empty view
+		 */
+		Column();
+		
+		/**
+		 * @brief get the no of values of the view (no of rows when the view has been created)
+		 * @return no of values
+		 */
+		std::size_t size() const;
+		
+		/**
+		 * @brief get the time of a row
+		 * @param i index of the row
+		 * @return time in seconds (relative to the first row)
+		 */
+		double getTime(std::size_t i) const;
+		
+		/**
+		 * @brief get a part of the complex value of a row
+		 * @param i index of the row
+		 * @param m defines which part of the value will be returned
+		 * @return the selected part, NaN if the spectrum of that row did not contain this column
+		 */
+		double getY(std::size_t i, DataP::COMPLEX_MODE m = DataP::COMPLEX_MODE::COMPLEX_ABS) const;
+	
+	private:
+		friend class SpectrumMatrix;
+		
+		std::shared_ptr<const Buffer> buffer;
+		std::size_t column;
+		std::size_t stride; // no of columns of the matrix
+		std::size_t rows;
+	};
+	
+	/**
+	 * @brief creates an empty matrix - the no of columns is set by the first appended row
+	 */
+	SpectrumMatrix();
+	
+	/**
+	 * @brief append a spectrum as new row. The first row defines the no of columns. Points of later spectrums exceeding that no are
+	 * ignored, missing points are stored as NaN
+	 * @param time time of the row in seconds (relative to the first row)
+	 * @param s the spectrum
+	 */
+	void appendRow(double time, const Spectrum &s);
+	
+	/**
+	 * @brief get the no of appended rows
+	 * @return no of rows
+	 */
+	std::size_t getRows() const;
+	
+	/**
+	 * @brief get the no of columns
+	 * @return no of columns, 0 if no row has been appended
+	 */
+	std::size_t getColumns() const;
+	
+	/**
+	 * @brief get the time of a row
+	 * @param row index of the row
+	 * @return time in seconds (relative to the first row)
+	 */
+	double getTime(std::size_t row) const;
+	
+	/**
+	 * @brief create an O(1) view of one column containing the rows which have been appended so far
+	 * @param column index of the column
+	 * @return the view, an empty view if column >= getColumns()
+	 */
+	Column getColumn(std::size_t column) const;
+
+private:
+	std::shared_ptr<Buffer> buffer;
+	std::size_t rows;
+	std::size_t cols;
+	
+	void grow();
+};
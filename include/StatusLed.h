@@ -5,12 +5,12 @@
  * @class StatusLed
  * @author Nils Bosbach
  * @date 04.08.2019
- * @brief used to control the status LED, which are connected to a shift register via the atmega32
+ * @brief used to control the status LED, which are connected to a shift register via the atmega32. The registers are written
+ * asynchronously by the ActuatorService.
  */
-#include "Uc_Connection.h"
+#include "ActuatorService.h"
 
 #include <memory>
-#include <chrono>
 #include <bitset>
 
 
@@ -73,19 +73,15 @@ public:
 	void read_reg_val();
 	
 	/**
-	 * @brief writes the value of the internal variable to the atmega32
+	 * @brief writes the value of the internal variable to the atmega32, does not wait until the value has been written
 	 */
 	void write_reg_val();
 		
 private:
-	typedef std::chrono::system_clock::time_point TimePoint;
-	Uc_Connection::Uc_Connection_ptr uc_connection;
-	TimePoint lastWrite;
+	ActuatorService::ActuatorService_ptr actuators;
 	std::bitset<16> reg_val;
 	
 	
 	inline void setLED(bool on, int led_id);
-	inline TimePoint getCurrentTime() const;
-	inline void delay_to_last_write() const;
 	
 };
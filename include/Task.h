@@ -12,6 +12,8 @@
 #include "ExperimentData.h"
 #include "StatusLed.h"
 #include "Relais.h"
+#include "CancellationToken.h"
+#include "DeviceState.h"
 
 #include <mutex>
 #include <pthread.h>
@@ -20,12 +22,14 @@
 #include <memory>
 #include <list>
 
+class Simulator;
+
 class Task {
 public:
 	typedef std::shared_ptr<Task> Task_ptr;
 	
-	/// devices, which can connected to the raspberry pi
-	enum DEVICES {DEVICE_ATTINY_VOLT, DEVICE_ATTINY_FREQ, DEVICE_ATMEGA_GENERAL, DEVICE_NOVOCONTROL, DEVICE_HP4294A, DEVICE_EMPICO, DEVICE_SPECTROMETER};
+	/// devices, which can connected to the raspberry pi (DEVICE_ELECTRODES and DEVICE_GPIB are only used by getUsedDevices())
+	enum DEVICES {DEVICE_ATTINY_VOLT, DEVICE_ATTINY_FREQ, DEVICE_ATMEGA_GENERAL, DEVICE_NOVOCONTROL, DEVICE_HP4294A, DEVICE_EMPICO, DEVICE_SPECTROMETER, DEVICE_ELECTRODES, DEVICE_GPIB};
 	
 	/**
 	 * @brief constructor
@@ -58,11 +62,12 @@ public:
 	
 	/**
 	 * @brief executes the task
-	 * @param executeNext used in objects of class Recipe to stop executing a Recipe if executeNext is false
+	 * @param data contains the data which is captured during the execution of the task
+	 * @param token cancelled to stop a running Recipe, waits in the task should sleep on the token
 	 * 
 	 * virtual void which needs to be implemented by subclass
 	 */
-	virtual void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) = 0;
+	virtual void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) = 0;
 	
 	/**
 	 * @brief get the kind of task
@@ -78,6 +83,49 @@ public:
 	 */
 	virtual std::list<DEVICES> getNecessaryDevices() = 0;
 	
+	/**
+	 * @brief get a list of all devices, which are used while the task is executed. Tasks of a concurrent Recipe which do not use the
+	 * same device may be executed at the same time (see TaskGraph)
+	 * @return list of used devices
+	 * 
+	 * The default implementation returns the necessary devices and DEVICE_GPIB if a device connected via GPIB is used.
+	 */
+	virtual std::list<DEVICES> getUsedDevices();
+	
+	/**
+	 * @brief check if the task needs to be executed alone: all previous tasks have finished before the task starts and all following
+	 * tasks start after the task has finished
+	 * @return true (default) if the task is a barrier, false if it only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier();
+	
+	/**
+	 * @brief used by CompiledRecipe to skip operations which have no effect. The task computes its hints from the expected state of
+	 * the devices before the task, updates the state to the state after the task and counts the skipped operations.
+	 * @param state expected state of the devices
+	 * @param hints hints for the execution of the task
+	 * @param report counts the skipped operations
+	 * 
+	 * The default implementation resets the state (unknown effects).
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report);
+	
+	/**
+	 * @brief set the hints which are used during the next execution (computed by compile())
+	 * @param h the hints, default hints (ExecutionHints()) skip nothing
+	 */
+	void setExecutionHints(const ExecutionHints &h);
+	
+	/**
+	 * @brief advances the virtual clock of the simulator by the time the execution of the task would take, nothing is sent to the
+	 * devices (used by Simulator). Operations which are skipped by the hints of the compiled recipe (Simulator::getHints()) take
+	 * no time.
+	 * @param sim the simulator
+	 * 
+	 * The default implementation takes no time.
+	 */
+	virtual void simulate(Simulator &sim);
+	
 	/**
 	 * @brief get the unique ID of the task
 	 * @return the unique ID 
@@ -146,6 +194,14 @@ protected:
 	 */
 	void addLogEvent(Log_Event::Log_Event_ptr l);
 	
+	/// hints for the current execution @see compile
+	ExecutionHints hints;
+	
+	/**
+	 * @brief read the relais from the microcontroller, skipped if the relais are known (ExecutionHints::relaisSynced)
+	 */
+	void readRelais();
+	
 private:
 	/// counts the created Task objects (ID of the next Task Object)
 	static int max_id;
@@ -0,0 +1,87 @@
+#pragma once
+/**
+ * @file TaskGraph.h
+ *
+ * @class TaskGraph
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Recipe
+ * @see Task::getUsedDevices
+ * @see Task::isBarrier
+ * @brief executes the tasks of a concurrent Recipe as dependency graph. A task depends on the previous tasks which use one of its
+ * devices (Task::getUsedDevices()). Barrier tasks (Task::isBarrier(), e.g. DelayTask, nested recipes and all tasks which do not
+ * declare their devices) depend on all previous tasks and all following tasks depend on them. Tasks without dependencies between
+ * them (e.g. a SpectrometerTask and a PadTask) are executed at the same time by worker threads. If several tasks are ready, the task
+ * which comes first in the recipe is started first.
+ *
+ * If a task throws an exception or the token is cancelled, no further tasks are started. The exception is rethrown by execute()
+ * after the running tasks have finished.
+ */
+#include "Task.h"
+#include "ExperimentData.h"
+#include "Simulator.h"
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+/// max. no of tasks which are executed at the same time
+#define TASK_GRAPH_THREADS 4
+
+class TaskGraph{
+public:
+	typedef std::shared_ptr<TaskGraph> TaskGraph_ptr;
+	
+	/**
+	 * @brief creates the dependency graph of the tasks
+	 * @param tasks the tasks in the order of the recipe
+	 * @return smart pointer to the created object
+	 */
+	static TaskGraph_ptr create(const std::vector<Task::Task_ptr> &tasks);
+	
+	/**
+	 * @brief executes the tasks, the method returns when all tasks have been executed
+	 * @param data contains the data which is captured during the execution of the tasks
+	 * @param token if cancelled, no further tasks are started
+	 * @param threads max. no of tasks which are executed at the same time
+	 */
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token, unsigned int threads = TASK_GRAPH_THREADS);
+	
+	/**
+	 * @brief simulates the execution, each task starts when its dependencies have finished and one of the threads is free
+	 * @param sim the simulator, its clock is set to the end of the last task
+	 * @param threads max. no of tasks which are executed at the same time
+	 */
+	void simulate(Simulator &sim, unsigned int threads = TASK_GRAPH_THREADS);
+	
+	/**
+	 * @brief get the no of tasks
+	 * @return no of tasks
+	 */
+	std::size_t getTaskCount() const;
+	
+	/**
+	 * @brief get the tasks which need to be finished before a task can start
+	 * @param i index of the task
+	 * @return indices of the tasks
+	 */
+	const std::vector<std::size_t>& getDependencies(std::size_t i) const;
+	
+	/**
+	 * @brief check if the tasks can only be executed one after another
+	 * @return true if each task depends on the previous task
+	 */
+	bool isSequential() const;
+
+private:
+	struct Node{
+		Task::Task_ptr task;
+		std::vector<std::size_t> dependencies;
+		std::vector<std::size_t> successors;
+	};
+	
+	TaskGraph(const std::vector<Task::Task_ptr> &tasks);
+	void addDependency(std::size_t from, std::size_t to);
+	
+	std::vector<Node> nodes;
+};
@@ -0,0 +1,196 @@
+#pragma once
+/**
+ * @file Telemetry.h
+ *
+ * @class Telemetry
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see TelemetryBuffer
+ * @brief samples the registers of the microcontrollers (voltage controller, external voltage, frequency generator, dht11) at
+ * configurable rates in a background thread. Each channel has a TelemetryBuffer, so the gui, the tasks and the export read the
+ * samples without i2c accesses and without waiting for the bus.
+ *
+ * The channels are scheduled on steady_clock deadlines. A value which cannot be read is stored as NaN, so a disconnected device
+ * shows up in the buffer. The dht11 needs TELEMETRY_DHT11_DELAY_MS after the request, the thread samples the other channels in the
+ * meantime; temperature and humidity are sampled together at the rate of CHANNEL_TEMPERATURE. Only the thread accesses the dht11,
+ * I2CTempTask requests a measurement by sampleNow() and waits for the sample.
+ *
+ * The buffers keep the last TELEMETRY_BUFFER_SIZE samples of each channel. A Recording (e.g. of an experiment) keeps all samples
+ * since its start: the thread drains the buffers into the recordings (TelemetryBuffer::read with a cursor) after each sample.
+ *
+ * The control loops (I2CVoltageTask) still read the adc themselves, they need the value at that moment.
+ */
+#include "TelemetryBuffer.h"
+#include "Uc_Connection.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+/// default rate of the internal voltage [Hz]
+#define TELEMETRY_RATE_VOLTAGE_HZ 5
+/// default rate of the setpoint, duty cycle, pwm frequency and mode of the voltage controller [Hz]
+#define TELEMETRY_RATE_CONTROLLER_HZ 1
+/// default rate of the external voltage [Hz]
+#define TELEMETRY_RATE_EXT_VOLTAGE_HZ 2
+/// default rate of the frequency generator [Hz]
+#define TELEMETRY_RATE_FREQUENCY_HZ 1
+/// default rate of the temperature / humidity measurement [Hz]
+#define TELEMETRY_RATE_CLIMATE_HZ 0.1
+
+/// time the dht11 needs for a measurement
+#define TELEMETRY_DHT11_DELAY_MS 50
+
+/// a sample is outdated after this no of periods of its channel
+#define TELEMETRY_MAX_AGE_PERIODS 3
+
+class Telemetry{
+public:
+	typedef std::shared_ptr<Telemetry> Telemetry_ptr;
+	
+	/// the sampled values
+	enum CHANNEL {CHANNEL_VOLTAGE, CHANNEL_SETPOINT, CHANNEL_DUTY_CYCLE, CHANNEL_PWM_FREQUENCY, CHANNEL_MODE, CHANNEL_EXT_VOLTAGE, CHANNEL_FREQUENCY, CHANNEL_TEMPERATURE, CHANNEL_HUMIDITY, CHANNEL_COUNT};
+	
+	/// all samples of all channels since the start of the recording @see startRecording
+	class Recording{
+	public:
+		/**
+		 * @brief get the start of the recording
+		 * @return steady clock [ns], the times of the csv file are relative to it
+		 */
+		std::int64_t getStart_ns() const;
+		
+		/**
+		 * @brief get the no of recorded samples
+		 * @param c the channel
+		 * @return no of samples
+		 */
+		std::size_t getCount(CHANNEL c) const;
+		
+		/**
+		 * @brief get the no of samples which have been overwritten in the buffers before they could be recorded
+		 * @return no of missing samples, 0 if the recording is complete
+		 */
+		unsigned long getLost() const;
+		
+	private:
+		friend class Telemetry;
+		
+		std::int64_t start_ns;
+		unsigned long cursors[CHANNEL_COUNT]; // TelemetryBuffer::read
+		std::vector<TelemetryBuffer::Sample> samples[CHANNEL_COUNT];
+		unsigned long lost;
+		bool finished; // written by writeCsv, no more samples are added
+		mutable std::mutex mtx;
+	};
+	typedef std::shared_ptr<Recording> Recording_ptr;
+	
+	/**
+	 * @brief creates / returns the service, there is at max one service (like Uc_Connection::create)
+	 * @return smart pointer to the service
+	 */
+	static Telemetry_ptr create();
+	
+	/**
+	 * @brief stops the thread
+	 */
+	virtual ~Telemetry();
+	
+	/**
+	 * @brief set the sample rate of a channel
+	 * @param c the channel (CHANNEL_HUMIDITY is sampled with CHANNEL_TEMPERATURE)
+	 * @param hz samples per second, 0: the channel is not sampled
+	 */
+	void setRate(CHANNEL c, double hz);
+	
+	/**
+	 * @brief get the sample rate of a channel
+	 * @param c the channel
+	 * @return samples per second
+	 */
+	double getRate(CHANNEL c);
+	
+	/**
+	 * @brief get the last value of a channel, does not wait
+	 * @param c the channel
+	 * @param value the value (V, Hz, %, °C, duty cycle 0..1, mode register)
+	 * @return false if there is no sample, the sample is outdated or the device could not be read
+	 */
+	bool getValue(CHANNEL c, double &value);
+	
+	/**
+	 * @brief get the buffer of a channel, the samples can be read without waiting
+	 * @param c the channel
+	 * @return the buffer (NaN: the device could not be read)
+	 */
+	const TelemetryBuffer& getBuffer(CHANNEL c) const;
+	
+	/**
+	 * @brief sample a channel as soon as possible, also if it is not sampled periodically (rate 0)
+	 * @param c the channel (CHANNEL_HUMIDITY is sampled with CHANNEL_TEMPERATURE)
+	 */
+	void sampleNow(CHANNEL c);
+	
+	/**
+	 * @brief start recording the samples of all channels
+	 * @return the recording, the samples are recorded as long as it exists
+	 */
+	Recording_ptr startRecording();
+	
+	/**
+	 * @brief finish a recording and write its samples as csv file (time_s;channel;value)
+	 * @param path path of the file
+	 * @param recording the recording, the samples of the buffers which have not been drained yet are added
+	 *
+	 * throws a runtime_error if the file cannot be written or samples are missing (the file is written anyway)
+	 */
+	void writeCsv(std::string path, Recording_ptr recording);
+	
+	/**
+	 * @brief get the time base of the samples
+	 * @return steady clock [ns]
+	 */
+	static std::int64_t now_ns();
+	
+	/**
+	 * @brief get the name of a channel
+	 * @param c the channel
+	 * @return name, e.g. "voltage"
+	 */
+	static std::string channelToString(CHANNEL c);
+
+private:
+	typedef std::chrono::steady_clock Clock;
+	
+	Telemetry();
+	void samplerThread();
+	void sample(CHANNEL c); // reads the channel and adds the sample
+	void requestClimate();
+	void readClimate();
+	void drain(Recording &recording); // append the new samples of the buffers
+	void drainRecordings();
+	
+	TelemetryBuffer buffers[CHANNEL_COUNT];
+	double rates[CHANNEL_COUNT];
+	Clock::time_point deadlines[CHANNEL_COUNT];
+	bool requested[CHANNEL_COUNT]; // sampleNow
+	std::vector<std::weak_ptr<Recording>> recordings;
+	bool climateRequested; // waiting for the dht11
+	Clock::time_point climateReady;
+	Uc_Connection::Uc_Connection_ptr voltageController;
+	Uc_Connection::Uc_Connection_ptr atmega32;
+	Uc_Connection::Uc_Connection_ptr freqGenerator;
+	bool running;
+	
+	std::mutex mtx; // rates, deadlines, requested, recordings, running
+	std::condition_variable changed;
+	std::thread sampler_thread;
+	
+	static std::weak_ptr<Telemetry> service;
+	static std::mutex serviceMtx;
+};
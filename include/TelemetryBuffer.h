@@ -0,0 +1,85 @@
+#pragma once
+/**
+ * @file TelemetryBuffer.h
+ *
+ * @class TelemetryBuffer
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Telemetry
+ * @brief fixed size ring buffer of timestamped values with one writer and any number of readers. Neither push() nor the readers lock
+ * or wait, so the gui, the tasks and the export can read while the sampler writes.
+ *
+ * Each slot has a sequence number (index of the sample + 1, 0 while the writer changes the slot). A reader copies the slot and checks
+ * that the sequence number is the expected one before and after copying (seqlock); samples which have been overwritten in the
+ * meantime are skipped. The values are atomics, so a torn copy is detected and never undefined.
+ */
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+/// default no of samples per buffer
+#define TELEMETRY_BUFFER_SIZE 1024
+
+class TelemetryBuffer{
+public:
+	/// one timestamped value
+	struct Sample{
+		std::int64_t time_ns; // steady clock
+		double value;
+	};
+	
+	/**
+	 * @param size no of samples which are kept
+	 */
+	TelemetryBuffer(std::size_t size = TELEMETRY_BUFFER_SIZE);
+	
+	TelemetryBuffer(const TelemetryBuffer&) = delete;
+	TelemetryBuffer& operator=(const TelemetryBuffer&) = delete;
+	
+	/**
+	 * @brief add a sample, overwrites the oldest sample if the buffer is full. Must only be called by one thread
+	 * @param time_ns time of the sample
+	 * @param value the value
+	 */
+	void push(std::int64_t time_ns, double value);
+	
+	/**
+	 * @brief get the last sample
+	 * @param s the sample
+	 * @return false if no sample has been added
+	 */
+	bool latest(Sample &s) const;
+	
+	/**
+	 * @brief append the samples which have been added since a previous call
+	 * @param cursor value returned by the previous call, 0 to get all samples in the buffer
+	 * @param samples the samples are appended (oldest first)
+	 * @return cursor for the next call
+	 */
+	unsigned long read(unsigned long cursor, std::vector<Sample> &samples) const;
+	
+	/**
+	 * @brief get the no of samples which have been added
+	 * @return no of samples since the buffer has been created
+	 */
+	unsigned long getCount() const;
+	
+	/**
+	 * @brief get the no of samples the buffer keeps
+	 * @return size of the buffer
+	 */
+	std::size_t getSize() const;
+
+private:
+	struct Slot{
+		std::atomic<unsigned long> seq;
+		std::atomic<std::int64_t> time_ns;
+		std::atomic<double> value;
+	};
+	
+	bool readSlot(unsigned long index, Sample &s) const;
+	
+	std::vector<Slot> slots;
+	std::atomic<unsigned long> count;
+};
@@ -17,7 +17,7 @@ public:
 	TestTask();
 	TestTask(std::string name);
 	~TestTask();
-	void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	virtual std::string getType() const override;
 	
 	/**
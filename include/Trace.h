@@ -0,0 +1,152 @@
+#pragma once
+/**
+ * @file Trace.h
+ *
+ * @class Trace
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see ExperimentData::saveTrace
+ * @brief records scoped spans (task execution, relais writes, i2c transfers, serial / gpib round-trips, sweeps, file writes) with
+ * nanosecond timing and writes them as trace.json in the Chrome trace event format. The file can be opened with chrome://tracing or
+ * https://ui.perfetto.dev, each thread is one row of the timeline.
+ *
+ * Each thread writes into its own fixed size buffer, only the thread itself appends spans, so recording does not lock. The buffer of a
+ * thread is allocated when the thread records its first span after start(). If a buffer is full, further spans of the thread are
+ * dropped and counted. If tracing is not running, a Span only checks an atomic flag.
+ *
+ * usage:
+ * 	{
+ * 		Trace::Span span("i2c", "writeRegister", "address", 0x50);
+ * 		...
+ * 	} // the span ends here
+ */
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+/// max. no of spans per thread between start() and write()
+#define TRACE_THREAD_EVENTS 16384
+
+/// max. length of the name of a span / thread (longer names are truncated)
+#define TRACE_NAME_LENGTH 48
+
+class Trace{
+public:
+	
+	/// measures the time between its construction and destruction
+	class Span{
+	public:
+		/**
+		 * @brief starts a span
+		 * @param category category of the span (string literal), e.g. "task", "i2c", "gpib"
+		 * @param name name of the span (copied)
+		 * @param argName name of an optional integer argument (string literal), nullptr if the span has no argument
+		 * @param arg value of the argument
+		 */
+		Span(const char* category, const char* name, const char* argName = nullptr, long arg = 0);
+		Span(const char* category, const std::string &name, const char* argName = nullptr, long arg = 0);
+		
+		/**
+		 * @brief ends the span and adds it to the buffer of the thread
+		 */
+		~Span();
+		
+		Span(const Span&) = delete;
+		Span& operator=(const Span&) = delete;
+	
+	private:
+		void begin(const char* category, const char* name, const char* argName, long arg);
+		
+		bool recording;
+		const char* category;
+		const char* argName;
+		long arg;
+		std::int64_t start_ns;
+		char name[TRACE_NAME_LENGTH];
+	};
+	
+	/**
+	 * @brief discard all recorded spans and start recording
+	 */
+	static void start();
+	
+	/**
+	 * @brief stop recording, spans which are running are still added when they end
+	 */
+	static void stop();
+	
+	/**
+	 * @brief check if spans are recorded
+	 * @return true between start() and stop()
+	 */
+	static bool isRunning();
+	
+	/**
+	 * @brief set the name of the calling thread, shown in the trace viewer
+	 * @param name name of the thread
+	 */
+	static void setThreadName(const std::string &name);
+	
+	/**
+	 * @brief write the spans which have been recorded since start() as json file (Chrome trace event format)
+	 * @param path path of the file
+	 *
+	 * throws a runtime_error if the file cannot be written
+	 */
+	static void write(std::string path);
+	
+	/**
+	 * @brief get the no of spans which have been dropped because the buffer of a thread was full
+	 * @return no of dropped spans since start()
+	 */
+	static unsigned long getDropped();
+
+private:
+	struct Event{
+		const char* category;
+		const char* argName;
+		long arg;
+		std::int64_t start_ns;
+		std::int64_t duration_ns;
+		char name[TRACE_NAME_LENGTH];
+	};
+	
+	struct ThreadBuffer{
+		std::vector<Event> events;
+		std::atomic<std::size_t> count; // only changed by the thread which owns the buffer
+		std::atomic<unsigned long> dropped;
+		std::atomic<unsigned int> generation; // recording run the events belong to
+		std::atomic<bool> alive; // false when the thread has ended
+		unsigned int tid;
+		char threadName[TRACE_NAME_LENGTH];
+		
+		ThreadBuffer(unsigned int tid, const char* threadName);
+	};
+	
+	struct ThreadState{
+		std::shared_ptr<ThreadBuffer> buffer;
+		char threadName[TRACE_NAME_LENGTH];
+		
+		ThreadState();
+		~ThreadState(); // marks the buffer as ended, it is kept until the next start()
+	};
+	
+	static std::int64_t now_ns();
+	static void add(const Event &e);
+	static ThreadBuffer* getBuffer();
+	static void copyName(char* dest, const char* src);
+	static std::string escape(const char* s);
+	
+	static std::atomic<bool> running;
+	static std::atomic<unsigned int> generation;
+	static std::atomic<std::int64_t> origin_ns;
+	static std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+	static std::mutex buffersMtx;
+	static unsigned int nextTid;
+	static thread_local ThreadState threadState;
+};
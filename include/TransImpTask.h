@@ -34,9 +34,9 @@ public:
 	/**
 	 * @brief caputures the spectrums and stores them in the ExperimentData object
 	 * @param data used to store caputured data - spectrums are stored here
-	 * @param executeNext used to stop the task during execution
+	 * @param token used to stop the task during execution
 	 */
-	void execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) override;
+	void execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) override;
 	
 	/**
 	 * @brief get the type of the task as string
@@ -84,6 +84,30 @@ public:
 	 */
 	virtual std::list<Task::DEVICES> getNecessaryDevices() override;
 	
+	/**
+	 * @brief get a list of all devices, which are used while the task is executed
+	 * @return the analyser, DEVICE_ATMEGA_GENERAL (impedance / source / wire mode relais) and DEVICE_ELECTRODES (the pads are switched to the analyser)
+	 */
+	virtual std::list<Task::DEVICES> getUsedDevices() override;
+	
+	/**
+	 * @brief check if the task needs to be executed alone
+	 * @return false, the task only depends on the tasks using the same devices
+	 */
+	virtual bool isBarrier() override;
+	
+	/**
+	 * @brief skips the relais writes and settle delays if the relais are already in the right position or the next task measures the impedance as well
+	 * @see Task::compile
+	 */
+	virtual void compile(DeviceState &state, ExecutionHints &hints, CompileReport &report) override;
+	
+	/**
+	 * @brief takes the sweeps until the termination condition is reached and the relais writes and settle delays which are not skipped
+	 * @see Task::simulate
+	 */
+	virtual void simulate(Simulator &sim) override;
+	
 	/**
 	 * @brief get parameters as string
 	 * @return string containing the parameters
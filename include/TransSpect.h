@@ -7,8 +7,15 @@
  * @date 05.06.2019
  * @brief class to store a transient spectrum. A listener can be added to call a specified function each time a spectrum has been added to
  * the transient spectrum. The captured spectrums and timestamps are stored and a transient spectrum of one frequency can be created
+ * 
+ * The spectrums are stored in an append-only time x frequency matrix (SpectrumMatrix), so the time series of one frequency is an O(1)
+ * strided view of that matrix.
  */
 #include "DataP.h"
+#include "Spectrum.h"
+#include "SpectrumMatrix.h"
+#include "MeasurementWriter.h"
+#include "MeasurementFileReader.h"
 
 #include <vector>
 #include <chrono>
@@ -19,7 +26,7 @@
 
 class TransSpect{
 public:
-	typedef std::vector<DataP::DataP_ptr> Spectrum;
+	typedef ::Spectrum Spectrum;
 	typedef std::shared_ptr<TransSpect> TransSpect_ptr;
 	
 	enum X_VALUE {X_TIME, X_TIME_DIFF, X_POINT};
@@ -33,6 +40,14 @@ public:
 	 * reference to itself, which is locked (transformed in a shared_ptr reference) when the listener is called.
 	 */
 	static TransSpect_ptr create();
+	
+	/**
+	 * @brief creates a transient spectrum from already loaded spectrums
+	 * @param spectrums the spectrums (in the order of the transient spectrum)
+	 * @param timediffs timediff of each spectrum, the timediff of the first spectrum is subtracted from all timediffs
+	 * @return smart pointer to the created object
+	 */
+	static TransSpect_ptr create(const std::vector<Spectrum> &spectrums, const std::vector<double> &timediffs);
 	virtual ~TransSpect();
 	
 	/**
@@ -50,12 +65,21 @@ public:
 	const std::vector<double> getFrequencies() const;
 	
 	/**
-	 * @brief creates a transient spectrum for one frequency
+	 * @brief creates a transient spectrum for one frequency. The lock is only held while the view on the matrix is created, the values
+	 * are copied afterwards into one preallocated spectrum
 	 * @param freqNo number of the frequency which should be used for the transient spectrum (index of frequency in getFrequencies() vector)
 	 * @param x defines what should be used for the x values (time or measurement number)
 	 */
 	const Spectrum getTransSpect(unsigned int freqNo, X_VALUE x = X_VALUE::X_POINT);
 	
+	/**
+	 * @brief get a view of the time series of one frequency (O(1), nothing is copied). The view contains the spectrums which have been
+	 * captured until this call and stays valid when new spectrums are added
+	 * @param freqNo number of the frequency (index of frequency in getFrequencies() vector)
+	 * @return the view, empty if freqNo is invalid
+	 */
+	SpectrumMatrix::Column getTimeTrace(unsigned int freqNo);
+	
 	/**
 	 * @brief links the method which is called each time a spectrum has been added
 	 * @param listener the method which should be called
@@ -63,19 +87,26 @@ public:
 	void setOn_Spec_added_listener(void (*listener)(TransSpect_ptr ptr, Spectrum s, unsigned int position, double timediff));
 	
 	/**
-	 * @brief set the path where the spectrums are saved (base path because _<index>.xml will be added to each file)
-	 * @param path the base path (where just "_<index>.xml" needs to be added)
+	 * @brief set the writer of the measurement file the spectrums are saved in and the no of the transient spectrum in that file
+	 * @param writer the writer of the measurement file of the experiment
+	 * @param series no of the transient spectrum (stored with each spectrum)
 	 * @see ExperimentData
 	 * 
-	 * this function is called by ExperimentData to store the calculated base path
+	 * this function is called by ExperimentData when the transient spectrum is added
 	 */
-	void setBasePath(std::string path);
+	void setMeasurementWriter(MeasurementWriter::MeasurementWriter_ptr writer, unsigned int series);
 	
 	/**
-	 * @brief get the value of the basepath variable (which has been set by setBasePath)
-	 * @return the base path (where just "_<index>.xml" needs to be added for each spectrum)
+	 * @brief get the writer which has been set by setMeasurementWriter
+	 * @return the writer, nullptr if it has not been set
 	 */
-	const std::string getBasePath() const;
+	MeasurementWriter::MeasurementWriter_ptr getMeasurementWriter() const;
+	
+	/**
+	 * @brief get the no of the transient spectrum in the measurement file
+	 * @return no of the transient spectrum
+	 */
+	unsigned int getSeriesNo() const;
 	
 	/**
 	 * @brief get the last added spectrum (last element in transSpect)
@@ -100,25 +131,37 @@ public:
 	double progress = 0.0;
 	
 	/**
-	 * @brief load a saved transient spectrum
+	 * @brief load a saved transient spectrum. The files are loaded in parallel by a TransSpectLoader, the method blocks until all
+	 * files have been loaded (use TransSpectLoader directly to load in the background)
 	 * @param paths list of the paths of the files that belong to the transient spectrum
 	 * @return smart pointer to the loaded spectrum
 	 */
 	static TransSpect_ptr loadTransImpSpectrum(std::vector<std::string> paths);
 	
+	/**
+	 * @brief load a transient spectrum from a measurement file
+	 * @param reader the opened measurement file
+	 * @param series no of the transient spectrum in the file
+	 * @return smart pointer to the loaded spectrum
+	 */
+	static TransSpect_ptr loadTransImpSpectrum(const MeasurementFileReader &reader, unsigned int series);
+	
 private:
 	typedef std::chrono::system_clock::time_point TimePoint;
 	
 	TransSpect();
-	std::vector<Spectrum> transSpect;
-	std::vector<TimePoint> timeStamps;
+	SpectrumMatrix transSpect;
+	Spectrum lastSpectrum;
+	TimePoint startTime; // time stamp of the first spectrum
 	std::vector<double> frequencies;
-	std::mutex spectMtx;
-	std::string basePath;
+	mutable std::mutex spectMtx;
+	MeasurementWriter::MeasurementWriter_ptr measurementWriter;
+	unsigned int seriesNo;
 	
 	void (*on_Spectrum_added) (TransSpect_ptr ptr, Spectrum s, unsigned int position, double timediff);
 	
 	static inline TimePoint getCurrentTime();
+	unsigned int appendSpectrum(const Spectrum &s, double timediff); // spectMtx needs to be locked
 	std::weak_ptr<TransSpect> this_ptr;
 	
 };
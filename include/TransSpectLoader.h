@@ -0,0 +1,124 @@
+#pragma once
+/**
+ * @file TransSpectLoader.h
+ *
+ * @class TransSpectLoader
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see TransSpect
+ * @see SpectrumCsvReader
+ * @brief loads a transient impedance spectrum from csv files (one file per spectrum) in background threads. The files are
+ * distributed over a small pool of threads, each file is parsed by SpectrumCsvReader. When all files have been loaded, the spectrums
+ * are sorted by their position=... line and the transient spectrum is created.
+ *
+ * The progress listener is called from the loading threads (use a Glib::Dispatcher to update the GUI) whenever the progress has
+ * changed by at least 1% and once when loading has finished. Loading can be cancelled at any time.
+ */
+#include "TransSpect.h"
+#include "Spectrum.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstddef>
+
+/// default no of loading threads
+#define TRANS_SPECT_LOADER_THREADS 4
+
+class TransSpectLoader{
+public:
+	typedef std::shared_ptr<TransSpectLoader> TransSpectLoader_ptr;
+	typedef std::function<void()> ProgressListener;
+	
+	/**
+	 * @brief creates a loader, call start() to start loading
+	 * @param paths paths of the csv files of the transient spectrum
+	 * @param threads max. no of loading threads
+	 * @return smart pointer to the created object
+	 */
+	static TransSpectLoader_ptr create(std::vector<std::string> paths, unsigned int threads = TRANS_SPECT_LOADER_THREADS);
+	
+	/**
+	 * @brief cancels loading and waits for the loading threads
+	 */
+	virtual ~TransSpectLoader();
+	
+	/**
+	 * @brief start the loading threads
+	 * @param listener called when the progress has changed and when loading has finished (from a loading thread)
+	 */
+	void start(ProgressListener listener = nullptr);
+	
+	/**
+	 * @brief stop loading, the files which are being read are finished
+	 */
+	void cancel();
+	
+	/**
+	 * @brief wait until all files have been loaded (or loading has been cancelled / failed)
+	 */
+	void waitUntilFinished();
+	
+	/**
+	 * @brief check if loading has finished (successfully, cancelled or failed)
+	 * @return true if loading has finished
+	 */
+	bool isFinished();
+	
+	/**
+	 * @brief check if loading has been cancelled
+	 * @return true if cancel() has been called before loading had finished
+	 */
+	bool isCancelled() const;
+	
+	/**
+	 * @brief get the no of files which have been loaded
+	 * @return no of loaded files
+	 */
+	std::size_t getLoadedCount() const;
+	
+	/**
+	 * @brief get the no of files of the transient spectrum
+	 * @return no of files
+	 */
+	std::size_t getFileCount() const;
+	
+	/**
+	 * @brief get the loaded transient spectrum
+	 * @return the transient spectrum, nullptr if loading has not finished or has been cancelled
+	 *
+	 * throws a runtime_error if a file could not be loaded
+	 */
+	TransSpect::TransSpect_ptr getTransSpect();
+
+private:
+	TransSpectLoader(std::vector<std::string> paths, unsigned int threads);
+	void loadThread();
+	void finish(); // called by the last loading thread
+	
+	std::vector<std::string> paths;
+	unsigned int threadCount;
+	std::vector<Spectrum> spectrums; // one slot per file, written by the thread which loaded the file
+	std::vector<int> positions;
+	std::vector<double> timediffs;
+	ProgressListener listener;
+	
+	std::atomic<std::size_t> nextFile;
+	std::atomic<std::size_t> loadedFiles;
+	std::atomic<unsigned int> lastProgress; // percent
+	std::atomic<bool> stop; // cancelled or failed
+	std::atomic<bool> cancelled;
+	unsigned int runningThreads;
+	bool finished;
+	std::string error;
+	TransSpect::TransSpect_ptr transSpect;
+	
+	std::mutex mtx;
+	std::condition_variable finishedCondition;
+	std::vector<std::thread> threads;
+};
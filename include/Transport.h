@@ -0,0 +1,173 @@
+#pragma once
+/**
+ * @file Transport.h
+ *
+ * @class Transport
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see WiringPiTransport
+ * @see SimulatedTransport
+ * @brief access to the gpio pins, the i2c bus and the serial port. PadTask, Uc_Connection (and with it Relais, StatusLed and the
+ * I2C tasks) and EmStatPico use the current transport (get()) instead of calling wiringPi directly. The WiringPiTransport
+ * accesses the hardware of the raspberry pi, the SimulatedTransport models the microcontrollers in memory, so the control paths can
+ * be run and profiled on any linux box.
+ *
+ * The default transport is the WiringPiTransport if the program is built with wiringPi (cmake option USE_WIRINGPI), otherwise the
+ * SimulatedTransport. It can be replaced with set() at any time, open i2c connections are reopened with the new transport.
+ */
+#include <memory>
+#include <string>
+#include <cstdint>
+
+/// no of the wiringPi pin numbers
+#define TRANSPORT_GPIO_PINS 32
+
+class Transport{
+public:
+	typedef std::shared_ptr<Transport> Transport_ptr;
+	
+	virtual ~Transport();
+	
+	/**
+	 * @brief get the current transport
+	 * @return the transport
+	 */
+	static Transport_ptr get();
+	
+	/**
+	 * @brief replace the current transport
+	 * @param t the new transport
+	 */
+	static void set(Transport_ptr t);
+	
+	/**
+	 * @brief init the transport, needs to be called once before the gpio pins are used
+	 */
+	virtual void setup() = 0;
+	
+	/**
+	 * @brief configure a gpio pin as output
+	 * @param pin wiringPi number of the pin
+	 */
+	virtual void setOutput(int pin) = 0;
+	
+	/**
+	 * @brief set the level of a gpio pin
+	 * @param pin wiringPi number of the pin
+	 * @param value true: high, false: low
+	 */
+	virtual void digitalWrite(int pin, bool value) = 0;
+	
+	/**
+	 * @brief get the level of a gpio pin
+	 * @param pin wiringPi number of the pin
+	 * @return true: high, false: low
+	 */
+	virtual bool digitalRead(int pin) = 0;
+	
+	/**
+	 * @brief set and clear several gpio pins at once, like the GPSET0 / GPCLR0 registers of the BCM2835 (set first, then clear)
+	 * @param set pins which are set high (bit n: BCM pin n)
+	 * @param clear pins which are set low (bit n: BCM pin n)
+	 * 
+	 * the default implementation writes the pins one by one with digitalWrite.
+	 */
+	virtual void writePins(std::uint32_t set, std::uint32_t clear);
+	
+	/**
+	 * @brief get the BCM number of a pin (raspberry pi with 40 pin header)
+	 * @param pin wiringPi number of the pin
+	 * @return BCM number of the pin, -1 if the pin does not exist
+	 */
+	static constexpr int toBcm(int pin){
+		return (pin >= 0 && pin < TRANSPORT_GPIO_PINS ? bcmPins[pin] : -1);
+	}
+	
+	/**
+	 * @brief wait a short time, e.g. the setup time of the pad address
+	 * @param us time in microseconds
+	 */
+	virtual void delayMicroseconds(unsigned int us) = 0;
+	
+	/**
+	 * @brief open a connection to an i2c slave
+	 * @param address 7 bit slave address
+	 * @return file descriptor of the connection, -1 if the connection could not be opened
+	 */
+	virtual int i2cSetup(int address) = 0;
+	
+	/**
+	 * @brief send one byte to the slave (e.g. the no of the register which is read next)
+	 * @param fd file descriptor of the connection
+	 * @param data the byte
+	 * @return 0 on success, -1 on error
+	 */
+	virtual int i2cWrite(int fd, int data) = 0;
+	
+	/**
+	 * @brief read one byte from the slave
+	 * @param fd file descriptor of the connection
+	 * @return the byte, -1 on error
+	 */
+	virtual int i2cRead(int fd) = 0;
+	
+	/**
+	 * @brief write one byte to a register of the slave
+	 * @param fd file descriptor of the connection
+	 * @param reg the no of the register
+	 * @param data the byte
+	 * @return 0 on success, -1 on error
+	 */
+	virtual int i2cWriteReg8(int fd, int reg, int data) = 0;
+	
+	/**
+	 * @brief read consecutive registers of the slave in one combined transaction (register no, repeated start, count bytes)
+	 * @param fd file descriptor of the connection
+	 * @param reg the no of the first register
+	 * @param data buffer for count bytes
+	 * @param count no of registers
+	 * @return 0 on success, -1 on error
+	 * 
+	 * the slave increments its register pointer after each byte. The default implementation reads the registers one by one.
+	 */
+	virtual int i2cReadBlock(int fd, int reg, unsigned char* data, int count);
+	
+	/**
+	 * @brief write consecutive registers of the slave in one transaction (register no, count bytes)
+	 * @param fd file descriptor of the connection
+	 * @param reg the no of the first register
+	 * @param data count bytes
+	 * @param count no of registers
+	 * @return 0 on success, -1 on error
+	 * 
+	 * the slave increments its register pointer after each byte. The default implementation writes the registers one by one.
+	 */
+	virtual int i2cWriteBlock(int fd, int reg, const unsigned char* data, int count);
+	
+	/**
+	 * @brief open a serial port
+	 * @param device e.g. /dev/serial0
+	 * @param baud baud rate
+	 * @return file descriptor which can be read by SerialReader, -1 if the port could not be opened
+	 */
+	virtual int serialOpen(const std::string &device, int baud) = 0;
+	
+	/**
+	 * @brief send a string to a serial port
+	 * @param fd file descriptor of the port
+	 * @param s the string
+	 */
+	virtual void serialPuts(int fd, const std::string &s) = 0;
+	
+	/**
+	 * @brief close a serial port
+	 * @param fd file descriptor of the port
+	 */
+	virtual void serialClose(int fd) = 0;
+
+private:
+	static Transport_ptr& current();
+	
+	/// BCM numbers of the wiringPi pins 0..31
+	static constexpr int bcmPins[TRANSPORT_GPIO_PINS] = {17, 18, 27, 22, 23, 24, 25, 4, 2, 3, 8, 7, 10, 9, 11, 14, 15, 28, 29, 30, 31, 5, 6, 13, 19, 26, 12, 16, 20, 21, 0, 1};
+};
@@ -14,6 +14,9 @@
 #include <gtkmm.h>
 #include <vector>
 
+/// name of the child row of a recipe whose tasks have not been loaded yet
+#define TREEVIEW_RECIPE_PLACEHOLDER "..."
+
 class TreeView_Recipe{
 	
 public:
@@ -168,6 +171,14 @@ private:
 	 */
 	void addTaskToView(Task::Task_ptr t);
 	
+	/**
+	 * @brief replaces the placeholder row of a recipe whose tasks have not been loaded by the tasks of the recipe
+	 * @param iter the row which is going to be expanded
+	 * @param path path of the row
+	 * @return false, the row is expanded
+	 */
+	bool on_test_expand_row(const Gtk::TreeModel::iterator& iter, const Gtk::TreeModel::Path& path);
+	
 	/**
 	 * @brief adds all Tasks / child recipes of a Recipe as childrows to an exisiting row
 	 * @see addRecipeToView
@@ -6,8 +6,15 @@
  * @author Nils Bosbach
  * @date 10.04.2019
  * @brief implements the I2C connection between the raspberry pi (master) and the atmega32 (slave)
- * An I2C connection is opened using the wiringPiI2C libary
+ * An I2C connection is opened using the current Transport (wiringPiI2C or the simulated microcontrollers)
+ * 
+ * Consecutive registers can be read / written in one bus transaction (readRegisters(), writeRegisters()). The connection keeps the
+ * last value written to / read from each register, writeRegisters() can skip registers whose value has not changed. This assumes that
+ * the registers are just changed by this program - registers which are changed by the microcontroller (e.g. a request flag which is
+ * reset after the request has been handled) should be written without skipping.
  */
+ #include "Transport.h"
+ 
  #include <memory>
  #include <mutex>
  #include <list>
@@ -40,7 +47,7 @@ public:
 	/**
 	 * @brief sends one byte to the slave
 	 * @param data the byte which should be send (values from 0 to 255 possible)
-	 * @return return value of wiringPiI2CWrite
+	 * @return return value of Transport::i2cWrite
 	 */
 	int sendByte(int data) const;
 	
@@ -61,10 +68,28 @@ public:
 	 * @brief write one byte to a register of the i2c slave
 	 * @param reg the number of the register where the data should be writen to
 	 * @param data the byte which should be writte to the register
-	 * @return the returnvalue of wiringPiI2CWrite
+	 * @return the returnvalue of Transport::i2cWriteReg8
 	 */
 	int writeRegister(int reg, int data) const;
 	
+	/**
+	 * @brief read consecutive registers of the i2c slave in one transaction
+	 * @param reg the number of the first register
+	 * @param count no of registers
+	 * @return the values of the registers (range 0 to 255), empty if the transfer failed
+	 */
+	std::vector<int> readRegisters(int reg, int count) const;
+	
+	/**
+	 * @brief write consecutive registers of the i2c slave in one transaction
+	 * @param reg the number of the first register
+	 * @param data the bytes which should be written to the registers
+	 * @param onlyChanged if true, just the registers from the first to the last register whose value differs from the last value
+	 * written to / read from it are written; nothing is sent if no value has changed
+	 * @return 0 on success, -1 on error
+	 */
+	int writeRegisters(int reg, const std::vector<int> &data, bool onlyChanged = false) const;
+	
 	
 	/**
 	 * @brief 
@@ -82,7 +107,9 @@ protected:
 	static std::mutex i2cMutex;
 	
 private:
-	int fd = 0; // connection hadler (from wiringPiI2C)
+	mutable int fd = 0; // connection hadler (from Transport::i2cSetup)
+	mutable Transport::Transport_ptr transport; // transport which has opened fd
+	mutable int shadow[256]; // last value written to / read from each register, -1 if unknown (guarded by i2cMutex)
 	int deviceID;
 	static std::list<std::weak_ptr<Uc_Connection>> all_Connections; // static class list that handles 
 	static std::mutex all_ConnectionsMtx;
@@ -94,4 +121,19 @@ private:
 	 * constructor not accessible from outside the class -> use create function to create a new object
 	 */
 	Uc_Connection(int deviceID);
+	
+	/**
+	 * @brief get the current transport, the connection is reopened if the transport has been replaced (Transport::set())
+	 * @return the transport
+	 * 
+	 * i2cMutex needs to be locked
+	 */
+	Transport::Transport_ptr open() const;
+	
+	/**
+	 * @brief forget the values of all registers, the next writeRegisters() writes all registers
+	 * 
+	 * i2cMutex needs to be locked
+	 */
+	void invalidateShadow() const;
 };
@@ -0,0 +1,170 @@
+#pragma once
+/**
+ * @file VoltageSettler.h
+ *
+ * @class VoltageSettler
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see I2CVoltageTask
+ * @brief decides when the voltage of the boost converter has settled and when it should be measured next.
+ *
+ * The caller measures the voltage, adds the sample and sleeps for getNextPollMs(). While the voltage is outside of the tolerance band,
+ * the next poll is placed at the estimated time the voltage enters the band. The estimate uses two models fitted to the last samples:
+ * a first order response towards the target (log-linear fit of the error) and a straight line. The first order model overestimates a
+ * ramp (rate limit of the converter), the line underestimates a first order response, so the smaller estimate is used and the poll
+ * does not miss the entry into the band. Inside the band the interval starts at VOLTAGE_SETTLE_MIN_INTERVAL_MS and backs off. The
+ * voltage has settled if it has been inside the band for VOLTAGE_SETTLE_HOLD_MS / VOLTAGE_SETTLE_HOLD_SAMPLES samples and does not
+ * drift.
+ *
+ * Optionally the settler drives the setpoint of the attiny45 (closed loop): the command is the target (feed-forward) plus an integral
+ * trim, which is updated whenever the voltage is steady. It corrects the offset of the voltage divider calibration.
+ */
+#include <deque>
+#include <cstddef>
+
+/// relative tolerance band of the voltage
+#define VOLTAGE_SETTLE_TOLERANCE 0.05
+/// relative tolerance band of the voltage in closed loop mode
+#define VOLTAGE_SETTLE_CLOSED_LOOP_TOLERANCE 0.01
+/// shortest interval between two measurements
+#define VOLTAGE_SETTLE_MIN_INTERVAL_MS 10
+/// longest interval between two measurements
+#define VOLTAGE_SETTLE_MAX_INTERVAL_MS 250
+/// factor the interval grows with while the voltage is inside the band
+#define VOLTAGE_SETTLE_BACKOFF 2.0
+/// time the voltage needs to be inside the band
+#define VOLTAGE_SETTLE_HOLD_MS 150
+/// no of samples which need to be inside the band
+#define VOLTAGE_SETTLE_HOLD_SAMPLES 3
+/// no of samples the models are fitted to
+#define VOLTAGE_SETTLE_FIT_SAMPLES 8
+/// max. time until the voltage has to be settled
+#define VOLTAGE_SETTLE_TIMEOUT_MS 20000
+/// gain of the integral trim in closed loop mode (per steady sample)
+#define VOLTAGE_SETTLE_TRIM_GAIN 0.8
+/// max. relative trim of the setpoint in closed loop mode
+#define VOLTAGE_SETTLE_TRIM_MAX 0.1
+
+class VoltageSettler{
+public:
+	/**
+	 * @param target the voltage [V] which should be reached
+	 * @param tolerance relative tolerance band
+	 */
+	VoltageSettler(double target, double tolerance = VOLTAGE_SETTLE_TOLERANCE);
+	
+	/**
+	 * @brief add a measurement
+	 * @param ms time of the measurement [ms], e.g. since the setpoint has been written
+	 * @param v measured voltage [V]
+	 */
+	void addSample(double ms, double v);
+	
+	/**
+	 * @brief discard the samples, e.g. after the capacitor has been discharged
+	 */
+	void reset();
+	
+	/**
+	 * @brief check if the voltage has settled
+	 * @return true if the voltage has been inside the band for the hold time and does not drift
+	 */
+	bool isSettled() const;
+	
+	/**
+	 * @brief check if the voltage is steady (may be outside of the band)
+	 * @return true if the last samples span the hold time and do not drift
+	 */
+	bool isSteady() const;
+	
+	/**
+	 * @brief get the time until the voltage should be measured again
+	 * @return time [ms]
+	 */
+	double getNextPollMs() const;
+	
+	/**
+	 * @brief estimate the time until the voltage reaches a level, based on the fitted models
+	 * @param level voltage [V]
+	 * @return time [ms] after the last sample, -1 if the voltage does not approach the level
+	 */
+	double estimateTimeToMs(double level) const;
+	
+	/**
+	 * @brief estimate the time until the voltage enters the band
+	 * @return time [ms] after the last sample, 0 if the voltage is inside the band, -1 if the voltage does not approach the band
+	 */
+	double estimateRemainingMs() const;
+	
+	/**
+	 * @brief get the time constant of the fitted first order response
+	 * @return time constant [ms], 0 if the response is not known
+	 */
+	double getTimeConstantMs() const;
+	
+	/**
+	 * @brief get the slope of the fitted line
+	 * @return slope [V/s]
+	 */
+	double getSlope() const;
+	
+	/**
+	 * @brief update the integral trim if the voltage is steady (closed loop mode)
+	 * @return true if the command has changed and needs to be written to the controller
+	 */
+	bool updateCommand();
+	
+	/**
+	 * @brief get the setpoint which should be written to the controller
+	 * @return target + trim [V]
+	 */
+	double getCommand() const;
+	
+	/**
+	 * @brief convert a voltage to the value of the setpoint registers of the attiny45
+	 * @param v voltage [V]
+	 * @return adc value of the setpoint (ADCL_S, ADCH_S)
+	 */
+	static int toSetpointAdc(double v);
+	
+	/**
+	 * @brief convert the value of the setpoint registers of the attiny45 to the voltage
+	 * @param adc value of ADCL_S / ADCH_S
+	 * @return voltage [V]
+	 */
+	static double toSetpointVoltage(int adc);
+	
+	/**
+	 * @brief convert the value of the adc of the attiny45 to the voltage
+	 * @param adc value of ADCL / ADCH
+	 * @return voltage [V]
+	 */
+	static double toVoltage(int adc);
+	
+	double getTarget() const;
+	double getBand() const;
+	unsigned int getSamples() const;
+
+private:
+	struct Sample{
+		double ms;
+		double v;
+	};
+	
+	void fit();
+	double fitLine(std::size_t first) const; // slope [V/ms] of the samples from first to the last sample
+	bool isInBand(double v) const;
+	
+	double target;
+	double band; // absolute [V]
+	double trim;
+	std::deque<Sample> samples; // last samples, oldest first
+	unsigned int sampleCount;
+	double inBandSinceMs; // -1 if the voltage is outside of the band
+	unsigned int inBandSamples;
+	double interval; // back-off interval
+	double nextPollMs;
+	double slope; // [V/ms]
+	double timeConstantMs; // 0 if unknown
+	double driftV; // change of the voltage during the hold time, according to the samples inside the band
+};
@@ -0,0 +1,72 @@
+#pragma once
+/**
+ * @file WiringPiTransport.h
+ *
+ * @class WiringPiTransport
+ * @author Nils Bosbach
+ * @date 17.10.2026
+ * @see Transport
+ * @brief accesses the gpio pins, the i2c bus and the serial port of the raspberry pi using the wiringPi library. writePins() writes
+ * the GPSET0 / GPCLR0 registers directly (/dev/gpiomem, no root needed), so all pins of a mask change with one write. If
+ * /dev/gpiomem cannot be mapped, the pins are written with digitalWrite.
+ */
+#include "Transport.h"
+
+#include <map>
+#include <mutex>
+#include <cstdint>
+
+/// gpio registers of the BCM2835 which are mapped
+#define WIRINGPI_GPIO_MAP_SIZE 4096
+/// word offset of the GPSET0 register
+#define WIRINGPI_GPIO_GPSET0 7
+/// word offset of the GPCLR0 register
+#define WIRINGPI_GPIO_GPCLR0 10
+
+class WiringPiTransport: public Transport{
+public:
+	typedef std::shared_ptr<WiringPiTransport> WiringPiTransport_ptr;
+	
+	/**
+	 * @brief creates the transport, setup() calls wiringPiSetup()
+	 * @return smart pointer to the created object
+	 */
+	static WiringPiTransport_ptr create();
+	
+	/**
+	 * @brief unmaps the gpio registers
+	 */
+	virtual ~WiringPiTransport();
+	
+	/**
+	 * @brief calls wiringPiSetup() and maps the gpio registers (/dev/gpiomem)
+	 */
+	virtual void setup() override;
+	virtual void setOutput(int pin) override;
+	virtual void digitalWrite(int pin, bool value) override;
+	virtual bool digitalRead(int pin) override;
+	virtual void writePins(std::uint32_t set, std::uint32_t clear) override;
+	virtual void delayMicroseconds(unsigned int us) override;
+	virtual int i2cSetup(int address) override;
+	virtual int i2cWrite(int fd, int data) override;
+	virtual int i2cRead(int fd) override;
+	virtual int i2cWriteReg8(int fd, int reg, int data) override;
+	virtual int i2cReadBlock(int fd, int reg, unsigned char* data, int count) override;
+	virtual int i2cWriteBlock(int fd, int reg, const unsigned char* data, int count) override;
+	virtual int serialOpen(const std::string &device, int baud) override;
+	virtual void serialPuts(int fd, const std::string &s) override;
+	virtual void serialClose(int fd) override;
+
+private:
+	WiringPiTransport();
+	
+	/**
+	 * @brief execute messages as one combined transaction (ioctl I2C_RDWR, repeated start between the messages)
+	 * @return 0 on success, -1 on error
+	 */
+	int transfer(int fd, struct i2c_msg* messages, int count);
+	
+	std::mutex addressesMtx;
+	std::map<int, int> addresses; // slave address of each fd opened by i2cSetup
+	volatile std::uint32_t *gpioRegisters; // nullptr if /dev/gpiomem has not been mapped
+};
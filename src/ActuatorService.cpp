@@ -0,0 +1,193 @@
+#include "ActuatorService.h"
+#include "Trace.h"
+
+#include <vector>
+
+std::weak_ptr<ActuatorService> ActuatorService::service;
+std::mutex ActuatorService::serviceMtx;
+
+ActuatorService::ActuatorService_ptr ActuatorService::create(){
+	serviceMtx.lock();
+	ActuatorService_ptr s = service.lock();
+	if (s == nullptr){ // no running service
+		s = ActuatorService_ptr(new ActuatorService());
+		service = s;
+	}
+	serviceMtx.unlock();
+	return s;
+}
+ActuatorService::ActuatorService(){
+	conn = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
+	for (int i = 0; i < REG_COUNT; i++){
+		registers[i] = 0;
+		dirty[i] = false;
+		known[i] = false;
+	}
+	requested = 0;
+	written = 0;
+	lastWriteOk = true;
+	readRequested = false;
+	readGeneration = 0;
+	lastReadOk = true;
+	lastAccess = Clock::now() - std::chrono::milliseconds(ACTUATOR_MIN_WRITE_INTERVAL_MS); // the first access does not wait
+	stats = Statistics();
+	
+	running = true;
+	actuator_thread = std::thread(&ActuatorService::actuatorThread, this);
+}
+ActuatorService::~ActuatorService(){
+	mtx.lock();
+	running = false;
+	mtx.unlock();
+	changed.notify_all();
+	
+	if (actuator_thread.joinable()){
+		actuator_thread.join();
+	}
+}
+
+bool ActuatorService::writeRelais(int low, int high){
+	std::unique_lock<std::mutex> lock(mtx);
+	if (known[REG_RELAISL] && known[REG_RELAISH] && !dirty[REG_RELAISL] && !dirty[REG_RELAISH] && registers[REG_RELAISL] == (low & 0xFF) && registers[REG_RELAISH] == (high & 0xFF)){
+		return true; // the relais already have the values
+	}
+	
+	change(REG_RELAISL, low, high);
+	unsigned long generation = requested;
+	changed.notify_one();
+	done.wait(lock, [this, generation]{return written >= generation;});
+	return lastWriteOk;
+}
+
+void ActuatorService::writeLeds(int low, int high){
+	mtx.lock();
+	change(REG_LEDL, low, high);
+	mtx.unlock();
+	changed.notify_one();
+}
+
+void ActuatorService::change(int reg, int low, int high){
+	registers[reg] = low & 0xFF;
+	registers[reg + 1] = high & 0xFF;
+	dirty[reg] = true;
+	dirty[reg + 1] = true;
+	requested++;
+	stats.changes++;
+}
+
+bool ActuatorService::readRelais(int &low, int &high, bool fromDevice){
+	return read(REG_RELAISL, low, high, fromDevice);
+}
+
+bool ActuatorService::readLeds(int &low, int &high, bool fromDevice){
+	return read(REG_LEDL, low, high, fromDevice);
+}
+
+bool ActuatorService::read(int reg, int &low, int &high, bool fromDevice){
+	std::unique_lock<std::mutex> lock(mtx);
+	bool retval = true;
+	
+	// a value which is being written is the value of the register as well
+	if (fromDevice || !(known[reg] || dirty[reg]) || !(known[reg + 1] || dirty[reg + 1])){
+		unsigned long generation = readGeneration;
+		readRequested = true;
+		changed.notify_one();
+		done.wait(lock, [this, generation]{return readGeneration != generation;});
+		retval = lastReadOk;
+	}
+	
+	low = registers[reg];
+	high = registers[reg + 1];
+	return retval;
+}
+
+void ActuatorService::waitUntilWritten(){
+	std::unique_lock<std::mutex> lock(mtx);
+	done.wait(lock, [this]{return written == requested;});
+}
+
+ActuatorService::Statistics ActuatorService::getStatistics(){
+	mtx.lock();
+	Statistics s = stats;
+	mtx.unlock();
+	return s;
+}
+
+void ActuatorService::actuatorThread(){
+	Trace::setThreadName("actuators");
+	
+	std::unique_lock<std::mutex> lock(mtx);
+	while (true){
+		changed.wait(lock, [this]{return requested != written || readRequested || !running;});
+		if (requested == written && !readRequested){ // stopped, all changes have been written
+			break;
+		}
+		
+		// sleep until the atmega32 can be accessed again, changes which are made in the meantime are written in the same transaction
+		Clock::time_point deadline = lastAccess + std::chrono::milliseconds(ACTUATOR_MIN_WRITE_INTERVAL_MS);
+		while (Clock::now() < deadline){
+			changed.wait_until(lock, deadline);
+		}
+		
+		int first = -1;
+		std::vector<int> values;
+		for (int i = 0; i < REG_COUNT; i++){
+			if (dirty[i]){
+				if (first < 0){
+					first = i;
+				}
+				values.resize(i - first + 1);
+			}
+		}
+		for (std::size_t i = 0; i < values.size(); i++){
+			values[i] = registers[first + i];
+			dirty[first + i] = false;
+		}
+		unsigned long generation = requested;
+		bool read = readRequested;
+		readRequested = false;
+		lock.unlock();
+		
+		bool writeOk = true;
+		std::vector<int> readValues;
+		if (!values.empty()){
+			Trace::Span span("relais", "write actuators", "registers", values.size());
+			writeOk = (conn->writeRegisters(I2C_ATMEGA32_BUFFER_LEDL + first, values, true) == 0);
+		}
+		if (read){
+			Trace::Span span("relais", "read actuators");
+			readValues = conn->readRegisters(I2C_ATMEGA32_BUFFER_LEDL, REG_COUNT);
+		}
+		
+		lock.lock();
+		lastAccess = Clock::now();
+		if (!values.empty()){
+			stats.transactions++;
+			for (std::size_t i = 0; i < values.size(); i++){
+				known[first + i] = (writeOk && !dirty[first + i]); // not changed again in the meantime
+			}
+			if (!writeOk){
+				stats.errors++;
+			}
+		}
+		written = generation;
+		lastWriteOk = writeOk;
+		
+		if (read){
+			stats.reads++;
+			lastReadOk = !readValues.empty();
+			if (lastReadOk){
+				for (int i = 0; i < REG_COUNT; i++){
+					if (!dirty[i]){ // changes which have not been written are kept
+						registers[i] = readValues[i];
+						known[i] = true;
+					}
+				}
+			}else{
+				stats.errors++;
+			}
+			readGeneration++;
+		}
+		done.notify_all();
+	}
+}
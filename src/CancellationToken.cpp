@@ -0,0 +1,30 @@
+#include "CancellationToken.h"
+
+CancellationToken::CancellationToken_ptr CancellationToken::create(){
+	return CancellationToken_ptr(new CancellationToken());
+}
+CancellationToken::CancellationToken(): cancelled(false){
+	
+}
+
+void CancellationToken::cancel(){
+	mtx.lock();
+	cancelled = true;
+	mtx.unlock();
+	cancelledCondition.notify_all();
+}
+
+void CancellationToken::reset(){
+	mtx.lock();
+	cancelled = false;
+	mtx.unlock();
+}
+
+bool CancellationToken::isCancelled() const{
+	return cancelled;
+}
+
+bool CancellationToken::sleepUntil(Clock::time_point deadline){
+	std::unique_lock<std::mutex> lock(mtx);
+	return !cancelledCondition.wait_until(lock, deadline, [this]{return cancelled.load();});
+}
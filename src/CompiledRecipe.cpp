@@ -0,0 +1,124 @@
+#include "CompiledRecipe.h"
+#include "Recipe.h"
+#include "ImpAnalyserTask.h"
+#include "TransImpTask.h"
+#include "Addresses.h"
+#include "Trace.h"
+
+#include <stdexcept>
+#include <unistd.h>
+
+CompiledRecipe::CompiledRecipe_ptr CompiledRecipe::compile(const std::vector<Task::Task_ptr> &tasks){
+	return CompiledRecipe_ptr(new CompiledRecipe(tasks));
+}
+CompiledRecipe::CompiledRecipe(const std::vector<Task::Task_ptr> &tasks){
+	flatten(tasks);
+	report.tasks = steps.size();
+	
+	DeviceState state; // nothing is known at the beginning
+	for (std::size_t i = 0; i < steps.size(); i++){
+		ExecutionHints &hints = steps[i].hints;
+		hints.keepImpRelaisOn = measuresImpedance(steps[i].task) && i + 1 < steps.size() && measuresImpedance(steps[i + 1].task);
+		steps[i].task->compile(state, hints, report);
+	}
+}
+
+void CompiledRecipe::flatten(const std::vector<Task::Task_ptr> &tasks){
+	for (std::vector<Task::Task_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+		Recipe::Recipe_ptr r = std::dynamic_pointer_cast<Recipe>(*cit);
+		if (r != nullptr && !r->isConcurrent()){ // concurrent recipes are executed by their TaskGraph
+			report.recipes++;
+			flatten(r->getTasks());
+		}else{
+			Step s;
+			s.task = *cit;
+			steps.push_back(s);
+		}
+	}
+}
+
+std::vector<PadTask::PadTask_ptr> CompiledRecipe::getPadSequence(std::size_t i) const{
+	std::vector<PadTask::PadTask_ptr> padTasks;
+	PadTask::PadTask_ptr p;
+	for (std::size_t j = i; j < steps.size() && (p = std::dynamic_pointer_cast<PadTask>(steps[j].task)) != nullptr; j++){
+		padTasks.push_back(p);
+	}
+	return padTasks;
+}
+
+bool CompiledRecipe::measuresImpedance(const Task::Task_ptr &task){
+	return std::dynamic_pointer_cast<ImpAnalyserTask>(task) != nullptr || std::dynamic_pointer_cast<TransImpTask>(task) != nullptr;
+}
+
+void CompiledRecipe::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
+	bool impRelaisOn = false; // relais have been kept in imp measurement mode for the next task
+	
+	try{
+		for (std::size_t i = 0; i < steps.size() && !token->isCancelled(); i++){
+			// consecutive PadTasks are played as one timeline
+			std::vector<PadTask::PadTask_ptr> padTasks = getPadSequence(i);
+			if (padTasks.size() > 1){
+				PadTask::executeSequence(padTasks, token);
+				i += padTasks.size() - 1;
+				continue;
+			}
+			
+			impRelaisOn = impRelaisOn || steps[i].hints.keepImpRelaisOn;
+			steps[i].task->setExecutionHints(steps[i].hints);
+			try{
+				Trace::Span span("task", steps[i].task->getName());
+				steps[i].task->execute(data, token);
+			}catch (...){
+				steps[i].task->setExecutionHints(ExecutionHints());
+				throw;
+			}
+			steps[i].task->setExecutionHints(ExecutionHints()); // the task may be executed without the recipe as well
+			impRelaisOn = steps[i].hints.keepImpRelaisOn;
+		}
+	}catch (...){
+		if (impRelaisOn){
+			try{
+				restoreEwodMode();
+			}catch (std::runtime_error &e){ // keep the original exception
+				
+			}
+		}
+		throw;
+	}
+	
+	if (impRelaisOn){ // stopped before the next impedance measurement
+		restoreEwodMode();
+	}
+}
+
+void CompiledRecipe::simulate(Simulator &sim){
+	for (std::size_t i = 0; i < steps.size(); i++){
+		std::vector<PadTask::PadTask_ptr> padTasks = getPadSequence(i);
+		if (padTasks.size() > 1){
+			PadTask::simulateSequence(padTasks, sim);
+			i += padTasks.size() - 1;
+		}else{
+			sim.run(steps[i].task, steps[i].hints);
+		}
+	}
+}
+
+void CompiledRecipe::restoreEwodMode(){
+	Task::relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true);
+	Task::relais->writeRelais();
+	usleep(IMP_RELAIS_SETTLE_MS * 1000);
+	Task::relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, false);
+	Task::relais->writeRelais();
+}
+
+std::size_t CompiledRecipe::getTaskCount() const{
+	return steps.size();
+}
+
+const ExecutionHints& CompiledRecipe::getHints(std::size_t i) const{
+	return steps.at(i).hints;
+}
+
+const CompileReport& CompiledRecipe::getReport() const{
+	return report;
+}
@@ -1,8 +1,8 @@
 #include "DelayTask.h"
 #include "FSHelper.h"
+#include "Simulator.h"
 
 #include <iostream>
-#include <unistd.h>
 #include <chrono>
 
 DelayTask::DelayTask(unsigned int delayTimeS, unsigned int delayTimeMs): Task(), delay_time_s(delayTimeS), delay_time_ms(delayTimeMs){
@@ -20,23 +20,11 @@ DelayTask::~DelayTask(){
 	
 }
 
-void DelayTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
-//	if (*executeNext){
-//		addLogEvent(Log_Event::create("delaying", "delaying for " + std::to_string(delay_time_us) + "us", Log_Event::TYPE::LOG_INFO));
-//		usleep(delay_time_us);
-//	}
-	const std::chrono::system_clock::time_point start_time = std::chrono::system_clock::now();
-	double elapsed_secs = 0;
-	
+void DelayTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	addLogEvent(Log_Event::create("delaying", "delaying for " + formatTime(), Log_Event::TYPE::LOG_INFO));
 	
-	while (elapsed_secs < delay_time_s && (*executeNext)){
-		const std::chrono::system_clock::time_point current_time = std::chrono::system_clock::now();
-		const std::chrono::duration<double> elapsed_secs_duration = current_time - start_time;
-		elapsed_secs = elapsed_secs_duration.count();
-		usleep(100);
-	}
-	usleep(delay_time_ms * 1000);
+	// sleeps on the token -> no cpu load during the delay, returns immediately if the experiment is stopped
+	token->sleepFor(std::chrono::seconds(delay_time_s) + std::chrono::milliseconds(delay_time_ms));
 }
 
 std::string DelayTask::getType() const{
@@ -79,4 +67,11 @@ std::string DelayTask::formatTime() const{
 	}
 	
 	return time;
+}
+
+void DelayTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	
+}
+void DelayTask::simulate(Simulator &sim){
+	sim.wait(delay_time_s * 1000.0 + delay_time_ms);
 }
\ No newline at end of file
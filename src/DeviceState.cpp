@@ -0,0 +1,77 @@
+#include "DeviceState.h"
+
+DeviceState::DeviceState(){
+	reset();
+}
+
+void DeviceState::reset(){
+	relaisSynced = false;
+	relaisKnown = 0;
+	relaisValues = 0;
+	voltageKnown = false;
+	voltage = 0;
+	voltageMode = 0;
+	frequencyKnown = false;
+	frequency = 0;
+}
+
+void DeviceState::setRelaisSynced(){
+	relaisSynced = true;
+}
+
+bool DeviceState::isRelaisSynced() const{
+	return relaisSynced;
+}
+
+void DeviceState::setRelais(Relais::RELAIS r, bool value){
+	relaisSynced = true; // relais have been written
+	relaisKnown |= 1u << r;
+	if (value){
+		relaisValues |= 1u << r;
+	}else{
+		relaisValues &= ~(1u << r);
+	}
+}
+
+void DeviceState::forgetRelais(Relais::RELAIS r){
+	relaisKnown &= ~(1u << r);
+}
+
+bool DeviceState::isRelais(Relais::RELAIS r, bool value) const{
+	return (relaisKnown & (1u << r)) && (((relaisValues >> r) & 1u) == (value ? 1u : 0u));
+}
+
+void DeviceState::setVoltage(unsigned int v, int mode){
+	voltageKnown = true;
+	voltage = v;
+	voltageMode = mode;
+}
+
+void DeviceState::forgetVoltage(){
+	voltageKnown = false;
+}
+
+bool DeviceState::isVoltage(unsigned int v, int mode) const{
+	return voltageKnown && voltage == v && voltageMode == mode;
+}
+
+void DeviceState::setFrequency(unsigned int freq){
+	frequencyKnown = true;
+	frequency = freq;
+}
+
+bool DeviceState::isFrequency(unsigned int freq) const{
+	return frequencyKnown && frequency == freq;
+}
+
+ExecutionHints::ExecutionHints(): relaisSynced(false), impRelaisOn(false), keepImpRelaisOn(false), sourceSet(false), wireModeSet(false), setpointActive(false){
+	
+}
+
+CompileReport::CompileReport(): tasks(0), recipes(0), relaisWrites(0), relaisReads(0), settleDelays(0), setpoints(0), savedMs(0){
+	
+}
+
+std::string CompileReport::to_string() const{
+	return std::to_string(tasks) + " tasks (" + std::to_string(recipes) + " nested recipes flattened), skipped " + std::to_string(relaisWrites) + " relais writes, " + std::to_string(relaisReads) + " relais reads, " + std::to_string(settleDelays) + " settle delays, " + std::to_string(setpoints) + " setpoints -> saves ~" + std::to_string(savedMs) + "ms per run";
+}
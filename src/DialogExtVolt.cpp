@@ -17,9 +17,9 @@ DialogExtVolt::DialogExtVolt(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Bu
 	CONNECT_SIGNAL_CLICKED(button_close, onButtonClose_clicked);
 	
 	timer.connect(sigc::mem_fun(*this, &DialogExtVolt::timerFunction));
-	timer.setInterval(200);
+	timer.setInterval(DIALOG_EXT_VOLT_INTERVAL_MS);
 	
-	atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
+	telemetry = Telemetry::create();
 	
 	dispatcher.connect(sigc::mem_fun(*this, &DialogExtVolt::onDispatcherEmit_mainContext));
 	running = false;
@@ -28,11 +28,8 @@ DialogExtVolt::DialogExtVolt(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Bu
 
 void DialogExtVolt::timerFunction(){
 	std::cout << "timer function" << std::endl;
-	if (atmega32->isConnected()){
-		int ADCL = atmega32->readRegister(I2C_ATMEGA32_BUFFER_ADCL);
-		int ADCH = atmega32->readRegister(I2C_ATMEGA32_BUFFER_ADCH);
-		int ADC = ADCH * 256 + ADCL;
-		double ext_voltage = (((double) VOLTAGE_ATMEGA32_R1) + ((double) VOLTAGE_ATMEGA32_R2)) / ((double) VOLTAGE_ATMEGA32_R2) * ((double) ADC) / 1023.0 * 5.0;
+	double ext_voltage;
+	if (telemetry->getValue(Telemetry::CHANNEL::CHANNEL_EXT_VOLTAGE, ext_voltage)){
 		double e_rel = (ext_voltage - (setpointVoltage)) / (setpointVoltage); // error
 		e_rel = (e_rel > 0 ? e_rel : e_rel * -1.0); //abs
 		
@@ -63,10 +60,12 @@ void DialogExtVolt::setSetpointVoltage(double setpoint){
 }
 void DialogExtVolt::startTimer(){
 	lastTimeWithRightVoltage = getCurrentTime();
+	telemetry->setRate(Telemetry::CHANNEL::CHANNEL_EXT_VOLTAGE, 1000.0 / DIALOG_EXT_VOLT_INTERVAL_MS);
 	timer.start();
 }
 void DialogExtVolt::closeDialog(int r){
 	timer.stop();
+	telemetry->setRate(Telemetry::CHANNEL::CHANNEL_EXT_VOLTAGE, TELEMETRY_RATE_EXT_VOLTAGE_HZ);
 	response(r);
 	signal_response();
 	hide();
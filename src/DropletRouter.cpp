@@ -0,0 +1,321 @@
+#include "DropletRouter.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <sstream>
+#include <queue>
+#include <deque>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cstdlib>
+
+DropletRouter::DropletRouter_ptr DropletRouter::create(unsigned int pads){
+	return DropletRouter_ptr(new DropletRouter(pads));
+}
+DropletRouter::DropletRouter(unsigned int pads){
+	DropletRouter::pads = pads;
+	separation = DROPLET_ROUTER_SEPARATION;
+	maxSteps = DROPLET_ROUTER_MAX_STEPS;
+	adjacent.resize(pads + 1);
+	distancesValid = false;
+}
+
+DropletRouter::DropletRouter_ptr DropletRouter::createGrid(unsigned int rows, unsigned int columns){
+	DropletRouter_ptr router = create(rows * columns);
+	for (unsigned int r = 0; r < rows; r++){
+		for (unsigned int c = 0; c < columns; c++){
+			int pad = r * columns + c + 1;
+			if (c + 1 < columns){
+				router->addAdjacency(pad, pad + 1);
+			}
+			if (r + 1 < rows){
+				router->addAdjacency(pad, pad + columns);
+			}
+		}
+	}
+	return router;
+}
+
+DropletRouter::DropletRouter_ptr DropletRouter::loadAdjacency(std::string path, unsigned int pads){
+	std::ifstream file(path);
+	if (!file.is_open()){
+		throw std::runtime_error("error opening file " + path);
+	}
+	
+	DropletRouter_ptr router = create(pads);
+	std::string line;
+	while (std::getline(file, line)){
+		if (line.empty() || line[0] == '#' || line.find_first_not_of(" \t\r") == std::string::npos){
+			continue;
+		}
+		std::stringstream ss(line);
+		std::string field;
+		std::getline(ss, field, ';');
+		int pad = std::atoi(field.c_str());
+		while (std::getline(ss, field, ';')){
+			if (field.find_first_not_of(" \t\r") != std::string::npos){
+				router->addAdjacency(pad, std::atoi(field.c_str()));
+			}
+		}
+	}
+	return router;
+}
+
+void DropletRouter::addAdjacency(int a, int b){
+	if (a < 1 || b < 1 || a > (int) pads || b > (int) pads || a == b){
+		throw std::runtime_error("invalid adjacency of pad " + std::to_string(a) + " and pad " + std::to_string(b));
+	}
+	if (!isAdjacent(a, b)){
+		adjacent[a].push_back(b);
+		adjacent[b].push_back(a);
+		distancesValid = false;
+	}
+}
+
+bool DropletRouter::isAdjacent(int a, int b) const{
+	if (a < 1 || a > (int) pads){
+		return false;
+	}
+	return std::find(adjacent[a].cbegin(), adjacent[a].cend(), b) != adjacent[a].cend();
+}
+
+int DropletRouter::getDistance(int a, int b) const{
+	if (a < 1 || b < 1 || a > (int) pads || b > (int) pads){
+		return -1;
+	}
+	if (!distancesValid){
+		updateDistances();
+	}
+	return distances[a * (pads + 1) + b];
+}
+
+void DropletRouter::updateDistances() const{
+	// breadth first search from each pad, all moves take one step
+	const int n = pads + 1;
+	distances.assign(n * n, -1);
+	std::deque<int> queue;
+	for (int from = 1; from < n; from++){
+		int *d = &distances[from * n];
+		d[from] = 0;
+		queue.push_back(from);
+		while (!queue.empty()){
+			int pad = queue.front();
+			queue.pop_front();
+			for (std::vector<int>::const_iterator cit = adjacent[pad].cbegin(); cit != adjacent[pad].cend(); cit++){
+				if (d[*cit] < 0){
+					d[*cit] = d[pad] + 1;
+					queue.push_back(*cit);
+				}
+			}
+		}
+	}
+	distancesValid = true;
+}
+
+void DropletRouter::setSeparation(unsigned int separation){
+	DropletRouter::separation = std::max(1u, separation);
+}
+unsigned int DropletRouter::getSeparation() const{
+	return separation;
+}
+void DropletRouter::setMaxSteps(unsigned int steps){
+	maxSteps = steps;
+}
+unsigned int DropletRouter::getMaxSteps() const{
+	return maxSteps;
+}
+unsigned int DropletRouter::getPadCount() const{
+	return pads;
+}
+
+std::vector<DropletRouter::Route> DropletRouter::plan(const std::vector<Droplet> &droplets){
+	Trace::Span span("router", "plan droplet routes", "droplets", droplets.size());
+	const std::size_t n = droplets.size();
+	
+	for (std::size_t i = 0; i < n; i++){
+		if (getDistance(droplets[i].start, droplets[i].goal) < 0){
+			throw std::runtime_error("droplet " + std::to_string(i + 1) + ": pad " + std::to_string(droplets[i].goal) + " cannot be reached from pad " + std::to_string(droplets[i].start));
+		}
+		for (std::size_t j = 0; j < i; j++){
+			if (!isSeparated(droplets[i].start, droplets[j].start)){
+				throw std::runtime_error("droplet " + std::to_string(j + 1) + " and " + std::to_string(i + 1) + ": start pads are too close");
+			}
+			if (!isSeparated(droplets[i].goal, droplets[j].goal)){
+				throw std::runtime_error("droplet " + std::to_string(j + 1) + " and " + std::to_string(i + 1) + ": goal pads are too close");
+			}
+		}
+	}
+	
+	std::vector<std::size_t> order(n); // priority of the droplets
+	std::iota(order.begin(), order.end(), 0);
+	for (std::size_t attempt = 0; attempt < std::max<std::size_t>(1, n); attempt++){
+		std::vector<Route> routes(n);
+		std::vector<Route> reserved;
+		std::size_t failed = n;
+		for (std::size_t k = 0; k < n; k++){
+			std::vector<int> waiting; // droplets which have not been planned yet
+			for (std::size_t w = k + 1; w < n; w++){
+				waiting.push_back(droplets[order[w]].start);
+			}
+			if (!findRoute(droplets[order[k]], reserved, waiting, routes[order[k]])){
+				failed = k;
+				break;
+			}
+			reserved.push_back(routes[order[k]]);
+		}
+		
+		if (failed == n){ // all droplets have been routed
+			std::size_t steps = 0;
+			for (std::vector<Route>::const_iterator cit = routes.cbegin(); cit != routes.cend(); cit++){
+				steps = std::max(steps, cit->size());
+			}
+			for (std::vector<Route>::iterator it = routes.begin(); it != routes.end(); it++){
+				it->resize(steps, it->back()); // the droplet stays on its goal
+			}
+			return routes;
+		}
+		std::rotate(order.begin(), order.begin() + failed, order.begin() + failed + 1); // plan the failed droplet first
+	}
+	throw std::runtime_error("no collision free routes found for " + std::to_string(n) + " droplets within " + std::to_string(maxSteps) + " steps");
+}
+
+bool DropletRouter::findRoute(const Droplet &droplet, const std::vector<Route> &reserved, const std::vector<int> &waiting, Route &route) const{
+	const int n = pads + 1;
+	
+	// the droplet can stay on its goal after the last reserved droplet has passed it
+	int reservedSteps = 0;
+	for (std::vector<Route>::const_iterator cit = reserved.cbegin(); cit != reserved.cend(); cit++){
+		reservedSteps = std::max(reservedSteps, (int) cit->size());
+	}
+	int arrival = 0;
+	for (int t = 1; t <= reservedSteps; t++){
+		if (!isFree(droplet.goal, droplet.goal, t, reserved, std::vector<int>())){
+			arrival = t + 1;
+		}
+	}
+	if (arrival > reservedSteps){ // a droplet stays too close to the goal
+		return false;
+	}
+	
+	struct Node{
+		int f;
+		int t;
+		int pad;
+		bool operator<(const Node &other) const{ // priority_queue: largest first
+			return (f != other.f ? f > other.f : t < other.t); // ties: the node which is closer to the goal
+		}
+	};
+	
+	std::vector<int> parent((maxSteps + 1) * n, -2); // state: t * n + pad, -2: not visited, -1: start
+	std::priority_queue<Node> open;
+	parent[droplet.start] = -1;
+	open.push(Node{std::max(getDistance(droplet.start, droplet.goal), arrival), 0, droplet.start});
+	
+	while (!open.empty()){
+		Node node = open.top();
+		open.pop();
+		
+		if (node.pad == droplet.goal && node.t >= arrival){
+			route.assign(node.t + 1, 0);
+			for (int state = node.t * n + node.pad; state >= 0; state = parent[state]){
+				route[state / n] = state % n;
+			}
+			return true;
+		}
+		if (node.t >= (int) maxSteps){
+			continue;
+		}
+		
+		const int t = node.t + 1;
+		const std::vector<int> &next = adjacent[node.pad];
+		for (int i = -1; i < (int) next.size(); i++){ // -1: the droplet stays
+			int pad = (i < 0 ? node.pad : next[i]);
+			int state = t * n + pad;
+			int h = getDistance(pad, droplet.goal);
+			if (parent[state] != -2 || h < 0 || t + h > (int) maxSteps || !isFree(pad, node.pad, t, reserved, waiting)){
+				continue;
+			}
+			parent[state] = node.t * n + node.pad; // each state is reached after t moves, so the first path is as short as any other
+			open.push(Node{t + std::max(h, arrival - t), t, pad});
+		}
+	}
+	return false;
+}
+
+bool DropletRouter::isFree(int pad, int from, int t, const std::vector<Route> &reserved, const std::vector<int> &waiting) const{
+	for (std::vector<Route>::const_iterator cit = reserved.cbegin(); cit != reserved.cend(); cit++){
+		int other = getPad(*cit, t);
+		if (!isSeparated(pad, other) || !isSeparated(from, other) || !isSeparated(pad, getPad(*cit, t - 1))){
+			return false;
+		}
+	}
+	if (t == 1){ // the waiting droplets are on their start pads before the first move
+		for (std::vector<int>::const_iterator cit = waiting.cbegin(); cit != waiting.cend(); cit++){
+			if (!isSeparated(pad, *cit)){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool DropletRouter::isSeparated(int a, int b) const{
+	int d = getDistance(a, b);
+	return (d < 0 || d >= (int) separation);
+}
+
+int DropletRouter::getPad(const Route &route, int t){
+	if (t <= 0){
+		return route.front();
+	}
+	return ((std::size_t) t < route.size() ? route[t] : route.back());
+}
+
+bool DropletRouter::verify(const std::vector<Droplet> &droplets, const std::vector<Route> &routes, std::string &error) const{
+	if (routes.size() != droplets.size()){
+		error = std::to_string(routes.size()) + " routes for " + std::to_string(droplets.size()) + " droplets";
+		return false;
+	}
+	for (std::size_t i = 0; i < routes.size(); i++){
+		const Route &route = routes[i];
+		if (route.empty() || route.front() != droplets[i].start || route.back() != droplets[i].goal){
+			error = "droplet " + std::to_string(i + 1) + ": the route does not lead from pad " + std::to_string(droplets[i].start) + " to pad " + std::to_string(droplets[i].goal);
+			return false;
+		}
+		for (std::size_t t = 1; t < route.size(); t++){
+			if (route[t] != route[t - 1] && !isAdjacent(route[t - 1], route[t])){
+				error = "droplet " + std::to_string(i + 1) + ", step " + std::to_string(t) + ": pad " + std::to_string(route[t - 1]) + " and pad " + std::to_string(route[t]) + " are not adjacent";
+				return false;
+			}
+		}
+		for (std::size_t j = 0; j < i; j++){
+			int steps = (int) std::max(route.size(), routes[j].size());
+			for (int t = 0; t < steps; t++){
+				int a = getPad(route, t), b = getPad(routes[j], t);
+				if (!isSeparated(a, b) || !isSeparated(a, getPad(routes[j], t - 1)) || !isSeparated(b, getPad(route, t - 1))){
+					error = "droplet " + std::to_string(j + 1) + " and " + std::to_string(i + 1) + ", step " + std::to_string(t) + ": pads are too close";
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+std::vector<std::vector<int>> DropletRouter::getSteps(const std::vector<Route> &routes){
+	std::size_t steps = 0;
+	for (std::vector<Route>::const_iterator cit = routes.cbegin(); cit != routes.cend(); cit++){
+		steps = std::max(steps, cit->size());
+	}
+	
+	std::vector<std::vector<int>> padSteps;
+	for (std::size_t t = 1; t < steps; t++){
+		std::vector<int> pads;
+		for (std::vector<Route>::const_iterator cit = routes.cbegin(); cit != routes.cend(); cit++){
+			pads.push_back(getPad(*cit, t));
+		}
+		padSteps.push_back(pads);
+	}
+	return padSteps;
+}
@@ -4,7 +4,7 @@
 #include <iostream>
 #include <algorithm>
 #include <math.h>
-#include <unistd.h>
+#include <chrono>
 #include <stdlib.h>
 
 DummyImpAnalyser::DummyImpAnalyser(): ImpAnalyser(){
@@ -23,17 +23,9 @@ DataP::DataP_ptr DummyImpAnalyser::measureFreq(double freq){
 	return std::make_shared<DataP>(freq, rand() % ((int) freq), rand() % ((int) freq / 7));
 }
 
-std::vector<DataP::DataP_ptr> DummyImpAnalyser::measureSpectrum(bool *running){
-	
-	std::vector<DataP::DataP_ptr> data;
-	double startFrequency_log = std::log10(startFrequency);
-	double stopFrequency_log = std::log10(stopFrequency);
-	double range_log = stopFrequency_log - startFrequency_log;
-	double step_log = (points > 1 ? range_log / (points-1): 0);
-	
-	
-	for (int i = 0; (i < points) && (*running); i++){
-		double freq = std::pow(10, startFrequency_log + i * step_log);
+void DummyImpAnalyser::streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token){
+	for (int i = 0; (i < points) && !token->isCancelled(); i++){
+		double freq = getPointFrequency(i);
 		
 		//measure 'pointAverage' times and calculate the average
 		DataP::DataP_ptr p = measureFreq(freq);
@@ -48,10 +40,9 @@ std::vector<DataP::DataP_ptr> DummyImpAnalyser::measureSpectrum(bool *running){
 		}
 		y_real /= pointAverage;
 		y_imag /= pointAverage;
-		data.push_back(DataP::create(x, y_real, y_imag));
+		onPoint(x, y_real, y_imag, i);
 	}
-	usleep(500 * 1000);
-	return data;
+	token->sleepFor(std::chrono::milliseconds(DUMMY_SWEEP_DELAY_MS));
 }
 
 tinyxml2::XMLElement* DummyImpAnalyser::toXMLElement(tinyxml2::XMLDocument *doc, bool externElements){
@@ -1,8 +1,9 @@
 #include "EmStatPico.h"
 #include "MeasurementValue.h"
 #include "MeasurementError.h"
+#include "Transport.h"
+#include "Trace.h"
 
-#include <wiringSerial.h>
 #include <stdexcept>
 #include <iostream>
 #include <unistd.h>
@@ -17,247 +18,219 @@ EmStatPico::EmStatPico(){
 }
 EmStatPico::~EmStatPico(){
 	
-}
-bool EmStatPico::waitForSerialData(int fd){
-	double timeoutCnt = 0.0;
-	while (!serialDataAvail(fd) && timeoutCnt < TIMEOUT_S){
-		usleep(20e3);
-		timeoutCnt += 20e-3;
-	}
-	return timeoutCnt < TIMEOUT_S;
 }
 void EmStatPico::startMeasurement(int fd, double f_min, double f_max, double current_min, double current_max){
-	serialPrintf(fd, "e\n"); // start of the method script
-	serialPrintf(fd, "var h\n");
-	serialPrintf(fd, "var r\n");
-	serialPrintf(fd, "var j\n");
-	serialPrintf(fd, "set_pgstat_chan 0\n"); //Select channel 0
-	serialPrintf(fd, "set_pgstat_mode 3\n"); //High speed mode is required for EIS
+	Transport::Transport_ptr serial = Transport::get();
+	serial->serialPuts(fd, "e\n"); // start of the method script
+	serial->serialPuts(fd, "var h\n");
+	serial->serialPuts(fd, "var r\n");
+	serial->serialPuts(fd, "var j\n");
+	serial->serialPuts(fd, "set_pgstat_chan 0\n"); //Select channel 0
+	serial->serialPuts(fd, "set_pgstat_mode 3\n"); //High speed mode is required for EIS
 //	serialPrintf(fd, "set_cr 1m\n"); //Set current range for currents of up to 1 mA
 	
 	std::string cmd_currentRange = "set_autoranging " + formatNumber(current_min) + " " + formatNumber(current_max) + " \n";
-	serialPrintf(fd, cmd_currentRange.c_str());
+	serial->serialPuts(fd, cmd_currentRange.c_str());
 	
-	serialPrintf(fd, "cell_on\n"); //Cell must be on to do measurements
+	serial->serialPuts(fd, "cell_on\n"); //Cell must be on to do measurements
 	
 	std::string cmd =  "meas_loop_eis h r j " + formatNumber(getVoltage()) + " " + formatNumber(f_min) + " " + formatNumber(f_max) + " " + formatNumber(getPoints()) + " 0\n";
 //	std::cout << cmd << std::endl;
 	
-	serialPrintf(fd, cmd.c_str()); //Run actual EIS measurement
-	serialPrintf(fd, "pck_start\n"); //Send measurement package containing frequency, Z-real and Z-imaginary
-	serialPrintf(fd, "pck_add h\n");
-	serialPrintf(fd, "pck_add r\n");
-	serialPrintf(fd, "pck_add j\n");
-	serialPrintf(fd, "pck_end\n");
-	serialPrintf(fd, "endloop\n");
-	serialPrintf(fd, "on_finished:\n"); //urn cell off when finished or aborted
-	serialPrintf(fd, "cell_off\n");
-	serialPrintf(fd, "\n"); // end of the method script
+	serial->serialPuts(fd, cmd.c_str()); //Run actual EIS measurement
+	serial->serialPuts(fd, "pck_start\n"); //Send measurement package containing frequency, Z-real and Z-imaginary
+	serial->serialPuts(fd, "pck_add h\n");
+	serial->serialPuts(fd, "pck_add r\n");
+	serial->serialPuts(fd, "pck_add j\n");
+	serial->serialPuts(fd, "pck_end\n");
+	serial->serialPuts(fd, "endloop\n");
+	serial->serialPuts(fd, "on_finished:\n"); //urn cell off when finished or aborted
+	serial->serialPuts(fd, "cell_off\n");
+	serial->serialPuts(fd, "\n"); // end of the method script
 }
-EmStatPico::MeasurementList_ptr EmStatPico::receiveMeasurements(int fd){
-	std::string line = "";
+bool EmStatPico::receiveMeasurements(SerialReader &reader, const PointListener &onPoint, CancellationToken::CancellationToken_ptr token){
+	char line[PICO_LINE_BUFFER];
+	std::size_t len = 0;
 	bool receiving = true;
-	MeasurementList_ptr packages = std::make_shared<MeasurementList>();
+	unsigned int index = 0;
+	PicoPackage package;
+	int waited_ms = 0;
 	
-	if (waitForSerialData(fd)){ // timeout not reached
-		while (receiving && serialDataAvail(fd)) {
-			char c = serialGetchar(fd);
-			if (c == '\n'){
-				if (line.empty()){ // end of return 
-					receiving = false;
-				}else{ // line is not empty
-					std::cout << "pico: " << line << std::endl;
-					switch(line.at(0)){
-						case 'P':{ // package
-							packages->push_back(MeasurementPackage::create(line));
-							break;
-						}
+	while (receiving){
+		if (token->isCancelled()){
+			return false;
+		}
+		if (!reader.readLine(line, PICO_LINE_BUFFER, len, PICO_CANCEL_CHECK_MS)){ // nothing received -> check the token again, throws if a line has been lost
+			waited_ms += PICO_CANCEL_CHECK_MS;
+			if (waited_ms >= TIMEOUT_S * 1000){ // timeout reached
+				throw std::runtime_error("timeout reached - no response from emstat pico");
+			}
+			continue;
+		}
+		waited_ms = 0;
 							
-						case '!':{ // error
-							MeasurementError::MeasurementError_ptr e = MeasurementError::create(line);
-							throw std::runtime_error(e->getDescr());
-							break;
-						}
-						
-						default :
-							std::cout << "received unhandled line: " << line << std::endl;
+		if (len == 0){ // end of return 
+			receiving = false;
+		}else{ // line is not empty
+			std::cout << "pico: ";
+			std::cout.write(line, len);
+			std::cout << std::endl;
+			switch(line[0]){
+				case 'P':{ // package
+					if (!package.parse(line, len)){ // the point is missing in the spectrum
+						throw std::runtime_error("unable to decode package " + std::to_string(index + 1) + " of emstat pico");
 					}
-					line = "";
+					handlePackage(package, onPoint, index);
+					break;
 				}
-			}else{
-				line += c;
-			}
-			if (receiving){
-				waitForSerialData(fd);
+						
+				case '!':{ // error
+					MeasurementError::MeasurementError_ptr e = MeasurementError::create(std::string(line, len));
+					throw std::runtime_error(e->getDescr());
+					break;
+				}
+				
+				default :
+					std::cout << "received unhandled line" << std::endl;
 			}
 		}
-	}else { // timeout reached
-		throw std::runtime_error("timeout reached - no response from emstat pico");
 	}
-	return packages;
+	return true;
 }
-std::vector<DataP::DataP_ptr> EmStatPico::measureSpectrum(bool* running){
+void EmStatPico::streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token){
+	Trace::Span span("serial", "EmStatPico sweep", "points", getPoints());
 	int fd;
+	Transport::Transport_ptr serial = Transport::get();
 	
-	if ((fd = serialOpen ("/dev/serial0", 230400)) < 0){
+	if ((fd = serial->serialOpen("/dev/serial0", 230400)) < 0){
 		throw std::runtime_error("Unable to open serial device: %s\n");
 	}
 	
+	SerialReader reader(fd);
+	reader.start();
 	startMeasurement(fd, getStartFrequency(), getStopFrequency());
-	MeasurementList_ptr measurements = receiveMeasurements(fd);
-	std::vector<DataP::DataP_ptr> spectrum;
-	
-	//for all measurement packages
-	for(MeasurementList::iterator it = measurements->begin(); it != measurements->end(); it++){
-		MeasurementPackage::MeasurementPackage_ptr package = *it;
-		MeasurementPackage::MeasurementList_ptr measuredValues = package->getMeasurements();
-		double x, y_real, y_imag;
-		bool x_found = false, y_real_found = false, y_imag_found = false;
-		bool data_valid = true;
-		int currentRange = -1;
-		MeasurementValue::META_STATUS status = MeasurementValue::META_STATUS::STATUS_NO_STATUS;
-		
-		// for all captured values of the measurement package
-		for (MeasurementPackage::MeasurementList::iterator it_measurement = measuredValues->begin(); it_measurement != measuredValues->end(); it_measurement++){
-			MeasurementValue::MeasurementValue_ptr value = *it_measurement;
-			if(value->getCurrentRange() != -1){
-				currentRange = value->getCurrentRange();
-			}
-			
-			if (value->getStatus() == MeasurementValue::META_STATUS::STATUS_OK || value->getStatus() == MeasurementValue::META_STATUS::STATUS_NO_STATUS || value->getStatus() == MeasurementValue::META_STATUS::STATUS_OVERLOAD_WARNING){
-				switch (value->getType()){
-				case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZREAL:
-					y_real_found = true;
-					y_real = value->getValue();
-					break;
-					
-				case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZIMAG:
-					y_imag_found = true;
-					y_imag = value->getValue();
-					break;
-					
-				case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_FREQUENCY:
-					x_found = true;
-					x = value->getValue();
-					break;
-				}
-			}else{ //Status not okay
-				status = value->getStatus();
-				data_valid = false;
-				std::cout << "received measurement with status " << MeasurementValue::statusToString(value->getStatus()) << std::endl;
-			}
+	try{
+		if (!receiveMeasurements(reader, onPoint, token)){ // stopped
+			serial->serialPuts(fd, "Z\n"); // abort the script, the cell is turned off in on_finished
 		}
-		//STATUS_OK, STATUS_OVERLOAD, STATUS_UNDERLOAD, STATUS_OVERLOAD_WARNING, STATUS_NO_STATUS
-		
-		// try to remeasure
-//		if (!data_valid){
-//			bool error = false;
-//			bool direction_upwards;
-//			
-//			switch (status){
-//				case MeasurementValue::META_STATUS::STATUS_OVERLOAD_WARNING:
-//				case MeasurementValue::META_STATUS::STATUS_OVERLOAD:
-//					direction_upwards = false;
-//					break;
-//					
-//				case MeasurementValue::META_STATUS::STATUS_UNDERLOAD:
-//					direction_upwards = true;
-//					break;
-//					
-//				default:
-//					error = true;
-//			}
-//			
+	}catch (std::runtime_error &e){
+		reader.stop();
+		serial->serialClose(fd);
+		throw;
+	}
+	reader.stop();
+	serial->serialClose(fd);
+}
+void EmStatPico::handlePackage(const PicoPackage &package, const PointListener &onPoint, unsigned int &index){
+	double x, y_real, y_imag;
+	bool x_found = false, y_real_found = false, y_imag_found = false;
+	bool data_valid = package.isValid();
+	
+	if (data_valid){
+		x_found = package.getValue(MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_FREQUENCY, x);
+		y_real_found = package.getValue(MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZREAL, y_real);
+		y_imag_found = package.getValue(MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZIMAG, y_imag);
+	}else{ //Status not okay
+		std::cout << "received measurement with status overload / underload" << std::endl;
+	}
+	//STATUS_OK, STATUS_OVERLOAD, STATUS_UNDERLOAD, STATUS_OVERLOAD_WARNING, STATUS_NO_STATUS
+	
+	// try to remeasure
+//	if (!data_valid){
+//		bool error = false;
+//		bool direction_upwards;
+//		
+//		switch (status){
+//			case MeasurementValue::META_STATUS::STATUS_OVERLOAD_WARNING:
+//			case MeasurementValue::META_STATUS::STATUS_OVERLOAD:
+//				direction_upwards = false;
+//				break;
+//				
+//			case MeasurementValue::META_STATUS::STATUS_UNDERLOAD:
+//				direction_upwards = true;
+//				break;
+//				
+//			default:
+//				error = true;
+//		}
+//		
+//		
+//		if (!error && x_found && currentRange != -1){ // no error, valid current ragne and freq information in last measurement (x_found == true)
+//			bool nextCrAvailable = true;
 //			
-//			if (!error && x_found && currentRange != -1){ // no error, valid current ragne and freq information in last measurement (x_found == true)
-//				bool nextCrAvailable = true;
+//			while (!data_valid && nextCrAvailable){
+//				int cr_nextMeasurement;
 //				
-//				while (!data_valid && nextCrAvailable){
-//					int cr_nextMeasurement;
-//					
-//					if (direction_upwards){
-//						cr_nextMeasurement = getNextCurrentRange(currentRange);
-//					}else{
-//						cr_nextMeasurement = getPrevCurrentRange(currentRange);
-//					}
+//				if (direction_upwards){
+//					cr_nextMeasurement = getNextCurrentRange(currentRange);
+//				}else{
+//					cr_nextMeasurement = getPrevCurrentRange(currentRange);
+//				}
+//				
+//				if ( cr_nextMeasurement != -1){
+//					std::string cr_nextMeasurement_str = formatNumber(cr_nextMeasurement);
+//					startMeasurement(fd, x, x, cr_nextMeasurement, cr_nextMeasurement);
+//					MeasurementList_ptr measurements = receiveMeasurements(fd);
 //					
-//					if ( cr_nextMeasurement != -1){
-//						std::string cr_nextMeasurement_str = formatNumber(cr_nextMeasurement);
-//						startMeasurement(fd, x, x, cr_nextMeasurement, cr_nextMeasurement);
-//						MeasurementList_ptr measurements = receiveMeasurements(fd);
+//					if (measurements->size() == 1){
+//						MeasurementPackage::MeasurementPackage_ptr package = *(measurements->begin());
+//						MeasurementPackage::MeasurementList_ptr measuredValues = package->getMeasurements();
+//						data_valid = true;
 //						
-//						if (measurements->size() == 1){
-//							MeasurementPackage::MeasurementPackage_ptr package = *(measurements->begin());
-//							MeasurementPackage::MeasurementList_ptr measuredValues = package->getMeasurements();
-//							data_valid = true;
-//							
-//							for (MeasurementPackage::MeasurementList::iterator it_measurement = measuredValues->begin(); it_measurement != measuredValues->end(); it_measurement++){
-//								MeasurementValue::MeasurementValue_ptr value = *it_measurement;
-//								if (value->getStatus() == MeasurementValue::META_STATUS::STATUS_OK || value->getStatus() == MeasurementValue::META_STATUS::STATUS_NO_STATUS ){
-//									switch (value->getType()){
-//									case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZREAL:
-//										y_real_found = true;
-//										y_real = value->getValue();
-//										break;
-//										
-//									case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZIMAG:
-//										y_imag_found = true;
-//										y_imag = value->getValue();
-//										break;
-//										
-//									case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_FREQUENCY:
-//										x_found = true;
-//										x = value->getValue();
-//										break;
-//									}
-//								}else{ //Status not okay
-//									status = value->getStatus();
-//									data_valid = false;
-//									std::cout << "received measurement with status " << MeasurementValue::statusToString(value->getStatus()) << std::endl;
-//									std::cout << "old cr: " << MeasurementValue::currentRangeToStr(currentRange) << "\t new cr: " << MeasurementValue::currentRangeToStr(value->getCurrentRange()) << std::endl; 
+//						for (MeasurementPackage::MeasurementList::iterator it_measurement = measuredValues->begin(); it_measurement != measuredValues->end(); it_measurement++){
+//							MeasurementValue::MeasurementValue_ptr value = *it_measurement;
+//							if (value->getStatus() == MeasurementValue::META_STATUS::STATUS_OK || value->getStatus() == MeasurementValue::META_STATUS::STATUS_NO_STATUS ){
+//								switch (value->getType()){
+//								case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZREAL:
+//									y_real_found = true;
+//									y_real = value->getValue();
+//									break;
+//									
+//								case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZIMAG:
+//									y_imag_found = true;
+//									y_imag = value->getValue();
+//									break;
+//									
+//								case MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_FREQUENCY:
+//									x_found = true;
+//									x = value->getValue();
+//									break;
 //								}
+//							}else{ //Status not okay
+//								status = value->getStatus();
+//								data_valid = false;
+//								std::cout << "received measurement with status " << MeasurementValue::statusToString(value->getStatus()) << std::endl;
+//								std::cout << "old cr: " << MeasurementValue::currentRangeToStr(currentRange) << "\t new cr: " << MeasurementValue::currentRangeToStr(value->getCurrentRange()) << std::endl; 
 //							}
-//							
-//						}else{ // received more than one measurement
-//							
 //						}
-//					}else {
-//						nextCrAvailable = false;
+//						
+//					}else{ // received more than one measurement
+//						
 //					}
+//				}else {
+//					nextCrAvailable = false;
 //				}
 //			}
 //		}
-		
-		if (data_valid){
-			if (x_found){ // got freq value
-				if (y_real_found){ // got no z_real value
-					if (y_imag_found){ // got no z_imag value
-						spectrum.push_back(DataP::create(x, y_real, y_imag));
-					}else{ // got no z_imag value
-						throw std::runtime_error("got no z_imag value");
-					}
-				}else{ // got no z_real value
-					throw std::runtime_error("got no z_real value");
+//	}
+	
+	if (data_valid){
+		if (x_found){ // got freq value
+			if (y_real_found){ // got no z_real value
+				if (y_imag_found){ // got no z_imag value
+					onPoint(x, y_real, y_imag, index++);
+				}else{ // got no z_imag value
+					throw std::runtime_error("got no z_imag value");
 				}
-			}else{ // got no freq value
-				throw std::runtime_error("got no freq value");
+			}else{ // got no z_real value
+				throw std::runtime_error("got no z_real value");
 			}
-		}else{
-			std::cout << "skipped invalid measurement" << std::endl;
+		}else{ // got no freq value
+			throw std::runtime_error("got no freq value");
 		}
-		
+	}else{
+		std::cout << "skipped invalid measurement" << std::endl;
 	}
-	
-	
-	
-	serialClose(fd);
-	
-//	for(std::list<MeasurementPackage::MeasurementPackage_ptr>::iterator it = packages.begin(); it != packages.end(); it++){
-//		MeasurementPackage::MeasurementPackage_ptr m = *it;
-//		std::cout << m->to_string() << std::endl;
-//	}
-	
-	return spectrum;
 }
 std::string EmStatPico::getType() const{
 	return "EmStat pico";
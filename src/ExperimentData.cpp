@@ -2,6 +2,8 @@
 #include "FSHelper.h"
 #include "Spectrometer.h"
 #include "ImpAnalyser.h"
+#include "MeasurementFileReader.h"
+#include "Trace.h"
 
 #include <string>
 #include <stdio.h>
@@ -9,6 +11,7 @@
 
 #define MEASUREMENTS_FOLDER_NAME "measurements"
 #define VIDEO_FOLDER_NAME "video"
+#define CSV_EXPORT_FOLDER_NAME "csv"
 
 sigc::slot<void, TransSpect::TransSpect_ptr, TransSpect::Spectrum, unsigned int, double, std::string> ExperimentData::slot_onTransImpSpecAdded;
 
@@ -19,54 +22,49 @@ ExperimentData::ExperimentData(std::string experimentName, std::string projectPa
 		FSHelper::createDirectory(projectPath);
 	}
 	FSHelper::createDirectory(experimentPath);
+	manifest = ExperimentManifest::open(experimentPath);
 	
 	recipeStartTime = getCurrentTime();
+	telemetryService = Telemetry::create();
+	telemetry = telemetryService->startRecording();
 }
 ExperimentData::~ExperimentData(){
 	
 }
 
 
-void ExperimentData::addSpectrum(std::vector<DataP::DataP_ptr> spectrum){
+void ExperimentData::addSpectrum(Spectrum spectrum){
 	spectrumsMtx.lock();
+	unsigned int position = spectrums.size();
 	spectrums.push_back(spectrum);
 	spectrumsMtx.unlock();
 	
-	std::string measurementsFolderPath = getMeasurementsFolderPath();
-	
-	Spectrometer::save_spectrumCSV(spectrum, FSHelper::getNextAvailablePath(FSHelper::composePath(measurementsFolderPath, std::string("opt_spectrum")), "csv", true), getElapsedSeconds());
+	getMeasurementWriter()->write(MeasurementFile::RECORD_TYPE::RECORD_SPECTRUM, 0, position, getElapsedSeconds(), spectrum);
 }
 
-void ExperimentData::addImpedanceSpectrum(std::vector<DataP::DataP_ptr> spectrum){
+void ExperimentData::addImpedanceSpectrum(Spectrum spectrum){
 	impSpectrumsMtx.lock();
+	unsigned int position = impedanceMeasurements.size();
 	impedanceMeasurements.push_back(spectrum);
 	impSpectrumsMtx.unlock();
 	
-	std::string measurementsFolderPath = getMeasurementsFolderPath();
-	
-	ImpAnalyser::save_spectrumCSV(spectrum, FSHelper::getNextAvailablePath(FSHelper::composePath(measurementsFolderPath, std::string("imp_spectrum")), "csv", true), 0, getElapsedSeconds());
+	getMeasurementWriter()->write(MeasurementFile::RECORD_TYPE::RECORD_IMPEDANCE, 0, position, getElapsedSeconds(), spectrum);
 }
 
 void ExperimentData::addTransImpedanceSpectrum(TransSpect::TransSpect_ptr spectrum){
-	std::string base_path; 
-	unsigned int appendix = 0;
-	std::string measurementsFolderPath = getMeasurementsFolderPath();
-	
-	do {
-		base_path = FSHelper::composePath(measurementsFolderPath, "trans_imp_spectrum_") + std::to_string(appendix++); 
-	}while (FSHelper::fileExists(base_path + "_0.csv"));
-	spectrum->setBasePath(base_path);
-	spectrum->setOn_Spec_added_listener(onTransImpSpecAdded);
+	MeasurementWriter::MeasurementWriter_ptr writer = getMeasurementWriter();
 	
 //	std::cout << "ExperimentData::addTransImpedanceSpectrum -- lock" << std::endl;
 	transImpSpectrumsMtx.lock();
 //	std::cout << "ExperimentData::addTransImpedanceSpectrum -- got lock" << std::endl;
+	spectrum->setMeasurementWriter(writer, transImpedanceMeasurements.size());
+	spectrum->setOn_Spec_added_listener(onTransImpSpecAdded);
 	transImpedanceMeasurements.push_back(spectrum);
 	transImpSpectrumsMtx.unlock();
 }
 
-std::vector<DataP::DataP_ptr> ExperimentData::getLastSpectreDataPoints(){
-	std::vector<DataP::DataP_ptr> lastSpectre;
+Spectrum ExperimentData::getLastSpectreDataPoints(){
+	Spectrum lastSpectre;
 	spectrumsMtx.lock();
 	if (spectrums.size() != 0){
 		lastSpectre = spectrums.back();
@@ -76,8 +74,8 @@ std::vector<DataP::DataP_ptr> ExperimentData::getLastSpectreDataPoints(){
 	return lastSpectre;
 }
 
-std::vector<DataP::DataP_ptr> ExperimentData::getLastImpedanceDataPoints(){
-	std::vector<DataP::DataP_ptr> lastSpectre;
+Spectrum ExperimentData::getLastImpedanceDataPoints(){
+	Spectrum lastSpectre;
 	impSpectrumsMtx.lock();
 	if (impedanceMeasurements.size() != 0){
 		lastSpectre = impedanceMeasurements.back();
@@ -103,17 +101,60 @@ std::string ExperimentData::getVideoPath() const{
 	return FSHelper::composePath(videoFolderPath, "video.mpeg");
 }
 
+std::string ExperimentData::addVideoFile(){
+	getVideoPath(); // create the folder
+	return manifest->add(FSHelper::composePath(VIDEO_FOLDER_NAME, "video.mpeg"), ExperimentManifest::ENTRY_TYPE::ENTRY_VIDEO);
+}
+
 void ExperimentData::saveLogfile(){
-	log->save_log_file(FSHelper::composePath(experimentPath, "logfile.log"));
+	measurementWriterMtx.lock();
+	MeasurementWriter::MeasurementWriter_ptr writer = measurementWriter;
+	measurementWriterMtx.unlock();
+	
+	if (writer != nullptr){ // log the counters of the writer
+		MeasurementWriter::Statistics s = writer->getStatistics();
+		std::string message = std::to_string(s.recordsWritten) + " spectrums written (" + std::to_string(s.bytesWritten) + " bytes), "
+			+ std::to_string(s.recordsDropped) + " dropped, " + std::to_string(s.writeErrors) + " errors, max. queue depth: " + std::to_string(s.maxQueueDepth)
+			+ ", write latency avg / max: " + FSHelper::formatDouble(s.avgWriteLatency_ms) + " / " + FSHelper::formatDouble(s.maxWriteLatency_ms) + " ms";
+		log->add_event(Log_Event::create("measurement writer", message, Log_Event::TYPE::LOG_INFO));
+	}
+	log->save_log_file(manifest->add("logfile.log", ExperimentManifest::ENTRY_TYPE::ENTRY_LOGFILE));
+}
+
+void ExperimentData::saveTrace(){
+	unsigned long dropped = Trace::getDropped();
+	if (dropped > 0){
+		log->add_event(Log_Event::create("trace", std::to_string(dropped) + " spans have been dropped (buffer full)", Log_Event::TYPE::LOG_INFO));
+	}
+	Trace::write(manifest->add("trace.json", ExperimentManifest::ENTRY_TYPE::ENTRY_TRACE));
+}
+
+void ExperimentData::saveTelemetry(){
+	if (telemetry == nullptr){ // has already been saved
+		return;
+	}
+	Telemetry::Telemetry_ptr service = telemetryService;
+	Telemetry::Recording_ptr recording = telemetry;
+	telemetryService = nullptr;
+	telemetry = nullptr;
+	service->writeCsv(manifest->add("telemetry.csv", ExperimentManifest::ENTRY_TYPE::ENTRY_TELEMETRY), recording);
 }
 
 std::string ExperimentData::getRecipePath() const{
 	return FSHelper::composePath(experimentPath, "recipe.xml");
 }
 
+std::string ExperimentData::addRecipeFile(){
+	return manifest->add("recipe.xml", ExperimentManifest::ENTRY_TYPE::ENTRY_RECIPE);
+}
+
 void ExperimentData::onTransImpSpecAdded(TransSpect::TransSpect_ptr t, TransSpect::Spectrum spectrum, unsigned int position, double timediff){
-	std::string path = FSHelper::getNextAvailablePath(t->getBasePath(), "csv", true);
-	ImpAnalyser::save_spectrumCSV(spectrum, path, position, timediff);
+	MeasurementWriter::MeasurementWriter_ptr writer = t->getMeasurementWriter();
+	std::string path;
+	if (writer != nullptr){
+		writer->write(MeasurementFile::RECORD_TYPE::RECORD_TRANS_IMPEDANCE, t->getSeriesNo(), position, timediff, spectrum);
+		path = writer->getPath();
+	}
 	
 	if (!slot_onTransImpSpecAdded.empty()) slot_onTransImpSpecAdded(t, spectrum, position, timediff, path);
 }
@@ -131,6 +172,62 @@ std::string ExperimentData::getMeasurementsFolderPath(){
 	return measurementsFolderPath;
 }
 
+MeasurementWriter::MeasurementWriter_ptr ExperimentData::getMeasurementWriter(){
+	measurementWriterMtx.lock();
+	if (measurementWriter == nullptr){
+		try{
+			getMeasurementsFolderPath(); // create the folder
+			std::string path = manifest->allocatePath(MEASUREMENTS_FOLDER_NAME, MEASUREMENT_FILE_NAME, MEASUREMENT_FILE_EXTENSION, ExperimentManifest::ENTRY_TYPE::ENTRY_MEASUREMENTS);
+			measurementWriter = MeasurementWriter::create(path);
+		}catch (...){
+			measurementWriterMtx.unlock();
+			throw;
+		}
+	}
+	MeasurementWriter::MeasurementWriter_ptr writer = measurementWriter;
+	measurementWriterMtx.unlock();
+	
+	return writer;
+}
+
+unsigned int ExperimentData::exportCSV(std::string measurementFilePath, std::string folderPath){
+	MeasurementFileReader::MeasurementFileReader_ptr reader = MeasurementFileReader::create(measurementFilePath);
+	if (folderPath.empty()){
+		std::string measurementsFolderPath = measurementFilePath.substr(0, measurementFilePath.find_last_of("/"));
+		std::string experimentPath = measurementsFolderPath.substr(0, measurementsFolderPath.find_last_of("/"));
+		if (ExperimentManifest::exists(experimentPath)){
+			ExperimentManifest::ExperimentManifest_ptr m = ExperimentManifest::open(experimentPath);
+			folderPath = m->allocatePath(measurementsFolderPath.substr(measurementsFolderPath.find_last_of("/") + 1), CSV_EXPORT_FOLDER_NAME, "", ExperimentManifest::ENTRY_TYPE::ENTRY_CSV_EXPORT);
+		}else{ // experiment without manifest
+			folderPath = FSHelper::composePath(measurementsFolderPath, CSV_EXPORT_FOLDER_NAME);
+		}
+	}
+	if (!FSHelper::folderExists(folderPath)){
+		FSHelper::createDirectory(folderPath);
+	}
+	
+	for (std::size_t i = 0; i < reader->getRecordCount(); i++){
+		const MeasurementFileReader::Record &r = reader->getRecord(i);
+		std::string path;
+		
+		switch (r.type){
+			case MeasurementFile::RECORD_TYPE::RECORD_SPECTRUM:
+				path = FSHelper::composePath(folderPath, "opt_spectrum_" + std::to_string(r.position) + ".csv");
+				Spectrometer::save_spectrumCSV(reader->getSpectrum(i), path, r.timestamp);
+				break;
+			case MeasurementFile::RECORD_TYPE::RECORD_IMPEDANCE:
+				path = FSHelper::composePath(folderPath, "imp_spectrum_" + std::to_string(r.position) + ".csv");
+				ImpAnalyser::save_spectrumCSV(reader->getSpectrum(i), path, 0, r.timestamp);
+				break;
+			case MeasurementFile::RECORD_TYPE::RECORD_TRANS_IMPEDANCE:
+				path = FSHelper::composePath(folderPath, "trans_imp_spectrum_" + std::to_string(r.series) + "_" + std::to_string(r.position) + ".csv");
+				ImpAnalyser::save_spectrumCSV(reader->getSpectrum(i), path, r.position, r.timestamp);
+				break;
+		}
+	}
+	return reader->getRecordCount();
+}
+
 ExperimentData::TimePoint ExperimentData::getCurrentTime(){
 	return std::chrono::system_clock::now();
 }
@@ -0,0 +1,191 @@
+#include "ExperimentManifest.h"
+#include "FSHelper.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+std::map<std::string, std::weak_ptr<ExperimentManifest>> ExperimentManifest::instances;
+std::mutex ExperimentManifest::instancesMtx;
+
+ExperimentManifest::ExperimentManifest_ptr ExperimentManifest::open(std::string experimentPath){
+	while (experimentPath.size() > 1 && experimentPath.back() == '/'){ // same key for "a/b" and "a/b/"
+		experimentPath.pop_back();
+	}
+	
+	instancesMtx.lock();
+	ExperimentManifest_ptr m = instances[experimentPath].lock();
+	if (m == nullptr){ // manifest is not open
+		try{
+			m = ExperimentManifest_ptr(new ExperimentManifest(experimentPath));
+			m->read();
+		}catch (...){
+			instancesMtx.unlock();
+			throw;
+		}
+		instances[experimentPath] = m;
+	}
+	instancesMtx.unlock();
+	return m;
+}
+ExperimentManifest::ExperimentManifest(std::string experimentPath): experimentPath(experimentPath){
+	
+}
+bool ExperimentManifest::exists(std::string experimentPath){
+	return FSHelper::fileExists(FSHelper::composePath(experimentPath, EXPERIMENT_MANIFEST_NAME));
+}
+
+std::string ExperimentManifest::typeToString(ENTRY_TYPE type){
+	switch (type){
+		case ENTRY_TYPE::ENTRY_MEASUREMENTS:
+			return "measurements";
+		case ENTRY_TYPE::ENTRY_CSV_EXPORT:
+			return "csv_export";
+		case ENTRY_TYPE::ENTRY_LOGFILE:
+			return "logfile";
+		case ENTRY_TYPE::ENTRY_RECIPE:
+			return "recipe";
+		case ENTRY_TYPE::ENTRY_VIDEO:
+			return "video";
+		case ENTRY_TYPE::ENTRY_TRACE:
+			return "trace";
+		case ENTRY_TYPE::ENTRY_TELEMETRY:
+			return "telemetry";
+		default:
+			return "unknown";
+	}
+}
+ExperimentManifest::ENTRY_TYPE ExperimentManifest::stringToType(const std::string &s){
+	for (int t = ENTRY_TYPE::ENTRY_MEASUREMENTS; t < ENTRY_TYPE::ENTRY_UNKNOWN; t++){
+		if (s.compare(typeToString(static_cast<ENTRY_TYPE>(t))) == 0){
+			return static_cast<ENTRY_TYPE>(t);
+		}
+	}
+	return ENTRY_TYPE::ENTRY_UNKNOWN;
+}
+
+/*
+ * line: <sequenceNo>;<type>;<timestamp>;<path>
+ */
+void ExperimentManifest::read(){
+	std::ifstream file(FSHelper::composePath(experimentPath, EXPERIMENT_MANIFEST_NAME));
+	if (!file.is_open()){
+		return;
+	}
+	
+	std::string line;
+	std::getline(file, line); // header
+	while (std::getline(file, line)){
+		std::size_t p1 = line.find(';');
+		std::size_t p2 = (p1 == std::string::npos) ? p1 : line.find(';', p1 + 1);
+		std::size_t p3 = (p2 == std::string::npos) ? p2 : line.find(';', p2 + 1);
+		if (p3 == std::string::npos){ // incomplete line (e.g. power loss while writing)
+			continue;
+		}
+		
+		Entry e;
+		try{
+			e.sequenceNo = std::stoul(line.substr(0, p1));
+		}catch (std::logic_error &){ // no number
+			continue;
+		}
+		e.type = stringToType(line.substr(p1 + 1, p2 - p1 - 1));
+		e.timestamp = line.substr(p2 + 1, p3 - p2 - 1);
+		e.path = line.substr(p3 + 1);
+		
+		entries.push_back(e);
+		paths.insert(e.path);
+		
+		// restore the counter of the prefix: <prefix>_<counter>[.<ending>]
+		std::string name = e.path;
+		std::size_t dot = name.find_last_of('.');
+		std::size_t slash = name.find_last_of('/');
+		if (dot != std::string::npos && (slash == std::string::npos || dot > slash)){ // remove ending
+			name = name.substr(0, dot);
+		}
+		std::size_t underscore = name.find_last_of('_');
+		if (underscore != std::string::npos && underscore + 1 < name.size() && underscore + 10 > name.size() && name.find_first_not_of("0123456789", underscore + 1) == std::string::npos){
+			unsigned int no = std::stoul(name.substr(underscore + 1));
+			std::string prefix = name.substr(0, underscore);
+			if (counters[prefix] <= no){
+				counters[prefix] = no + 1;
+			}
+		}
+	}
+}
+
+// mtx needs to be locked
+void ExperimentManifest::append(const Entry &e){
+	std::string manifestPath = FSHelper::composePath(experimentPath, EXPERIMENT_MANIFEST_NAME);
+	bool newFile = entries.empty() && !FSHelper::fileExists(manifestPath);
+	
+	std::ofstream file(manifestPath, std::ios::app);
+	if (!file.is_open()){
+		throw std::runtime_error("could not open manifest " + manifestPath);
+	}
+	if (newFile){
+		file << "sequence;type;timestamp;path" << std::endl;
+	}
+	file << e.sequenceNo << ";" << typeToString(e.type) << ";" << e.timestamp << ";" << e.path << std::endl;
+	
+	entries.push_back(e);
+	paths.insert(e.path);
+}
+
+std::string ExperimentManifest::allocatePath(std::string folder, std::string prefix, std::string ending, ENTRY_TYPE type){
+	std::string name = folder.empty() ? prefix : FSHelper::composePath(folder, prefix);
+	
+	mtx.lock();
+	unsigned int no = counters[name]++;
+	std::string path = name + "_" + std::to_string(no);
+	if (!ending.empty()){
+		path += "." + ending;
+	}
+	
+	Entry e;
+	e.sequenceNo = entries.size();
+	e.type = type;
+	e.timestamp = FSHelper::getCurrentTimestamp();
+	e.path = path;
+	try{
+		append(e);
+	}catch (...){
+		mtx.unlock();
+		throw;
+	}
+	mtx.unlock();
+	
+	return FSHelper::composePath(experimentPath, path);
+}
+
+std::string ExperimentManifest::add(std::string path, ENTRY_TYPE type){
+	mtx.lock();
+	if (paths.find(path) == paths.end()){
+		Entry e;
+		e.sequenceNo = entries.size();
+		e.type = type;
+		e.timestamp = FSHelper::getCurrentTimestamp();
+		e.path = path;
+		try{
+			append(e);
+		}catch (...){
+			mtx.unlock();
+			throw;
+		}
+	}
+	mtx.unlock();
+	
+	return FSHelper::composePath(experimentPath, path);
+}
+
+std::vector<ExperimentManifest::Entry> ExperimentManifest::getEntries(){
+	mtx.lock();
+	std::vector<Entry> e = entries;
+	mtx.unlock();
+	
+	return e;
+}
+
+std::string ExperimentManifest::getExperimentPath() const{
+	return experimentPath;
+}
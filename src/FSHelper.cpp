@@ -1,4 +1,5 @@
 #include "FSHelper.h"
+#include "Trace.h"
 
 #include <dirent.h>
 #include <fstream>
@@ -65,8 +66,9 @@ std::string FSHelper::formatDouble(double d){
 	std::string strObj = streamObj.str();
 	return strObj;
 }
-
-void FSHelper::save_dataPToCsv(const std::vector<DataP::DataP_ptr> &data, std::string path, bool y_real, bool y_imag, bool y_abs, bool y_phase, std::string x_label, std::string y_label, std::string header){
+
+void FSHelper::save_dataPToCsv(const Spectrum &data, std::string path, bool y_real, bool y_imag, bool y_abs, bool y_phase, std::string x_label, std::string y_label, std::string header){
+	Trace::Span span("file", "save csv", "points", data.size());
 	std::ofstream file;
 	file.open(path);
 	if (!header.empty()){
@@ -88,9 +90,8 @@ void FSHelper::save_dataPToCsv(const std::vector<DataP::DataP_ptr> &data, std::s
 	}
 	file << std::endl;
 	
-	for (std::vector<DataP::DataP_ptr>::const_iterator cit = data.begin(); cit != data.end(); cit++){
-		const DataP::DataP_ptr data_point = *cit;
-		file << data_point->toCsvLine(y_real, y_imag, y_abs, y_phase) << std::endl;
+	for (std::size_t i = 0; i < data.size(); i++){
+		file << data.toCsvLine(i, y_real, y_imag, y_abs, y_phase) << std::endl;
 	}
 	
 	file.close();
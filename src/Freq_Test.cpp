@@ -14,7 +14,7 @@ Freq_Test::Freq_Test_ptr Freq_Test::create(){
 	return std::make_shared<Freq_Test>();
 }
 
-void Freq_Test::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void Freq_Test::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	I2CFreqTask::I2CFreqTask_ptr freqgen = I2CFreqTask::create(2);
 	double f_min = 2;
 	double f_max = 100000;
@@ -32,10 +32,10 @@ void Freq_Test::execute(ExperimentData::ExperimentData_ptr data, bool* executeNe
 	std::ofstream file;
 	file.open("/home/pi/data.txt");
 	
-	for (int i = 0; (i < points) && (*executeNext); i++){ // for each frequency
+	for (int i = 0; (i < points) && !token->isCancelled(); i++){ // for each frequency
 		int freq = std::pow(10, startFrequency_log + i * step_log);
 		freqgen->setFrequency(freq);
-		freqgen->execute(0, executeNext);
+		freqgen->execute(0, token);
 		usleep(1000000);
 		
 		double measured = 0;
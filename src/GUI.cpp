@@ -16,8 +16,10 @@
 #include "Addresses.h"
 #include "EmStatPico.h"
 #include "DialogExtVolt.h"
+#include "SpectrumCsvReader.h"
+#include "Simulator.h"
+#include "Trace.h"
 
-#include <wiringPi.h>
 #include <bitset>
 #include <iostream> 
 #include <vector>
@@ -70,14 +72,18 @@ void GUI::init_loadRecipes(){
 			while((dp = readdir(dirp)) != NULL){
 				std::string path = FSHelper::composePath(*cit, dp->d_name); // full path of file in the folder
 				if (FSHelper::endsWith(path, ".csv") || FSHelper::endsWith(path, ".xml")){
-					recipes.push_back(Recipe::loadRecipe(path, &spectrometer));
+					Recipe::Recipe_ptr r = Recipe::loadRecipe(path, &spectrometer); // the tasks are loaded when they are needed
+					if (r != nullptr){
+						recipes.push_back(r);
+					}
 				}
 			}
 			closedir(dirp);
 		}else {
 			std::cout << "failed to open folder - " << cit->c_str() << std::endl;
 		}
-	}	
+	}
+	recTv1->setTasks(recipes);
 }
 void GUI::init_grabWidgetsFromBuilder(){
 	refBuilder = Gtk::Builder::create(); //Load the GtkBuilder file and instantiate its widgets:
@@ -124,6 +130,9 @@ void GUI::init_grabWidgetsFromBuilder(){
 		LOAD_WIDGET("button_page_addTask_page_SpectrometerTask_addTask", button_addSpectrometerTask);
 		LOAD_WIDGET("button_page_exData_page_overview_project", button_selectProject);
 		LOAD_WIDGET("button_page_exData_page_overview_spectrum", button_selectSpectrum);
+		LOAD_WIDGET("button_page_exData_page_overview_exportCSV", button_exportCSV);
+		LOAD_WIDGET("button_page_exData_page_overview_cancelLoad", button_cancelLoad);
+		LOAD_WIDGET("progressbar_page_exData_page_overview_load", progressbar_load);
 		LOAD_WIDGET("checkbutton_videoPreview", checkbutton_preview);
 		LOAD_WIDGET("checkButton_page_addTask_page_impTask_transientTask", checkbutton_impTask_transient);
 		LOAD_WIDGET("entry_gpib_slaveAddress", entry_gpib_slaveAddress);
@@ -278,6 +287,8 @@ void GUI::init_connectSignals(){
 	CONNECT_SIGNAL_CLICKED(button_selectProject, on_buttonSelectProject_clicked);
 	CONNECT_SIGNAL_CLICKED(button_selectExperiment, on_buttonSelectExperiment_clicked);
 	CONNECT_SIGNAL_CLICKED(button_selectSpectrum, on_buttonSelectSpectrum_clicked);
+	CONNECT_SIGNAL_CLICKED(button_exportCSV, on_buttonExportCSV_clicked);
+	CONNECT_SIGNAL_CLICKED(button_cancelLoad, on_buttonCancelLoad_clicked);
 	CONNECT_SIGNAL_CLICKED(dialogSave_button_cancel, dialogSave_on_buttonCancel_clicked);
 	CONNECT_SIGNAL_CLICKED(button_gpib_read, on_buttonGpibRead_clicked);
 	CONNECT_SIGNAL_CLICKED(button_gpib_send, on_buttonGpibSend_clicked);
@@ -303,6 +314,7 @@ void GUI::init_connectSignals(){
 	button_fullscreen->signal_toggled().connect(sigc::mem_fun(*this, &GUI::on_button_fullscreen_toggled));
 	
 	logEventDispatcher.connect(sigc::mem_fun(*this, &GUI::logEventDispatcherFunction));
+	transSpectLoaderDispatcher.connect(sigc::mem_fun(*this, &GUI::transSpectLoaderDispatcherFunction));
 	camera.connect_onFrameCapturedListener(sigc::mem_fun(*this, &GUI::on_preview_captured));
 	mainWindow->signal_delete_event().connect(sigc::mem_fun(*this, &GUI::on_window_close));
 	updateTimer.connect(sigc::mem_fun(*this, &GUI::updateThread));
@@ -314,6 +326,7 @@ void GUI::init_variables(){
 	thread_execute_MyRecipe_data = nullptr;
 	gpib = nullptr;
 	status_leds = StatusLed::create();
+	telemetry = Telemetry::create();
 	relais = Relais::create();
 	
 	Task::status_leds = status_leds;
@@ -391,6 +404,9 @@ void GUI::init_setRelais(){
 }
 
 GUI::~GUI(){
+	if (transSpectLoader != nullptr){
+		transSpectLoader->cancel();
+	}
 	delete mainWindow;
 	delete entryPads;
 	delete buttonPadsExecute;
@@ -423,9 +439,10 @@ void GUI::on_buttonRemoveFromMyRecipe_clicked(){
 
 void* GUI::executemyrecipe(void *d){
 	ExecuteMyRecipeThreadData* data = static_cast<ExecuteMyRecipeThreadData*>(d);
+	Trace::setThreadName("recipe");
 	try{
 		//execute all tasks
-		data->recipe->execute(data->pData, data->executeNext);
+		data->recipe->execute(data->pData, data->token);
 	}catch (std::runtime_error r){
 		data->error = new std::runtime_error(r);
 	}
@@ -472,6 +489,17 @@ void GUI::on_finished_executing_myRecipe(){
 				status_leds->write_reg_val();
 				
 				log->add_event(Log_Event::create("execution finished", "the custom recipe is finished", Log_Event::TYPE::LOG_INFO));
+				Trace::stop();
+				try{
+					thread_execute_MyRecipe_data->pData->saveTrace();
+				}catch (std::runtime_error &e){
+					log->add_event(Log_Event::create("error saving trace", e.what(), Log_Event::TYPE::LOG_ERROR));
+				}
+				try{
+					thread_execute_MyRecipe_data->pData->saveTelemetry();
+				}catch (std::runtime_error &e){
+					log->add_event(Log_Event::create("error saving telemetry", e.what(), Log_Event::TYPE::LOG_ERROR));
+				}
 				log->set_temp_Logbook(Logbook::create());
 				thread_execute_MyRecipe_data->pData->saveLogfile();
 				
@@ -578,6 +606,9 @@ void GUI::on_buttonRunRecipe_clicked(){
 //				std::cout << "needed: spectrometer" << std::endl;
 				break;
 			}
+			case Task::DEVICES::DEVICE_ELECTRODES: // always connected
+			case Task::DEVICES::DEVICE_GPIB:
+				break;
 		}
 	}
 	
@@ -588,7 +619,10 @@ void GUI::on_buttonRunRecipe_clicked(){
 		dialog.run();
 	}else{
 		
-		dialogSave_label_description->set_text("name of the project");
+		// predict the duration before the chip is committed to the recipe
+		SimulationResult prediction = Simulator::create()->simulate(r);
+		
+		dialogSave_label_description->set_text("name of the project (predicted duration: " + FSHelper::formatTime(prediction.totalS + 0.5) + ")");
 		dialogSave_entry_name->get_buffer()->set_text(pref.getCurrentProjectName());
 		dialogSave->set_transient_for(*mainWindow);
 		
@@ -609,11 +643,11 @@ void GUI::on_buttonRunRecipe_clicked(){
 			exDataPtr->connectOnTransImpSpecAddedListener(slot);
 			
 			thread_execute_MyRecipe_data->recipe = r;
-			*(thread_execute_MyRecipe_data->executeNext) = true;
+			thread_execute_MyRecipe_data->token->reset();
 			thread_execute_MyRecipe_data->dispatcher.connect(sigc::mem_fun(*this, &GUI::on_finished_executing_myRecipe));
 			thread_execute_MyRecipe_data->pData = exDataPtr;
 			log->set_temp_Logbook(thread_execute_MyRecipe_data->pData->log);
-			r->save(thread_execute_MyRecipe_data->pData->getRecipePath());
+			r->save(thread_execute_MyRecipe_data->pData->addRecipeFile());
 			
 			//disable / enable widgets
 			button_addToMyRecipe->set_sensitive(false);
@@ -627,13 +661,15 @@ void GUI::on_buttonRunRecipe_clicked(){
 			button_shutdown->set_sensitive(false);
 			
 			if (button_record->get_active()){
-				camera.startRecord(thread_execute_MyRecipe_data->pData->getVideoPath());
+				camera.startRecord(thread_execute_MyRecipe_data->pData->addVideoFile());
 			}
 			
 			status_leds->recipeRunning(true);
 			status_leds->write_reg_val();
 			
-			log->add_event(Log_Event::create("execution started", "user started custom recipe - project '" + pref.getCurrentProjectName() + "'", Log_Event::TYPE::LOG_INFO));
+			log->add_event(Log_Event::create("execution started", "user started custom recipe - project '" + pref.getCurrentProjectName() + "' - predicted duration: " + FSHelper::formatTime(prediction.totalS + 0.5), Log_Event::TYPE::LOG_INFO));
+			log->add_event(Log_Event::create("predicted timeline", prediction.to_string(), Log_Event::TYPE::LOG_INFO));
+			Trace::start();
 			pthread_create(&thread_execute_MyRecipe, NULL, executemyrecipe, thread_execute_MyRecipe_data);
 			
 			dialogSave_entry_name->get_buffer()->set_text("");
@@ -644,8 +680,8 @@ void GUI::on_buttonStopRecipe_clicked(){
 	if ( thread_execute_MyRecipe_data != nullptr ){
 		log->add_event(Log_Event::create("recipe canceled", "the execution of the recipe has been canceled by the user", Log_Event::TYPE::LOG_INFO));
 		
-		//stop the thread
-		*(thread_execute_MyRecipe_data->executeNext) = false;
+		//stop the thread - wakes up the waiting task
+		thread_execute_MyRecipe_data->token->cancel();
 		pthread_join(thread_execute_MyRecipe, NULL);
 	}
 }
@@ -694,15 +730,14 @@ void GUI::on_preview_captured(Camera_cv::Image_ptr image){
 void GUI::on_buttonExecutePadTask_clicked(){
 	std::string text = entryPads->get_text(); //get text from gui
 	Task::Task_ptr task = PadTask::getPadTaskFromString(text);
-	bool exNext = true;
-	task->execute(std::make_shared<ExperimentData>("",""), &exNext);
+	task->execute(std::make_shared<ExperimentData>("",""), CancellationToken::create());
 }
 
 void GUI::on_buttonSetFrequency_clicked(){
 	I2CFreqTask t(adjustment_frequency->get_value());
-	bool running = true;
+	CancellationToken::CancellationToken_ptr token = CancellationToken::create();
 	try{
-		t.execute(0, &running);
+		t.execute(0, token);
 	}catch (std::runtime_error r){
 		Gtk::MessageDialog dialog(*mainWindow, "error occured", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
 		dialog.set_secondary_text(r.what());
@@ -732,10 +767,10 @@ void GUI::on_buttonSetFrequency_clicked(){
 void GUI::on_buttonSetVoltage_clicked(){
 	I2CVoltageTask t(adjustment_voltage->get_value());
 	t.setWaitForVoltage(checkbutton_waitForVoltage->get_active());
-	bool running = true;
+	CancellationToken::CancellationToken_ptr token = CancellationToken::create();
 	
 	try{
-		t.execute(0, &running);
+		t.execute(0, token);
 	}catch (std::runtime_error r){
 		Gtk::MessageDialog dialog(*mainWindow, "error occured", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
 		dialog.set_secondary_text(r.what());
@@ -767,10 +802,10 @@ void GUI::on_buttonSetDutyCycle_clicked(){
 	t.setVoltageMode(I2CVoltageTask::VOLTAGE_MODE::MODE_DUTY_CYCLE);
 	t.setDutyCycle(dcycle);
 	std::cout << "dcycle: " << dcycle << std::endl;
-	bool running = true;
+	CancellationToken::CancellationToken_ptr token = CancellationToken::create();
 	
 	try{
-		t.execute(0, &running);
+		t.execute(0, token);
 	}catch (std::runtime_error r){
 		Gtk::MessageDialog dialog(*mainWindow, "error occured", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
 		dialog.set_secondary_text(r.what());
@@ -815,10 +850,10 @@ void GUI::on_buttonAddSpectrometerTask_clicked(){
 }
 void GUI::on_buttonActivatePad_clicked(){
 	PadTask::PadTask_ptr p = getPadTaskFromGUI();
-	bool running = true;
+	CancellationToken::CancellationToken_ptr token = CancellationToken::create();
 	
 	try{
-		p->execute(0, &running);
+		p->execute(0, token);
 	}catch (std::runtime_error r){
 		Gtk::MessageDialog dialog(*mainWindow, "error occured", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
 		dialog.set_secondary_text(r.what());
@@ -1155,19 +1190,36 @@ void GUI::on_buttonSelectSpectrum_clicked(){
 	ListView_SavedData::SPECTRUM_TYPE spectrumType = listView_spectrums->getSelectedSpectrumType();
 	std::string path = listView_spectrums->getSelectedSpectrumPath();
 	try{
+		MeasurementFileReader::MeasurementFileReader_ptr reader; // only used if the spectrum is stored in a measurement file
+		if (listView_spectrums->isMeasurementFileSelected()){
+			reader = MeasurementFileReader::create(path);
+		}
+		
 		switch (spectrumType){
 			case ListView_SavedData::SPECTRUM_TYPE::SPECTRUM:
-				setSpectrum(loadSpectrum(path), path); //load spectrum
+				setSpectrum((reader != nullptr) ? reader->getSpectrum(listView_spectrums->getSelectedRecordIndex()) : SpectrumCsvReader::loadSpectrum(path), path); //load spectrum
 				notebook_page_exData->set_current_page(1); //switch to plot page
 				break;
 			
 			case ListView_SavedData::SPECTRUM_TYPE::IMPEDANCE:
-				setImpSpectrum(loadImpSpectrum(path), path); //load spectrum
+				setImpSpectrum((reader != nullptr) ? reader->getSpectrum(listView_spectrums->getSelectedRecordIndex()) : SpectrumCsvReader::loadImpSpectrum(path), path); //load spectrum
 				notebook_page_exData->set_current_page(2); //switch to plot page
 				break;
 				
 			case ListView_SavedData::SPECTRUM_TYPE::TRANSIENT:
-				setTransImpSpectrum(TransSpect::loadTransImpSpectrum(listView_spectrums->getSelectedTransSpectrumPaths()));
+				if (reader != nullptr){
+					setTransImpSpectrum(TransSpect::loadTransImpSpectrum(*reader, listView_spectrums->getSelectedSpectrumNumber()), path);
+				}else{
+					if (transSpectLoader != nullptr){ // stop loading the previous transient spectrum
+						transSpectLoader->cancel();
+					}
+					transSpectLoader = TransSpectLoader::create(listView_spectrums->getSelectedTransSpectrumPaths()); // load in the background
+					progressbar_load->set_fraction(0.0);
+					progressbar_load->set_text("loading...");
+					progressbar_load->show();
+					button_cancelLoad->show();
+					transSpectLoader->start([this]{transSpectLoaderDispatcher.emit();});
+				}
 				break;
 		}
 	}catch (std::runtime_error &e){
@@ -1176,155 +1228,17 @@ void GUI::on_buttonSelectSpectrum_clicked(){
 		dialog.run();
 	} 
 }
-std::vector<DataP::DataP_ptr> GUI::loadSpectrum(std::string path){
-	std::vector<DataP::DataP_ptr> spectrum;
-	std::ifstream spectrum_file(path);
-	
-	if (spectrum_file.is_open()){
-		std::string line;
-		short wavelength = -1, intensity = -1;
-		short i = 0;
-		int lineNo = 1;
-		if (std::getline(spectrum_file, line)){ // get header
-			if (line.find_first_of("timediff") != std::string::npos){ // timediff=... line
-				std::getline(spectrum_file, line); // read next line
-			}
-			
-			// read header
-			std::string element;
-			while (!line.empty()){ // read header
-				if (line.find_first_of(";") == std::string::npos){ // last element in row
-					element = line;
-					line = "";
-				}else{ // not the last element in row
-					element = line.substr(0, line.find_first_of(";"));
-					line = line.substr(line.find_first_of(";")+1);
-				}
-				if (element.compare("wavelength") == 0){
-					wavelength = i;
-					i++;
-				}else if (element.compare("intensity_real") == 0 || element.compare("intensity") == 0){
-					intensity = i;
-					i++;
-				}
-			}
-			
-			if (intensity == -1){ // no frequency information found
-				throw std::runtime_error("no intensity_real found in file" + path);
-			}
-			
-			//read data
-			std::vector<std::string> elementsOfLine;
-			while(std::getline(spectrum_file, line)){ // for the rest of the document
-				lineNo++;
-				elementsOfLine.clear();
-				
-				while (!line.empty()){ // fill elementsOfLineVector
-					if (line.find_first_of(";") == std::string::npos){ // last element in row
-						elementsOfLine.push_back(line);
-						line = "";
-					}else{ // not the last element in row
-						elementsOfLine.push_back(line.substr(0, line.find_first_of(";")));
-						line = line.substr(line.find_first_of(";")+1);
-					}
-				}
-				if (elementsOfLine.size() != i){ // no of elements does not fit the header
-					throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no. of elements dismatch header - " + path);
-				}
-				
-				DataP::DataP_ptr p = std::make_shared<DataP>(std::stod(elementsOfLine[wavelength]), std::stod(elementsOfLine[intensity]));
-				spectrum.push_back(p);
-			}
-			spectrum_file.close();
-		}
-	}
-	return spectrum;
-}
-std::vector<DataP::DataP_ptr> GUI::loadImpSpectrum(std::string path){
-	std::vector<DataP::DataP_ptr> spectrum;
-	
-	std::ifstream spectrum_file(path);
-	if (spectrum_file.is_open()){
-		std::string line;
-		short frequency = -1, impedance_real = -1, impedance_imag = -1, impedance_abs = -1, impedance_phase = -1;
-		short i = 0;
-		int lineNo = 1;
-		
-		//overread possible header of transient impedance files
-		while (std::getline(spectrum_file, line) && (line.find("position") == 0 || line.find("timediff") == 0)){
-			lineNo++;
-		}
-		
-			
-			if (!line.empty()){ // get header
-			
-			// read header
-			std::string element;
-			while (!line.empty()){ // read header
-				if (line.find_first_of(";") == std::string::npos){ // last element in row
-					element = line;
-					line = "";
-				}else{ // not the last element in row
-					element = line.substr(0, line.find_first_of(";"));
-					line = line.substr(line.find_first_of(";")+1);
-				}
-				if (element.compare("frequency") == 0){
-					frequency = i;
-					i++;
-				}else if (element.compare("impedance_real") == 0){
-					impedance_real = i;
-					i++;
-				}else if (element.compare("impedance_imag") == 0){
-					impedance_imag = i;
-					i++;
-				}else if (element.compare("impedance_abs") == 0){
-					impedance_abs = i;
-					i++;
-				}else if (element.compare("impedance_phase") == 0){
-					impedance_phase = i;
-					i++;
-				}
-			}
-			
-			if (frequency == -1){ // no frequency information found
-				throw std::runtime_error("no freq information found in file" + path);
-			}
-			
-			//read data
-			std::vector<std::string> elementsOfLine;
-			while(std::getline(spectrum_file, line)){ // for the rest of the document
-				lineNo++;
-				elementsOfLine.clear();
-				
-				while (!line.empty()){ // fill elementsOfLineVector
-					if (line.find_first_of(";") == std::string::npos){ // last element in row
-						elementsOfLine.push_back(line);
-						line = "";
-					}else{ // not the last element in row
-						elementsOfLine.push_back(line.substr(0, line.find_first_of(";")));
-						line = line.substr(line.find_first_of(";")+1);
-					}
-				}
-				if (elementsOfLine.size() != i){ // no of elements does not fit the header
-					throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no. of elements dismatch header - " + path);
-				}
-				
-				if ((impedance_real != -1) && (impedance_imag != -1)){ // got real and imag information
-					DataP::DataP_ptr p = std::make_shared<DataP>(std::stod(elementsOfLine[frequency]), std::stod(elementsOfLine[impedance_real]), std::stod(elementsOfLine[impedance_imag]));
-					spectrum.push_back(p);
-				}else if ((impedance_phase != -1) && (impedance_abs != -1)){
-					DataP::DataP_ptr p = std::make_shared<DataP>();
-					p->setX(std::stod(elementsOfLine[frequency]));
-					p->setY_AbsPhase(std::stod(elementsOfLine[impedance_abs]), std::stod(elementsOfLine[impedance_phase]), DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD);
-					spectrum.push_back(p);
-				}else { ///@todo add other possible combinations
-					throw std::runtime_error("data combination of real / imag / abs / phase not implemented");
-				}
-			}
-			spectrum_file.close();
+void GUI::on_buttonExportCSV_clicked(){
+	if (listView_spectrums->isMeasurementFileSelected()){
+		try{
+			unsigned int count = ExperimentData::exportCSV(listView_spectrums->getSelectedSpectrumPath());
+			log->add_event(Log_Event::create("csv export", std::to_string(count) + " spectrums have been exported", Log_Event::TYPE::LOG_INFO));
+		}catch (std::runtime_error &e){
+			Gtk::MessageDialog dialog(*mainWindow, "error exporting spectrums", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
+			dialog.set_secondary_text(e.what());
+			dialog.run();
 		}
 	}
-	return spectrum;
 }
 
 
@@ -1355,6 +1269,42 @@ void GUI::addLogEvent(Log_Event::Log_Event_ptr event){
 	
 	logEventDispatcher.emit();
 }
+void GUI::transSpectLoaderDispatcherFunction(){
+	if (transSpectLoader == nullptr){
+		return;
+	}
+	
+	std::size_t loaded = transSpectLoader->getLoadedCount();
+	std::size_t files = transSpectLoader->getFileCount();
+	progressbar_load->set_fraction((files > 0) ? (double) loaded / files : 1.0);
+	progressbar_load->set_text(std::to_string(loaded) + " / " + std::to_string(files) + " spectrums");
+	
+	if (transSpectLoader->isFinished()){
+		TransSpectLoader::TransSpectLoader_ptr loader = transSpectLoader;
+		transSpectLoader = nullptr;
+		progressbar_load->hide();
+		button_cancelLoad->hide();
+		if (loader->isCancelled()){
+			return;
+		}
+		
+		try{
+			TransSpect::TransSpect_ptr t = loader->getTransSpect();
+			if (t != nullptr){
+				setTransImpSpectrum(t);
+			}
+		}catch (std::runtime_error &e){
+			Gtk::MessageDialog dialog(*mainWindow, "error loading spectrum", false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_CLOSE);
+			dialog.set_secondary_text(e.what());
+			dialog.run();
+		}
+	}
+}
+void GUI::on_buttonCancelLoad_clicked(){
+	if (transSpectLoader != nullptr){
+		transSpectLoader->cancel();
+	}
+}
 void GUI::logEventDispatcherFunction(){
 	Glib::ustring text = textViewLog->get_buffer()->get_text();
 	
@@ -1371,13 +1321,12 @@ void GUI::logEventDispatcherFunction(){
 }
 
 
-void GUI::setImpSpectrum(std::vector<DataP::DataP_ptr> s, std::string title){
-	std::vector<DataP::DataP_ptr> nyquist_data;
+void GUI::setImpSpectrum(Spectrum s, std::string title){
+	Spectrum nyquist_data;
+	nyquist_data.reserve(s.size());
 	
-	for (std::vector<DataP::DataP_ptr>::const_iterator cit = s.cbegin(); cit != s.cend(); cit++){
-		DataP::DataP_ptr p = *cit;
-		DataP::DataP_ptr dataPoint = std::make_shared<DataP>(p->getY(DataP::COMPLEX_MODE::COMPLEX_REAL), (-1.0) * p->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG));
-		nyquist_data.push_back(dataPoint);
+	for (std::size_t i = 0; i < s.size(); i++){
+		nyquist_data.add(s.getY(i, DataP::COMPLEX_MODE::COMPLEX_REAL), (-1.0) * s.getY(i, DataP::COMPLEX_MODE::COMPLEX_IMAG));
 	}
 	
 	plotWindowImpedance_Abs->autoMax_y = true;
@@ -1430,7 +1379,7 @@ void GUI::setImpSpectrum(std::vector<DataP::DataP_ptr> s, std::string title){
 	label_impedance_plot_title->set_text(title);
 	label_impedance_plot_nyquist_title->set_text(title);
 }
-void GUI::setSpectrum(std::vector<DataP::DataP_ptr> s, std::string title){
+void GUI::setSpectrum(Spectrum s, std::string title){
 	plotWindowSpectrum->autoMax_y = true;
 	plotWindowSpectrum->autoMax_x = true;
 	plotWindowSpectrum->autoScl_x = true;
@@ -1452,30 +1401,29 @@ bool GUI::on_window_close(GdkEventAny* event){
 	return false;
 } 
 
+/*
+ * the values are sampled by the telemetry service, the gui does not access the i2c bus
+ */
 void GUI::on_button_voltContr_refresh_clicked(){
-	I2CVoltageTask::I2CVoltageTask_ptr voltageTask = I2CVoltageTask::create();
-	if (voltageTask->isConnected()){
+	double voltage;
+	if (telemetry->getValue(Telemetry::CHANNEL::CHANNEL_VOLTAGE, voltage)){
 		checkbutton_voltageContr_connected->set_active(true);
-		double voltage = voltageTask->readVoltage();
+		double value;
 		
-		label_voltContr_dcycle->set_text(std::to_string((int)(voltageTask->readCurrentDutyCycle()* 100.0)).append("%"));
+		label_voltContr_dcycle->set_text(telemetry->getValue(Telemetry::CHANNEL::CHANNEL_DUTY_CYCLE, value) ? std::to_string((int)(value * 100.0)).append("%") : "-");
 		label_voltContr_voltage->set_text(FSHelper::formatDouble(voltage).append("V"));
-		label_voltContr_svoltage->set_text(FSHelper::formatDouble(voltageTask->readSetpointVoltage()).append("V"));
+		label_voltContr_svoltage->set_text(telemetry->getValue(Telemetry::CHANNEL::CHANNEL_SETPOINT, value) ? FSHelper::formatDouble(value).append("V") : "-");
 		label_voltage_controller->set_text(std::string("V = ").append(FSHelper::formatDouble(voltage).append("V")));
-		label_voltContr_freq->set_text(std::to_string(voltageTask->readFrequency()).append("Hz"));
+		label_voltContr_freq->set_text(telemetry->getValue(Telemetry::CHANNEL::CHANNEL_PWM_FREQUENCY, value) ? std::to_string((long) value).append("Hz") : "-");
 		
-		switch (voltageTask->readCurrentMode()){
-			case I2CVoltageTask::VOLTAGE_MODE::MODE_CONTROLLER:
-				label_voltContr_mode->set_text("voltage controller");
-				break;
-				
-			case I2CVoltageTask::VOLTAGE_MODE::MODE_DUTY_CYCLE:
-				label_voltContr_mode->set_text("duty cycle");
-				break;
-				
-			default:
-				label_voltContr_mode->set_text("error");
-				break;
+		if (!telemetry->getValue(Telemetry::CHANNEL::CHANNEL_MODE, value)){
+			label_voltContr_mode->set_text("-");
+		}else if (value == I2C_ATTINY45_VOLT_BUFFER_MODE_CONT){
+			label_voltContr_mode->set_text("voltage controller");
+		}else if (value == I2C_ATTINY45_VOLT_BUFFER_MODE_DUTY){
+			label_voltContr_mode->set_text("duty cycle");
+		}else{
+			label_voltContr_mode->set_text("error");
 		}
 	}else{
 		checkbutton_voltageContr_connected->set_active(false);
@@ -1487,18 +1435,17 @@ void GUI::on_button_voltContr_refresh_clicked(){
 		label_voltContr_freq->set_text("-");
 	}
 	
-	Uc_Connection::Uc_Connection_ptr atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
-	if (atmega32->isConnected()){
-		label_voltContr_extvoltage->set_text(FSHelper::formatDouble(voltageTask->readExternalVoltage()).append("V"));
+	double extVoltage;
+	if (telemetry->getValue(Telemetry::CHANNEL::CHANNEL_EXT_VOLTAGE, extVoltage)){
+		label_voltContr_extvoltage->set_text(FSHelper::formatDouble(extVoltage).append("V"));
 	}else{
 		label_voltContr_extvoltage->set_text("-");
 	}
 }
 void GUI::on_button_freqGen_refresh_clicked(){
-	I2CFreqTask::I2CFreqTask_ptr freqTask = I2CFreqTask::create();
-	if (freqTask->isConnected()){
+	double freq;
+	if (telemetry->getValue(Telemetry::CHANNEL::CHANNEL_FREQUENCY, freq)){
 		checkbutton_freqGen_connected->set_active(true);
-		double freq = freqTask->readFreq();
 		
 		label_freqGen_freq->set_text(FSHelper::formatDouble(freq).append("Hz"));
 	}else{
@@ -1510,8 +1457,8 @@ void GUI::on_button_overview_general_refresh_clicked(){
 	on_button_freqGen_refresh_clicked();
 	on_button_voltContr_refresh_clicked();
 	
-	Uc_Connection::Uc_Connection_ptr atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
-	checkbutton_atmega32_connected->set_active(atmega32->isConnected());
+	double extVoltage;
+	checkbutton_atmega32_connected->set_active(telemetry->getValue(Telemetry::CHANNEL::CHANNEL_EXT_VOLTAGE, extVoltage));
 	
 	Spectrometer::Spectrometer_ptr s = Spectrometer::create();
 	checkbutton_spectrometer_connected->set_active(s->isConnected());
@@ -1525,7 +1472,7 @@ void GUI::on_button_overview_general_refresh_clicked(){
 }
 void GUI::on_button_read_realis_clicked(){
 	try{
-		relais->readRelais();
+		relais->readRelais(true);
 		
 		checkbutton_relais_ac->set_active(relais->getRelais(Relais::RELAIS::R_STEUER_AC));
 		checkbutton_relais_boost_in->set_active(relais->getRelais(Relais::RELAIS::R_STEUER_BOOST_IN));
@@ -1638,8 +1585,6 @@ PadTask::PadTask_ptr GUI::getPadTaskFromGUI(){
 }
 
 void GUI::updateThread(){
-	Uc_Connection::Uc_Connection_ptr atmega = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
-	
 	switch (notebook_main->get_current_page()){
 		case 0:{ //overview
 			switch(notebook_overview->get_current_page()){
@@ -1690,16 +1635,12 @@ void GUI::on_button_setPwmFreq_clicked(){
 	Uc_Connection::Uc_Connection_ptr attinyController = Uc_Connection::create(I2C_ATTINY45_VOLT_SLAVE_ADDRESS);
 	int freq = adjustment_pwmFreq->get_value();
 	
-	char freq_0 =  (0x000000FF & freq);
-	char freq_1 = ((0x0000FF00 & freq) >> 8);
-	char freq_2 = ((0x00FF0000 & freq) >> 16);
-	char freq_3 = ((0xFF000000 & freq) >> 24);
+	int freq_0 =  (0x000000FF & freq);
+	int freq_1 = ((0x0000FF00 & freq) >> 8);
+	int freq_2 = ((0x00FF0000 & freq) >> 16);
+	int freq_3 = ((0xFF000000 & freq) >> 24);
 	
-	bool error = false;
-	if (!error) error = (attinyController->writeRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ0, freq_0) != false);
-	if (!error) error = (attinyController->writeRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ1, freq_1) != false);
-	if (!error) error = (attinyController->writeRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ2, freq_2) != false);
-	if (!error) error = (attinyController->writeRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ3, freq_3) != false);
+	bool error = (attinyController->writeRegisters(I2C_ATTINY45_VOLT_BUFFER_FREQ0, {freq_0, freq_1, freq_2, freq_3}, true) != false);
 	
 	if (!error){
 		std::cout << "set pwm freq to " << freq << " Hz" << std::endl;
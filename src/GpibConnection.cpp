@@ -1,4 +1,5 @@
 #include "GpibConnection.h"
+#include "Trace.h"
 
 #include <stdexcept>
 #include <gpib/ib.h>
@@ -18,6 +19,7 @@ GpibConnection::~GpibConnection(){
 }
 
 void GpibConnection::send(std::string command){
+	Trace::Span span("gpib", "send " + command, "address", slaveAddress);
 	if (devDescr < 0){ // connection has not been opened yet
 		openConnection();
 	}
@@ -44,6 +46,7 @@ bool GpibConnection::isConnected(){
 }
 
 std::string GpibConnection::read(){
+	Trace::Span span("gpib", "read", "address", slaveAddress);
 	char buffer[1024];
 	if (devDescr < 0){ // connection has not been opened yet
 		openConnection();
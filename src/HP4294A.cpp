@@ -73,18 +73,17 @@ void HP4294A::waitUntilMeasurementFinished(){
 	}
 }
 
-std::vector<DataP::DataP_ptr> HP4294A::measureSpectrum(bool *running){
+void HP4294A::streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token){
 	applyParams();
 	triggerMeasurement();
 	waitUntilMeasurementFinished();
 	connection.send("MEAS IMPH; TRAC B; FMT LINY; TRAC A; FMT LOGY; AUTO");
 	
-	std::vector<DataP::DataP_ptr> data;
 	std::string sweep_val = "";
 	std::string measurement_val = "";
 	std::string measurement_val_real = "";
 	std::string measurement_val_im = "";
-	for (int i = 1; (i <= points) && (*running); i++){
+	for (int i = 1; (i <= points) && !token->isCancelled(); i++){
 		connection.send("OUTPSWPRMP? " + std::to_string(i));
 		sweep_val = connection.read();
 		sweep_val = sweep_val.substr(0, sweep_val.find_first_of("\n")); // cut off the \n<^END>
@@ -100,9 +99,8 @@ std::vector<DataP::DataP_ptr> HP4294A::measureSpectrum(bool *running){
 		double measurement_val_real_d = FSHelper::sciToDouble(measurement_val_real);
 		double sweep_val_d = FSHelper::sciToDouble(sweep_val);
 		
-		data.push_back(std::make_shared<DataP>(sweep_val_d, measurement_val_real_d, measurement_val_im_d));
+		onPoint(sweep_val_d, measurement_val_real_d, measurement_val_im_d, i - 1);
 	}
-	return data;
 }
 
 
@@ -1,7 +1,7 @@
 #include "I2CFreqTask.h"
 #include "Addresses.h"
+#include "Simulator.h"
 
-#include <wiringPi.h>
 #include <iostream>
 
 I2CFreqTask::I2CFreqTask(unsigned int freq): I2CTask(I2C_ATTINY45_FREQ_SLAVE_ADDRESS){
@@ -16,48 +16,52 @@ I2CFreqTask::I2CFreqTask_ptr I2CFreqTask::create(unsigned int freq){
 	return std::make_shared<I2CFreqTask>(freq);
 }
 
-void I2CFreqTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void I2CFreqTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
+	if (hints.setpointActive){ // frequency has already been set by a previous task
+		addLogEvent(Log_Event::create("set frequency", "f=" + std::to_string(freq) + "Hz is already set", Log_Event::TYPE::LOG_INFO));
+		executed = true;
+		return;
+	}
 	if (isConnected()){
 		if (freq == 0){
-			if (relais->uc_is_connected()){
-				relais->readRelais();
+			try{
+				readRelais();
 				if (relais->getRelais(Relais::RELAIS::R_STEUER_AC)){
 					relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
 					relais->writeRelais();
 					addLogEvent(Log_Event::create("switch relais", "switched relais to disable AC output", Log_Event::TYPE::LOG_INFO));
 				}
-			}else{
+			}catch(std::runtime_error &e){
 				addLogEvent(Log_Event::create("switch relais", "can't send i2c command to the relais uc", Log_Event::TYPE::LOG_ERROR));
-				throw std::runtime_error("microcontroller is not connected - cannot switch relais to disable frequency generator"); 
+				throw std::runtime_error(std::string("cannot switch relais to disable frequency generator - ") + e.what());
 			}
 		}else{
 			addLogEvent(Log_Event::create("set frequency", "f=" + std::to_string(freq) + "Hz", Log_Event::TYPE::LOG_INFO));
 			
 	//		std::cout << "freq: " << freq << "Hz" << std::endl;
 			
-			char freq_0 =  (0x000000FF & freq);
-			char freq_1 = ((0x0000FF00 & freq) >> 8);
-			char freq_2 = ((0x00FF0000 & freq) >> 16);
-			char freq_3 = ((0xFF000000 & freq) >> 24);
+			int freq_0 =  (0x000000FF & freq);
+			int freq_1 = ((0x0000FF00 & freq) >> 8);
+			int freq_2 = ((0x00FF0000 & freq) >> 16);
+			int freq_3 = ((0xFF000000 & freq) >> 24);
 			
 	//		std::cout << std::bitset<8>(freq_3) << " - " << std::bitset<8>(freq_2) << " - " << std::bitset<8>(freq_1) << " - " << std::bitset<8>(freq_0) << std::endl;
 			
-			bool error = false;
-			if (!error) error = (connection->writeRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ0, freq_0) != false);
-			if (!error) error = (connection->writeRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ1, freq_1) != false);
-			if (!error) error = (connection->writeRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ2, freq_2) != false);
-			if (!error) error = (connection->writeRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ3, freq_3) != false);
+			// one transaction, skipped if the frequency has not changed
+			bool error = (connection->writeRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, {freq_0, freq_1, freq_2, freq_3}, true) != false);
 			
 			if (error){
 				addLogEvent(Log_Event::create("set frequency", "can't send i2c command to frequency generator", Log_Event::TYPE::LOG_ERROR));
 			}else{
-				if (relais->uc_is_connected()){
-					relais->readRelais();
+				try{
+					readRelais();
 					if (!relais->getRelais(Relais::RELAIS::R_STEUER_AC)){
 						relais->setRelais(Relais::RELAIS::R_STEUER_AC, true);
 						relais->writeRelais();
 						addLogEvent(Log_Event::create("switch relais", "switched relais to enable AC output", Log_Event::TYPE::LOG_INFO));
 					}
+				}catch(std::runtime_error &e){ // the frequency has been set, the output stays disabled
+					addLogEvent(Log_Event::create("switch relais", std::string("can't enable AC output - ") + e.what(), Log_Event::TYPE::LOG_ERROR));
 				}
 			}
 		}
@@ -102,11 +106,11 @@ bool I2CFreqTask::isConnected(){
 }
 
 int I2CFreqTask::readFreq(){
-	int freq0 = connection->readRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ0);
-	int freq1 = connection->readRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ1);
-	int freq2 = connection->readRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ2);
-	int freq3 = connection->readRegister(I2C_ATTINY45_FREQ_BUFFER_FREQ3);
-	int freq = freq0 + (freq1 << 8) + (freq2 << 16) + (freq3 << 24);
+	std::vector<int> f = connection->readRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, 4);
+	if (f.empty()){
+		return -1;
+	}
+	int freq = f[0] + (f[1] << 8) + (f[2] << 16) + (f[3] << 24);
 	
 	return freq;
 }
@@ -125,4 +129,36 @@ std::list<Task::DEVICES> I2CFreqTask::getNecessaryDevices(){
 	devices.push_back(d);
 	
 	return devices;
+}
+bool I2CFreqTask::isBarrier(){
+	return false;
+}
+void I2CFreqTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	hints.relaisSynced = state.isRelaisSynced();
+	hints.setpointActive = state.isRelais(Relais::RELAIS::R_STEUER_AC, freq != 0) && (freq == 0 || state.isFrequency(freq));
+	
+	if (hints.setpointActive){
+		report.setpoints++;
+	}
+	if (hints.relaisSynced || hints.setpointActive){
+		report.relaisReads++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	
+	if (freq != 0){
+		state.setFrequency(freq);
+	}
+	state.setRelais(Relais::RELAIS::R_STEUER_AC, freq != 0);
+}
+void I2CFreqTask::simulate(Simulator &sim){
+	const ExecutionHints &h = sim.getHints();
+	if (h.setpointActive){
+		return;
+	}
+	const SimulationModel &model = sim.getModel();
+	
+	if (freq != 0){
+		sim.wait(4 * model.i2cAccessMs);
+	}
+	sim.wait((h.relaisSynced ? 0 : model.relaisAccessMs) + model.relaisAccessMs);
 }
\ No newline at end of file
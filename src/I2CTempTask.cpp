@@ -1,13 +1,16 @@
 #include "I2CTempTask.h"
 #include "TempData.h"
 #include "Addresses.h"
+#include "Simulator.h"
+#include "Telemetry.h"
 
 #include <iostream>
-#include <wiringPi.h>
 #include <iomanip> // std::setprecision
-#include <unistd.h>
+#include <chrono>
+#include <cmath>
 
-#define TIMEOUT_US 500
+/// max. time until the telemetry service has sampled the dht11
+#define TIMEOUT_MS 1000
 
 I2CTempTask::I2CTempTask(int slaveAddress): I2CTask(slaveAddress){
 	data = nullptr;  // no data read so far
@@ -17,33 +20,29 @@ I2CTempTask::~I2CTempTask(){
 }
 
 /*
-* Triggers a data read from DHT11 on atmega32, receives the measured data ad stors it in class
-* variable data
+* Requests a measurement of the DHT11 from the telemetry service (the only one which accesses the DHT11, so the requests do not
+* interleave) and stores the sample in class variable data
 */
-void I2CTempTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
-	usleep(2 * 1000 * 1000);
-	std:: cout << "write: " << connection->writeRegister(I2C_ATMEGA32_BUFFER_TEMP_REQUEST, 0x01) << std::endl; //trigger measurement
-	usleep(50 * 1000); //wait until data is ready
+void I2CTempTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
+	if (!token->sleepFor(std::chrono::seconds(2))){ // experiment has been stopped
+		return;
+	}
+	Telemetry::Telemetry_ptr telemetry = Telemetry::create();
+	std::int64_t requested = Telemetry::now_ns();
+	telemetry->sampleNow(Telemetry::CHANNEL::CHANNEL_TEMPERATURE);
 	
-	int status;
-	int timeout = 0;
+	// the humidity is added after the temperature of the same measurement
+	TelemetryBuffer::Sample temperature, humidity;
+	bool sampled = false;
+	std::chrono::steady_clock::time_point timeout = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_MS);
 	do{
-		status = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_READY);
-		timeout += 10;
-		usleep(10);
-	}while((status == 0) && (timeout < TIMEOUT_US) && (*executeNext));
+		sampled = (telemetry->getBuffer(Telemetry::CHANNEL::CHANNEL_HUMIDITY).latest(humidity) && humidity.time_ns >= requested);
+	}while (!sampled && std::chrono::steady_clock::now() < timeout && token->sleepFor(std::chrono::milliseconds(10)));
 	
-	if (*executeNext){
-		std::cout << "status: " << status << std::endl;
-		int temp_data[5];
-		
-		temp_data[0] = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_DATA0);
-		temp_data[1] = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_DATA1);
-		temp_data[2] = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_DATA2);
-		temp_data[3] = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_DATA3);
-		temp_data[4] = connection->readRegister(I2C_ATMEGA32_BUFFER_TEMP_DATA4);
-		if (status == 0x01){ // data valid
-			I2CTempTask::data = std::make_shared<TempData>(temp_data);
+	if (!token->isCancelled()){
+		bool valid = sampled && telemetry->getBuffer(Telemetry::CHANNEL::CHANNEL_TEMPERATURE).latest(temperature) && !std::isnan(temperature.value) && !std::isnan(humidity.value);
+		if (valid){ // data valid
+			I2CTempTask::data = std::make_shared<TempData>(temperature.value, TempData::UNIT::CELSIUS, humidity.value);
 			measurementValid = true;
 			addLogEvent(Log_Event::create("measurement valid", "received valid temperature measurement - " + std::to_string(I2CTempTask::data->getTemperature()) + "°C, " + std::to_string(I2CTempTask::data->getHumidity()) + "%" , Log_Event::TYPE::LOG_INFO));
 		}else{
@@ -81,4 +80,13 @@ std::list<Task::DEVICES> I2CTempTask::getNecessaryDevices(){
 	devices.push_back(d);
 	
 	return devices;
+}
+bool I2CTempTask::isBarrier(){
+	return false;
+}
+void I2CTempTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	
+}
+void I2CTempTask::simulate(Simulator &sim){
+	sim.wait(sim.getModel().tempMeasurementMs);
 }
\ No newline at end of file
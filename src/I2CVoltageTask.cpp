@@ -1,18 +1,24 @@
 #include "I2CVoltageTask.h"
 #include "FSHelper.h"
 #include "Addresses.h"
+#include "Simulator.h"
+#include "VoltageSettler.h"
 
-#include <wiringPi.h>
 #include <iostream>
 #include <unistd.h>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 
-#define WAIT_FOR_VOLTAGE_TIMEOUT 40
+#define VOLTAGE_DISCHARGE_TIMEOUT_MS 3000
 
 DialogExtVolt* I2CVoltageTask::dialogExtVolt= nullptr;
+std::atomic<int> I2CVoltageTask::activeSetpoint(-1);
 
 I2CVoltageTask::I2CVoltageTask(unsigned int voltage, VOLTAGE_MODE m): I2CTask(I2C_ATTINY45_VOLT_SLAVE_ADDRESS), mode(m){
 	setVoltage(voltage);
 	waitForVoltage = true;
+	closedLoop = false;
 	dutyCycle = 0.5;
 }
 
@@ -24,17 +30,17 @@ I2CVoltageTask::I2CVoltageTask_ptr I2CVoltageTask::create(unsigned int voltage,
 	return std::make_shared<I2CVoltageTask>(voltage, m);
 }
 
-void I2CVoltageTask::setInternalVoltage(bool* executeNext){
+void I2CVoltageTask::setInternalVoltage(CancellationToken::CancellationToken_ptr token){
 	if (voltage > 0){ // voltage should be turned on
 		if (isConnected()){
 			
 			if (mode == VOLTAGE_MODE::MODE_CONTROLLER){
 				addLogEvent(Log_Event::create("set voltage", "v=" + std::to_string(voltage) + "V", Log_Event::TYPE::LOG_INFO));
 				
-				int ADCS = ((double) VOLTAGE_ATTINY45_R2) / (((double) VOLTAGE_ATTINY45_R1) + ((double) VOLTAGE_ATTINY45_R2)) * ((double) VOLTAGE_ATTINY45_R_CORR) * 1024.0 / 5.0 * ((double) voltage);
+				int ADCS = VoltageSettler::toSetpointAdc(voltage);
 				
-				char ADC_SL =  (0x000000FF & ADCS);
-				char ADC_SH = ((0x0000FF00 & ADCS) >> 8);
+				int ADC_SL =  (0x000000FF & ADCS);
+				int ADC_SH = ((0x0000FF00 & ADCS) >> 8);
 				
 				//std::cout << std::bitset<8>(ADC_SH) << " - " << std::bitset<8>(ADC_SL) << std::endl;
 				int tries = 0;
@@ -43,80 +49,69 @@ void I2CVoltageTask::setInternalVoltage(bool* executeNext){
 				
 				//try to set voltage
 				do{
-					if (!error) error = (connection->writeRegister(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, ADC_SL) != false);
-					if (!error) error = (connection->writeRegister(I2C_ATTINY45_VOLT_BUFFER_ADCH_S, ADC_SH) != false);
+					if (!error) error = (connection->writeRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, {ADC_SL, ADC_SH}, true) != false); // skipped if the setpoint has not changed
 					if (!error) error = (connection->writeRegister(I2C_ATTINY45_VOLT_BUFFER_MODE, I2C_ATTINY45_VOLT_BUFFER_MODE_CONT) != false);
 					
-					usleep(1 * 1000);
+					usleep(VOLTAGE_SETPOINT_ACCEPT_MS * 1000);
 					
 					//check if controller accepted the voltage
-					success = (connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCL_S) == ADC_SL && connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCH_S) == ADC_SH);
+					success = (connection->readRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, 2) == std::vector<int>({ADC_SL, ADC_SH}));
 					tries++;
 				}while (!success && tries < 3);
 				
 				if (!error && success){
 					//set relais
-					if (relais->uc_is_connected()){
-						relais->readRelais();
+					try{
+						readRelais();
 						if (!relais->getRelais(Relais::RELAIS::R_STEUER_SAFETY)){
 							relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, true);
 							relais->setRelais(Relais::RELAIS::R_STEUER_BOOST_IN, true);
 							relais->writeRelais();
 							addLogEvent(Log_Event::create("relais switched", "relais switched to supply the boost converter with voltage", Log_Event::TYPE::LOG_INFO));
 						}
-						
-						int timeout = 0;
-						double current_voltage = readVoltage();
-						TimePoint lastTimeWithRightVoltage = getCurrentTime();
-						
-						
-						while(getElapsedSeconds(lastTimeWithRightVoltage) < VOLTAGE_TASK_TIME_CORRECT_VOLT && timeout < WAIT_FOR_VOLTAGE_TIMEOUT && *executeNext && waitForVoltage){
-							if (current_voltage > voltage * 1.2){ // voltage is much higher than the setpoint
-								
-								relais->readRelais();
-								if (relais->getRelais(Relais::RELAIS::R_STEUER_SAFETY)){ //if capacitor is not discharging at the moment
-									addLogEvent(Log_Event::create("huge voltage difference", "current voltage (" + FSHelper::formatDouble(current_voltage) + "V) is too high - discharging capacitor" , Log_Event::TYPE::LOG_INFO));
-									
-									relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, false);
-									relais->writeRelais(); // discharge
-									
-									int discharging_timeout = 0;
-									//while (current_voltage > voltage * 1.2 && discharging_timeout < 60){
-									while (current_voltage > voltage * 1 && discharging_timeout < 60){
-										current_voltage = readVoltage();
-										usleep(50 * 1000);
-										discharging_timeout++;
-									}
-									
-									relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, true);
-									relais->writeRelais(); // stop discharging
-								}
-							}
-							current_voltage = readVoltage();
-							double e_rel = (current_voltage - (voltage)) / (voltage); // error
-							e_rel = (e_rel > 0 ? e_rel : e_rel * -1.0); //abs
-							
-							usleep(500 * 1000);
-							if (e_rel > 0.05){ //error bigger than 5%
-								timeout++;
-								lastTimeWithRightVoltage = getCurrentTime();
-							}else{
-								
+					}catch(std::runtime_error &e){
+						addLogEvent(Log_Event::create("cannot set relais", e.what(), Log_Event::TYPE::LOG_ERROR));
+						throw;
+					}
+					
+					// poll fast while the voltage approaches the band, back off inside the band
+					VoltageSettler settler(voltage, (closedLoop ? VOLTAGE_SETTLE_CLOSED_LOOP_TOLERANCE : VOLTAGE_SETTLE_TOLERANCE));
+					TimePoint startTime = getCurrentTime();
+					double current_voltage = readVoltage();
+					settler.addSample(0, current_voltage);
+					
+					while (waitForVoltage && !settler.isSettled() && getElapsedSeconds(startTime) * 1000.0 < VOLTAGE_SETTLE_TIMEOUT_MS && !token->isCancelled()){
+						bool discharge = (current_voltage > voltage * 1.2); // voltage is much higher than the setpoint
+						if (closedLoop && settler.updateCommand()){ // voltage is steady outside of the band - trim the setpoint
+							int ADCS_trim = VoltageSettler::toSetpointAdc(settler.getCommand());
+							if (connection->writeRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, {ADCS_trim & 0xFF, (ADCS_trim >> 8) & 0xFF}, true) != false){ // the settler assumes the new setpoint
+								addLogEvent(Log_Event::create("set voltage", "can't send the trimmed setpoint " + FSHelper::formatDouble(settler.getCommand()) + "V to the voltage controller", Log_Event::TYPE::LOG_ERROR));
+								throw std::runtime_error("can't send i2c command to voltage controller");
 							}
-							std::cout << "e_rel: " << e_rel << "\tvoltag: " << current_voltage << "\ttimeout: " << timeout << std::endl;
-							
-						} 
-						
-						
-						if (timeout >= WAIT_FOR_VOLTAGE_TIMEOUT){
-							addLogEvent(Log_Event::create("timeout expired", "cannot set voltage to " + std::to_string(voltage) + "V - current voltage: " + FSHelper::formatDouble(current_voltage) +"V", Log_Event::TYPE::LOG_ERROR));
-							throw std::runtime_error("timeout expired - cannot set voltage");
-						}else{
-							addLogEvent(Log_Event::create("voltage set", "current voltage: " + FSHelper::formatDouble(current_voltage) +"V", Log_Event::TYPE::LOG_INFO));
+							discharge = discharge || (current_voltage > voltage + settler.getBand()); // the controller cannot lower the voltage
 						}
+						if (discharge){
+							current_voltage = dischargeCapacitor(token, current_voltage);
+							settler.reset();
+						}
+						
+						token->sleepFor(std::chrono::microseconds((long) (settler.getNextPollMs() * 1000.0))); // returns immediately if the experiment is stopped
+						current_voltage = readVoltage();
+						settler.addSample(getElapsedSeconds(startTime) * 1000.0, current_voltage);
+					}
+					
+					
+					if (settler.isSettled()){ // only a confirmed voltage can be skipped by the following tasks
+						std::string trimmed = (settler.getCommand() != voltage ? ", setpoint trimmed to " + FSHelper::formatDouble(settler.getCommand()) + "V" : "");
+						addLogEvent(Log_Event::create("voltage set", "current voltage: " + FSHelper::formatDouble(current_voltage) +"V (" + std::to_string(settler.getSamples()) + " measurements in " + FSHelper::formatDouble(getElapsedSeconds(startTime)) + "s" + trimmed + ")", Log_Event::TYPE::LOG_INFO));
+						activeSetpoint = voltage;
+					}else if (token->isCancelled()){
+						addLogEvent(Log_Event::create("set voltage", "stopped before the voltage has been reached - current voltage: " + FSHelper::formatDouble(current_voltage) +"V", Log_Event::TYPE::LOG_INFO));
+					}else if (!waitForVoltage){
+						addLogEvent(Log_Event::create("set voltage", "setpoint sent, not waiting for the voltage - current voltage: " + FSHelper::formatDouble(current_voltage) +"V", Log_Event::TYPE::LOG_INFO));
 					}else{
-						addLogEvent(Log_Event::create("cannot set relais", "relais microcontroller is not connected", Log_Event::TYPE::LOG_ERROR));
-						throw std::runtime_error("relais cannot be set - microcontroller is not connected"); 
+						addLogEvent(Log_Event::create("timeout expired", "cannot set voltage to " + std::to_string(voltage) + "V - current voltage: " + FSHelper::formatDouble(current_voltage) +"V", Log_Event::TYPE::LOG_ERROR));
+						throw std::runtime_error("timeout expired - cannot set voltage");
 					}
 				}else{
 					if (error){
@@ -138,16 +133,16 @@ void I2CVoltageTask::setInternalVoltage(bool* executeNext){
 				if (!error) error = (connection->writeRegister(I2C_ATTINY45_VOLT_BUFFER_DUTY_CYCLE, dutyCycle_int) != false);
 				
 				if (!error){
-					if (relais->uc_is_connected()){
-						relais->readRelais();
+					try{
+						readRelais();
 						if (!relais->getRelais(Relais::RELAIS::R_STEUER_SAFETY)){
 							relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, true);
 							relais->writeRelais();
 							addLogEvent(Log_Event::create("relais switched", "relais switched to supply the boost converter with voltage", Log_Event::TYPE::LOG_INFO));
 						}
-					}else{
-						addLogEvent(Log_Event::create("cannot set relais", "relais microcontroller is not connected", Log_Event::TYPE::LOG_ERROR));
-						throw std::runtime_error("relais cannot be set - microcontroller is not connected"); 
+					}catch(std::runtime_error &e){
+						addLogEvent(Log_Event::create("cannot set relais", e.what(), Log_Event::TYPE::LOG_ERROR));
+						throw;
 					}
 				}else{
 					addLogEvent(Log_Event::create("set duty cycle", "can't send i2c command to voltage controller", Log_Event::TYPE::LOG_ERROR));
@@ -159,19 +154,51 @@ void I2CVoltageTask::setInternalVoltage(bool* executeNext){
 		}
 		
 	}else{ // voltage should be turned off
-		if (relais->uc_is_connected()){
-			relais->readRelais();
+		try{
+			readRelais();
 			if (relais->getRelais(Relais::RELAIS::R_STEUER_SAFETY)){
 				relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, false);
 				relais->writeRelais();
 				addLogEvent(Log_Event::create("relais switched", "relais switched to not supply the boost converter with voltage", Log_Event::TYPE::LOG_INFO));
 			}
-		}else{
-			throw std::runtime_error("microcontroller is not connected - cannot turn off the voltage by switching relais");
+		}catch(std::runtime_error &e){
+			addLogEvent(Log_Event::create("cannot set relais", e.what(), Log_Event::TYPE::LOG_ERROR));
+			throw std::runtime_error(std::string("cannot turn off the voltage by switching relais - ") + e.what());
+		}
+		if (mode == VOLTAGE_MODE::MODE_CONTROLLER){
+			activeSetpoint = 0;
 		}
 	}
 }
-void I2CVoltageTask::setExternalVoltage(bool* executeNext){
+double I2CVoltageTask::dischargeCapacitor(CancellationToken::CancellationToken_ptr token, double current_voltage){
+	readRelais();
+	if (!relais->getRelais(Relais::RELAIS::R_STEUER_SAFETY)){ // capacitor is discharging at the moment
+		return current_voltage;
+	}
+	addLogEvent(Log_Event::create("huge voltage difference", "current voltage (" + FSHelper::formatDouble(current_voltage) + "V) is too high - discharging capacitor" , Log_Event::TYPE::LOG_INFO));
+	
+	relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, false);
+	relais->writeRelais(); // discharge
+	
+	// the capacitor discharges towards 0V, measure when the setpoint should be reached
+	VoltageSettler discharge(0);
+	TimePoint startTime = getCurrentTime();
+	discharge.addSample(0, current_voltage);
+	while (current_voltage > voltage && getElapsedSeconds(startTime) * 1000.0 < VOLTAGE_DISCHARGE_TIMEOUT_MS){
+		double ms = discharge.estimateTimeToMs(voltage);
+		ms = (ms < 0 ? VOLTAGE_SETTLE_MIN_INTERVAL_MS : std::min(std::max(ms, (double) VOLTAGE_SETTLE_MIN_INTERVAL_MS), (double) VOLTAGE_SETTLE_MAX_INTERVAL_MS));
+		if (!token->sleepFor(std::chrono::microseconds((long) (ms * 1000.0)))){ // experiment has been stopped
+			break;
+		}
+		current_voltage = readVoltage();
+		discharge.addSample(getElapsedSeconds(startTime) * 1000.0, current_voltage);
+	}
+	
+	relais->setRelais(Relais::RELAIS::R_STEUER_SAFETY, true);
+	relais->writeRelais(); // stop discharging
+	return current_voltage;
+}
+void I2CVoltageTask::setExternalVoltage(CancellationToken::CancellationToken_ptr token){
 	addLogEvent(Log_Event::create("external V source", "setpoint v=" + std::to_string(voltage) + "V", Log_Event::TYPE::LOG_INFO));
 	Uc_Connection::Uc_Connection_ptr atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
 	
@@ -210,50 +237,48 @@ void I2CVoltageTask::setExternalVoltage(bool* executeNext){
 		throw std::runtime_error("atmega32 not connected - relais cannot be set and ext voltage cannot be measured");
 	}
 }
-void I2CVoltageTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
-	if (executeNext != 0 && *executeNext){
-		if (relais->uc_is_connected()){
-			
-			//unswitch AC Relais
-//			bool acRelaisSwitched;
-//			relais->readRelais();
-//			acRelaisSwitched = relais->getRelais(Relais::RELAIS::R_STEUER_AC);
-			
-//			if (acRelaisSwitched){
-//				relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
-//				relais->writeRelais();
-//			}
-			
-			
-			if (mode == VOLTAGE_MODE::MODE_EXTERN){ // external source
-				relais->readRelais();
-				if (relais->getRelais(Relais::RELAIS::R_STEUER_HV_EXT)){
-					relais->setRelais(Relais::RELAIS::R_STEUER_HV_EXT, false); // external source
-					relais->writeRelais();
-					addLogEvent(Log_Event::create("relais switched", "relais switched to connect the external HV source with the H-bridge", Log_Event::TYPE::LOG_INFO));
-				}
-				
-				setExternalVoltage(executeNext);
-			
-			}else{ // internal source
-				relais->readRelais();
-				if (!relais->getRelais(Relais::RELAIS::R_STEUER_HV_EXT)){
-					relais->setRelais(Relais::RELAIS::R_STEUER_HV_EXT, true); // external source
-					relais->writeRelais();
-					addLogEvent(Log_Event::create("relais switched", "relais switched to connect the internal HV source with the H-bridge", Log_Event::TYPE::LOG_INFO));
-				}
-				
-				setInternalVoltage(executeNext);
+void I2CVoltageTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
+	if (hints.setpointActive && activeSetpoint == (int) voltage){ // voltage has already been set by a previous task
+		addLogEvent(Log_Event::create("set voltage", "v=" + std::to_string(voltage) + "V is already set", Log_Event::TYPE::LOG_INFO));
+		return;
+	}
+	activeSetpoint = -1; // set again when the voltage has been reached
+	if (!token->isCancelled()){
+		
+		//unswitch AC Relais
+//		bool acRelaisSwitched;
+//		relais->readRelais();
+//		acRelaisSwitched = relais->getRelais(Relais::RELAIS::R_STEUER_AC);
+		
+//		if (acRelaisSwitched){
+//			relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
+//			relais->writeRelais();
+//		}
+		
+		// R_STEUER_HV_EXT: false -> external source, true -> internal source
+		bool internal = (mode != VOLTAGE_MODE::MODE_EXTERN);
+		try{
+			readRelais();
+			if (relais->getRelais(Relais::RELAIS::R_STEUER_HV_EXT) != internal){
+				relais->setRelais(Relais::RELAIS::R_STEUER_HV_EXT, internal);
+				relais->writeRelais();
+				addLogEvent(Log_Event::create("relais switched", std::string("relais switched to connect the ") + (internal ? "internal" : "external") + " HV source with the H-bridge", Log_Event::TYPE::LOG_INFO));
 			}
-			
-//			if (acRelaisSwitched){
-//				relais->setRelais(Relais::RELAIS::R_STEUER_AC, true);
-//				relais->writeRelais();
-//			}
+		}catch(std::runtime_error &e){
+			addLogEvent(Log_Event::create("cannot set relais", e.what(), Log_Event::TYPE::LOG_ERROR));
+			throw;
+		}
+		
+		if (internal){
+			setInternalVoltage(token);
 		}else{
-			addLogEvent(Log_Event::create("cannot set relais", "relais microcontroller is not connected", Log_Event::TYPE::LOG_ERROR));
-			throw std::runtime_error("relais cannot be set - microcontroller is not connected"); 
+			setExternalVoltage(token);
 		}
+		
+//		if (acRelaisSwitched){
+//			relais->setRelais(Relais::RELAIS::R_STEUER_AC, true);
+//			relais->writeRelais();
+//		}
 	}
 	executed = true;
 }
@@ -283,6 +308,9 @@ tinyxml2::XMLElement* I2CVoltageTask::toXMLElement(tinyxml2::XMLDocument *doc, b
 		case VOLTAGE_MODE::MODE_CONTROLLER:
 			xmlTaskElement->SetAttribute("volt", voltage);
 			xmlTaskElement->SetAttribute("wait_for_voltage", waitForVoltage);
+			if (closedLoop){
+				xmlTaskElement->SetAttribute("closed_loop", closedLoop);
+			}
 			break;
 			
 		case VOLTAGE_MODE::MODE_DUTY_CYCLE:
@@ -306,6 +334,10 @@ I2CVoltageTask::I2CVoltageTask_ptr I2CVoltageTask::loadVoltageTask(tinyxml2::XML
 		p->setWaitForVoltage(task_element->FindAttribute("wait_for_voltage")->BoolValue());
 	}
 	
+	if (p != nullptr && task_element->FindAttribute("closed_loop") != nullptr){
+		p->setClosedLoop(task_element->FindAttribute("closed_loop")->BoolValue());
+	}
+	
 	if (p != nullptr && task_element->FindAttribute("mode") != nullptr){
 		p->setVoltageMode(static_cast<VOLTAGE_MODE>(task_element->FindAttribute("mode")->IntValue()));
 	}
@@ -321,8 +353,9 @@ bool I2CVoltageTask::isConnected(){
 }
 
 double I2CVoltageTask::readCurrentDutyCycle(){
-	int OCR1A = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_OCR1A);
-	int OCR1C = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_OCR1C);
+	std::vector<int> OCR1 = connection->readRegisters(I2C_ATTINY45_VOLT_BUFFER_OCR1A, 2); // OCR1A, OCR1C
+	int OCR1A = (OCR1.empty() ? -1 : OCR1[0]);
+	int OCR1C = (OCR1.empty() ? -1 : OCR1[1]);
 	
 	double dutyCycle = (((double) OCR1A) / ((double) OCR1C));
 	
@@ -332,19 +365,21 @@ double I2CVoltageTask::readCurrentDutyCycle(){
 }
 
 double I2CVoltageTask::readVoltage(){
-	int ADCL = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCL);
-	int ADCH = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCH);
+	std::vector<int> ADC_LH = connection->readRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL, 2); // reading ADCL latches ADCH
+	int ADCL = (ADC_LH.empty() ? -1 : ADC_LH[0]);
+	int ADCH = (ADC_LH.empty() ? -1 : ADC_LH[1]);
 	int ADC = ADCH * 256 + ADCL;
 	
-	double voltage = (((double)VOLTAGE_ATTINY45_R2) + ((double) VOLTAGE_ATTINY45_R1)) / ((double) VOLTAGE_ATTINY45_R2) / ((double) VOLTAGE_ATTINY45_R_CORR) * ((double) ADC) / 1023.0 * 5.0;
+	double voltage = VoltageSettler::toVoltage(ADC);
 //	std::cout << "ADCL: " << ADCL << "\tADCH: " << ADCH << "\ADC: " << ADC << std::endl;
 	
 	return voltage;
 }
 double I2CVoltageTask::readExternalVoltage(){
 	Uc_Connection::Uc_Connection_ptr atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
-	int ADCL = atmega32->readRegister(I2C_ATMEGA32_BUFFER_ADCL);
-	int ADCH = atmega32->readRegister(I2C_ATMEGA32_BUFFER_ADCH);
+	std::vector<int> ADC_LH = atmega32->readRegisters(I2C_ATMEGA32_BUFFER_ADCL, 2);
+	int ADCL = (ADC_LH.empty() ? -1 : ADC_LH[0]);
+	int ADCH = (ADC_LH.empty() ? -1 : ADC_LH[1]);
 	int ADC = ADCH * 256 + ADCL;
 	double ext_voltage = (((double) VOLTAGE_ATMEGA32_R1) + ((double) VOLTAGE_ATMEGA32_R2)) / ((double) VOLTAGE_ATMEGA32_R2) / ((double) VOLTAGE_ATMEGA32_R_CORR) * ((double) ADC) / 1023.0 * 5.0;
 	
@@ -352,12 +387,13 @@ double I2CVoltageTask::readExternalVoltage(){
 }
 
 double I2CVoltageTask::readSetpointVoltage(){
-	int ADCL = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCL_S);
-	int ADCH = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_ADCH_S);
+	std::vector<int> ADC_LH = connection->readRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, 2);
+	int ADCL = (ADC_LH.empty() ? -1 : ADC_LH[0]);
+	int ADCH = (ADC_LH.empty() ? -1 : ADC_LH[1]);
 	
 	int ADC = ADCH * 256 + ADCL;
 	
-	double voltage = (((double)VOLTAGE_ATTINY45_R2) + ((double) VOLTAGE_ATTINY45_R1)) / ((double) VOLTAGE_ATTINY45_R2) / ((double) VOLTAGE_ATTINY45_R_CORR) * ((double) ADC) / 1024.0 * 5.0;
+	double voltage = VoltageSettler::toSetpointVoltage(ADC);
 //	std::cout << "ADCL: " << ADCL << "\tADCH: " << ADCH << "\ADC: " << ADC << std::endl;
 	return voltage;
 }
@@ -375,6 +411,14 @@ bool I2CVoltageTask::getWaitForVoltage() const{
 	return waitForVoltage;
 }
 
+void I2CVoltageTask::setClosedLoop(bool closedLoop){
+	I2CVoltageTask::closedLoop = closedLoop;
+}
+
+bool I2CVoltageTask::getClosedLoop() const{
+	return closedLoop;
+}
+
 void I2CVoltageTask::setVoltageMode(I2CVoltageTask::VOLTAGE_MODE mode){
 	I2CVoltageTask::mode = mode;
 }
@@ -413,11 +457,11 @@ I2CVoltageTask::VOLTAGE_MODE I2CVoltageTask::readCurrentMode(){
 }
 
 int I2CVoltageTask::readFrequency(){
-	int freq0 = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ0);
-	int freq1 = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ1);
-	int freq2 = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ2);
-	int freq3 = connection->readRegister(I2C_ATTINY45_VOLT_BUFFER_FREQ3);
-	int freq = freq0 + (freq1 << 8) + (freq2 << 16) + (freq3 << 24);
+	std::vector<int> f = connection->readRegisters(I2C_ATTINY45_VOLT_BUFFER_FREQ0, 4);
+	if (f.empty()){
+		return -1;
+	}
+	int freq = f[0] + (f[1] << 8) + (f[2] << 16) + (f[3] << 24);
 	
 	return freq;
 }
@@ -436,6 +480,9 @@ std::list<Task::DEVICES> I2CVoltageTask::getNecessaryDevices(){
 	
 	return devices;
 }
+bool I2CVoltageTask::isBarrier(){
+	return false;
+}
 
 I2CVoltageTask::TimePoint I2CVoltageTask::getCurrentTime(){
 	return std::chrono::system_clock::now();
@@ -445,4 +492,65 @@ double I2CVoltageTask::getElapsedSeconds(I2CVoltageTask::TimePoint startTime){
 	std::chrono::duration<double> elapsed_seconds = getCurrentTime() - startTime;
 	
 	return elapsed_seconds.count();
+}
+void I2CVoltageTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	unsigned int reads = (mode == VOLTAGE_MODE::MODE_EXTERN ? 1 : 2); // relais reads of execute
+	hints.relaisSynced = state.isRelaisSynced();
+	hints.setpointActive = (mode == VOLTAGE_MODE::MODE_CONTROLLER && state.isVoltage(voltage, mode) && state.isRelais(Relais::RELAIS::R_STEUER_HV_EXT, true));
+	
+	if (hints.setpointActive){
+		report.setpoints++;
+		report.relaisReads += reads;
+		report.savedMs += reads * RELAIS_ACCESS_TIME_MS;
+		if (voltage > 0 && waitForVoltage){ // min. time to check the voltage
+			report.savedMs += VOLTAGE_SETTLE_HOLD_MS;
+		}
+	}else if (hints.relaisSynced){
+		report.relaisReads += reads;
+		report.savedMs += reads * RELAIS_ACCESS_TIME_MS;
+	}
+	
+	state.setRelais(Relais::RELAIS::R_STEUER_HV_EXT, mode != VOLTAGE_MODE::MODE_EXTERN);
+	state.forgetRelais(Relais::RELAIS::R_STEUER_SAFETY);
+	state.forgetRelais(Relais::RELAIS::R_STEUER_BOOST_IN);
+	if (mode == VOLTAGE_MODE::MODE_CONTROLLER && voltage > 0 && !waitForVoltage){ // the voltage is not confirmed -> a following task sets it again
+		state.forgetVoltage();
+	}else{
+		state.setVoltage(voltage, mode); // assumed to succeed - execute() checks activeSetpoint before it skips a following task
+	}
+}
+void I2CVoltageTask::simulate(Simulator &sim){
+	const ExecutionHints &h = sim.getHints();
+	if (h.setpointActive){
+		return;
+	}
+	const SimulationModel &model = sim.getModel();
+	double relaisReadMs = (h.relaisSynced ? 0 : model.relaisAccessMs);
+	
+	sim.wait(relaisReadMs); // source relais
+	if (mode == VOLTAGE_MODE::MODE_EXTERN){
+		sim.wait(2 * model.i2cAccessMs); // measure the external voltage
+		sim.setVoltage(voltage);
+		
+	}else if (voltage == 0){
+		sim.wait(relaisReadMs + model.relaisAccessMs);
+		sim.setVoltage(0);
+		
+	}else if (mode == VOLTAGE_MODE::MODE_DUTY_CYCLE){
+		sim.wait(2 * model.i2cAccessMs + relaisReadMs + model.relaisAccessMs);
+		
+	}else{ // MODE_CONTROLLER
+		sim.wait(5 * model.i2cAccessMs + VOLTAGE_SETPOINT_ACCEPT_MS + relaisReadMs + model.relaisAccessMs);
+		if (waitForVoltage){
+			double ms = 0;
+			if (sim.getVoltage() > voltage * 1.2){ // discharge the capacitor
+				ms += std::min((sim.getVoltage() - voltage) / model.voltageDischargeVPerS * 1000.0, (double) VOLTAGE_DISCHARGE_TIMEOUT_MS) + relaisReadMs + 2 * model.relaisAccessMs;
+			}else if (sim.getVoltage() < voltage * (1.0 - VOLTAGE_SETTLE_TOLERANCE)){ // ramp into the band
+				ms += std::min((voltage * (1.0 - VOLTAGE_SETTLE_TOLERANCE) - sim.getVoltage()) / model.voltageRampVPerS * 1000.0, (double) VOLTAGE_SETTLE_TIMEOUT_MS);
+			}
+			ms += VOLTAGE_SETTLE_HOLD_MS;
+			sim.wait(std::ceil(ms));
+		}
+		sim.setVoltage(voltage);
+	}
 }
\ No newline at end of file
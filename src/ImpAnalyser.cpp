@@ -1,10 +1,24 @@
 #include "ImpAnalyser.h"
 #include "FSHelper.h"
+#include "Trace.h"
+
+#include <cmath>
 
 ImpAnalyser::ImpAnalyser(){
 	wire_mode = WIRE_MODE::FOUR_WIRE;
 }
 
+Spectrum ImpAnalyser::measureSpectrum(CancellationToken::CancellationToken_ptr token){
+	Trace::Span span("sweep", getType(), "points", getPoints());
+	Spectrum spectrum;
+	spectrum.reserve(getPoints());
+	
+	streamSpectrum([&spectrum](double x, double y_real, double y_imag, unsigned int index){
+		spectrum.add(x, y_real, y_imag);
+	}, token);
+	return spectrum;
+}
+
 void ImpAnalyser::setStartFrequency(int staFreq){
 	if (staFreq < getMinFreq()){
 		staFreq = getMinFreq();
@@ -71,8 +85,15 @@ int ImpAnalyser::getPoints() const{
 int ImpAnalyser::getPointAverage() const{
 	return pointAverage;
 }
+double ImpAnalyser::getPointFrequency(int i) const{
+	double startFrequency_log = std::log10(startFrequency);
+	double stopFrequency_log = std::log10(stopFrequency);
+	double step_log = (points > 1 ? (stopFrequency_log - startFrequency_log) / (points-1): 0);
+	
+	return std::pow(10, startFrequency_log + i * step_log);
+}
 
-void ImpAnalyser::save_spectrumCSV(const std::vector<DataP::DataP_ptr>& spectre, std::string path, int position, double timediff){
+void ImpAnalyser::save_spectrumCSV(const Spectrum& spectre, std::string path, int position, double timediff){
 	std::string header = "";
 	
 	if (position =! -1){
@@ -97,4 +118,22 @@ ImpAnalyser::WIRE_MODE ImpAnalyser::getWireMode(){
 }
 void ImpAnalyser::setWireMode(ImpAnalyser::WIRE_MODE w){
 	wire_mode = w;
+}
+void ImpAnalyser::getWireModeRelais(WIRE_MODE w, bool &re_p_ce, bool &we_p_we_s){
+	switch(w){
+	case WIRE_MODE::TWO_WIRE:
+		re_p_ce = true;
+		we_p_we_s = true;
+		break;
+		
+	case WIRE_MODE::THREE_WIRE:
+		re_p_ce = false;
+		we_p_we_s = true;
+		break;
+		
+	default:
+		re_p_ce = false;
+		we_p_we_s = false;
+		break;
+	}
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "Novocontrol.h"
 #include "HP4294A.h"
 #include "EmStatPico.h"
+#include "Addresses.h"
+#include "Simulator.h"
 
 #include <iostream>
 
@@ -12,66 +14,60 @@ ImpAnalyserTask::~ImpAnalyserTask(){
 	
 }
 
-void ImpAnalyserTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void ImpAnalyserTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	try{
-		relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
-		//relais->writeRelais();
-		//usleep(51*1000);
-		relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true); //Imp measurement
-		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to imp measurement", Log_Event::LOG_INFO));
-		
-		usleep(51*1000);
-		
-		if (impAnalyser->getInternal()){ // internal imp analyser
-			relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, false); //internal measurement
-			relais->writeRelais();
-			addLogEvent(Log_Event::create("switched relais", "switched relais to internal imp measurement", Log_Event::LOG_INFO));
-		}else{
-			relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
+		if (!hints.impRelaisOn){ // not switched to imp measurement by the previous task
+			relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
+			//relais->writeRelais();
+			//usleep(51*1000);
+			relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true); //Imp measurement
 			relais->writeRelais();
-			addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
+			addLogEvent(Log_Event::create("switched relais", "switched relais to imp measurement", Log_Event::LOG_INFO));
+			
+			usleep(IMP_RELAIS_SETTLE_MS * 1000);
 		}
 		
-
+		if (!hints.sourceSet){
+			if (impAnalyser->getInternal()){ // internal imp analyser
+				relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, false); //internal measurement
+				relais->writeRelais();
+				addLogEvent(Log_Event::create("switched relais", "switched relais to internal imp measurement", Log_Event::LOG_INFO));
+			}else{
+				relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
+				relais->writeRelais();
+				addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
+			}
+		}
 		
-		switch(impAnalyser->getWireMode()){
-		case ImpAnalyser::WIRE_MODE::TWO_WIRE:
-			relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, true);
-			relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, true);
-			break;
-			
-		case ImpAnalyser::WIRE_MODE::THREE_WIRE:
-			relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, false);
-			relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, true);
-			break;
-			
-		default:
-			relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, false);
-			relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, false);
-			break;
+		if (!hints.wireModeSet){
+			bool re_p_ce, we_p_we_s;
+			ImpAnalyser::getWireModeRelais(impAnalyser->getWireMode(), re_p_ce, we_p_we_s);
+			relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce);
+			relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
+			relais->writeRelais();
+			addLogEvent(Log_Event::create("switched relais", "switched relais to configure " + std::to_string(impAnalyser->getWireMode()) + "-wire mode", Log_Event::LOG_INFO));
 		}
-		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to configure " + std::to_string(impAnalyser->getWireMode()) + "-wire mode", Log_Event::LOG_INFO));
 		
 		
 		status_leds->impMeasRunning(true);
 		status_leds->write_reg_val();
 		
 		addLogEvent(Log_Event::create("imp. measurement start", impAnalyser->getType() + " triggered to measure - " + getParams(), Log_Event::LOG_INFO));
-		data->addImpedanceSpectrum(impAnalyser->measureSpectrum(executeNext));
+		data->addImpedanceSpectrum(impAnalyser->measureSpectrum(token));
 		addLogEvent(Log_Event::create("imp. measurement done", impAnalyser->getType() + " is done - " + getParams(), Log_Event::LOG_INFO));
 		
-		//relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
-		relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
-		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
-		
-		usleep(51*1000);
-		
-		relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, false); //Imp measurement
-		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to ewod mode", Log_Event::LOG_INFO));
+		if (!hints.keepImpRelaisOn){ // the next task does not measure the impedance
+			//relais->setRelais(Relais::RELAIS::R_STEUER_AC, false);
+			relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
+			relais->writeRelais();
+			addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
+			
+			usleep(IMP_RELAIS_SETTLE_MS * 1000);
+			
+			relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, false); //Imp measurement
+			relais->writeRelais();
+			addLogEvent(Log_Event::create("switched relais", "switched relais to ewod mode", Log_Event::LOG_INFO));
+		}
 		
 		status_leds->impMeasRunning(false);
 		status_leds->write_reg_val();
@@ -145,3 +141,69 @@ std::list<Task::DEVICES> ImpAnalyserTask::getNecessaryDevices(){
 	
 	return devices;
 }
+std::list<Task::DEVICES> ImpAnalyserTask::getUsedDevices(){
+	std::list<Task::DEVICES> devices = Task::getUsedDevices();
+	
+	devices.push_back(Task::DEVICES::DEVICE_ATMEGA_GENERAL);
+	devices.push_back(Task::DEVICES::DEVICE_ELECTRODES);
+	
+	return devices;
+}
+bool ImpAnalyserTask::isBarrier(){
+	return false;
+}
+void ImpAnalyserTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	bool internal = impAnalyser->getInternal();
+	bool re_p_ce, we_p_we_s;
+	ImpAnalyser::getWireModeRelais(impAnalyser->getWireMode(), re_p_ce, we_p_we_s);
+	
+	hints.impRelaisOn = state.isRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true) && state.isRelais(Relais::RELAIS::R_STEUER_AC, false);
+	hints.sourceSet = state.isRelais(Relais::RELAIS::R_STEUER_EXT_PICO, !internal);
+	hints.wireModeSet = state.isRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce) && state.isRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
+	// hints.keepImpRelaisOn is set by CompiledRecipe
+	
+	if (hints.impRelaisOn){
+		report.relaisWrites++;
+		report.settleDelays++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS + IMP_RELAIS_SETTLE_MS;
+	}
+	if (hints.sourceSet){
+		report.relaisWrites++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	if (hints.wireModeSet){
+		report.relaisWrites++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	if (hints.keepImpRelaisOn){
+		report.relaisWrites += 2;
+		report.settleDelays++;
+		report.savedMs += 2 * RELAIS_ACCESS_TIME_MS + IMP_RELAIS_SETTLE_MS;
+	}
+	
+	state.setRelais(Relais::RELAIS::R_STEUER_AC, false);
+	state.setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce);
+	state.setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
+	state.setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, hints.keepImpRelaisOn ? !internal : true);
+	state.setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, hints.keepImpRelaisOn);
+}
+void ImpAnalyserTask::simulate(Simulator &sim){
+	const ExecutionHints &h = sim.getHints();
+	const SimulationModel &model = sim.getModel();
+	
+	if (!h.impRelaisOn){
+		sim.wait(model.relaisAccessMs + model.relaisSettleMs);
+	}
+	if (!h.sourceSet){
+		sim.wait(model.relaisAccessMs);
+	}
+	if (!h.wireModeSet){
+		sim.wait(model.relaisAccessMs);
+	}
+	sim.wait(2 * model.i2cAccessMs); // status leds
+	sim.wait(sim.getSweepMs(*impAnalyser));
+	sim.wait(2 * model.i2cAccessMs);
+	if (!h.keepImpRelaisOn){
+		sim.wait(2 * model.relaisAccessMs + model.relaisSettleMs);
+	}
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <map>
 
 ListView_SavedData::ListView_SavedData(BaseObjectType* cobject, const Glib::RefPtr<Gtk::Builder>& builder): Gtk::TreeView(cobject){
 	m_refTreeModel = Gtk::TreeStore::create(m_colums);
@@ -20,10 +21,22 @@ ListView_SavedData::~ListView_SavedData(){
 }
 
 void ListView_SavedData::scanFolder(std::string path){
-	std::vector<std::string> content = FSHelper::getFolderContent(path, false);
-	
 	m_refTreeModel->clear();
 	
+	std::string experimentPath = path.substr(0, path.find_last_of("/"));
+	if (ExperimentManifest::exists(experimentPath)){ // read the measurement files from the manifest
+		std::vector<ExperimentManifest::Entry> entries = ExperimentManifest::open(experimentPath)->getEntries();
+		for (std::vector<ExperimentManifest::Entry>::const_iterator cit = entries.cbegin(); cit != entries.cend(); cit++){
+			if (cit->type == ExperimentManifest::ENTRY_TYPE::ENTRY_MEASUREMENTS){
+				addMeasurementFile(FSHelper::composePath(experimentPath, cit->path));
+			}
+		}
+		return;
+	}
+	
+	// experiment without manifest - parse the file names
+	std::vector<std::string> content = FSHelper::getFolderContent(path, false);
+	
 	for (std::vector<std::string>::iterator it = content.begin(); it != content.end(); it++){
 		std::string filename = it->substr(it->find_last_of("/")+1);
 		std::string filename_without_ending = filename.substr(0, filename.find_last_of("."));
@@ -33,6 +46,8 @@ void ListView_SavedData::scanFolder(std::string path){
 			addImpSpectrum(*it, filename_without_ending);
 		}else if (filename_without_ending.find("opt_spectrum") == 0){ //spectrum data
 			addSpectrum(*it, filename_without_ending);
+		}else if (FSHelper::endsWith(filename, std::string(".") + MEASUREMENT_FILE_EXTENSION)){ //measurement file
+			addMeasurementFile(*it);
 		}
 	}
 }
@@ -65,6 +80,7 @@ void ListView_SavedData::addSpectrum(std::string path, std::string filename){
 		row[m_colums.m_col_spectrumNumber] = std::stoi(number);
 		row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::SPECTRUM;
 		row[m_colums.m_col_spectrumType_string] = "Spectrum";
+		row[m_colums.m_col_recordIndex] = -1;
 	}
 }
 void ListView_SavedData::addImpSpectrum(std::string path, std::string filename){
@@ -78,6 +94,7 @@ void ListView_SavedData::addImpSpectrum(std::string path, std::string filename){
 		row[m_colums.m_col_spectrumNumber] = std::stoi(number);
 		row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::IMPEDANCE;
 		row[m_colums.m_col_spectrumType_string] = "Impedance";
+		row[m_colums.m_col_recordIndex] = -1;
 	}
 }
 void ListView_SavedData::addTransImpSpectrum(std::string path, std::string filename){
@@ -108,6 +125,7 @@ void ListView_SavedData::addTransImpSpectrum(std::string path, std::string filen
 			transientSpectrumRow[m_colums.m_col_spectrumNumber] = trans_spectrum_no;
 			transientSpectrumRow[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::TRANSIENT;
 			transientSpectrumRow[m_colums.m_col_spectrumType_string] = "Transient";
+			transientSpectrumRow[m_colums.m_col_recordIndex] = -1;
 		}
 		
 		Gtk::TreeModel::Row row = *(m_refTreeModel->append(transientSpectrumRow.children()));
@@ -115,6 +133,58 @@ void ListView_SavedData::addTransImpSpectrum(std::string path, std::string filen
 		row[m_colums.m_col_spectrumNumber] = spectrum_no;
 		row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::IMPEDANCE;
 		row[m_colums.m_col_spectrumType_string] = "Impedance";
+		row[m_colums.m_col_recordIndex] = -1;
+	}
+}
+void ListView_SavedData::addMeasurementFile(std::string path){
+	if (!pathAlreadyInView(path)){
+		MeasurementFileReader::MeasurementFileReader_ptr reader;
+		try{
+			reader = MeasurementFileReader::create(path);
+		}catch (std::runtime_error &e){
+			std::cout << "ListView_SavedData::addMeasurementFile - " << e.what() << std::endl;
+			return;
+		}
+		
+		std::map<unsigned int, Gtk::TreeModel::Row> transientSpectrumRows; // series no -> row of the transient spectrum
+		for (std::size_t i = 0; i < reader->getRecordCount(); i++){
+			const MeasurementFileReader::Record &r = reader->getRecord(i);
+			Gtk::TreeModel::Row row;
+			
+			switch (r.type){
+				case MeasurementFile::RECORD_TYPE::RECORD_SPECTRUM:
+					row = *(m_refTreeModel->append());
+					row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::SPECTRUM;
+					row[m_colums.m_col_spectrumType_string] = "Spectrum";
+					break;
+				case MeasurementFile::RECORD_TYPE::RECORD_IMPEDANCE:
+					row = *(m_refTreeModel->append());
+					row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::IMPEDANCE;
+					row[m_colums.m_col_spectrumType_string] = "Impedance";
+					break;
+				case MeasurementFile::RECORD_TYPE::RECORD_TRANS_IMPEDANCE:{
+					std::map<unsigned int, Gtk::TreeModel::Row>::iterator it = transientSpectrumRows.find(r.series);
+					if (it == transientSpectrumRows.end()){ // first spectrum of the transient spectrum
+						Gtk::TreeModel::Row transientSpectrumRow = *(m_refTreeModel->append());
+						transientSpectrumRow[m_colums.m_col_spectrumPath] = path;
+						transientSpectrumRow[m_colums.m_col_spectrumNumber] = r.series;
+						transientSpectrumRow[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::TRANSIENT;
+						transientSpectrumRow[m_colums.m_col_spectrumType_string] = "Transient";
+						transientSpectrumRow[m_colums.m_col_recordIndex] = -1;
+						it = transientSpectrumRows.insert(std::make_pair(r.series, transientSpectrumRow)).first;
+					}
+					row = *(m_refTreeModel->append(it->second.children()));
+					row[m_colums.m_col_spectrumType] = SPECTRUM_TYPE::IMPEDANCE;
+					row[m_colums.m_col_spectrumType_string] = "Impedance";
+					break;
+				}
+				default:
+					continue;
+			}
+			row[m_colums.m_col_spectrumPath] = path;
+			row[m_colums.m_col_spectrumNumber] = r.position;
+			row[m_colums.m_col_recordIndex] = i;
+		}
 	}
 }
 	
@@ -147,6 +217,27 @@ std::string ListView_SavedData::getSelectedSpectrumPath(){
 	}
 	return "";
 }
+bool ListView_SavedData::isMeasurementFileSelected(){
+	return FSHelper::endsWith(getSelectedSpectrumPath(), std::string(".") + MEASUREMENT_FILE_EXTENSION);
+}
+int ListView_SavedData::getSelectedRecordIndex(){
+	Gtk::TreeModel::iterator it = get_selection()->get_selected();
+	
+	if(it) { //something is selected
+		Gtk::TreeModel::Row row = *it;
+		return row[m_colums.m_col_recordIndex];
+	}
+	return -1;
+}
+int ListView_SavedData::getSelectedSpectrumNumber(){
+	Gtk::TreeModel::iterator it = get_selection()->get_selected();
+	
+	if(it) { //something is selected
+		Gtk::TreeModel::Row row = *it;
+		return row[m_colums.m_col_spectrumNumber];
+	}
+	return -1;
+}
 ListView_SavedData::SPECTRUM_TYPE ListView_SavedData::getSelectedSpectrumType(){
 	Gtk::TreeModel::iterator it = get_selection()->get_selected();
 	
@@ -0,0 +1,72 @@
+#include "MeasurementFile.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <ctime>
+#include <unistd.h>
+
+MeasurementFile::MeasurementFile_ptr MeasurementFile::create(std::string path){
+	return MeasurementFile_ptr(new MeasurementFile(path));
+}
+MeasurementFile::MeasurementFile(std::string path): path(path){
+	file = fopen(path.c_str(), "ab");
+	if (file == nullptr){
+		throw std::runtime_error("could not open measurement file " + path);
+	}
+	
+	fseek(file, 0, SEEK_END);
+	if (ftell(file) == 0){ // new file -> write header
+		FileHeader header;
+		std::memset(&header, 0, sizeof(header));
+		std::memcpy(header.magic, MEASUREMENT_FILE_MAGIC, sizeof(header.magic));
+		header.version = MEASUREMENT_FILE_VERSION;
+		header.headerSize = sizeof(FileHeader);
+		header.created = std::time(0);
+		
+		if (fwrite(&header, sizeof(header), 1, file) != 1){
+			fclose(file);
+			throw std::runtime_error("could not write header of measurement file " + path);
+		}
+		fflush(file);
+	}
+}
+MeasurementFile::~MeasurementFile(){
+	fclose(file);
+}
+
+std::size_t MeasurementFile::append(RECORD_TYPE type, unsigned int series, unsigned int position, double timestamp, const Spectrum &s){
+	RecordHeader header;
+	std::memset(&header, 0, sizeof(header));
+	header.magic = MEASUREMENT_FILE_RECORD_MAGIC;
+	header.type = type;
+	header.series = series;
+	header.position = position;
+	header.timestamp = timestamp;
+	header.points = s.size();
+	
+	fileMtx.lock();
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	if (ok && header.points > 0){
+		ok = fwrite(s.getXData(), sizeof(double), header.points, file) == header.points
+			&& fwrite(s.getRealData(), sizeof(double), header.points, file) == header.points
+			&& fwrite(s.getImagData(), sizeof(double), header.points, file) == header.points;
+	}
+	fileMtx.unlock();
+	
+	if (!ok){
+		throw std::runtime_error("could not write spectrum to measurement file " + path);
+	}
+	return sizeof(header) + 3 * sizeof(double) * header.points;
+}
+void MeasurementFile::flush(bool sync){
+	fileMtx.lock();
+	fflush(file);
+	if (sync){
+		fsync(fileno(file));
+	}
+	fileMtx.unlock();
+}
+
+std::string MeasurementFile::getPath() const{
+	return path;
+}
@@ -0,0 +1,108 @@
+#include "MeasurementFileReader.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MeasurementFileReader::MeasurementFileReader_ptr MeasurementFileReader::create(std::string path){
+	return MeasurementFileReader_ptr(new MeasurementFileReader(path));
+}
+MeasurementFileReader::MeasurementFileReader(std::string path): path(path){
+	map = nullptr;
+	mapSize = 0;
+	
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0){
+		throw std::runtime_error("could not open measurement file " + path);
+	}
+	
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(MeasurementFile::FileHeader)){
+		close(fd);
+		throw std::runtime_error("no valid measurement file " + path);
+	}
+	mapSize = st.st_size;
+	
+	void* m = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+	if (m == MAP_FAILED){
+		close(fd);
+		throw std::runtime_error("could not map measurement file " + path);
+	}
+	map = static_cast<const char*>(m);
+	
+	const MeasurementFile::FileHeader* header = reinterpret_cast<const MeasurementFile::FileHeader*>(map);
+	if (std::memcmp(header->magic, MEASUREMENT_FILE_MAGIC, sizeof(header->magic)) != 0 || header->version != MEASUREMENT_FILE_VERSION){
+		munmap(const_cast<char*>(map), mapSize);
+		close(fd);
+		throw std::runtime_error("no valid measurement file " + path);
+	}
+	
+	buildIndex();
+}
+MeasurementFileReader::~MeasurementFileReader(){
+	munmap(const_cast<char*>(map), mapSize);
+	close(fd);
+}
+
+/*
+ * jump from record header to record header, stop at the first incomplete / invalid record
+ */
+void MeasurementFileReader::buildIndex(){
+	const MeasurementFile::FileHeader* fileHeader = reinterpret_cast<const MeasurementFile::FileHeader*>(map);
+	std::size_t pos = fileHeader->headerSize;
+	
+	while (pos + sizeof(MeasurementFile::RecordHeader) <= mapSize){
+		const MeasurementFile::RecordHeader* header = reinterpret_cast<const MeasurementFile::RecordHeader*>(map + pos);
+		std::size_t available = mapSize - pos - sizeof(MeasurementFile::RecordHeader);
+		if (header->magic != MEASUREMENT_FILE_RECORD_MAGIC || header->points > available / (3 * sizeof(double))){ // invalid / incomplete
+			break;
+		}
+		std::size_t payloadSize = 3 * sizeof(double) * header->points;
+		
+		Record r;
+		r.type = static_cast<MeasurementFile::RECORD_TYPE>(header->type);
+		r.series = header->series;
+		r.position = header->position;
+		r.timestamp = header->timestamp;
+		r.points = header->points;
+		r.offset = pos + sizeof(MeasurementFile::RecordHeader);
+		records.push_back(r);
+		
+		pos = r.offset + payloadSize;
+	}
+}
+
+std::size_t MeasurementFileReader::getRecordCount() const{
+	return records.size();
+}
+const MeasurementFileReader::Record& MeasurementFileReader::getRecord(std::size_t i) const{
+	return records.at(i);
+}
+
+Spectrum MeasurementFileReader::getSpectrum(std::size_t i) const{
+	const Record &r = records.at(i);
+	const double* x = reinterpret_cast<const double*>(map + r.offset);
+	const double* y_real = x + r.points;
+	const double* y_imag = y_real + r.points;
+	
+	Spectrum s;
+	s.assign(x, y_real, y_imag, r.points);
+	return s;
+}
+
+std::vector<std::size_t> MeasurementFileReader::getRecords(MeasurementFile::RECORD_TYPE type, unsigned int series) const{
+	std::vector<std::size_t> indices;
+	for (std::size_t i = 0; i < records.size(); i++){
+		if (records[i].type == type && (type != MeasurementFile::RECORD_TYPE::RECORD_TRANS_IMPEDANCE || records[i].series == series)){
+			indices.push_back(i);
+		}
+	}
+	return indices;
+}
+
+std::string MeasurementFileReader::getPath() const{
+	return path;
+}
@@ -30,7 +30,7 @@ std::string MeasurementPackage::to_string() const{
 void MeasurementPackage::parseLine(std::string line){
 	if (line.at(0) == 'P'){ // Package data
 		
-		unsigned int posLastCSemicolon = 0; // skip first character
+		std::size_t posLastCSemicolon = 0; // skip first character
 		
 		while(posLastCSemicolon != std::string::npos){
 			std::string partString = line.substr(posLastCSemicolon + 1, line.find(';', posLastCSemicolon + 1) - (posLastCSemicolon + 1));
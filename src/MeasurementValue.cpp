@@ -214,7 +214,7 @@ void MeasurementValue::parse(std::string line){
 		int valueWP = MeasurementValue::hexStrToInt(hexValueWO) - 0x8000000;  // value without prefix
 		value = valueWP * getPrefix(prefix);
 		
-		unsigned int posLastComma = line.find(',', 0);
+		std::size_t posLastComma = line.find(',', 0);
 		while(posLastComma != std::string::npos){
 			std::string partString = line.substr(posLastComma + 1, line.find(',', posLastComma + 1) - (posLastComma + 1));
 			posLastComma = line.find(',', posLastComma + 1);
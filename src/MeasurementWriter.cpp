@@ -0,0 +1,192 @@
+#include "MeasurementWriter.h"
+#include "Trace.h"
+
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+
+MeasurementWriter::MeasurementWriter_ptr MeasurementWriter::create(std::string path, std::size_t queueSize){
+	return MeasurementWriter_ptr(new MeasurementWriter(path, queueSize));
+}
+MeasurementWriter::MeasurementWriter(std::string path, std::size_t queueSize): queueSize(queueSize){
+	file = MeasurementFile::create(path);
+	flushPolicy = FLUSH_POLICY::FLUSH_WHEN_IDLE;
+	flushInterval_ms = MEASUREMENT_WRITER_FLUSH_INTERVAL_MS;
+	fsyncEnabled = false;
+	backpressure = BACKPRESSURE::BACKPRESSURE_BLOCK;
+	busy = false;
+	dirty = false;
+	flushRequested = false;
+	stats = Statistics();
+	latencySum_ms = 0;
+	
+	running = true;
+	writer_thread = std::thread(&MeasurementWriter::writeThread, this);
+}
+MeasurementWriter::~MeasurementWriter(){
+	queueMtx.lock();
+	running = false;
+	queueMtx.unlock();
+	queueNotEmpty.notify_all();
+	
+	if (writer_thread.joinable()){
+		writer_thread.join();
+	}
+}
+
+bool MeasurementWriter::write(MeasurementFile::RECORD_TYPE type, unsigned int series, unsigned int position, double timestamp, const Spectrum &s){
+	std::unique_lock<std::mutex> lock(queueMtx);
+	if (queue.size() >= queueSize){
+		if (backpressure == BACKPRESSURE::BACKPRESSURE_DROP){
+			stats.recordsDropped++;
+			return false;
+		}
+		queueNotFull.wait(lock, [this]{return queue.size() < queueSize;});
+	}
+	
+	Job job;
+	job.type = type;
+	job.series = series;
+	job.position = position;
+	job.timestamp = timestamp;
+	job.spectrum = s;
+	queue.push_back(job);
+	
+	if (queue.size() > stats.maxQueueDepth){
+		stats.maxQueueDepth = queue.size();
+	}
+	lock.unlock();
+	queueNotEmpty.notify_one();
+	
+	return true;
+}
+
+void MeasurementWriter::flush(bool sync){
+	try{
+		file->flush(sync);
+	}catch (std::runtime_error &e){
+		std::cout << "MeasurementWriter::flush - " << e.what() << std::endl;
+	}
+}
+
+void MeasurementWriter::writeThread(){
+	Trace::setThreadName("measurement writer");
+	std::chrono::steady_clock::time_point lastFlush = std::chrono::steady_clock::now();
+	std::unique_lock<std::mutex> lock(queueMtx);
+	
+	while (true){
+		if (queue.empty()){
+			if (dirty && (flushPolicy != FLUSH_POLICY::FLUSH_INTERVAL || flushRequested || !running)){ // flush when idle
+				bool sync = fsyncEnabled;
+				dirty = false;
+				lock.unlock();
+				flush(sync);
+				lock.lock();
+				lastFlush = std::chrono::steady_clock::now();
+				continue;
+			}
+			
+			flushRequested = false;
+			allWritten.notify_all();
+			if (!running){
+				break;
+			}
+			
+			if (dirty){ // FLUSH_INTERVAL - wait until the next flush is due
+				std::chrono::steady_clock::time_point nextFlush = lastFlush + std::chrono::milliseconds(flushInterval_ms);
+				if (queueNotEmpty.wait_until(lock, nextFlush) == std::cv_status::timeout && queue.empty()){
+					flushRequested = true;
+				}
+			}else{
+				queueNotEmpty.wait(lock);
+			}
+			continue;
+		}
+		
+		Job job = queue.front();
+		queue.pop_front();
+		FLUSH_POLICY policy = flushPolicy;
+		bool sync = fsyncEnabled;
+		busy = true;
+		lock.unlock();
+		queueNotFull.notify_one();
+		
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		std::size_t bytes = 0;
+		bool error = false;
+		try{
+			Trace::Span span("file", "append record", "points", job.spectrum.size());
+			bytes = file->append(job.type, job.series, job.position, job.timestamp, job.spectrum);
+			if (policy == FLUSH_POLICY::FLUSH_EACH_RECORD){
+				file->flush(sync);
+			}
+		}catch (std::runtime_error &e){
+			std::cout << "MeasurementWriter::writeThread - " << e.what() << std::endl;
+			error = true;
+		}
+		std::chrono::duration<double, std::milli> latency = std::chrono::steady_clock::now() - start;
+		
+		lock.lock();
+		busy = false;
+		if (error){
+			stats.writeErrors++;
+		}else{
+			stats.recordsWritten++;
+			stats.bytesWritten += bytes;
+			stats.lastWriteLatency_ms = latency.count();
+			if (latency.count() > stats.maxWriteLatency_ms){
+				stats.maxWriteLatency_ms = latency.count();
+			}
+			latencySum_ms += latency.count();
+			stats.avgWriteLatency_ms = latencySum_ms / stats.recordsWritten;
+			dirty = (policy != FLUSH_POLICY::FLUSH_EACH_RECORD);
+		}
+		
+		if (dirty && flushPolicy == FLUSH_POLICY::FLUSH_INTERVAL && std::chrono::steady_clock::now() - lastFlush >= std::chrono::milliseconds(flushInterval_ms)){
+			sync = fsyncEnabled;
+			dirty = false;
+			lock.unlock();
+			flush(sync);
+			lock.lock();
+			lastFlush = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+void MeasurementWriter::setFlushPolicy(FLUSH_POLICY policy, unsigned int interval_ms){
+	queueMtx.lock();
+	flushPolicy = policy;
+	flushInterval_ms = interval_ms;
+	queueMtx.unlock();
+	queueNotEmpty.notify_all();
+}
+void MeasurementWriter::setFsync(bool sync){
+	queueMtx.lock();
+	fsyncEnabled = sync;
+	queueMtx.unlock();
+}
+void MeasurementWriter::setBackpressure(BACKPRESSURE b){
+	queueMtx.lock();
+	backpressure = b;
+	queueMtx.unlock();
+}
+
+void MeasurementWriter::waitUntilWritten(){
+	std::unique_lock<std::mutex> lock(queueMtx);
+	flushRequested = true;
+	queueNotEmpty.notify_all();
+	allWritten.wait(lock, [this]{return queue.empty() && !busy && !dirty;});
+}
+
+MeasurementWriter::Statistics MeasurementWriter::getStatistics(){
+	queueMtx.lock();
+	Statistics s = stats;
+	s.queueDepth = queue.size();
+	queueMtx.unlock();
+	
+	return s;
+}
+
+std::string MeasurementWriter::getPath() const{
+	return file->getPath();
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <algorithm>
 #include <math.h>
+#include <chrono>
 
 Novocontrol::Novocontrol(int slaveAddress): connection(slaveAddress){
 	voltage = 0.05;
@@ -64,7 +65,7 @@ void Novocontrol::applyParams(){
 	
 }
 
-DataP::DataP_ptr Novocontrol::measureFreq(double freq){
+DataP::DataP_ptr Novocontrol::measureFreq(double freq, CancellationToken::CancellationToken_ptr token){
 	/* GFR=%1 Set Frequency
 	 * %f1 Frequency [Hz]
 	 * Answer OK
@@ -98,10 +99,14 @@ DataP::DataP_ptr Novocontrol::measureFreq(double freq){
 	 * ...
 	 */
 	 
-	//wait until measurement finished
+	//wait until measurement finished - sleep on the token between the requests
 	connection.send("ZTSTAT?");
 	std::string state = connection.read();
 	while (state.compare("ZTSTAT=1 5") == 0){
+		if (!token->sleepFor(std::chrono::milliseconds(NOVOCONTROL_POLL_INTERVAL_MS))){ // experiment has been stopped
+			sendOKCommand("MBK"); // user break
+			return nullptr;
+		}
 		connection.send("ZTSTAT?");
 		state = connection.read();
 	}
@@ -178,10 +183,9 @@ DataP::DataP_ptr Novocontrol::measureFreq(double freq){
 	return std::make_shared<DataP>(imp_Meausrement_freq_double, imp_Meausrement_real_double, imp_Meausrement_imag_double);
 }
 
-std::vector<DataP::DataP_ptr> Novocontrol::measureSpectrum(bool *running){
+void Novocontrol::streamSpectrum(const PointListener &onPoint, CancellationToken::CancellationToken_ptr token){
 	applyParams();
 	
-	std::vector<DataP::DataP_ptr> data;
 	double startFrequency_log = std::log10(startFrequency);
 	double stopFrequency_log = std::log10(stopFrequency);
 	double range_log = stopFrequency_log - startFrequency_log;
@@ -189,25 +193,30 @@ std::vector<DataP::DataP_ptr> Novocontrol::measureSpectrum(bool *running){
 	
 	applyParams();
 	
-	for (int i = 0; (i < points) && (*running); i++){ // for each frequency
+	for (int i = 0; (i < points) && !token->isCancelled(); i++){ // for each frequency
 		double freq = std::pow(10, startFrequency_log + i * step_log);
 		
 		//measure 'pointAverage' times and calculate the average
-		DataP::DataP_ptr p = measureFreq(freq);
+		DataP::DataP_ptr p = measureFreq(freq, token);
+		if (p == nullptr){ // stopped
+			return;
+		}
 		double x = p->getX();
 		double y_real = p->getY(DataP::COMPLEX_MODE::COMPLEX_REAL);
 		double y_imag = p->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG);
 		
 		for (int i = 1; i < pointAverage; i++){ // measure #pointAverage -1 times and calculate the average
-			p = measureFreq(freq);
+			p = measureFreq(freq, token);
+			if (p == nullptr){ // stopped
+				return;
+			}
 			y_real += p->getY(DataP::COMPLEX_MODE::COMPLEX_REAL);
 			y_imag += p->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG);
 		}
 		y_real /= pointAverage;
 		y_imag /= pointAverage;
-		data.push_back(DataP::create(x, y_real, y_imag));
+		onPoint(x, y_real, y_imag, i);
 	}
-	return data;
 }
 
 tinyxml2::XMLElement* Novocontrol::toXMLElement(tinyxml2::XMLDocument *doc, bool externElements){
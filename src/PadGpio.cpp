@@ -0,0 +1,197 @@
+#include "PadGpio.h"
+#include "SimulatedTransport.h"
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstdio>
+
+// indices 0..N-1 to expand the table at compile time (std::index_sequence is C++14)
+template<unsigned int... I> struct PadIndices{};
+template<unsigned int N, unsigned int... I> struct MakePadIndices: MakePadIndices<N - 1, N - 1, I...>{};
+template<unsigned int... I> struct MakePadIndices<0, I...>{
+	typedef PadIndices<I...> type;
+};
+
+template<unsigned int... I> static constexpr std::array<PadGpio::Masks, sizeof...(I) + 1> makePadMasks(PadIndices<I...>){
+	return std::array<PadGpio::Masks, sizeof...(I) + 1>{{PadGpio::Masks{0, 0}, PadGpio::computeMasks(I + 1)...}}; // index 0: no pad
+}
+
+/// masks of the pads 1..118
+static constexpr std::array<PadGpio::Masks, PAD_GPIO_PADS + 1> padMasks = makePadMasks(MakePadIndices<PAD_GPIO_PADS>::type());
+
+static_assert(PAD_GPIO_PADS == 2 * PAD_GPIO_PADS_PER_PCB, "2 circuit boards");
+static_assert(PadGpio::getPcb(59) == 1 && PadGpio::getUc(59) == 5 && PadGpio::getPadNo(59) == 11, "last pad of the first circuit board");
+static_assert(PadGpio::getPcb(60) == 2 && PadGpio::getUc(60) == 1 && PadGpio::getPadNo(60) == 1, "first pad of the second circuit board");
+static_assert(PadGpio::getPcb(118) == 2 && PadGpio::getUc(118) == 5 && PadGpio::getPadNo(118) == 11, "last pad");
+static_assert((PadGpio::getAdcPins() & PadGpio::getCsPins()) == 0 && ((PadGpio::getAdcPins() | PadGpio::getCsPins()) & PadGpio::getEnablePins()) == 0, "each pin has one function");
+
+const PadGpio::Masks& PadGpio::getMasks(unsigned int pad){
+	return padMasks[(pad <= PAD_GPIO_PADS ? pad : 0)];
+}
+
+void PadGpio::setOutputs(Transport::Transport_ptr gpio){
+	gpio->setOutput(GPIO_ADC_0);
+	gpio->setOutput(GPIO_ADC_1);
+	gpio->setOutput(GPIO_ADC_2);
+	gpio->setOutput(GPIO_ADC_3);
+	
+	gpio->setOutput(GPIO_EN_1);
+	gpio->setOutput(GPIO_EN_2);
+	gpio->setOutput(GPIO_EN_3);
+	gpio->setOutput(GPIO_EN_4);
+	gpio->setOutput(GPIO_EN_5);
+	
+	gpio->setOutput(GPIO_CS_1);
+	gpio->setOutput(GPIO_CS_2);
+}
+
+void PadGpio::setPadHigh(Transport::Transport_ptr gpio, unsigned int pad){
+	if (pad <= PAD_GPIO_PADS && pad > 0){ //valid pad
+		const Masks &m = padMasks[pad];
+		
+		gpio->writePins(m.address, (getAdcPins() | getCsPins()) & ~m.address); // address of the pad
+		gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+		
+		gpio->writePins(m.enable, getEnablePins() & ~m.enable); // uc latches the address
+		gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+		
+		gpio->writePins(0, getEnablePins() | getCsPins());
+	}
+}
+
+void PadGpio::setPadsLow(Transport::Transport_ptr gpio){
+	gpio->writePins(0, getAdcPins());
+	gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+	
+	gpio->writePins(getEnablePins() | getCsPins(), 0); // all ucs latch the address 0
+	gpio->delayMicroseconds(PAD_GPIO_CLEAR_US);
+	
+	gpio->writePins(0, getEnablePins() | getCsPins());
+}
+
+void PadGpio::setPadHighPinwise(Transport::Transport_ptr gpio, unsigned int pad){
+	/*
+	 * 1 circuit borad: 4 uc x 12 pads * 1 uc x 11 pads = 59 pads
+	 * first pad is pad 1 !!
+	 * first pcb is pcb 1 !!
+	 * first uc is uc 1 !!
+	 *
+	 */
+	if (pad <= PAD_GPIO_PADS && pad > 0){ //valid pad
+		int pcb_no; // 1, 2
+		int uc_no;  // 1, .., 5
+		int pad_no; // 1, .., 59
+		
+		pcb_no = std::ceil(((double)pad) / 59.0); // 1, 2
+		uc_no = std::ceil((((double)pad) - double((pcb_no - 1) * 59.0))/ 12.0); // 1, .., 5
+		pad_no = pad - ((pcb_no - 1)*59 + (uc_no - 1) * 12); // 1, .. , 12
+		
+		bool ADC_0 = (((pad_no >> 0) & 1) == 1);
+		bool ADC_1 = (((pad_no >> 1) & 1) == 1);
+		bool ADC_2 = (((pad_no >> 2) & 1) == 1);
+		bool ADC_3 = (((pad_no >> 3) & 1) == 1);
+		
+		bool EN_1 = (uc_no == 1);
+		bool EN_2 = (uc_no == 2);
+		bool EN_3 = (uc_no == 3);
+		bool EN_4 = (uc_no == 4);
+		bool EN_5 = (uc_no == 5);
+		
+		bool CS_1 = (pcb_no == 1);
+		bool CS_2 = (pcb_no == 2);
+		
+		gpio->digitalWrite(GPIO_ADC_0, ADC_0);
+		gpio->digitalWrite(GPIO_ADC_1, ADC_1);
+		gpio->digitalWrite(GPIO_ADC_2, ADC_2);
+		gpio->digitalWrite(GPIO_ADC_3, ADC_3);
+		gpio->digitalWrite(GPIO_CS_1, CS_1);
+		gpio->digitalWrite(GPIO_CS_2, CS_2);
+		
+		gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+		gpio->digitalWrite(GPIO_EN_1, EN_1);
+		gpio->digitalWrite(GPIO_EN_2, EN_2);
+		gpio->digitalWrite(GPIO_EN_3, EN_3);
+		gpio->digitalWrite(GPIO_EN_4, EN_4);
+		gpio->digitalWrite(GPIO_EN_5, EN_5);
+		
+		gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+		
+		gpio->digitalWrite(GPIO_EN_1, false);
+		gpio->digitalWrite(GPIO_EN_2, false);
+		gpio->digitalWrite(GPIO_EN_3, false);
+		gpio->digitalWrite(GPIO_EN_4, false);
+		gpio->digitalWrite(GPIO_EN_5, false);
+		gpio->digitalWrite(GPIO_CS_1, false);
+		gpio->digitalWrite(GPIO_CS_2, false);
+	}
+}
+
+void PadGpio::setPadsLowPinwise(Transport::Transport_ptr gpio){
+	gpio->digitalWrite(GPIO_ADC_0, false);
+	gpio->digitalWrite(GPIO_ADC_1, false);
+	gpio->digitalWrite(GPIO_ADC_2, false);
+	gpio->digitalWrite(GPIO_ADC_3, false);
+	
+	gpio->delayMicroseconds(PAD_GPIO_SETUP_US);
+	gpio->digitalWrite(GPIO_EN_1, true);
+	gpio->digitalWrite(GPIO_EN_2, true);
+	gpio->digitalWrite(GPIO_EN_3, true);
+	gpio->digitalWrite(GPIO_EN_4, true);
+	gpio->digitalWrite(GPIO_EN_5, true);
+	
+	gpio->digitalWrite(GPIO_CS_1, true);
+	gpio->digitalWrite(GPIO_CS_2, true);
+	
+	gpio->delayMicroseconds(PAD_GPIO_CLEAR_US);
+	
+	gpio->digitalWrite(GPIO_EN_1, false);
+	gpio->digitalWrite(GPIO_EN_2, false);
+	gpio->digitalWrite(GPIO_EN_3, false);
+	gpio->digitalWrite(GPIO_EN_4, false);
+	gpio->digitalWrite(GPIO_EN_5, false);
+	
+	gpio->digitalWrite(GPIO_CS_1, false);
+	gpio->digitalWrite(GPIO_CS_2, false);
+}
+
+bool PadGpio::verify(std::string &error){
+	SimulatedTransport::SimulatedTransport_ptr pinwise = SimulatedTransport::create();
+	SimulatedTransport::SimulatedTransport_ptr masks = SimulatedTransport::create();
+	pinwise->setLatency(0, 0);
+	masks->setLatency(0, 0);
+	setOutputs(pinwise);
+	setOutputs(masks);
+	
+	for (unsigned int pad = 0; pad <= PAD_GPIO_PADS; pad++){ // pad 0: all pads low
+		pinwise->recordPins(true);
+		masks->recordPins(true);
+		if (pad == 0){
+			setPadsLowPinwise(pinwise);
+			setPadsLow(masks);
+		}else{
+			setPadHighPinwise(pinwise, pad);
+			setPadHigh(masks, pad);
+		}
+		std::vector<std::uint32_t> expected = pinwise->getRecordedPins();
+		std::vector<std::uint32_t> actual = masks->getRecordedPins();
+		expected.push_back(pinwise->getPins());
+		actual.push_back(masks->getPins());
+		
+		if (expected.size() != actual.size()){
+			error = (pad == 0 ? std::string("all pads low") : "pad " + std::to_string(pad)) + ": " + std::to_string(actual.size()) + " instead of " + std::to_string(expected.size()) + " latches";
+			return false;
+		}
+		for (std::size_t i = 0; i < expected.size(); i++){
+			if (expected[i] != actual[i]){
+				char buffer[64];
+				std::snprintf(buffer, sizeof(buffer), "0x%08x instead of 0x%08x", actual[i], expected[i]);
+				error = (pad == 0 ? std::string("all pads low") : "pad " + std::to_string(pad)) + ", step " + std::to_string(i) + ": pins " + buffer;
+				return false;
+			}
+		}
+	}
+	pinwise->recordPins(false);
+	masks->recordPins(false);
+	return true;
+}
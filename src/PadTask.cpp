@@ -1,12 +1,18 @@
 #include "PadTask.h"
 #include "Addresses.h"
+#include "PadTimeline.h"
+#include "PadGpio.h"
+#include "Simulator.h"
+#include "Transport.h"
+#include "Trace.h"
+#include "DropletRouter.h"
+#include "FSHelper.h"
 
 #include <string>
 #include <iostream>
-#include <wiringPi.h>
 #include <thread>
 #include <algorithm> //std::find
-#include <math.h>
+#include <stdexcept>
 
 //static variables
 std::mutex PadTask::executeMtx;
@@ -31,20 +37,7 @@ PadTask::PadTask(std::vector<int> pads, int duration_ms): Task(){
 	PadTask::name = name;
 	
 	//set outputs
-	pinMode(GPIO_ADC_0, OUTPUT);
-	pinMode(GPIO_ADC_1, OUTPUT);
-	pinMode(GPIO_ADC_2, OUTPUT);
-	pinMode(GPIO_ADC_3, OUTPUT);
-	
-	pinMode(GPIO_EN_1, OUTPUT);
-	pinMode(GPIO_EN_2, OUTPUT);
-	pinMode(GPIO_EN_3, OUTPUT);
-	pinMode(GPIO_EN_4, OUTPUT);
-	pinMode(GPIO_EN_5, OUTPUT);
-	
-	pinMode(GPIO_CS_1, OUTPUT);
-	pinMode(GPIO_CS_2, OUTPUT);
-
+	PadGpio::setOutputs(Transport::get());
 }
 
 PadTask::~PadTask(){
@@ -53,48 +46,82 @@ PadTask::~PadTask(){
 PadTask::PadTask_ptr PadTask::create(std::vector<int> pads, int duration_ms){
 	return std::make_shared<PadTask>(pads, duration_ms);
 }
+std::vector<PadTask::PadTask_ptr> PadTask::createSteps(const std::vector<std::vector<int>> &steps, int duration_ms){
+	std::vector<PadTask_ptr> tasks;
+	for (std::vector<std::vector<int>>::const_iterator cit = steps.cbegin(); cit != steps.cend(); cit++){
+		tasks.push_back(create(*cit, duration_ms));
+	}
+	return tasks;
+}
+
+void PadTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
+	std::vector<PadTask*> tasks;
+	tasks.push_back(this);
+	executeSteps(tasks, token);
+}
+
+void PadTask::executeSequence(const std::vector<PadTask_ptr> &tasks, CancellationToken::CancellationToken_ptr token){
+	Trace::Span span("task", "pad sequence", "steps", tasks.size());
+	std::vector<PadTask*> t;
+	for (std::vector<PadTask_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+		t.push_back(cit->get());
+	}
+	executeSteps(t, token);
+}
 
-void PadTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void PadTask::executeSteps(const std::vector<PadTask*> &tasks, CancellationToken::CancellationToken_ptr token){
+	if (tasks.empty()){
+		return;
+	}
+	PadTask* first = tasks.front(); // used to add the log events
+	
 	executeMtx.lock();
 	if (executing == false){ // not executing at the moment
 		executing = true;
 		executeMtx.unlock();
 		
+		PadTimeline::PadTimeline_ptr timeline = PadTimeline::create();
+		for (std::vector<PadTask*>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+			timeline->addStep((*cit)->pads, (*cit)->duration_ms);
+		}
+		
 		relais->setRelais(Relais::RELAIS::R_STEUER_AC, true);
 		relais->writeRelais();
 		
 		Task::status_leds->pad(true);
 		Task::status_leds->write_reg_val();
-		std::string loginfo = "pads ";
-		for (std::vector<int>::iterator it = pads.begin(); it != pads.end(); it++){
-				//std::cout << "power on pad " << *it << std::endl;
-				setPadHigh(*it);
-				loginfo += std::to_string(*it);
-				loginfo += ", ";
-		}
-		loginfo = loginfo.substr(0, loginfo.length()-2);
-		loginfo += " for " + std::to_string(duration_ms) + "ms";
-		addLogEvent(Log_Event::create("pad on", loginfo, Log_Event::TYPE::LOG_INFO));
 		
-		delay(duration_ms);
+		timeline->play(token); // only the gpio writes are done during the playback
 		
-		setPadsLow();
 		Task::status_leds->pad(false);
 		Task::status_leds->write_reg_val();
-		addLogEvent(Log_Event::create("pads off", "setting all pads to low", Log_Event::TYPE::LOG_INFO));
-//		loginfo = "pads ";
-//		for (std::vector<int>::reverse_iterator rit = pads.rbegin(); rit != pads.rend(); rit++){
-//			//std::cout << "power off pad " << *rit << std::endl;
-//			loginfo += *rit;
-//			loginfo += ", ";
-//		}
-//		addLogEvent(Log_Event::create("pad off", loginfo, Log_Event::TYPE::LOG_INFO));
+		
+		// deferred log events
+		for (std::size_t i = 0; i < tasks.size(); i++){
+			if (timeline->getStepLatenessUs(i) < 0){ // not played - stopped
+				break;
+			}
+			std::string loginfo = "pads ";
+			for (std::vector<int>::const_iterator cit = tasks[i]->pads.cbegin(); cit != tasks[i]->pads.cend(); cit++){
+				loginfo += std::to_string(*cit);
+				loginfo += ", ";
+			}
+			loginfo = loginfo.substr(0, loginfo.length()-2);
+			loginfo += " for " + std::to_string(tasks[i]->duration_ms) + "ms";
+			if (tasks.size() > 1){
+				loginfo += " at +" + std::to_string(timeline->getStepOffsetMs(i)) + "ms";
+			}
+			first->addLogEvent(Log_Event::create("pad on", loginfo, Log_Event::TYPE::LOG_INFO));
+		}
+		first->addLogEvent(Log_Event::create("pads off", "setting all pads to low", Log_Event::TYPE::LOG_INFO));
+		first->addLogEvent(Log_Event::create("pad timing", timeline->getStatistics().to_string(), Log_Event::TYPE::LOG_INFO));
+		
 		executeMtx.lock();
 		executing = false;
 		executeMtx.unlock();
 	}else{ //error, executing at the moment
 		executeMtx.unlock();
-		addLogEvent(Log_Event::create("already executing", "already powering pads", Log_Event::TYPE::LOG_ERROR));
+		first->addLogEvent(Log_Event::create("already executing", "already powering pads", Log_Event::TYPE::LOG_ERROR));
 	}
 }
 
@@ -155,104 +182,11 @@ tinyxml2::XMLElement* PadTask::toXMLElement(tinyxml2::XMLDocument *doc, bool ext
 
 
 void PadTask::setPadHigh(unsigned int pad){
-	/*
-	 * 1 circuit borad: 4 uc x 12 pads * 1 uc x 11 pads = 59 pads
-	 * first pad is pad 1 !!
-	 * first pcb is pcb 1 !!
-	 * first uc is uc 1 !!
-	 * 
-	 */
-	//std::cout << "powering pad " << pad << std::endl;
-	if (pad <= 118 && pad > 0){ //valid pad
-		
-		int pcb_no; // 1, 2
-		int uc_no;  // 1, .., 5
-		int pad_no; // 1, .., 59
-		
-		pcb_no = std::ceil(((double)pad) / 59.0); // 1, 2
-		uc_no = std::ceil((((double)pad) - double((pcb_no - 1) * 59.0))/ 12.0); // 1, .., 5
-		pad_no = pad - ((pcb_no - 1)*59 + (uc_no - 1) * 12); // 1, .. , 12
-		
-		
-		
-		std::cout << "powering pad " << pad_no << " of uc " << uc_no << " on pcb " << pcb_no << std::endl; 
-		
-		bool ADC_0 = (((pad_no >> 0) & 1) == 1);
-		bool ADC_1 = (((pad_no >> 1) & 1) == 1);
-		bool ADC_2 = (((pad_no >> 2) & 1) == 1);
-		bool ADC_3 = (((pad_no >> 3) & 1) == 1);
-		
-		bool EN_1 = (uc_no == 1);
-		bool EN_2 = (uc_no == 2);
-		bool EN_3 = (uc_no == 3);
-		bool EN_4 = (uc_no == 4);
-		bool EN_5 = (uc_no == 5);
-		
-		bool CS_1 = (pcb_no == 1);
-		bool CS_2 = (pcb_no == 2);
-		
-		digitalWrite(GPIO_ADC_0, ADC_0);
-		digitalWrite(GPIO_ADC_1, ADC_1);
-		digitalWrite(GPIO_ADC_2, ADC_2);
-		digitalWrite(GPIO_ADC_3, ADC_3);
-		digitalWrite(GPIO_CS_1, CS_1);
-		digitalWrite(GPIO_CS_2, CS_2);
-		
-		delayMicroseconds(20);
-		digitalWrite(GPIO_EN_1, EN_1);
-		digitalWrite(GPIO_EN_2, EN_2);
-		digitalWrite(GPIO_EN_3, EN_3);
-		digitalWrite(GPIO_EN_4, EN_4);
-		digitalWrite(GPIO_EN_5, EN_5);
-		
-		
-//		std::cout << "Address set" << std::endl;
-		delayMicroseconds(20);
-//		delayMicroseconds(4e6);
-//		delay(20000);
-		
-		digitalWrite(GPIO_EN_1, LOW);
-		digitalWrite(GPIO_EN_2, LOW);
-		digitalWrite(GPIO_EN_3, LOW);
-		digitalWrite(GPIO_EN_4, LOW);
-		digitalWrite(GPIO_EN_5, LOW);
-		digitalWrite(GPIO_CS_1, LOW);
-		digitalWrite(GPIO_CS_2, LOW);
-		
-//		std::cout << "EN LOW" << std::endl;
-	}
+	PadGpio::setPadHigh(Transport::get(), pad);
 }
 
 void PadTask::setPadsLow(){
-	digitalWrite(GPIO_ADC_0, LOW);
-	digitalWrite(GPIO_ADC_1, LOW);
-	digitalWrite(GPIO_ADC_2, LOW);
-	digitalWrite(GPIO_ADC_3, LOW);
-	
-	delayMicroseconds(20);
-	digitalWrite(GPIO_EN_1, HIGH);
-	digitalWrite(GPIO_EN_2, HIGH);
-	digitalWrite(GPIO_EN_3, HIGH);
-	digitalWrite(GPIO_EN_4, HIGH);
-	digitalWrite(GPIO_EN_5, HIGH);
-	
-	digitalWrite(GPIO_CS_1, HIGH);
-	digitalWrite(GPIO_CS_2, HIGH);
-	
-	
-//	std::cout << "Pad clear" << std::endl;
-	delayMicroseconds(30);
-//	delay(20000);
-	
-	digitalWrite(GPIO_EN_1, LOW);
-	digitalWrite(GPIO_EN_2, LOW);
-	digitalWrite(GPIO_EN_3, LOW);
-	digitalWrite(GPIO_EN_4, LOW);
-	digitalWrite(GPIO_EN_5, LOW);
-	
-	digitalWrite(GPIO_CS_1, LOW);
-	digitalWrite(GPIO_CS_2, LOW);
-//	std::cout << "EN low" << std::endl;
+	PadGpio::setPadsLow(Transport::get());
 }
 
 PadTask::PadTask_ptr PadTask::loadPadTask(tinyxml2::XMLElement* task_element){
@@ -275,9 +209,64 @@ PadTask::PadTask_ptr PadTask::loadPadTask(tinyxml2::XMLElement* task_element){
 	return std::make_shared<PadTask>(pads, duration_ms);
 }
 
+std::vector<PadTask::PadTask_ptr> PadTask::loadDropletRoute(tinyxml2::XMLElement* task_element, std::string folder){
+	DropletRouter::DropletRouter_ptr router;
+	if (task_element->FindAttribute("adjacency") != nullptr){
+		std::string path = task_element->FindAttribute("adjacency")->Value();
+		if (!path.empty() && path[0] != '/' && !folder.empty()){ // relative to the recipe
+			path = FSHelper::composePath(folder, path);
+		}
+		router = DropletRouter::loadAdjacency(path, task_element->UnsignedAttribute("pads", PAD_GPIO_PADS));
+	}else if (task_element->FindAttribute("rows") != nullptr && task_element->FindAttribute("columns") != nullptr){
+		router = DropletRouter::createGrid(task_element->UnsignedAttribute("rows"), task_element->UnsignedAttribute("columns"));
+	}else{
+		throw std::runtime_error("DropletRoute: neither adjacency nor rows / columns are set");
+	}
+	router->setSeparation(task_element->UnsignedAttribute("separation", DROPLET_ROUTER_SEPARATION));
+	
+	std::vector<DropletRouter::Droplet> droplets;
+	tinyxml2::XMLElement *droplet = task_element->FirstChildElement("Droplet");
+	while (droplet != nullptr){
+		droplets.push_back(DropletRouter::Droplet{droplet->IntAttribute("start"), droplet->IntAttribute("goal")});
+		droplet = droplet->NextSiblingElement("Droplet");
+	}
+	
+	std::vector<DropletRouter::Route> routes = router->plan(droplets);
+	std::string error;
+	if (!router->verify(droplets, routes, error)){
+		throw std::runtime_error("DropletRoute: invalid routes - " + error);
+	}
+	return createSteps(DropletRouter::getSteps(routes), task_element->IntAttribute("duration_ms"));
+}
+
 std::list<Task::DEVICES> PadTask::getNecessaryDevices(){
 	std::list<Task::DEVICES> devices;
 	
 	
 	return devices;
 }
+std::list<Task::DEVICES> PadTask::getUsedDevices(){
+	std::list<Task::DEVICES> devices;
+	
+	devices.push_back(Task::DEVICES::DEVICE_ELECTRODES);
+	devices.push_back(Task::DEVICES::DEVICE_ATMEGA_GENERAL);
+	
+	return devices;
+}
+bool PadTask::isBarrier(){
+	return false;
+}
+void PadTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	state.setRelais(Relais::RELAIS::R_STEUER_AC, true);
+}
+void PadTask::simulate(Simulator &sim){
+	sim.wait(sim.getModel().padTimelineStartMs + duration_ms);
+}
+void PadTask::simulateSequence(const std::vector<PadTask_ptr> &tasks, Simulator &sim){
+	sim.wait(sim.getModel().padTimelineStartMs); // one timeline for all steps
+	for (std::vector<PadTask_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+		sim.begin(**cit);
+		sim.wait((*cit)->duration_ms);
+		sim.end();
+	}
+}
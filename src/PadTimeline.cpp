@@ -0,0 +1,140 @@
+#include "PadTimeline.h"
+#include "PadGpio.h"
+
+#include <thread>
+#include <cmath>
+#include <algorithm>
+#include <ctime>
+#include <pthread.h>
+#include <sched.h>
+
+PadTimeline::PadTimeline_ptr PadTimeline::create(){
+	return PadTimeline_ptr(new PadTimeline());
+}
+PadTimeline::PadTimeline(): duration_ns(0), realtime(false), cancelled(false){
+	
+}
+
+void PadTimeline::addStep(const std::vector<int> &pads, unsigned int duration_ms){
+	Step s;
+	s.pads = pads;
+	s.offset_ns = duration_ns;
+	steps.push_back(s);
+	duration_ns += duration_ms * 1000000LL;
+}
+
+std::size_t PadTimeline::getStepCount() const{
+	return steps.size();
+}
+
+unsigned long PadTimeline::getStepOffsetMs(std::size_t i) const{
+	return steps.at(i).offset_ns / 1000000LL;
+}
+
+bool PadTimeline::play(CancellationToken::CancellationToken_ptr token){
+	lateness_ns.assign(steps.size(), -1); // allocated before the playback
+	realtime = false;
+	cancelled = false;
+	
+	std::thread t(&PadTimeline::playThread, this, token);
+	t.join();
+	
+	return !cancelled;
+}
+
+void PadTimeline::playThread(CancellationToken::CancellationToken_ptr token){
+	sched_param param;
+	param.sched_priority = PAD_TIMELINE_PRIORITY;
+	realtime = (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0); // needs root / CAP_SYS_NICE
+	
+	Transport::Transport_ptr gpio = Transport::get();
+	const long long start = now() + PAD_TIMELINE_START_DELAY_US * 1000LL;
+	for (std::size_t i = 0; i < steps.size(); i++){
+		const long long deadline = start + steps[i].offset_ns;
+		if (!sleepUntil(deadline, token)){
+			cancelled = true;
+			break;
+		}
+		lateness_ns[i] = now() - deadline;
+		
+		if (i > 0){
+			PadGpio::setPadsLow(gpio);
+		}
+		for (std::vector<int>::const_iterator cit = steps[i].pads.cbegin(); cit != steps[i].pads.cend(); cit++){
+			PadGpio::setPadHigh(gpio, *cit);
+		}
+	}
+	if (!cancelled && !sleepUntil(start + duration_ns, token)){
+		cancelled = true;
+	}
+	PadGpio::setPadsLow(gpio);
+}
+
+bool PadTimeline::sleepUntil(long long deadline_ns, const CancellationToken::CancellationToken_ptr &token){
+	while (true){
+		if (token->isCancelled()){
+			return false;
+		}
+		long long current = now();
+		if (current >= deadline_ns){
+			return true;
+		}
+		// wake up in time to check the token, the last part is slept until the exact deadline
+		long long wakeup = std::min(deadline_ns, current + PAD_TIMELINE_CANCEL_CHECK_MS * 1000000LL);
+		timespec ts;
+		ts.tv_sec = wakeup / 1000000000LL;
+		ts.tv_nsec = wakeup % 1000000000LL;
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr); // interrupted -> loop
+	}
+}
+
+long long PadTimeline::now(){
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+double PadTimeline::getStepLatenessUs(std::size_t i) const{
+	if (i >= lateness_ns.size() || lateness_ns[i] < 0){
+		return -1.0;
+	}
+	return lateness_ns[i] / 1000.0;
+}
+
+PadTimeline::Statistics PadTimeline::getStatistics() const{
+	Statistics s;
+	s.steps = 0;
+	s.min_us = 0.0;
+	s.max_us = 0.0;
+	s.mean_us = 0.0;
+	s.stddev_us = 0.0;
+	s.realtime = realtime;
+	
+	double sum = 0.0;
+	double sum_sq = 0.0;
+	for (std::vector<long long>::const_iterator cit = lateness_ns.cbegin(); cit != lateness_ns.cend(); cit++){
+		if (*cit < 0){ // not played
+			continue;
+		}
+		double l = *cit / 1000.0;
+		if (s.steps == 0 || l < s.min_us){
+			s.min_us = l;
+		}
+		if (s.steps == 0 || l > s.max_us){
+			s.max_us = l;
+		}
+		sum += l;
+		sum_sq += l * l;
+		s.steps++;
+	}
+	if (s.steps > 0){
+		s.mean_us = sum / s.steps;
+		s.stddev_us = std::sqrt(std::max(0.0, sum_sq / s.steps - s.mean_us * s.mean_us));
+	}
+	
+	return s;
+}
+
+std::string PadTimeline::Statistics::to_string() const{
+	return std::to_string(steps) + " steps, lateness min/mean/max " + std::to_string((long) std::lround(min_us)) + "/" + std::to_string((long) std::lround(mean_us)) + "/" + std::to_string((long) std::lround(max_us)) + "us, stddev " + std::to_string((long) std::lround(stddev_us)) + "us" + (realtime ? ", real-time" : ", no real-time priority");
+}
@@ -0,0 +1,195 @@
+#include "PicoPackage.h"
+
+namespace{
+	/// lookup table for the var types - index: (c0 - 'a') * 26 + (c1 - 'a')
+	struct TypeTable{
+		unsigned char t[26*26];
+		
+		TypeTable(){
+			for (int i = 0; i < 26*26; i++){
+				t[i] = MeasurementValue::MEASUREMENT_TYPE::TYPE_ERROR;
+			}
+			add(VT_UNKNOWN, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_UNKNOWN);
+			add(VT_POTENTIAL_RE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_POTENTIAL_RE);
+			add(VT_POTENTIAL_CE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_POTENTIAL_CE);
+			add(VT_POTENTIAL_WE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_POTENTIAL_WE);
+			add(VT_POTENTIAL_AUX1_IN, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_POTENTIAL_AUX1_IN);
+			add(VT_POTENTIAL_AUX2_IN, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_POTENTIAL_AUX2_IN);
+			add(VT_CURRENT_WE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CURRENT_WE);
+			add(VT_PHASE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_PHASE);
+			add(VT_IMP, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_IMP);
+			add(VT_ZREAL, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZREAL);
+			add(VT_ZIMAG, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_ZIMAG);
+			add(VT_CELL_POTENTIAL, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_POTENTIAL);
+			add(VT_CELL_CURRENT, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_CURRENT);
+			add(VT_CELL_FREQUENCY, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_FREQUENCY);
+			add(VT_CELL_AMPLITUDE, MeasurementValue::MEASUREMENT_TYPE::TYPE_VT_CELL_AMPLITUDE);
+		}
+		void add(const char* vt, MeasurementValue::MEASUREMENT_TYPE m){
+			t[(vt[0] - 'a') * 26 + (vt[1] - 'a')] = m;
+		}
+	};
+	
+	const TypeTable typeTable;
+}
+
+PicoPackage::PicoPackage(){
+	count = 0;
+}
+
+MeasurementValue::MEASUREMENT_TYPE PicoPackage::lookupType(char c0, char c1){
+	unsigned int i0 = c0 - 'a';
+	unsigned int i1 = c1 - 'a';
+	if (i0 < 26 && i1 < 26){
+		return static_cast<MeasurementValue::MEASUREMENT_TYPE>(typeTable.t[i0 * 26 + i1]);
+	}
+	return MeasurementValue::MEASUREMENT_TYPE::TYPE_ERROR;
+}
+double PicoPackage::prefixFactor(char p){
+	switch(p){
+		case 'a': return 1e-18;
+		case 'f': return 1e-15;
+		case 'p': return 1e-12;
+		case 'n': return 1e-9;
+		case 'u': return 1e-6;
+		case 'm': return 1e-3;
+		case ' ': return 1;
+		case 'k': return 1e3;
+		case 'M': return 1e6;
+		case 'G': return 1e9;
+		case 'T': return 1e12;
+		case 'P': return 1e15;
+		case 'E': return 1e18;
+	}
+	return 0;
+}
+bool PicoPackage::decodeHex(const char* s, std::size_t len, unsigned int &result){
+	unsigned int r = 0;
+	for (std::size_t i = 0; i < len; i++){
+		char c = s[i];
+		unsigned int d;
+		if (c >= '0' && c <= '9'){
+			d = c - '0';
+		}else if (c >= 'A' && c <= 'F'){
+			d = c - 'A' + 10;
+		}else if (c >= 'a' && c <= 'f'){
+			d = c - 'a' + 10;
+		}else{
+			return false;
+		}
+		r = (r << 4) | d;
+	}
+	result = r;
+	return true;
+}
+
+/*
+ * s: ttHHHHHHHp,MV..V,MV..V
+ *    0123456789
+ */
+bool PicoPackage::parseValue(const char* s, std::size_t len, Value &v){
+	if (len < 10){
+		return false;
+	}
+	
+	v.type = lookupType(s[0], s[1]);
+	v.status = MeasurementValue::META_STATUS::STATUS_NO_STATUS;
+	v.range = -1;
+	
+	unsigned int hexValue;
+	double factor = prefixFactor(s[9]);
+	if (v.type == MeasurementValue::MEASUREMENT_TYPE::TYPE_ERROR || factor == 0 || !decodeHex(s + 2, 7, hexValue)){
+		return false;
+	}
+	v.value = (static_cast<int>(hexValue) - 0x8000000) * factor;
+	
+	// meta data
+	std::size_t pos = 10;
+	while (pos < len){
+		if (s[pos] == ','){
+			pos++;
+			continue;
+		}
+		std::size_t end = pos;
+		while (end < len && s[end] != ','){
+			end++;
+		}
+		
+		switch (s[pos]){
+			case '1':{ //MetaData Mode
+				if (end - pos > 1){
+					switch (s[pos + 1]){
+						case '0':
+							v.status = MeasurementValue::META_STATUS::STATUS_OK;
+							break;
+						case '2':
+							v.status = MeasurementValue::META_STATUS::STATUS_OVERLOAD;
+							break;
+						case '4':
+							v.status = MeasurementValue::META_STATUS::STATUS_UNDERLOAD;
+							break;
+						case '8':
+							v.status = MeasurementValue::META_STATUS::STATUS_OVERLOAD_WARNING;
+							break;
+					}
+				}
+				break;
+			}
+			case '2':{ //Current Range
+				unsigned int range;
+				if (end - pos > 1 && decodeHex(s + pos + 1, end - pos - 1, range)){
+					v.range = range;
+				}
+				break;
+			}
+		}
+		pos = end;
+	}
+	return true;
+}
+bool PicoPackage::parse(const char* line, std::size_t len){
+	count = 0;
+	
+	if (len == 0 || line[0] != 'P'){ // no package data
+		return false;
+	}
+	
+	std::size_t pos = 1; // skip 'P'
+	while (pos < len){
+		std::size_t end = pos;
+		while (end < len && line[end] != ';'){
+			end++;
+		}
+		
+		if (count >= PICO_MAX_VALUES || !parseValue(line + pos, end - pos, values[count])){
+			count = 0;
+			return false;
+		}
+		count++;
+		pos = end + 1;
+	}
+	return count > 0;
+}
+std::size_t PicoPackage::size() const{
+	return count;
+}
+const PicoPackage::Value& PicoPackage::at(std::size_t i) const{
+	return values[i];
+}
+bool PicoPackage::getValue(MeasurementValue::MEASUREMENT_TYPE type, double &value) const{
+	for (std::size_t i = 0; i < count; i++){
+		if (values[i].type == type){
+			value = values[i].value;
+			return true;
+		}
+	}
+	return false;
+}
+bool PicoPackage::isValid() const{
+	for (std::size_t i = 0; i < count; i++){
+		if (values[i].status == MeasurementValue::META_STATUS::STATUS_OVERLOAD || values[i].status == MeasurementValue::META_STATUS::STATUS_UNDERLOAD){
+			return false;
+		}
+	}
+	return true;
+}
@@ -280,28 +280,27 @@ bool PlotWindow::on_draw(const Cairo::RefPtr<Cairo::Context>& cr){
 					cr->set_line_width(PLOT_LINE_WIDTH);
 					
 					//for each data point
-					for (std::vector<DataP::DataP_ptr>::iterator it = plot_data.begin() ; it != plot_data.end(); ++it){
+					for (std::size_t i = 0; i < plot_data.size(); i++){
 						int x, y; //absolute coordinates 
-						DataP::DataP_ptr data_point = *it;
 						
 						switch (scale_x){
 							case SCALE::LINEAR:
-								x = (data_point->getX() - x_min)*toDraw_x + x_zero;
+								x = (plot_data.getX(i) - x_min)*toDraw_x + x_zero;
 								break;
 							case SCALE::LOG:
-								x = (log10(data_point->getX()) - log10(x_min))*toDraw_x + x_zero;
+								x = (log10(plot_data.getX(i)) - log10(x_min))*toDraw_x + x_zero;
 								break;
 						}
 						switch (scale_y){
 							case SCALE::LINEAR:
-								y = (y_min - (data_point->getY(complexMode)))*toDraw_y + y_zero;
+								y = (y_min - (plot_data.getY(i, complexMode)))*toDraw_y + y_zero;
 								break;
 							case SCALE::LOG:
-								y = (log10(y_min) - log10(data_point->getY(complexMode)))*toDraw_y + y_zero;
+								y = (log10(y_min) - log10(plot_data.getY(i, complexMode)))*toDraw_y + y_zero;
 								break;
 						}
 						
-						if (it != plot_data.begin()){
+						if (i != 0){
 							cr->line_to(x, y);
 						}
 						cr->move_to(x, y);
@@ -458,55 +457,19 @@ void PlotWindow::updateWindowSizes(){
 
 // dataMtx needs to be locked externaly
 void PlotWindow::calculateDataRage(){
-	if (!plot_data.empty()){
-		x_min_data = plot_data.front()->getX();
-		x_max_data = plot_data.front()->getX();
-		y_min_data = plot_data.front()->getY(complexMode);
-		y_max_data = plot_data.front()->getY(complexMode);
-	}else{
-		x_min_data = 0;
-		x_max_data = 0;
-		y_min_data = 0;
-		y_max_data = 0;
-	}
-	
-	for (std::vector<DataP::DataP_ptr>::const_iterator cit = plot_data.cbegin(); cit != plot_data.cend(); cit++){
-//		std::cout << "x_min_data: " << x_min_data << std::endl;
-//		std::cout << "x_max_data: " << x_min_data << std::endl;
-//		std::cout << "y_min_data: " << y_min_data << std::endl;
-//		std::cout << "y_max_data: " << y_max_data << std::endl;
-		
-		DataP::DataP_ptr data_point = *cit;
-		if (data_point->getX() < x_min_data){
-			x_min_data = data_point->getX();
-		}
-		
-		if (data_point->getX() > x_max_data){
-			x_max_data = data_point->getX();
-		}
-		
-		if (data_point->getY(complexMode) < y_min_data){
-			y_min_data = data_point->getY(complexMode);
-		}
-		
-		if (data_point->getY(complexMode) > y_max_data){
-			y_max_data = data_point->getY(complexMode);
-		}
-	}
+	plot_data.getRange(complexMode, x_min_data, x_max_data, y_min_data, y_max_data);
 }
 
 /*
  * set the entire data
  */
-void PlotWindow::setData(std::vector<DataP::DataP_ptr> data){
-//	for (std::vector<DataP::DataP_ptr>::iterator it = data.begin(); it != data.end(); it++){
-//		DataP::DataP_ptr data = *it;
-//		std::cout << data->getX() << " - " << data->getY(DataP::COMPLEX_MODE::COMPLEX_REAL) << " - " << data->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG) << std::endl;
+void PlotWindow::setData(Spectrum data){
+//	for (std::size_t i = 0; i < data.size(); i++){
+//		std::cout << data.getX(i) << " - " << data.getY(i, DataP::COMPLEX_MODE::COMPLEX_REAL) << " - " << data.getY(i, DataP::COMPLEX_MODE::COMPLEX_IMAG) << std::endl;
 //	}
 	
 	dataMtx.lock();
 	
-	plot_data.clear();
 	plot_data = data;
 	calculateDataRage();
 
@@ -546,30 +509,32 @@ double PlotWindow::getScl(double widget_dim, double axis_dim){
 /*
  * add one DataPoint
  */
-void PlotWindow::addData(DataP::DataP_ptr data){
+void PlotWindow::addData(double x, double y_real, double y_imag){
 	dataMtx.lock();
-	if (plot_data.empty()){
-		x_min_data = data->getX();
-		x_max_data = data->getX();
-		y_min_data = data->getY(complexMode);
-		y_max_data = data->getY(complexMode);
+	plot_data.add(x, y_real, y_imag);
+	double y = plot_data.getY(plot_data.size() - 1, complexMode);
+	
+	if (plot_data.size() == 1){
+		x_min_data = x;
+		x_max_data = x;
+		y_min_data = y;
+		y_max_data = y;
 	}
 	
-	plot_data.push_back(data);
-	if (data->getX() < x_min_data){
-		x_min_data = data->getX();
+	if (x < x_min_data){
+		x_min_data = x;
 	}
 	
-	if (data->getX() > x_max_data){
-		x_max_data = data->getX();
+	if (x > x_max_data){
+		x_max_data = x;
 	}
 	
-	if (data->getY(complexMode) < y_min_data){
-		y_min_data = data->getY(complexMode);;
+	if (y < y_min_data){
+		y_min_data = y;
 	}
 	
-	if (data->getY(complexMode) > y_max_data){
-		y_max_data = data->getY(complexMode);;
+	if (y > y_max_data){
+		y_max_data = y;
 	}
 	dataMtx.unlock();
 	updateWindowSizes();
@@ -602,8 +567,8 @@ double PlotWindow::getYaverage(){
 	double sum = 0;
 	int size = 1;
 	dataMtx.lock();
-	for (std::vector<DataP::DataP_ptr>::const_iterator cit = plot_data.cbegin(); cit != plot_data.cend(); cit++){
-		sum += (*cit)->getY(complexMode);
+	for (std::size_t i = 0; i < plot_data.size(); i++){
+		sum += plot_data.getY(i, complexMode);
 	}
 	
 	size = plot_data.size();
@@ -7,28 +7,42 @@
 #include "DelayTask.h"
 #include "I2CFreqTask.h"
 #include "I2CVoltageTask.h"
+#include "TaskGraph.h"
+#include "CompiledRecipe.h"
+#include "Trace.h"
 
 #include <iostream>
 #include <fstream>
 #include <tinyxml2.h>
 #include <stdexcept>
+#include <algorithm>
+#include <sys/stat.h>
 
-std::vector<std::weak_ptr<Recipe>> Recipe::all_recipes;
+std::unordered_map<std::string, std::vector<Recipe::RegistryEntry>> Recipe::all_recipes;
 std::mutex Recipe::all_recipesMtx;
+std::unordered_map<std::string, Recipe::CacheEntry> Recipe::recipeCache;
+std::mutex Recipe::recipeCacheMtx;
 
 Recipe::Recipe(std::string name): Task(){
 	file_path = "";
 	changed = true;
+	concurrent = false;
+	bodyLoaded = true;
+	spectrometer = nullptr;
+	registered = false;
 	setName(name);
 }
 
 Recipe::Recipe_ptr Recipe::create(const std::string& name){
 	Recipe_ptr r = Recipe_ptr(new Recipe(name));
 	
-	//add a weak_ptr to the global list
-	std::weak_ptr<Recipe> weak_r = r;
+	//add a weak_ptr to the global index
+	RegistryEntry entry;
+	entry.recipe = r.get();
+	entry.weak = r;
 	all_recipesMtx.lock();
-	all_recipes.push_back(weak_r);
+	all_recipes[r->name].push_back(entry);
+	r->registered = true;
 	all_recipesMtx.unlock();
 	
 	return r;
@@ -37,22 +51,31 @@ Recipe::Recipe_ptr Recipe::create(const std::string& name){
 
 Recipe::~Recipe(){
 	
-	//remove recipe from global vector
+	//remove recipe from global index
 	all_recipesMtx.lock();
-	for(std::vector<std::weak_ptr<Recipe>>::iterator it = all_recipes.begin(); it != all_recipes.end(); it++){
-		if (Recipe_ptr r = it->lock()){ // pointer is not expired
-			if (r->getID() == id){
-				std::cout << "removed recipe from global list" << std::endl;
-				all_recipes.erase(it);
+	if (registered){
+		removeFromRegistry();
+	}
+	all_recipesMtx.unlock();
+}
+
+std::weak_ptr<Recipe> Recipe::removeFromRegistry(){
+	std::weak_ptr<Recipe> weak;
+	std::unordered_map<std::string, std::vector<RegistryEntry>>::iterator bucket = all_recipes.find(name);
+	if (bucket != all_recipes.end()){
+		for (std::vector<RegistryEntry>::iterator it = bucket->second.begin(); it != bucket->second.end(); it++){
+			if (it->recipe == this){
+				weak = it->weak;
+				bucket->second.erase(it);
 				break;
 			}
-		}else{
-			std::cout << "expired pointer in list" << std::endl;
-			all_recipes.erase(it);
-			break;
+		}
+		if (bucket->second.empty()){
+			all_recipes.erase(bucket);
 		}
 	}
-	all_recipesMtx.unlock();
+	registered = false;
+	return weak;
 }
 
 void Recipe::addTask(Task_ptr t){
@@ -62,23 +85,25 @@ void Recipe::addTask(Task_ptr t){
 	tasksMtx.unlock();
 }
 
-void Recipe::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void Recipe::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	
 	// recipe should not be executed
-	if (!(*executeNext)){
+	if (token->isCancelled()){
 		return;
 	}
 	
+	loadBody();
 	tasksMtx.lock();
 	try{
+		Trace::Span span("recipe", name);
 		addLogEvent(Log_Event::create("start recipe", "recipe " + name + "(" + std::to_string(id) + ")", Log_Event::TYPE::LOG_INFO));
-		for(std::vector<Task_ptr>::iterator it = tasks.begin(); it != tasks.end(); it++){
-			Task_ptr t = *it;
-			if (*executeNext){
-				t->execute(data, executeNext);
-			}else{
-				break;
-			}
+		if (concurrent){ // execute tasks which do not use the same devices at the same time
+			TaskGraph::create(tasks)->execute(data, token);
+		}else{ // nested recipes are flattened, redundant device writes are skipped
+			CompiledRecipe::CompiledRecipe_ptr compiled = CompiledRecipe::compile(tasks);
+			std::cout << "compiled recipe " << name << ": " << compiled->getReport().to_string() << std::endl;
+			addLogEvent(Log_Event::create("compiled recipe", "recipe " + name + ": " + compiled->getReport().to_string(), Log_Event::TYPE::LOG_INFO));
+			compiled->execute(data, token);
 		}
 		addLogEvent(Log_Event::create("end recipe", "recipe " + name + "(" + std::to_string(id) + ")", Log_Event::TYPE::LOG_INFO));
 	}catch(std::runtime_error r){
@@ -92,14 +117,38 @@ void Recipe::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext)
 	tasksMtx.unlock();
 }
 
-const std::vector<Task::Task_ptr> Recipe::getTasks() const{
+void Recipe::simulate(Simulator &sim){
+	loadBody();
+	tasksMtx.lock();
+	if (concurrent){
+		TaskGraph::create(tasks)->simulate(sim);
+	}else{
+		CompiledRecipe::compile(tasks)->simulate(sim);
+	}
+	tasksMtx.unlock();
+}
+
+void Recipe::setConcurrent(bool concurrent){
+	Recipe::concurrent = concurrent;
+	changed = true;
+}
+bool Recipe::isConcurrent() const{
+	return concurrent;
+}
+
+const std::vector<Task::Task_ptr> Recipe::getTasks(){
+	loadBody();
 	return tasks;
 }
+bool Recipe::isBodyLoaded() const{
+	return bodyLoaded;
+}
 std::string Recipe::getType() const{
 	return "recipe";
 }
 
 bool Recipe::isBasicRecipe(){
+	loadBody();
 	tasksMtx.lock();
 	bool retval = true;
 	for(std::vector<Task_ptr>::const_iterator it = tasks.cbegin(); it != tasks.cend(); it++){
@@ -123,6 +172,7 @@ void Recipe::save(){
 			if (FSHelper::endsWith(file_path, ".csv")){
 				
 			}else{ // save xml file
+				loadBody();
 				tasksMtx.lock();
 				
 				tinyxml2::XMLDocument doc;
@@ -131,6 +181,7 @@ void Recipe::save(){
 				std::cout << "saved recipe to " << file_path << std::endl;
 				
 				tasksMtx.unlock();
+				updateCache();
 			}
 			changed = false;
 		}
@@ -142,6 +193,9 @@ tinyxml2::XMLElement* Recipe::toXMLElement(tinyxml2::XMLDocument *doc, bool exte
 	
 	xmlTaskElement->SetAttribute("name", name.c_str());
 	xmlTaskElement->SetAttribute("comment", comment.c_str());
+	if (concurrent){
+		xmlTaskElement->SetAttribute("concurrent", true);
+	}
 	
 	if (externElements){ // save recipe in own file and link the path
 		
@@ -150,6 +204,7 @@ tinyxml2::XMLElement* Recipe::toXMLElement(tinyxml2::XMLDocument *doc, bool exte
 		
 		save();
 	}else{
+		loadBody();
 		for(std::vector<Task_ptr>::const_iterator cit = Recipe::tasks.cbegin(); cit != tasks.cend(); cit++){
 			xmlTaskElement->InsertEndChild((*cit)->toXMLElement(doc, externElements));
 		}
@@ -183,86 +238,265 @@ Recipe::Recipe_ptr Recipe::loadRecipe(tinyxml2::XMLElement* task_element, Spectr
 	}else{ //direct load
 		r = create(name);
 		r->setComment(comment);
+		r->setConcurrent(task_element->BoolAttribute("concurrent"));
 		
-		tinyxml2::XMLNode* task = task_element->FirstChild();
-		while (task!= nullptr){ // add all tasks
-			tinyxml2::XMLElement* currentTask = dynamic_cast<tinyxml2::XMLElement*>(task);
-			
-			if (currentTask != 0){
-				if (std::string(currentTask->Name()).compare("Recipe") == 0){
-					r->addTask(loadRecipe(currentTask, s));
-				}else if(std::string(currentTask->Name()).compare("PadTask") == 0){
-					r->addTask(PadTask::loadPadTask(currentTask));
-				}else if(std::string(currentTask->Name()).compare("SpectrometerTask") == 0){
-					r->addTask(SpectrometerTask::loadSpectrometerTask(currentTask, s));
-				}else if(std::string(currentTask->Name()).compare("ImpAnalyserTask") == 0){
-					r->addTask(ImpAnalyserTask::loadImpAnalyserTask(currentTask));
-				}else if(std::string(currentTask->Name()).compare("TransImpTask") == 0){
-					r->addTask(TransImpTask::loadTransImpTask(currentTask));
-				}else if(std::string(currentTask->Name()).compare("DelayTask") == 0){
-					r->addTask(DelayTask::loadDelayTask(currentTask));
-				}else if(std::string(currentTask->Name()).compare("FreqTask") == 0){
-					r->addTask(I2CFreqTask::loadFreqTask(currentTask));
-				}else if(std::string(currentTask->Name()).compare("VoltageTask") == 0){
-					r->addTask(I2CVoltageTask::loadVoltageTask(currentTask));
-				}
-			}
-			task = task->NextSibling();
+		std::vector<Task_ptr> tasks = loadTasks(task_element, s);
+		for (std::vector<Task_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+			r->addTask(*cit);
 		}
 		return r;
 	}
 	return r; // never reached
 }
+std::vector<Task::Task_ptr> Recipe::loadTasks(tinyxml2::XMLElement* task_element, Spectrometer* s, std::string folder){
+	std::vector<Task_ptr> tasks;
+	
+	tinyxml2::XMLNode* task = task_element->FirstChild();
+	while (task!= nullptr){ // add all tasks
+		tinyxml2::XMLElement* currentTask = dynamic_cast<tinyxml2::XMLElement*>(task);
+		
+		if (currentTask != 0){
+			if (std::string(currentTask->Name()).compare("Recipe") == 0){
+				tasks.push_back(loadRecipe(currentTask, s));
+			}else if(std::string(currentTask->Name()).compare("PadTask") == 0){
+				tasks.push_back(PadTask::loadPadTask(currentTask));
+			}else if(std::string(currentTask->Name()).compare("DropletRoute") == 0){
+				std::vector<PadTask::PadTask_ptr> steps = PadTask::loadDropletRoute(currentTask, folder);
+				tasks.insert(tasks.end(), steps.begin(), steps.end());
+			}else if(std::string(currentTask->Name()).compare("SpectrometerTask") == 0){
+				tasks.push_back(SpectrometerTask::loadSpectrometerTask(currentTask, s));
+			}else if(std::string(currentTask->Name()).compare("ImpAnalyserTask") == 0){
+				tasks.push_back(ImpAnalyserTask::loadImpAnalyserTask(currentTask));
+			}else if(std::string(currentTask->Name()).compare("TransImpTask") == 0){
+				tasks.push_back(TransImpTask::loadTransImpTask(currentTask));
+			}else if(std::string(currentTask->Name()).compare("DelayTask") == 0){
+				tasks.push_back(DelayTask::loadDelayTask(currentTask));
+			}else if(std::string(currentTask->Name()).compare("FreqTask") == 0){
+				tasks.push_back(I2CFreqTask::loadFreqTask(currentTask));
+			}else if(std::string(currentTask->Name()).compare("VoltageTask") == 0){
+				tasks.push_back(I2CVoltageTask::loadVoltageTask(currentTask));
+			}
+		}
+		task = task->NextSibling();
+	}
+	return tasks;
+}
 Recipe::Recipe_ptr Recipe::loadRecipe(std::string path, Spectrometer *s, std::string name, std::string comment){
+	Recipe_ptr r;
 	
-	Recipe_ptr r = getRecipeByName(name);
+	if (!name.empty()){
+		r = getRecipeByName(name);
+		if (r != nullptr) return r;
+	}
+	
+	CacheEntry entry;
+	if (!getFileStamp(path, entry)){
+		std::cout << "error opening file " << path << std::endl;
+		return r;
+	}
+	
+	//check if the file has been loaded and neither the file nor the recipe has been changed since then
+	bool reuse = true;
+	recipeCacheMtx.lock();
+	std::unordered_map<std::string, CacheEntry>::iterator cached = recipeCache.find(path);
+	if (cached != recipeCache.end()){
+		r = cached->second.recipe.lock();
+		if (cached->second.mtime_ns != entry.mtime_ns || cached->second.size != entry.size || (r != nullptr && r->changed)){
+			reuse = false;
+			r = nullptr;
+		}
+		if (r == nullptr){
+			recipeCache.erase(cached);
+		}
+	}
+	recipeCacheMtx.unlock();
 	if (r != nullptr) return r;
 	
-	//recipe has not been loaded -> load recipe
+	//recipe has not been loaded or is not up to date -> load recipe, a changed file or recipe is loaded as new recipe
+	r = loadRecipeHeader(path, s, reuse);
+	if (r != nullptr){
+		entry.recipe = r;
+		recipeCacheMtx.lock();
+		recipeCache[path] = entry;
+		recipeCacheMtx.unlock();
+	}
+	return r;
+}
+Recipe::Recipe_ptr Recipe::loadRecipeHeader(std::string path, Spectrometer* s, bool reuse){
+	Recipe_ptr r;
 	
 	if(FSHelper::endsWith(path, ".csv")){
-		
 		r = create(path.substr(path.find_last_of("/") + 1));
-		r->setPath(path);
+	} else if (FSHelper::endsWith(path, ".xml")){
+		std::string name = "", comment = "";
+		bool concurrent = false;
 		
-		std::ifstream file(path);
-		if (file.is_open()){
-			std::string line;
-			while(std::getline(file, line)){
-				if (!line.empty()){
-					r->addTask(PadTask::getPadTaskFromString(line));
+		if (readXmlHeader(path, name, comment, concurrent)){
+			if (reuse){
+				r = getRecipeByName(name);
+				if (r != nullptr && !r->changed){
+					r->setPath(path);
+					return r;
 				}
 			}
+			r = create(name);
+			r->setComment(comment);
+			r->setConcurrent(concurrent);
+		}else{ //error, no recipe xml file
+			std::cout << "no recipe found in " << path << std::endl;
 			return r;
-		}else{
-			std::cout << "error opening file " << path << std::endl;
-		}
-	} else if (FSHelper::endsWith(path, ".xml")){
-		tinyxml2::XMLDocument doc;
-		
-		if (doc.LoadFile(path.c_str()) == 0){ // no error
-			tinyxml2::XMLElement* recipe = dynamic_cast<tinyxml2::XMLElement*>(doc.FirstChildElement("Recipe"));
-			if (recipe != nullptr){
-				r =  loadRecipe(recipe, s);
-				r->setPath(path);
-				
-				return r;
-			}else{ //error, no recipe xml file
-				
-			}
-		} else {
-//			addLogEvent(Log_Event::create("error opening xml file", "opening xml file '" + path + "' failed"));
 		}
 	} else { // unsupported file ending
-//		addLogEvent(Log_Event::create("unsupported file", "Recipe::Recipe(std::string path, Uc_Control *ucControl) - the file " + path + "is not supported", Log_Event::TYPE::LOG_ERROR));
+		return r;
 	}
+	
+	r->setPath(path);
+	r->spectrometer = s;
+	r->bodyLoaded = false;
+	r->changed = false; // same as the file
 	return r;
 }
+bool Recipe::readXmlHeader(std::string path, std::string &name, std::string &comment, bool &concurrent){
+	tinyxml2::XMLDocument doc;
+	tinyxml2::XMLElement* recipe = nullptr;
+	
+	//read the file until the end of the start tag of the Recipe element
+	std::ifstream file(path);
+	std::string head, part;
+	std::size_t start = std::string::npos;
+	while (std::getline(file, part, '>')){
+		head += part + ">";
+		if (start == std::string::npos){
+			start = head.find("<Recipe");
+		}
+		if (start != std::string::npos){
+			std::string tag = head.substr(start);
+			if (std::count(tag.begin(), tag.end(), '"') % 2 == 0){ // '>' is not part of an attribute value -> end of the tag
+				if (!FSHelper::endsWith(tag, "/>")){
+					tag += "</Recipe>";
+				}
+				if (doc.Parse(tag.c_str()) == tinyxml2::XML_SUCCESS){
+					recipe = doc.FirstChildElement("Recipe");
+				}
+				break;
+			}
+		}
+	}
+	file.close();
+	
+	if (recipe == nullptr){ // start tag could not be parsed -> parse the whole file
+		if (doc.LoadFile(path.c_str()) == tinyxml2::XML_SUCCESS){
+			recipe = doc.FirstChildElement("Recipe");
+		}
+		if (recipe == nullptr){
+			return false;
+		}
+	}
+	
+	if (recipe->FindAttribute("name") != nullptr){
+		name = recipe->FindAttribute("name")->Value();
+	}
+	if (recipe->FindAttribute("comment") != nullptr){
+		comment = recipe->FindAttribute("comment")->Value();
+	}
+	concurrent = recipe->BoolAttribute("concurrent");
+	return true;
+}
+void Recipe::loadBody(){
+	if (bodyLoaded){
+		return;
+	}
+	
+	bodyMtx.lock();
+	if (!bodyLoaded){ // not loaded by another thread in the meantime
+		Trace::Span span("recipe", "load " + name);
+		std::vector<Task_ptr> body;
+		try{
+			if(FSHelper::endsWith(file_path, ".csv")){
+				std::ifstream file(file_path);
+				if (!file.is_open()){
+					throw std::runtime_error("error opening file " + file_path);
+				}
+				std::string line;
+				while(std::getline(file, line)){
+					if (!line.empty()){
+						body.push_back(PadTask::getPadTaskFromString(line));
+					}
+				}
+			}else{
+				tinyxml2::XMLDocument doc;
+				if (doc.LoadFile(file_path.c_str()) != tinyxml2::XML_SUCCESS){
+					throw std::runtime_error("opening xml file '" + file_path + "' failed");
+				}
+				tinyxml2::XMLElement* recipe = doc.FirstChildElement("Recipe");
+				if (recipe == nullptr){
+					throw std::runtime_error("no recipe found in " + file_path);
+				}
+				body = loadTasks(recipe, spectrometer, file_path.substr(0, file_path.find_last_of('/') + 1));
+			}
+		}catch(std::runtime_error &e){
+			std::cout << "loading recipe " << name << " failed - " << e.what() << std::endl;
+			addLogEvent(Log_Event::create("error loading recipe", "recipe " + name + ": " + e.what(), Log_Event::TYPE::LOG_ERROR));
+			body.clear();
+		}catch(std::invalid_argument &e){
+			std::cout << "loading recipe " << name << " failed - " << e.what() << std::endl;
+			addLogEvent(Log_Event::create("error loading recipe", "recipe " + name + ": " + e.what(), Log_Event::TYPE::LOG_ERROR));
+			body.clear();
+		}
+		
+		// tasks which have been added before are kept behind the loaded tasks
+		tasksMtx.lock();
+		tasks.insert(tasks.begin(), body.begin(), body.end());
+		tasksMtx.unlock();
+		bodyLoaded = true;
+	}
+	bodyMtx.unlock();
+}
+void Recipe::updateCache(){
+	CacheEntry entry;
+	if (!getFileStamp(file_path, entry)){
+		return;
+	}
+	
+	recipeCacheMtx.lock();
+	std::unordered_map<std::string, CacheEntry>::iterator cached = recipeCache.find(file_path);
+	if (cached != recipeCache.end()){
+		if (cached->second.recipe.lock().get() == this){ // the cached recipe matches the file again
+			cached->second.mtime_ns = entry.mtime_ns;
+			cached->second.size = entry.size;
+		}else{ // another recipe has been overwritten -> load the file again when it is needed
+			recipeCache.erase(cached);
+		}
+	}
+	recipeCacheMtx.unlock();
+}
+bool Recipe::getFileStamp(std::string path, CacheEntry &entry){
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0){
+		return false;
+	}
+	entry.mtime_ns = (std::int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+	entry.size = st.st_size;
+	return true;
+}
 void Recipe::setName(std::string name){
 	if (recipeWithNameExists(name)){
 		std::cout << "warning - recipe with name '" << name << "' already exists" << std::endl;
 	}
-	Task::setName(name);
+	
+	//move the recipe to the entry of the new name
+	all_recipesMtx.lock();
+	if (registered){
+		RegistryEntry entry;
+		entry.recipe = this;
+		entry.weak = removeFromRegistry();
+		Task::setName(name);
+		all_recipes[Recipe::name].push_back(entry);
+		registered = true;
+	}else{ // called by the constructor
+		Task::setName(name);
+	}
+	all_recipesMtx.unlock();
 }
 
 std::string Recipe::getPath() const{
@@ -278,14 +512,14 @@ Recipe::Recipe_ptr Recipe::getRecipeByName(std::string name){
 	Recipe_ptr retVal;
 	
 	all_recipesMtx.lock();
-	for (std::vector<std::weak_ptr<Recipe>>::iterator it = all_recipes.begin(); it != all_recipes.end(); it++){
-		if (Recipe_ptr r = it->lock()){ // pointer is not expired
-			if (r->getName().compare(name) == 0){ //found recipe
-				retVal = r;
+	std::unordered_map<std::string, std::vector<RegistryEntry>>::const_iterator bucket = all_recipes.find(name);
+	if (bucket != all_recipes.cend()){
+		// the latest recipe is preferred (e.g. loaded again after the file has been changed)
+		for (std::vector<RegistryEntry>::const_reverse_iterator rit = bucket->second.crbegin(); rit != bucket->second.crend(); rit++){
+			retVal = rit->weak.lock();
+			if (retVal != nullptr){ // pointer is not expired
 				break;
 			}
-		}else{
-			std::cout << "found expired weak_ptr in global list" << std::endl;
 		}
 	}
 	all_recipesMtx.unlock();
@@ -293,6 +527,7 @@ Recipe::Recipe_ptr Recipe::getRecipeByName(std::string name){
 }
 
 std::list<Task::DEVICES> Recipe::getNecessaryDevices(){
+	loadBody();
 	std::list<Task::DEVICES> devices;
 	
 	// for all tasks of the recipe
@@ -0,0 +1,142 @@
+#include "SerialReader.h"
+
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+SerialReader::SerialReader(int fd): fd(fd){
+	head = 0;
+	tail = 0;
+	used = 0;
+	lines = 0;
+	closed = false;
+	running = false;
+}
+SerialReader::~SerialReader(){
+	stop();
+}
+
+void SerialReader::start(){
+	if (!running){
+		running = true;
+		closed = false;
+		reader_thread = std::thread(&SerialReader::readThread, this);
+	}
+}
+void SerialReader::stop(){
+	running = false;
+	spaceAvailable.notify_all();
+	if (reader_thread.joinable()){
+		reader_thread.join();
+	}
+	lineReceived.notify_all();
+}
+
+void SerialReader::readThread(){
+	char buffer[1024];
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	
+	while (running){
+		std::size_t space;
+		{
+			std::unique_lock<std::mutex> lock(ringMtx);
+			spaceAvailable.wait_for(lock, std::chrono::milliseconds(SERIAL_READER_POLL_MS), [this](){ return used < SERIAL_READER_RING_SIZE || !running; });
+			space = SERIAL_READER_RING_SIZE - used; // only this thread fills the buffer -> at least this space is available below
+		}
+		if (space == 0){ // buffer full -> the data stays in the tty buffer
+			continue;
+		}
+		
+		int ret = poll(&pfd, 1, SERIAL_READER_POLL_MS);
+		if (ret < 0 && errno == EINTR){
+			continue;
+		}
+		
+		ssize_t n = 0;
+		bool error = (ret < 0);
+		if (ret > 0){
+			n = read(fd, buffer, std::min(sizeof(buffer), space));
+			error = (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR));
+		}
+		
+		if (error){ // port closed
+			ringMtx.lock();
+			closed = true;
+			ringMtx.unlock();
+			lineReceived.notify_all();
+			break;
+		}
+		
+		if (n > 0){
+			bool newLine = false;
+			
+			ringMtx.lock();
+			for (ssize_t i = 0; i < n; i++){
+				ring[head] = buffer[i];
+				head = (head + 1) % SERIAL_READER_RING_SIZE;
+				used++;
+				if (buffer[i] == '\n'){
+					lines++;
+					newLine = true;
+				}
+			}
+			bool full = (used == SERIAL_READER_RING_SIZE);
+			ringMtx.unlock();
+			
+			if (newLine || full){ // full without a line: readLine reports the error
+				lineReceived.notify_one();
+			}
+		}
+	}
+}
+
+bool SerialReader::readLine(char* line, std::size_t maxLen, std::size_t &len, int timeout_ms){
+	std::unique_lock<std::mutex> lock(ringMtx);
+	len = 0;
+	
+	lineReceived.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this](){ return lines > 0 || used == SERIAL_READER_RING_SIZE || closed || !running; });
+	if (lines == 0){
+		if (used == SERIAL_READER_RING_SIZE){ // the line does not fit into the buffer -> discard it, the reader continues
+			head = tail = used = 0;
+			lock.unlock();
+			spaceAvailable.notify_one();
+			throw std::runtime_error("serial line longer than " + std::to_string(SERIAL_READER_RING_SIZE) + " bytes");
+		}
+		if (closed){
+			throw std::runtime_error("serial port closed" + (used > 0 ? ", " + std::to_string(used) + " bytes of an incomplete line lost" : std::string("")));
+		}
+		return false; // timeout / stopped
+	}
+	
+	bool truncated = false;
+	while (used > 0){
+		char c = ring[tail];
+		tail = (tail + 1) % SERIAL_READER_RING_SIZE;
+		used--;
+		
+		if (c == '\n'){
+			break;
+		}
+		if (c != '\r'){
+			if (len < maxLen){
+				line[len++] = c;
+			}else{
+				truncated = true;
+			}
+		}
+	}
+	lines--;
+	lock.unlock();
+	spaceAvailable.notify_one();
+	
+	if (truncated){
+		throw std::runtime_error("serial line longer than " + std::to_string(maxLen) + " characters");
+	}
+	return true;
+}
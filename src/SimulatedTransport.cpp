@@ -0,0 +1,403 @@
+#include "SimulatedTransport.h"
+#include "Addresses.h"
+#include "Relais.h"
+
+#include <thread>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// adc values of the voltage dividers, see I2CVoltageTask
+#define SIMULATED_ATTINY45_ADC_PER_V (((double) VOLTAGE_ATTINY45_R2) / (((double) VOLTAGE_ATTINY45_R1) + ((double) VOLTAGE_ATTINY45_R2)) * ((double) VOLTAGE_ATTINY45_R_CORR) / 5.0)
+#define SIMULATED_ATMEGA32_ADC_PER_V (((double) VOLTAGE_ATMEGA32_R2) / (((double) VOLTAGE_ATMEGA32_R1) + ((double) VOLTAGE_ATMEGA32_R2)) * ((double) VOLTAGE_ATMEGA32_R_CORR) / 5.0)
+
+SimulatedTransport::SimulatedTransport_ptr SimulatedTransport::create(){
+	return SimulatedTransport_ptr(new SimulatedTransport());
+}
+SimulatedTransport::SimulatedTransport(){
+	i2cByteUs = SIMULATED_I2C_BYTE_US;
+	gpioWriteNs = SIMULATED_GPIO_WRITE_NS;
+	rampVPerS = SIMULATED_VOLTAGE_RAMP_V_PER_S;
+	dischargeVPerS = SIMULATED_VOLTAGE_DISCHARGE_V_PER_S;
+	timeConstantMs = SIMULATED_VOLTAGE_TIME_CONSTANT_MS;
+	gain = 1.0;
+	voltage = 0;
+	lastVoltageUpdate = Clock::now();
+	externalVoltage = 0;
+	temperature = 22.0;
+	humidity = 40.0;
+	gpioWrites = 0;
+	i2cTransfers = 0;
+	recording = false;
+	
+	const int addresses[] = {I2C_ATMEGA32_SLAVE_ADDRESS, I2C_ATTINY45_VOLT_SLAVE_ADDRESS, I2C_ATTINY45_FREQ_SLAVE_ADDRESS};
+	for (int i = 0; i < 3; i++){
+		Slave &s = slaves[addresses[i]];
+		std::memset(s.registers, 0, sizeof(s.registers));
+		s.registers[0x00] = addresses[i]; // id register
+		s.pointer = 0;
+		s.connected = true;
+	}
+	slaves[I2C_ATTINY45_VOLT_SLAVE_ADDRESS].registers[I2C_ATTINY45_VOLT_BUFFER_OCR1C] = 0xFF;
+}
+
+void SimulatedTransport::setLatency(unsigned int i2cByteUs, unsigned int gpioWriteNs){
+	mtx.lock();
+	SimulatedTransport::i2cByteUs = i2cByteUs;
+	SimulatedTransport::gpioWriteNs = gpioWriteNs;
+	mtx.unlock();
+}
+
+void SimulatedTransport::setVoltageSlope(double rampVPerS, double dischargeVPerS){
+	mtx.lock();
+	updateVoltage();
+	SimulatedTransport::rampVPerS = rampVPerS;
+	SimulatedTransport::dischargeVPerS = dischargeVPerS;
+	mtx.unlock();
+}
+
+void SimulatedTransport::setVoltageResponse(double timeConstantMs, double gain){
+	mtx.lock();
+	updateVoltage();
+	SimulatedTransport::timeConstantMs = timeConstantMs;
+	SimulatedTransport::gain = gain;
+	mtx.unlock();
+}
+
+void SimulatedTransport::setExternalVoltage(double v){
+	mtx.lock();
+	externalVoltage = v;
+	mtx.unlock();
+}
+
+void SimulatedTransport::setClimate(double temperature, double humidity){
+	mtx.lock();
+	SimulatedTransport::temperature = temperature;
+	SimulatedTransport::humidity = humidity;
+	mtx.unlock();
+}
+
+void SimulatedTransport::setConnected(int address, bool connected){
+	mtx.lock();
+	std::map<int, Slave>::iterator it = slaves.find(address);
+	if (it != slaves.end()){
+		it->second.connected = connected;
+	}
+	mtx.unlock();
+}
+
+int SimulatedTransport::getRegister(int address, int reg){
+	int value = -1;
+	mtx.lock();
+	std::map<int, Slave>::iterator it = slaves.find(address);
+	if (it != slaves.end()){
+		value = it->second.registers[reg & 0xFF];
+	}
+	mtx.unlock();
+	return value;
+}
+
+double SimulatedTransport::getInternalVoltage(){
+	mtx.lock();
+	updateVoltage();
+	double v = voltage;
+	mtx.unlock();
+	return v;
+}
+
+bool SimulatedTransport::getPin(int pin){
+	mtx.lock();
+	bool value = pins[pin];
+	mtx.unlock();
+	return value;
+}
+
+std::uint32_t SimulatedTransport::getPins(){
+	mtx.lock();
+	std::uint32_t mask = pinMask();
+	mtx.unlock();
+	return mask;
+}
+
+void SimulatedTransport::recordPins(bool record){
+	mtx.lock();
+	recording = record;
+	if (record){
+		recordedPins.clear();
+	}
+	mtx.unlock();
+}
+
+std::vector<std::uint32_t> SimulatedTransport::getRecordedPins(){
+	mtx.lock();
+	std::vector<std::uint32_t> r = recordedPins;
+	mtx.unlock();
+	return r;
+}
+
+unsigned long SimulatedTransport::getGpioWrites(){
+	mtx.lock();
+	unsigned long n = gpioWrites;
+	mtx.unlock();
+	return n;
+}
+
+unsigned long SimulatedTransport::getI2CTransfers(){
+	mtx.lock();
+	unsigned long n = i2cTransfers;
+	mtx.unlock();
+	return n;
+}
+
+void SimulatedTransport::setup(){
+	
+}
+
+void SimulatedTransport::setOutput(int pin){
+	mtx.lock();
+	pins[pin] = false;
+	mtx.unlock();
+}
+
+void SimulatedTransport::digitalWrite(int pin, bool value){
+	mtx.lock();
+	pins[pin] = value;
+	gpioWrites++;
+	unsigned int ns = gpioWriteNs;
+	mtx.unlock();
+	
+	if (ns > 0){
+		wait(std::chrono::nanoseconds(ns));
+	}
+}
+
+bool SimulatedTransport::digitalRead(int pin){
+	return getPin(pin);
+}
+
+void SimulatedTransport::writePins(std::uint32_t set, std::uint32_t clear){
+	mtx.lock();
+	for (int pin = 0; pin < TRANSPORT_GPIO_PINS; pin++){
+		std::uint32_t bit = (1u << toBcm(pin));
+		if ((clear & bit) != 0){ // cleared after set
+			pins[pin] = false;
+		}else if ((set & bit) != 0){
+			pins[pin] = true;
+		}
+	}
+	unsigned int writes = (set != 0 ? 1 : 0) + (clear != 0 ? 1 : 0);
+	gpioWrites += writes;
+	unsigned int ns = gpioWriteNs * writes;
+	mtx.unlock();
+	
+	if (ns > 0){
+		wait(std::chrono::nanoseconds(ns));
+	}
+}
+
+void SimulatedTransport::delayMicroseconds(unsigned int us){
+	mtx.lock();
+	if (recording){
+		recordedPins.push_back(pinMask());
+	}
+	mtx.unlock();
+	
+	wait(std::chrono::microseconds(us));
+}
+
+int SimulatedTransport::i2cSetup(int address){
+	mtx.lock();
+	bool exists = (slaves.find(address) != slaves.end());
+	mtx.unlock();
+	
+	return (exists ? address : -1); // the address is used as file descriptor
+}
+
+int SimulatedTransport::i2cWrite(int fd, int data){
+	transfer(2); // address, data
+	
+	int retval = -1;
+	mtx.lock();
+	Slave *s = getSlave(fd);
+	if (s != nullptr){
+		s->pointer = data & 0xFF;
+		retval = 0;
+	}
+	mtx.unlock();
+	return retval;
+}
+
+int SimulatedTransport::i2cRead(int fd){
+	transfer(2); // address, data
+	
+	int retval = -1;
+	mtx.lock();
+	Slave *s = getSlave(fd);
+	if (s != nullptr){
+		onRead(fd, s->pointer);
+		retval = s->registers[s->pointer];
+	}
+	mtx.unlock();
+	return retval;
+}
+
+int SimulatedTransport::i2cWriteReg8(int fd, int reg, int data){
+	transfer(3); // address, register, data
+	
+	int retval = -1;
+	mtx.lock();
+	Slave *s = getSlave(fd);
+	if (s != nullptr && reg != 0x00){ // the id is read only
+		updateVoltage(); // with the old relais / setpoint
+		s->registers[reg & 0xFF] = data & 0xFF;
+		onWrite(fd, reg & 0xFF);
+		retval = 0;
+	}
+	mtx.unlock();
+	return retval;
+}
+
+int SimulatedTransport::i2cReadBlock(int fd, int reg, unsigned char* data, int count){
+	transfer(3 + count); // address, register, address, data
+	
+	int retval = -1;
+	mtx.lock();
+	Slave *s = getSlave(fd);
+	if (s != nullptr){
+		for (int i = 0; i < count; i++){ // the register pointer is incremented after each byte
+			s->pointer = (reg + i) & 0xFF;
+			onRead(fd, s->pointer);
+			data[i] = s->registers[s->pointer];
+		}
+		s->pointer = (reg + count) & 0xFF;
+		retval = 0;
+	}
+	mtx.unlock();
+	return retval;
+}
+
+int SimulatedTransport::i2cWriteBlock(int fd, int reg, const unsigned char* data, int count){
+	transfer(2 + count); // address, register, data
+	
+	int retval = -1;
+	mtx.lock();
+	Slave *s = getSlave(fd);
+	if (s != nullptr && (reg & 0xFF) != 0x00){ // the id is read only
+		updateVoltage(); // with the old relais / setpoint
+		for (int i = 0; i < count; i++){
+			s->registers[(reg + i) & 0xFF] = data[i];
+			onWrite(fd, (reg + i) & 0xFF);
+		}
+		s->pointer = (reg + count) & 0xFF;
+		retval = 0;
+	}
+	mtx.unlock();
+	return retval;
+}
+
+int SimulatedTransport::serialOpen(const std::string &device, int baud){
+	return -1; // not modelled
+}
+
+void SimulatedTransport::serialPuts(int fd, const std::string &s){
+	
+}
+
+void SimulatedTransport::serialClose(int fd){
+	
+}
+
+SimulatedTransport::Slave* SimulatedTransport::getSlave(int address){
+	i2cTransfers++;
+	std::map<int, Slave>::iterator it = slaves.find(address);
+	if (it == slaves.end() || !it->second.connected){
+		return nullptr;
+	}
+	return &it->second;
+}
+
+void SimulatedTransport::onWrite(int address, int reg){
+	if (address == I2C_ATMEGA32_SLAVE_ADDRESS && reg == I2C_ATMEGA32_BUFFER_TEMP_REQUEST){ // dht11 measurement
+		unsigned char *r = slaves[address].registers;
+		if (r[reg] == 0x01){
+			r[I2C_ATMEGA32_BUFFER_TEMP_DATA0] = (int) humidity;
+			r[I2C_ATMEGA32_BUFFER_TEMP_DATA1] = std::lround((humidity - (int) humidity) * 10) % 10;
+			r[I2C_ATMEGA32_BUFFER_TEMP_DATA2] = (int) temperature;
+			r[I2C_ATMEGA32_BUFFER_TEMP_DATA3] = std::lround((temperature - (int) temperature) * 10) % 10;
+			r[I2C_ATMEGA32_BUFFER_TEMP_DATA4] = r[I2C_ATMEGA32_BUFFER_TEMP_DATA0] + r[I2C_ATMEGA32_BUFFER_TEMP_DATA1] + r[I2C_ATMEGA32_BUFFER_TEMP_DATA2] + r[I2C_ATMEGA32_BUFFER_TEMP_DATA3]; // parity
+			r[I2C_ATMEGA32_BUFFER_TEMP_READY] = 0x01;
+			r[reg] = 0x00;
+		}
+	}else if (address == I2C_ATTINY45_VOLT_SLAVE_ADDRESS && (reg == I2C_ATTINY45_VOLT_BUFFER_DUTY_CYCLE || reg == I2C_ATTINY45_VOLT_BUFFER_MODE)){
+		unsigned char *r = slaves[address].registers;
+		if (r[I2C_ATTINY45_VOLT_BUFFER_MODE] == I2C_ATTINY45_VOLT_BUFFER_MODE_DUTY){
+			r[I2C_ATTINY45_VOLT_BUFFER_OCR1A] = r[I2C_ATTINY45_VOLT_BUFFER_DUTY_CYCLE];
+		}
+	}
+}
+
+void SimulatedTransport::onRead(int address, int reg){
+	if (address == I2C_ATTINY45_VOLT_SLAVE_ADDRESS && reg == I2C_ATTINY45_VOLT_BUFFER_ADCL){ // reading ADCL latches ADCH
+		updateVoltage();
+		int adc = std::min(1023L, std::lround(voltage * SIMULATED_ATTINY45_ADC_PER_V * 1023.0));
+		slaves[address].registers[I2C_ATTINY45_VOLT_BUFFER_ADCL] = adc & 0xFF;
+		slaves[address].registers[I2C_ATTINY45_VOLT_BUFFER_ADCH] = (adc >> 8) & 0xFF;
+	}else if (address == I2C_ATMEGA32_SLAVE_ADDRESS && reg == I2C_ATMEGA32_BUFFER_ADCL){
+		int adc = std::min(1023L, std::lround(externalVoltage * SIMULATED_ATMEGA32_ADC_PER_V * 1023.0));
+		slaves[address].registers[I2C_ATMEGA32_BUFFER_ADCL] = adc & 0xFF;
+		slaves[address].registers[I2C_ATMEGA32_BUFFER_ADCH] = (adc >> 8) & 0xFF;
+	}
+}
+
+void SimulatedTransport::updateVoltage(){
+	Clock::time_point now = Clock::now();
+	double elapsed = std::chrono::duration<double>(now - lastVoltageUpdate).count();
+	lastVoltageUpdate = now;
+	
+	const unsigned char *tiny = slaves[I2C_ATTINY45_VOLT_SLAVE_ADDRESS].registers;
+	bool supplied = (slaves[I2C_ATMEGA32_SLAVE_ADDRESS].registers[I2C_ATMEGA32_BUFFER_RELAISL] >> Relais::RELAIS::R_STEUER_SAFETY) & 1;
+	
+	if (!supplied){ // capacitor is discharged
+		voltage = std::max(0.0, voltage - dischargeVPerS * elapsed);
+	}else if (tiny[I2C_ATTINY45_VOLT_BUFFER_MODE] == I2C_ATTINY45_VOLT_BUFFER_MODE_CONT){ // controller ramps up to the setpoint
+		double setpoint = gain * (tiny[I2C_ATTINY45_VOLT_BUFFER_ADCH_S] * 256 + tiny[I2C_ATTINY45_VOLT_BUFFER_ADCL_S]) / (SIMULATED_ATTINY45_ADC_PER_V * 1024.0);
+		if (voltage < setpoint){ // a higher voltage is kept until the capacitor is discharged
+			double step = (setpoint - voltage);
+			if (timeConstantMs > 0){
+				step *= 1.0 - std::exp(-elapsed * 1000.0 / timeConstantMs);
+			}
+			voltage += std::min(step, rampVPerS * elapsed);
+		}
+	}
+}
+
+void SimulatedTransport::transfer(unsigned int bytes){
+	mtx.lock();
+	unsigned int us = bytes * i2cByteUs;
+	mtx.unlock();
+	
+	if (us > 0){
+		wait(std::chrono::microseconds(us));
+	}
+}
+
+std::uint32_t SimulatedTransport::pinMask(){
+	std::uint32_t mask = 0;
+	for (std::map<int, bool>::const_iterator cit = pins.cbegin(); cit != pins.cend(); cit++){
+		if (cit->second && toBcm(cit->first) >= 0){
+			mask |= (1u << toBcm(cit->first));
+		}
+	}
+	return mask;
+}
+
+void SimulatedTransport::wait(Clock::duration d){
+	if (d < std::chrono::microseconds(100)){ // short delays are busy waits like in wiringPi
+		Clock::time_point end = Clock::now() + d;
+		while (Clock::now() < end){
+			
+		}
+	}else{
+		std::this_thread::sleep_for(d);
+	}
+}
@@ -0,0 +1,156 @@
+#include "Simulator.h"
+#include "PadTimeline.h"
+#include "DummyImpAnalyser.h"
+#include "FSHelper.h"
+#include "Addresses.h"
+
+#include <ctime>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+SimulationAnalyserModel::SimulationAnalyserModel(double overheadMs, double msPerPoint, double periodsPerPoint): overheadMs(overheadMs), msPerPoint(msPerPoint), periodsPerPoint(periodsPerPoint){
+	
+}
+
+SimulationModel::SimulationModel(){
+	taskOverheadMs = 0.5;
+	relaisAccessMs = RELAIS_ACCESS_TIME_MS;
+	relaisSettleMs = IMP_RELAIS_SETTLE_MS;
+	i2cAccessMs = 1;
+	padTimelineStartMs = PAD_TIMELINE_START_DELAY_US / 1000.0;
+	voltageRampVPerS = 100;
+	voltageDischargeVPerS = 200;
+	tempMeasurementMs = 2050; // request, 2s conversion, 50ms until the data is ready
+	spectrometerReadoutMs = 20;
+	
+	analysers[ImpAnalyser::ANALYSER_DEVICE::ANALYSER_NOVOCONTROL] = SimulationAnalyserModel(500, 300, 3);
+	analysers[ImpAnalyser::ANALYSER_DEVICE::ANALYSER_HP4294A] = SimulationAnalyserModel(1000, 5, 1);
+	analysers[ImpAnalyser::ANALYSER_DEVICE::ANALYSER_EMPICO] = SimulationAnalyserModel(200, 50, 2);
+	analysers[ImpAnalyser::ANALYSER_DEVICE::ANALYSER_DUMMY] = SimulationAnalyserModel(DUMMY_SWEEP_DELAY_MS, 0, 0);
+}
+
+double SimulationResult::getRunsPerHour() const{
+	return (totalS > 0 ? 3600.0 / totalS : 0);
+}
+
+std::string SimulationResult::to_string() const{
+	std::string s = "start[s]\tduration[s]\ttask\n";
+	for (std::vector<SimulationEntry>::const_iterator cit = timeline.cbegin(); cit != timeline.cend(); cit++){
+		s += FSHelper::formatDouble(cit->startS) + "\t" + FSHelper::formatDouble(cit->durationS) + "\t" + std::string(2 * cit->depth, ' ') + cit->type + ": " + cit->name + "\n";
+	}
+	s += "total: " + FSHelper::formatTime(std::lround(totalS)) + " (" + FSHelper::formatDouble(totalS) + "s), " + FSHelper::formatDouble(getRunsPerHour()) + " runs/h, simulated in " + FSHelper::formatDouble(cpuS) + "s CPU time\n";
+	for (std::map<std::string, double>::const_iterator cit = timePerType.cbegin(); cit != timePerType.cend(); cit++){
+		s += cit->first + ": " + FSHelper::formatDouble(cit->second) + "s (" + FSHelper::formatDouble(totalS > 0 ? std::round(cit->second / totalS * 1000) / 10 : 0) + "%)\n";
+	}
+	return s;
+}
+
+Simulator::Simulator_ptr Simulator::create(const SimulationModel &model){
+	return Simulator_ptr(new Simulator(model));
+}
+Simulator::Simulator(const SimulationModel &model): model(model){
+	timeMs = 0;
+	voltage = 0;
+}
+
+SimulationResult Simulator::simulate(Task::Task_ptr task){
+	std::clock_t cpuStart = std::clock();
+	timeMs = 0;
+	voltage = 0;
+	timeline.clear();
+	open.clear();
+	
+	run(task);
+	
+	SimulationResult result;
+	result.timeline = timeline;
+	result.totalS = 0;
+	for (std::vector<SimulationEntry>::const_iterator cit = timeline.cbegin(); cit != timeline.cend(); cit++){
+		result.totalS = std::max(result.totalS, cit->startS + cit->durationS);
+		if (cit->leaf){
+			result.timePerType[cit->type] += cit->durationS;
+		}
+	}
+	result.cpuS = ((double) (std::clock() - cpuStart)) / CLOCKS_PER_SEC;
+	return result;
+}
+
+void Simulator::run(Task::Task_ptr task, const ExecutionHints &hints){
+	ExecutionHints parentHints = Simulator::hints;
+	Simulator::hints = hints;
+	
+	begin(*task);
+	wait(model.taskOverheadMs);
+	task->simulate(*this);
+	end();
+	
+	Simulator::hints = parentHints;
+}
+
+const ExecutionHints& Simulator::getHints() const{
+	return hints;
+}
+
+void Simulator::begin(const Task &task){
+	if (!open.empty()){ // the running task has sub tasks
+		timeline[open.back()].leaf = false;
+	}
+	SimulationEntry e;
+	e.name = task.getName();
+	e.type = task.getType();
+	e.depth = open.size();
+	e.startS = timeMs / 1000.0;
+	e.durationS = 0;
+	e.leaf = true;
+	open.push_back(timeline.size());
+	timeline.push_back(e);
+}
+
+void Simulator::end(){
+	if (open.empty()){
+		throw std::runtime_error("Simulator::end() without begin()");
+	}
+	SimulationEntry &e = timeline[open.back()];
+	e.durationS = timeMs / 1000.0 - e.startS;
+	open.pop_back();
+}
+
+void Simulator::wait(double ms){
+	timeMs += ms;
+}
+
+double Simulator::getTimeMs() const{
+	return timeMs;
+}
+
+void Simulator::setTimeMs(double ms){
+	timeMs = ms;
+}
+
+const SimulationModel& Simulator::getModel() const{
+	return model;
+}
+
+double Simulator::getSweepMs(const ImpAnalyser &analyser) const{
+	std::map<ImpAnalyser::ANALYSER_DEVICE, SimulationAnalyserModel>::const_iterator a = model.analysers.find(analyser.getAnalyserType());
+	if (a == model.analysers.end()){
+		return 0;
+	}
+	
+	double ms = a->second.overheadMs;
+	for (int i = 0; i < analyser.getPoints(); i++){
+		double freq = analyser.getPointFrequency(i);
+		double pointMs = std::max(a->second.msPerPoint, (freq > 0 ? a->second.periodsPerPoint * 1000.0 / freq : 0));
+		ms += pointMs * std::max(1, analyser.getPointAverage());
+	}
+	return ms;
+}
+
+double Simulator::getVoltage() const{
+	return voltage;
+}
+
+void Simulator::setVoltage(double v){
+	voltage = v;
+}
@@ -1,5 +1,6 @@
 #include "Spectrometer.h"
 #include "FSHelper.h"
+#include "Trace.h"
 
 #include <iostream>
 #include <stdlib.h>
@@ -92,9 +93,9 @@ std::vector<double> Spectrometer::getFormattedSpectrum() {
 	}
 	return spectrum;
 }
-std::vector<DataP::DataP_ptr> Spectrometer::getFormattedSpectrum_DataPoints() {
+Spectrum Spectrometer::getFormattedSpectrum_DataPoints() {
 	int error = 0;
-	std::vector<DataP::DataP_ptr> spectrum;
+	Spectrum spectrum;
 	
 	if (id == -1){ // spectrometer has not been initialized
 		init();
@@ -109,8 +110,9 @@ std::vector<DataP::DataP_ptr> Spectrometer::getFormattedSpectrum_DataPoints() {
 		spectr->spectrometerGetWavelengths(id, spectrometer_id, &error, wavelengths, formattedSpectrum.size()); if (error != 0) throw std::runtime_error("spectrometerGetWavelengths - " + std::string(sbapi_get_error_string(error)));
 		
 		
+		spectrum.reserve(formattedSpectrum.size());
 		for (int i = 0; i < formattedSpectrum.size(); i++){
-			spectrum.push_back(std::make_shared<DataP>(wavelengths[i], formattedSpectrum.at(i)));
+			spectrum.add(wavelengths[i], formattedSpectrum.at(i));
 		}
 		delete [] wavelengths;
 		
@@ -162,7 +164,7 @@ void Spectrometer::setIntegrationTimeMicros(unsigned long integrationtime_us){
 		throw std::runtime_error("no spectrometer found");
 	}
 }
-void Spectrometer::save_spectrumCSV(const std::vector<DataP::DataP_ptr> &spectre, std::string path, double timediff){
+void Spectrometer::save_spectrumCSV(const Spectrum &spectre, std::string path, double timediff){
 	FSHelper::save_dataPToCsv(spectre, path, true, false, false, false, "wavelength", "intensity", "timediff=" + FSHelper::formatDouble(timediff)+ "s");
 }
 void Spectrometer::setScansToAverage(unsigned int scansToAverage){
@@ -252,6 +254,7 @@ void Spectrometer::openDevice(){
 
 // !! spectr needs to be opened and closed outside this function !!
 std::vector<double> Spectrometer::getSpectrum(){
+	Trace::Span span("spectrometer", "getSpectrum", "scans", scansToAverage);
 	int error = 0;
 	std::vector<double> spectrum;
 	int formattedSpectrumLength = spectr->spectrometerGetFormattedSpectrumLength(id, spectrometer_id, &error);  if (error != 0) throw std::runtime_error("spectrometerGetFormattedSpectrumLength - " + std::string(sbapi_get_error_string(error)));
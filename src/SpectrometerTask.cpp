@@ -1,5 +1,6 @@
 #include "SpectrometerTask.h"
 #include "FSHelper.h"
+#include "Simulator.h"
 
 #include <stdexcept>
 
@@ -14,7 +15,7 @@ SpectrometerTask::~SpectrometerTask(){
 	
 }
 
-void SpectrometerTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void SpectrometerTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	if (spectrometer != nullptr){
 		try{
 			spectrometer->setIntegrationTimeMicros(integrationTimeMicros);
@@ -85,3 +86,12 @@ std::list<Task::DEVICES> SpectrometerTask::getNecessaryDevices(){
 	
 	return devices;
 }
+bool SpectrometerTask::isBarrier(){
+	return false;
+}
+void SpectrometerTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	
+}
+void SpectrometerTask::simulate(Simulator &sim){
+	sim.wait(scansToAverage * (integrationTimeMicros / 1000.0 + sim.getModel().spectrometerReadoutMs));
+}
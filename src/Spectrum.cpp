@@ -0,0 +1,209 @@
+#include "Spectrum.h"
+
+#include <math.h>
+
+Spectrum::Data::Data(){
+	absPhaseCount = 0;
+}
+
+Spectrum::Spectrum(){
+	
+}
+
+void Spectrum::detach(){
+	if (data == nullptr){
+		data = std::make_shared<Data>();
+	}else if (data.use_count() > 1){ // shared with another spectrum -> copy
+		std::shared_ptr<Data> d = std::make_shared<Data>();
+		d->x = data->x;
+		d->y_real = data->y_real;
+		d->y_imag = data->y_imag;
+		data = d;
+	}
+}
+void Spectrum::calculateAbsPhase() const{
+	std::size_t n = data->x.size();
+	if (data->absPhaseCount < n){
+		data->absPhaseMtx.lock();
+		if (data->absPhaseCount < n){
+			data->y_abs.resize(n);
+			data->y_phase.resize(n);
+			for (std::size_t i = data->absPhaseCount; i < n; i++){
+				double re = data->y_real[i];
+				double im = data->y_imag[i];
+				data->y_abs[i] = std::sqrt(re * re + im * im);
+				data->y_phase[i] = std::atan2(im, re);
+			}
+			data->absPhaseCount = n;
+		}
+		data->absPhaseMtx.unlock();
+	}
+}
+
+void Spectrum::reserve(std::size_t n){
+	detach();
+	data->x.reserve(n);
+	data->y_real.reserve(n);
+	data->y_imag.reserve(n);
+}
+void Spectrum::add(double x, double y_real, double y_imag){
+	detach();
+	data->x.push_back(x);
+	data->y_real.push_back(y_real);
+	data->y_imag.push_back(y_imag);
+}
+void Spectrum::addAbsPhase(double x, double abs, double phase, DataP::COMPLEX_MODE m){
+	phase = (m == DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD) ? phase : degToRad(phase);
+	add(x, std::cos(phase) * abs, std::sin(phase) * abs);
+}
+void Spectrum::assign(const double* x, const double* y_real, const double* y_imag, std::size_t n){
+	if (data != nullptr && data.use_count() == 1){ // reuse the memory
+		data->absPhaseCount = 0;
+	}else{
+		data = std::make_shared<Data>();
+	}
+	data->x.assign(x, x + n);
+	data->y_real.assign(y_real, y_real + n);
+	data->y_imag.assign(y_imag, y_imag + n);
+}
+
+std::size_t Spectrum::size() const{
+	return (data == nullptr) ? 0 : data->x.size();
+}
+bool Spectrum::empty() const{
+	return size() == 0;
+}
+
+double Spectrum::getX(std::size_t i) const{
+	return data->x[i];
+}
+double Spectrum::getY(std::size_t i, DataP::COMPLEX_MODE m) const{
+	switch(m){
+		case DataP::COMPLEX_MODE::COMPLEX_REAL:
+			return data->y_real[i];
+		case DataP::COMPLEX_MODE::COMPLEX_IMAG:
+			return data->y_imag[i];
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD:
+			calculateAbsPhase();
+			return data->y_phase[i];
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_DEG:
+			calculateAbsPhase();
+			return radToDeg(data->y_phase[i]);
+		case DataP::COMPLEX_MODE::COMPLEX_ABS:
+		default:
+			calculateAbsPhase();
+			return data->y_abs[i];
+	}
+}
+
+const double* Spectrum::getXData() const{
+	return empty() ? nullptr : data->x.data();
+}
+const double* Spectrum::getRealData() const{
+	return empty() ? nullptr : data->y_real.data();
+}
+const double* Spectrum::getImagData() const{
+	return empty() ? nullptr : data->y_imag.data();
+}
+
+void Spectrum::getRange(DataP::COMPLEX_MODE m, double &x_min, double &x_max, double &y_min, double &y_max) const{
+	if (empty()){
+		x_min = 0;
+		x_max = 0;
+		y_min = 0;
+		y_max = 0;
+		return;
+	}
+	
+	const double* y;
+	switch(m){
+		case DataP::COMPLEX_MODE::COMPLEX_REAL:
+			y = data->y_real.data();
+			break;
+		case DataP::COMPLEX_MODE::COMPLEX_IMAG:
+			y = data->y_imag.data();
+			break;
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD:
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_DEG:
+			calculateAbsPhase();
+			y = data->y_phase.data();
+			break;
+		case DataP::COMPLEX_MODE::COMPLEX_ABS:
+		default:
+			calculateAbsPhase();
+			y = data->y_abs.data();
+			break;
+	}
+	
+	const double* x = data->x.data();
+	std::size_t n = data->x.size();
+	x_min = x[0];
+	x_max = x[0];
+	y_min = y[0];
+	y_max = y[0];
+	for (std::size_t i = 1; i < n; i++){
+		if (x[i] < x_min){
+			x_min = x[i];
+		}
+		if (x[i] > x_max){
+			x_max = x[i];
+		}
+		if (y[i] < y_min){
+			y_min = y[i];
+		}
+		if (y[i] > y_max){
+			y_max = y[i];
+		}
+	}
+	
+	if (m == DataP::COMPLEX_MODE::COMPLEX_PHASE_DEG){ // the conversion keeps the order
+		y_min = radToDeg(y_min);
+		y_max = radToDeg(y_max);
+	}
+}
+
+DataP::DataP_ptr Spectrum::at(std::size_t i) const{
+	return DataP::create(data->x[i], data->y_real[i], data->y_imag[i]);
+}
+std::string Spectrum::toCsvLine(std::size_t i, bool real, bool imag, bool abs, bool phase) const{
+	std::string returnString = std::to_string(data->x[i]);
+	
+	if (real){
+		returnString += ";";
+		returnString += std::to_string(data->y_real[i]);
+	}
+	
+	if (imag){
+		returnString += ";";
+		returnString += std::to_string(data->y_imag[i]);
+	}
+	
+	if (abs){
+		returnString += ";";
+		returnString += std::to_string(getY(i, DataP::COMPLEX_MODE::COMPLEX_ABS));
+	}
+	
+	if (phase){
+		returnString += ";";
+		returnString += std::to_string(getY(i, DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD));
+	}
+	
+	return returnString;
+}
+
+Spectrum Spectrum::fromDataP(const std::vector<DataP::DataP_ptr> &points){
+	Spectrum s;
+	s.reserve(points.size());
+	for (std::vector<DataP::DataP_ptr>::const_iterator cit = points.cbegin(); cit != points.cend(); cit++){
+		s.add((*cit)->getX(), (*cit)->getY(DataP::COMPLEX_MODE::COMPLEX_REAL), (*cit)->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG));
+	}
+	return s;
+}
+std::vector<DataP::DataP_ptr> Spectrum::toDataP() const{
+	std::vector<DataP::DataP_ptr> points;
+	points.reserve(size());
+	for (std::size_t i = 0; i < size(); i++){
+		points.push_back(at(i));
+	}
+	return points;
+}
@@ -0,0 +1,373 @@
+#include "SpectrumCsvReader.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// powers of 10 which can be represented exactly as double
+static const double exactPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+	1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+SpectrumCsvReader::SpectrumCsvReader(std::string path): path(path){
+	map = nullptr;
+	mapSize = 0;
+	pos = nullptr;
+	lineNo = 0;
+	
+	fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0){ // could not open the file
+		return;
+	}
+	
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0){ // nothing to map
+		return;
+	}
+	mapSize = st.st_size;
+	
+	void* m = mmap(nullptr, mapSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (m == MAP_FAILED){
+		close(fd);
+		throw std::runtime_error("could not map file " + path);
+	}
+	map = static_cast<const char*>(m);
+	pos = map;
+	madvise(m, mapSize, MADV_SEQUENTIAL);
+}
+SpectrumCsvReader::~SpectrumCsvReader(){
+	if (map != nullptr){
+		munmap(const_cast<char*>(map), mapSize);
+	}
+	if (fd >= 0){
+		close(fd);
+	}
+}
+
+bool SpectrumCsvReader::isOpen() const{
+	return map != nullptr;
+}
+
+bool SpectrumCsvReader::getLine(const char* &begin, const char* &end){
+	const char* mapEnd = map + mapSize;
+	if (pos == nullptr || pos >= mapEnd){
+		return false;
+	}
+	
+	begin = pos;
+	const char* newline = static_cast<const char*>(std::memchr(pos, '\n', mapEnd - pos));
+	if (newline == nullptr){ // last line without '\n'
+		end = mapEnd;
+		pos = mapEnd;
+	}else{
+		end = newline;
+		pos = newline + 1;
+	}
+	if (end > begin && *(end - 1) == '\r'){ // windows line ending
+		end--;
+	}
+	lineNo++;
+	
+	return true;
+}
+
+/*
+ * reads the position=... and timediff=... lines, begin / end point to the first other line (the header) afterwards
+ */
+void SpectrumCsvReader::readMetaLines(const char* &begin, const char* &end, bool &gotLine, int* position, double* timediff){
+	while ((gotLine = getLine(begin, end))){
+		std::size_t length = end - begin;
+		const char* value = static_cast<const char*>(std::memchr(begin, '=', length));
+		double d;
+		if (length >= 8 && std::strncmp(begin, "position", 8) == 0){
+			if (position != nullptr && value != nullptr && parseDouble(++value, end, d)){
+				*position = static_cast<int>(d);
+			}
+		}else if (length >= 8 && std::strncmp(begin, "timediff", 8) == 0){
+			if (timediff != nullptr && value != nullptr && parseDouble(++value, end, d)){
+				*timediff = d;
+			}
+		}else{
+			return;
+		}
+	}
+}
+
+std::vector<std::string> SpectrumCsvReader::splitHeader(const char* begin, const char* end) const{
+	std::vector<std::string> columns;
+	while (begin < end){
+		const char* separator = static_cast<const char*>(std::memchr(begin, ';', end - begin));
+		if (separator == nullptr){ // last element in row
+			separator = end;
+		}
+		columns.push_back(std::string(begin, separator));
+		begin = separator + 1;
+	}
+	return columns;
+}
+
+/*
+ * reads the next data line, the value of column i is stored in values[slots[i]] (not stored if slots[i] == -1)
+ */
+bool SpectrumCsvReader::readRow(const std::vector<int> &slots, double* values){
+	const char* begin;
+	const char* end;
+	do{
+		if (!getLine(begin, end)){
+			return false;
+		}
+	}while (begin == end); // skip empty lines
+	
+	const char* p = begin;
+	for (std::size_t i = 0; i < slots.size(); i++){
+		if (p > end){ // less elements than columns
+			throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no. of elements dismatch header - " + path);
+		}
+		
+		if (slots[i] == -1){ // skip column
+			const char* separator = static_cast<const char*>(std::memchr(p, ';', end - p));
+			p = (separator == nullptr) ? end : separator;
+		}else{
+			while (p < end && *p == ' '){
+				p++;
+			}
+			if (!parseDouble(p, end, values[slots[i]])){
+				throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no number in column " + std::to_string(i + 1) + " - " + path);
+			}
+			while (p < end && *p == ' '){
+				p++;
+			}
+		}
+		
+		if (p < end && *p != ';'){
+			throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - invalid number in column " + std::to_string(i + 1) + " - " + path);
+		}
+		p++; // skip ';'
+	}
+	if (p < end){ // more elements than columns (a ; at the end of the line is ignored)
+		throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no. of elements dismatch header - " + path);
+	}
+	
+	return true;
+}
+
+/*
+ * estimates the no of points from the length of the next line
+ */
+void SpectrumCsvReader::reserve(Spectrum &spectrum) const{
+	const char* mapEnd = map + mapSize;
+	if (pos == nullptr || pos >= mapEnd){
+		return;
+	}
+	const char* newline = static_cast<const char*>(std::memchr(pos, '\n', mapEnd - pos));
+	std::size_t lineLength = (newline == nullptr) ? mapEnd - pos : newline - pos + 1;
+	spectrum.reserve((mapEnd - pos) / lineLength + 1);
+}
+
+Spectrum SpectrumCsvReader::loadSpectrum(std::string path){
+	Spectrum spectrum;
+	SpectrumCsvReader reader(path);
+	if (!reader.isOpen()){
+		return spectrum;
+	}
+	
+	const char* begin;
+	const char* end;
+	bool gotLine;
+	reader.readMetaLines(begin, end, gotLine, nullptr, nullptr);
+	if (!gotLine || begin == end){ // no header
+		return spectrum;
+	}
+	
+	// read header
+	std::vector<std::string> columns = reader.splitHeader(begin, end);
+	std::vector<int> slots(columns.size(), -1);
+	bool wavelength = false, intensity = false;
+	for (std::size_t i = 0; i < columns.size(); i++){
+		if (columns[i].compare("wavelength") == 0){
+			slots[i] = 0;
+			wavelength = true;
+		}else if (columns[i].compare("intensity_real") == 0 || columns[i].compare("intensity") == 0){
+			slots[i] = 1;
+			intensity = true;
+		}
+	}
+	if (!wavelength){ // no wavelength information found
+		throw std::runtime_error("no wavelength found in file " + path);
+	}
+	if (!intensity){ // no intensity information found
+		throw std::runtime_error("no intensity_real found in file " + path);
+	}
+	
+	//read data
+	reader.reserve(spectrum);
+	double values[2];
+	while (reader.readRow(slots, values)){
+		spectrum.add(values[0], values[1]);
+	}
+	
+	return spectrum;
+}
+
+Spectrum SpectrumCsvReader::loadImpSpectrum(std::string path, int* position, double* timediff){
+	Spectrum spectrum;
+	SpectrumCsvReader reader(path);
+	if (!reader.isOpen()){
+		return spectrum;
+	}
+	
+	//overread possible header of transient impedance files
+	const char* begin;
+	const char* end;
+	bool gotLine;
+	reader.readMetaLines(begin, end, gotLine, position, timediff);
+	if (!gotLine || begin == end){ // no header
+		return spectrum;
+	}
+	
+	// read header
+	std::vector<std::string> columns = reader.splitHeader(begin, end);
+	std::vector<int> slots(columns.size(), -1);
+	short frequency = -1, impedance_real = -1, impedance_imag = -1, impedance_abs = -1, impedance_phase = -1;
+	for (std::size_t i = 0; i < columns.size(); i++){
+		if (columns[i].compare("frequency") == 0){
+			frequency = i;
+		}else if (columns[i].compare("impedance_real") == 0){
+			impedance_real = i;
+		}else if (columns[i].compare("impedance_imag") == 0){
+			impedance_imag = i;
+		}else if (columns[i].compare("impedance_abs") == 0){
+			impedance_abs = i;
+		}else if (columns[i].compare("impedance_phase") == 0){
+			impedance_phase = i;
+		}
+	}
+	
+	if (frequency == -1){ // no frequency information found
+		throw std::runtime_error("no freq information found in file " + path);
+	}
+	slots[frequency] = 0;
+	
+	bool absPhase = false;
+	if ((impedance_real != -1) && (impedance_imag != -1)){ // got real and imag information
+		slots[impedance_real] = 1;
+		slots[impedance_imag] = 2;
+	}else if ((impedance_phase != -1) && (impedance_abs != -1)){
+		slots[impedance_abs] = 1;
+		slots[impedance_phase] = 2;
+		absPhase = true;
+	}else { ///@todo add other possible combinations
+		throw std::runtime_error("data combination of real / imag / abs / phase not implemented");
+	}
+	
+	//read data
+	reader.reserve(spectrum);
+	double values[3];
+	while (reader.readRow(slots, values)){
+		if (absPhase){
+			spectrum.addAbsPhase(values[0], values[1], values[2], DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD);
+		}else{
+			spectrum.add(values[0], values[1], values[2]);
+		}
+	}
+	
+	return spectrum;
+}
+
+/*
+ * up to 19 significant digits are collected in an integer. If it fits into the mantissa of a double and the exponent is small
+ * enough, one multiplication / division by an exact power of 10 gives the correctly rounded result (this is always the case for
+ * numbers written by std::to_string). Otherwise the result is calculated with long double.
+ */
+bool SpectrumCsvReader::parseDouble(const char* &pos, const char* end, double &value){
+	const char* p = pos;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')){
+		negative = (*p == '-');
+		p++;
+	}
+	
+	if (p + 3 <= end && (std::strncmp(p, "nan", 3) == 0 || std::strncmp(p, "NAN", 3) == 0)){
+		p += 3;
+		while (p < end && *p != ';'){ // nan(...)
+			p++;
+		}
+		value = std::numeric_limits<double>::quiet_NaN();
+		pos = p;
+		return true;
+	}
+	if (p + 3 <= end && (std::strncmp(p, "inf", 3) == 0 || std::strncmp(p, "INF", 3) == 0)){
+		p += (p + 8 <= end && (std::strncmp(p, "infinity", 8) == 0 || std::strncmp(p, "INFINITY", 8) == 0)) ? 8 : 3;
+		value = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+		pos = p;
+		return true;
+	}
+	
+	uint64_t mantissa = 0;
+	int digits = 0; // significant digits in mantissa
+	int exponent = 0;
+	bool anyDigit = false;
+	while (p < end && *p >= '0' && *p <= '9'){ // integer part
+		if (digits < 19){
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += (mantissa != 0);
+		}else{
+			exponent++;
+		}
+		anyDigit = true;
+		p++;
+	}
+	if (p < end && (*p == '.' || *p == ',')){ // fraction
+		p++;
+		while (p < end && *p >= '0' && *p <= '9'){
+			if (digits < 19){
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa != 0);
+				exponent--;
+			}
+			anyDigit = true;
+			p++;
+		}
+	}
+	if (!anyDigit){
+		return false;
+	}
+	
+	if (p < end && (*p == 'e' || *p == 'E')){ // exponent
+		const char* e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')){
+			negativeExponent = (*e == '-');
+			e++;
+		}
+		if (e < end && *e >= '0' && *e <= '9'){
+			int exp = 0;
+			while (e < end && *e >= '0' && *e <= '9'){
+				if (exp < 10000){
+					exp = exp * 10 + (*e - '0');
+				}
+				e++;
+			}
+			exponent += negativeExponent ? -exp : exp;
+			p = e;
+		}
+	}
+	
+	double d;
+	if (mantissa == 0){
+		d = 0.0;
+	}else if (mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22){ // exact
+		d = (exponent < 0) ? static_cast<double>(mantissa) / exactPow10[-exponent] : static_cast<double>(mantissa) * exactPow10[exponent];
+	}else{
+		d = static_cast<double>(static_cast<long double>(mantissa) * std::pow(10.0L, exponent));
+	}
+	
+	value = negative ? -d : d;
+	pos = p;
+	return true;
+}
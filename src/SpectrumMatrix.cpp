@@ -0,0 +1,103 @@
+#include "SpectrumMatrix.h"
+
+#include <math.h>
+#include <limits>
+#include <algorithm>
+
+SpectrumMatrix::Column::Column(){
+	column = 0;
+	stride = 0;
+	rows = 0;
+}
+
+std::size_t SpectrumMatrix::Column::size() const{
+	return rows;
+}
+double SpectrumMatrix::Column::getTime(std::size_t i) const{
+	return buffer->time[i];
+}
+double SpectrumMatrix::Column::getY(std::size_t i, DataP::COMPLEX_MODE m) const{
+	double re = buffer->y_real[i * stride + column];
+	double im = buffer->y_imag[i * stride + column];
+	switch(m){
+		case DataP::COMPLEX_MODE::COMPLEX_REAL:
+			return re;
+		case DataP::COMPLEX_MODE::COMPLEX_IMAG:
+			return im;
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD:
+			return std::atan2(im, re);
+		case DataP::COMPLEX_MODE::COMPLEX_PHASE_DEG:
+			return radToDeg(std::atan2(im, re));
+		case DataP::COMPLEX_MODE::COMPLEX_ABS:
+		default:
+			return std::sqrt(re * re + im * im);
+	}
+}
+
+SpectrumMatrix::SpectrumMatrix(){
+	rows = 0;
+	cols = 0;
+}
+
+/*
+ * the old buffer is not changed, so views on the old buffer stay valid
+ */
+void SpectrumMatrix::grow(){
+	std::size_t capacity = (buffer == nullptr) ? SPECTRUM_MATRIX_INIT_ROWS : buffer->capacity * 2;
+	std::shared_ptr<Buffer> b = std::make_shared<Buffer>();
+	b->capacity = capacity;
+	b->y_real.resize(capacity * cols);
+	b->y_imag.resize(capacity * cols);
+	b->time.resize(capacity);
+	
+	if (buffer != nullptr){
+		std::copy(buffer->y_real.begin(), buffer->y_real.begin() + rows * cols, b->y_real.begin());
+		std::copy(buffer->y_imag.begin(), buffer->y_imag.begin() + rows * cols, b->y_imag.begin());
+		std::copy(buffer->time.begin(), buffer->time.begin() + rows, b->time.begin());
+	}
+	buffer = b;
+}
+
+void SpectrumMatrix::appendRow(double time, const Spectrum &s){
+	if (buffer == nullptr){ // first row
+		cols = s.size();
+		grow();
+	}else if (rows == buffer->capacity){
+		grow();
+	}
+	
+	// rows >= this row are not visible for existing views, so this row can be written without synchronization
+	double* re = buffer->y_real.data() + rows * cols;
+	double* im = buffer->y_imag.data() + rows * cols;
+	const double* s_re = s.getRealData();
+	const double* s_im = s.getImagData();
+	std::size_t n = (s.size() < cols) ? s.size() : cols;
+	std::copy(s_re, s_re + n, re);
+	std::copy(s_im, s_im + n, im);
+	std::fill(re + n, re + cols, std::numeric_limits<double>::quiet_NaN());
+	std::fill(im + n, im + cols, std::numeric_limits<double>::quiet_NaN());
+	buffer->time[rows] = time;
+	
+	rows++;
+}
+
+std::size_t SpectrumMatrix::getRows() const{
+	return rows;
+}
+std::size_t SpectrumMatrix::getColumns() const{
+	return cols;
+}
+double SpectrumMatrix::getTime(std::size_t row) const{
+	return buffer->time[row];
+}
+
+SpectrumMatrix::Column SpectrumMatrix::getColumn(std::size_t column) const{
+	Column c;
+	if (column < cols){
+		c.buffer = buffer;
+		c.column = column;
+		c.stride = cols;
+		c.rows = rows;
+	}
+	return c;
+}
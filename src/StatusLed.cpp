@@ -3,8 +3,7 @@
 
 #include <iostream>
 
-StatusLed::StatusLed(): uc_connection(Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS)){
-	lastWrite = getCurrentTime();
+StatusLed::StatusLed(): actuators(ActuatorService::create()){
 	all(false);
 	running(true);
 	write_reg_val();
@@ -41,29 +40,16 @@ void StatusLed::setLED(bool on, int led_id){
 	}
 }
 void StatusLed::read_reg_val(){
-	reg_val = uc_connection->readRegister(I2C_ATMEGA32_BUFFER_LEDH);
-	reg_val <<= 8;
-	reg_val &= (uc_connection->readRegister(I2C_ATMEGA32_BUFFER_LEDH) & 0xFF);
+	int low, high;
+	if (actuators->readLeds(low, high, true)){
+		reg_val = ((high & 0xFF) << 8) | (low & 0xFF);
+	}
 }
 void StatusLed::write_reg_val(){
-	delay_to_last_write();
 	std::bitset<16> bitmask(0x00FF);
 	std::bitset<8> low_byte((reg_val & bitmask).to_ulong());
 	std::bitset<8> high_byte(((reg_val >> 8) & bitmask).to_ulong());
 	
 	std::cout << "H: " << high_byte.to_ulong() << "\tL: " << low_byte.to_ulong() << std::endl;
-	uc_connection->writeRegister(I2C_ATMEGA32_BUFFER_LEDL, low_byte.to_ulong());
-	uc_connection->writeRegister(I2C_ATMEGA32_BUFFER_LEDH, high_byte.to_ulong());
-	lastWrite = getCurrentTime();
-}
-
-StatusLed::TimePoint StatusLed::getCurrentTime() const{
-	return std::chrono::system_clock::now();
-}
-void StatusLed::delay_to_last_write() const{
-	std::chrono::duration<double> elapsed_seconds;
-	
-	do{
-		elapsed_seconds = getCurrentTime() - lastWrite;
-	}while (elapsed_seconds.count() < 0.01);
+	actuators->writeLeds(low_byte.to_ulong(), high_byte.to_ulong());
 }
@@ -48,6 +48,31 @@ std::string Task::getName() const{
 	return Task::name;
 }
 
+std::list<Task::DEVICES> Task::getUsedDevices(){
+	std::list<DEVICES> devices = getNecessaryDevices();
+	
+	for (std::list<DEVICES>::const_iterator cit = devices.cbegin(); cit != devices.cend(); cit++){
+		if (*cit == DEVICES::DEVICE_HP4294A || *cit == DEVICES::DEVICE_NOVOCONTROL){ // only one device can use the gpib bus at a time
+			devices.push_back(DEVICES::DEVICE_GPIB);
+			break;
+		}
+	}
+	return devices;
+}
+bool Task::isBarrier(){
+	return true;
+}
+void Task::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	state.reset();
+}
+void Task::setExecutionHints(const ExecutionHints &h){
+	hints = h;
+}
+
+void Task::simulate(Simulator &sim){
+	
+}
+
 void Task::addLogEvent(Log_Event::Log_Event_ptr l){
 	if (logfile != nullptr){
 		logfile->add_event(l);
@@ -55,4 +80,9 @@ void Task::addLogEvent(Log_Event::Log_Event_ptr l){
 }
 void Task::setLogFile(Logbook::Logbook_ptr l){
 	logfile = l;
+}
+void Task::readRelais(){
+	if (!hints.relaisSynced){
+		relais->readRelais();
+	}
 }
\ No newline at end of file
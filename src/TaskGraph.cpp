@@ -0,0 +1,197 @@
+#include "TaskGraph.h"
+#include "Trace.h"
+
+#include <map>
+#include <set>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <list>
+
+TaskGraph::TaskGraph_ptr TaskGraph::create(const std::vector<Task::Task_ptr> &tasks){
+	return TaskGraph_ptr(new TaskGraph(tasks));
+}
+TaskGraph::TaskGraph(const std::vector<Task::Task_ptr> &tasks){
+	nodes.resize(tasks.size());
+	
+	bool barrierExists = false;
+	std::size_t lastBarrier = 0;
+	std::vector<std::size_t> sinceBarrier; // tasks after the last barrier
+	std::map<Task::DEVICES, std::size_t> lastUser; // last task (after the last barrier) which used a device
+	
+	for (std::size_t i = 0; i < tasks.size(); i++){
+		nodes[i].task = tasks[i];
+		
+		if (tasks[i]->isBarrier()){ // depends on all previous tasks
+			if (sinceBarrier.empty() && barrierExists){
+				addDependency(lastBarrier, i);
+			}
+			for (std::vector<std::size_t>::const_iterator cit = sinceBarrier.cbegin(); cit != sinceBarrier.cend(); cit++){
+				if (nodes[*cit].successors.empty()){ // the other tasks are finished before these tasks
+					addDependency(*cit, i);
+				}
+			}
+			barrierExists = true;
+			lastBarrier = i;
+			sinceBarrier.clear();
+			lastUser.clear();
+		}else{ // depends on the previous tasks using the same devices
+			std::list<Task::DEVICES> devices = tasks[i]->getUsedDevices();
+			for (std::list<Task::DEVICES>::const_iterator cit = devices.cbegin(); cit != devices.cend(); cit++){
+				std::map<Task::DEVICES, std::size_t>::iterator user = lastUser.find(*cit);
+				if (user != lastUser.end()){
+					addDependency(user->second, i);
+				}
+				lastUser[*cit] = i;
+			}
+			if (nodes[i].dependencies.empty() && barrierExists){
+				addDependency(lastBarrier, i);
+			}
+			sinceBarrier.push_back(i);
+		}
+	}
+}
+
+void TaskGraph::addDependency(std::size_t from, std::size_t to){
+	std::vector<std::size_t> &dependencies = nodes[to].dependencies;
+	if (std::find(dependencies.begin(), dependencies.end(), from) == dependencies.end()){
+		dependencies.push_back(from);
+		nodes[from].successors.push_back(to);
+	}
+}
+
+std::size_t TaskGraph::getTaskCount() const{
+	return nodes.size();
+}
+
+const std::vector<std::size_t>& TaskGraph::getDependencies(std::size_t i) const{
+	return nodes.at(i).dependencies;
+}
+
+bool TaskGraph::isSequential() const{
+	for (std::size_t i = 1; i < nodes.size(); i++){
+		if (std::find(nodes[i].dependencies.begin(), nodes[i].dependencies.end(), i - 1) == nodes[i].dependencies.end()){
+			return false;
+		}
+	}
+	return true;
+}
+
+void TaskGraph::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token, unsigned int threads){
+	if (isSequential() || threads <= 1){ // nothing to execute concurrently
+		for (std::vector<Node>::iterator it = nodes.begin(); it != nodes.end(); it++){
+			if (token->isCancelled()){
+				break;
+			}
+			Trace::Span span("task", it->task->getName());
+			it->task->execute(data, token);
+		}
+		return;
+	}
+	
+	std::mutex mtx;
+	std::condition_variable changed;
+	std::vector<std::size_t> missingDependencies(nodes.size());
+	std::set<std::size_t> ready; // ordered -> the first ready task of the recipe is started first
+	std::size_t finished = 0;
+	bool stop = false;
+	std::exception_ptr error;
+	
+	for (std::size_t i = 0; i < nodes.size(); i++){
+		missingDependencies[i] = nodes[i].dependencies.size();
+		if (missingDependencies[i] == 0){
+			ready.insert(i);
+		}
+	}
+	
+	std::function<void()> worker = [&](){
+		std::unique_lock<std::mutex> lock(mtx);
+		while (true){
+			changed.wait(lock, [&]{return stop || finished == nodes.size() || !ready.empty();});
+			if (stop || finished == nodes.size()){
+				break;
+			}
+			if (token->isCancelled()){ // recipe has been stopped
+				stop = true;
+				changed.notify_all();
+				break;
+			}
+			
+			std::size_t i = *ready.begin();
+			ready.erase(ready.begin());
+			lock.unlock();
+			
+			std::exception_ptr e;
+			try{
+				Trace::Span span("task", nodes[i].task->getName());
+				nodes[i].task->execute(data, token);
+			}catch (...){
+				e = std::current_exception();
+			}
+			
+			lock.lock();
+			finished++;
+			if (e){
+				if (!error){
+					error = e;
+				}
+				stop = true;
+			}else{
+				for (std::vector<std::size_t>::const_iterator cit = nodes[i].successors.cbegin(); cit != nodes[i].successors.cend(); cit++){
+					if (--missingDependencies[*cit] == 0){
+						ready.insert(*cit);
+					}
+				}
+			}
+			changed.notify_all();
+		}
+	};
+	
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1; i < std::min<std::size_t>(threads, nodes.size()); i++){
+		workers.push_back(std::thread([&worker](){
+			Trace::setThreadName("task graph worker");
+			worker();
+		}));
+	}
+	worker(); // the calling thread is a worker as well
+	for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); it++){
+		it->join();
+	}
+	
+	if (error){
+		std::rethrow_exception(error);
+	}
+}
+
+void TaskGraph::simulate(Simulator &sim, unsigned int threads){
+	if (isSequential() || threads <= 1){
+		for (std::vector<Node>::iterator it = nodes.begin(); it != nodes.end(); it++){
+			sim.run(it->task);
+		}
+		return;
+	}
+	
+	// the dependencies of a task come before the task -> the tasks are scheduled in the order of the recipe
+	double start = sim.getTimeMs();
+	double end = start;
+	std::vector<double> finished(nodes.size());
+	std::vector<double> threadFree(std::min<std::size_t>(threads, nodes.size()), start);
+	for (std::size_t i = 0; i < nodes.size(); i++){
+		double ready = start;
+		for (std::vector<std::size_t>::const_iterator cit = nodes[i].dependencies.cbegin(); cit != nodes[i].dependencies.cend(); cit++){
+			ready = std::max(ready, finished[*cit]);
+		}
+		std::vector<double>::iterator thread = std::min_element(threadFree.begin(), threadFree.end());
+		
+		sim.setTimeMs(std::max(ready, *thread));
+		sim.run(nodes[i].task);
+		finished[i] = sim.getTimeMs();
+		*thread = finished[i];
+		end = std::max(end, finished[i]);
+	}
+	sim.setTimeMs(end);
+}
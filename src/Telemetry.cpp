@@ -0,0 +1,386 @@
+#include "Telemetry.h"
+#include "Addresses.h"
+#include "VoltageSettler.h"
+#include "TempData.h"
+#include "Trace.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+#include <cstdio>
+
+#define TELEMETRY_NAN std::numeric_limits<double>::quiet_NaN()
+
+std::weak_ptr<Telemetry> Telemetry::service;
+std::mutex Telemetry::serviceMtx;
+
+Telemetry::Telemetry_ptr Telemetry::create(){
+	serviceMtx.lock();
+	Telemetry_ptr t = service.lock();
+	if (t == nullptr){ // no running service
+		t = Telemetry_ptr(new Telemetry());
+		service = t;
+	}
+	serviceMtx.unlock();
+	return t;
+}
+Telemetry::Telemetry(){
+	voltageController = Uc_Connection::create(I2C_ATTINY45_VOLT_SLAVE_ADDRESS);
+	atmega32 = Uc_Connection::create(I2C_ATMEGA32_SLAVE_ADDRESS);
+	freqGenerator = Uc_Connection::create(I2C_ATTINY45_FREQ_SLAVE_ADDRESS);
+	
+	rates[CHANNEL_VOLTAGE] = TELEMETRY_RATE_VOLTAGE_HZ;
+	rates[CHANNEL_SETPOINT] = TELEMETRY_RATE_CONTROLLER_HZ;
+	rates[CHANNEL_DUTY_CYCLE] = TELEMETRY_RATE_CONTROLLER_HZ;
+	rates[CHANNEL_PWM_FREQUENCY] = TELEMETRY_RATE_CONTROLLER_HZ;
+	rates[CHANNEL_MODE] = TELEMETRY_RATE_CONTROLLER_HZ;
+	rates[CHANNEL_EXT_VOLTAGE] = TELEMETRY_RATE_EXT_VOLTAGE_HZ;
+	rates[CHANNEL_FREQUENCY] = TELEMETRY_RATE_FREQUENCY_HZ;
+	rates[CHANNEL_TEMPERATURE] = TELEMETRY_RATE_CLIMATE_HZ;
+	rates[CHANNEL_HUMIDITY] = TELEMETRY_RATE_CLIMATE_HZ;
+	
+	Clock::time_point now = Clock::now();
+	for (int c = 0; c < CHANNEL_COUNT; c++){
+		deadlines[c] = now;
+		requested[c] = false;
+	}
+	climateRequested = false;
+	climateReady = now;
+	
+	running = true;
+	sampler_thread = std::thread(&Telemetry::samplerThread, this);
+}
+Telemetry::~Telemetry(){
+	mtx.lock();
+	running = false;
+	mtx.unlock();
+	changed.notify_all();
+	
+	if (sampler_thread.joinable()){
+		sampler_thread.join();
+	}
+}
+
+void Telemetry::setRate(CHANNEL c, double hz){
+	if (c == CHANNEL_HUMIDITY){ // sampled with the temperature
+		c = CHANNEL_TEMPERATURE;
+	}
+	mtx.lock();
+	rates[c] = (hz > 0 ? hz : 0);
+	if (c == CHANNEL_TEMPERATURE){
+		rates[CHANNEL_HUMIDITY] = rates[c];
+	}
+	deadlines[c] = Clock::now(); // the new rate applies immediately
+	mtx.unlock();
+	changed.notify_one();
+}
+
+double Telemetry::getRate(CHANNEL c){
+	mtx.lock();
+	double hz = rates[c];
+	mtx.unlock();
+	return hz;
+}
+
+bool Telemetry::getValue(CHANNEL c, double &value){
+	TelemetryBuffer::Sample s;
+	if (!buffers[c].latest(s) || std::isnan(s.value)){
+		return false;
+	}
+	double hz = getRate(c);
+	if (hz > 0 && (now_ns() - s.time_ns) / 1e9 > TELEMETRY_MAX_AGE_PERIODS / hz){ // outdated
+		return false;
+	}
+	value = s.value;
+	return true;
+}
+
+const TelemetryBuffer& Telemetry::getBuffer(CHANNEL c) const{
+	return buffers[c];
+}
+
+std::int64_t Telemetry::now_ns(){
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+std::string Telemetry::channelToString(CHANNEL c){
+	switch (c){
+		case CHANNEL_VOLTAGE:
+			return "voltage";
+		case CHANNEL_SETPOINT:
+			return "setpoint";
+		case CHANNEL_DUTY_CYCLE:
+			return "duty_cycle";
+		case CHANNEL_PWM_FREQUENCY:
+			return "pwm_frequency";
+		case CHANNEL_MODE:
+			return "mode";
+		case CHANNEL_EXT_VOLTAGE:
+			return "ext_voltage";
+		case CHANNEL_FREQUENCY:
+			return "frequency";
+		case CHANNEL_TEMPERATURE:
+			return "temperature";
+		case CHANNEL_HUMIDITY:
+			return "humidity";
+		default:
+			return "unknown";
+	}
+}
+
+void Telemetry::sampleNow(CHANNEL c){
+	if (c == CHANNEL_HUMIDITY){ // sampled with the temperature
+		c = CHANNEL_TEMPERATURE;
+	}
+	mtx.lock();
+	requested[c] = true;
+	deadlines[c] = Clock::now();
+	mtx.unlock();
+	changed.notify_one();
+}
+
+Telemetry::Recording_ptr Telemetry::startRecording(){
+	Recording_ptr recording = std::make_shared<Recording>();
+	recording->start_ns = now_ns();
+	for (int c = 0; c < CHANNEL_COUNT; c++){
+		recording->cursors[c] = buffers[c].getCount(); // samples which are added from now on
+	}
+	recording->lost = 0;
+	recording->finished = false;
+	
+	mtx.lock();
+	recordings.push_back(recording);
+	mtx.unlock();
+	return recording;
+}
+
+void Telemetry::writeCsv(std::string path, Recording_ptr recording){
+	drain(*recording);
+	recording->mtx.lock();
+	recording->finished = true;
+	recording->mtx.unlock();
+	
+	std::ofstream file(path);
+	if (!file.is_open()){
+		throw std::runtime_error("Telemetry::writeCsv - the file " + path + " cannot be opened");
+	}
+	
+	recording->mtx.lock();
+	char time[32];
+	file << "time_s;channel;value\n";
+	for (int c = 0; c < CHANNEL_COUNT; c++){
+		const std::vector<TelemetryBuffer::Sample> &samples = recording->samples[c];
+		std::string name = channelToString(static_cast<CHANNEL>(c));
+		for (std::vector<TelemetryBuffer::Sample>::const_iterator cit = samples.cbegin(); cit != samples.cend(); cit++){
+			std::snprintf(time, sizeof(time), "%.3f", (cit->time_ns - recording->start_ns) / 1e9);
+			file << time << ";" << name << ";" << cit->value << "\n";
+		}
+	}
+	unsigned long lost = recording->lost;
+	recording->mtx.unlock();
+	
+	if (!file.good()){
+		throw std::runtime_error("Telemetry::writeCsv - writing " + path + " failed");
+	}
+	if (lost > 0){
+		throw std::runtime_error("Telemetry::writeCsv - " + std::to_string(lost) + " samples are missing in " + path);
+	}
+}
+
+void Telemetry::drain(Recording &recording){
+	recording.mtx.lock();
+	for (int c = 0; c < CHANNEL_COUNT && !recording.finished; c++){
+		std::size_t before = recording.samples[c].size();
+		unsigned long cursor = buffers[c].read(recording.cursors[c], recording.samples[c]);
+		recording.lost += (cursor - recording.cursors[c]) - (recording.samples[c].size() - before); // overwritten in the meantime
+		recording.cursors[c] = cursor;
+	}
+	recording.mtx.unlock();
+}
+
+void Telemetry::drainRecordings(){
+	std::vector<Recording_ptr> active;
+	mtx.lock();
+	for (std::vector<std::weak_ptr<Recording>>::iterator it = recordings.begin(); it != recordings.end();){
+		Recording_ptr r = it->lock();
+		if (r == nullptr){ // the recording has been finished
+			it = recordings.erase(it);
+		}else{
+			active.push_back(r);
+			it++;
+		}
+	}
+	mtx.unlock();
+	
+	for (std::vector<Recording_ptr>::const_iterator cit = active.cbegin(); cit != active.cend(); cit++){
+		drain(**cit);
+	}
+}
+
+std::int64_t Telemetry::Recording::getStart_ns() const{
+	return start_ns;
+}
+std::size_t Telemetry::Recording::getCount(CHANNEL c) const{
+	mtx.lock();
+	std::size_t count = samples[c].size();
+	mtx.unlock();
+	return count;
+}
+unsigned long Telemetry::Recording::getLost() const{
+	mtx.lock();
+	unsigned long l = lost;
+	mtx.unlock();
+	return l;
+}
+
+void Telemetry::samplerThread(){
+	Trace::setThreadName("telemetry");
+	
+	std::unique_lock<std::mutex> lock(mtx);
+	while (running){
+		// the channel with the earliest deadline, the pending dht11 measurement counts as a channel
+		Clock::time_point now = Clock::now();
+		Clock::time_point due = now + std::chrono::seconds(1); // recheck the rates
+		int next = -1;
+		for (int c = 0; c < CHANNEL_COUNT; c++){
+			if (c == CHANNEL_HUMIDITY || (c == CHANNEL_TEMPERATURE && climateRequested)){ // one dht11 measurement at a time
+				continue;
+			}
+			if ((rates[c] > 0 || requested[c]) && deadlines[c] < due){
+				due = deadlines[c];
+				next = c;
+			}
+		}
+		if (climateRequested && climateReady <= due){
+			due = climateReady;
+			next = CHANNEL_HUMIDITY;
+		}
+		
+		if (next < 0 || due > now){
+			changed.wait_until(lock, due); // woken up early if a rate changes or the service stops
+			continue;
+		}
+		
+		if (next != CHANNEL_HUMIDITY){
+			requested[next] = false;
+			if (rates[next] > 0){
+				std::chrono::duration<double> period(1.0 / rates[next]);
+				deadlines[next] += std::chrono::duration_cast<Clock::duration>(period);
+				if (deadlines[next] < now){ // missed samples are not caught up
+					deadlines[next] = now + std::chrono::duration_cast<Clock::duration>(period);
+				}
+			}
+		}
+		lock.unlock();
+		
+		if (next == CHANNEL_HUMIDITY){
+			readClimate();
+		}else if (next == CHANNEL_TEMPERATURE){
+			requestClimate();
+		}else{
+			sample(static_cast<CHANNEL>(next));
+		}
+		drainRecordings();
+		
+		lock.lock();
+	}
+}
+
+void Telemetry::sample(CHANNEL c){
+	Trace::Span span("telemetry", channelToString(c));
+	double value = TELEMETRY_NAN;
+	std::vector<int> r;
+	
+	switch (c){
+		case CHANNEL_VOLTAGE:
+			r = voltageController->readRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL, 2); // reading ADCL latches ADCH
+			if (!r.empty()){
+				value = VoltageSettler::toVoltage(r[1] * 256 + r[0]);
+			}
+			break;
+		
+		case CHANNEL_SETPOINT:
+			r = voltageController->readRegisters(I2C_ATTINY45_VOLT_BUFFER_ADCL_S, 2);
+			if (!r.empty()){
+				value = VoltageSettler::toSetpointVoltage(r[1] * 256 + r[0]);
+			}
+			break;
+		
+		case CHANNEL_DUTY_CYCLE:
+			r = voltageController->readRegisters(I2C_ATTINY45_VOLT_BUFFER_OCR1A, 2); // OCR1A, OCR1C
+			if (!r.empty() && r[1] != 0){
+				value = ((double) r[0]) / ((double) r[1]);
+			}
+			break;
+		
+		case CHANNEL_PWM_FREQUENCY:
+			r = voltageController->readRegisters(I2C_ATTINY45_VOLT_BUFFER_FREQ0, 4);
+			if (!r.empty()){
+				value = r[0] + (r[1] << 8) + (r[2] << 16) + ((unsigned int) r[3] << 24);
+			}
+			break;
+		
+		case CHANNEL_MODE:
+			r = voltageController->readRegisters(I2C_ATTINY45_VOLT_BUFFER_MODE, 1);
+			if (!r.empty()){
+				value = r[0];
+			}
+			break;
+		
+		case CHANNEL_EXT_VOLTAGE:
+			r = atmega32->readRegisters(I2C_ATMEGA32_BUFFER_ADCL, 2);
+			if (!r.empty()){
+				value = (((double) VOLTAGE_ATMEGA32_R1) + ((double) VOLTAGE_ATMEGA32_R2)) / ((double) VOLTAGE_ATMEGA32_R2) / ((double) VOLTAGE_ATMEGA32_R_CORR) * ((double) (r[1] * 256 + r[0])) / 1023.0 * 5.0;
+			}
+			break;
+		
+		case CHANNEL_FREQUENCY:
+			r = freqGenerator->readRegisters(I2C_ATTINY45_FREQ_BUFFER_FREQ0, 4);
+			if (!r.empty()){
+				value = r[0] + (r[1] << 8) + (r[2] << 16) + ((unsigned int) r[3] << 24);
+			}
+			break;
+		
+		default:
+			return;
+	}
+	buffers[c].push(now_ns(), value);
+}
+
+void Telemetry::requestClimate(){
+	Trace::Span span("telemetry", "request dht11");
+	bool ok = (atmega32->writeRegister(I2C_ATMEGA32_BUFFER_TEMP_REQUEST, 0x01) == 0); // trigger measurement
+	
+	mtx.lock();
+	climateRequested = ok;
+	climateReady = Clock::now() + std::chrono::milliseconds(TELEMETRY_DHT11_DELAY_MS);
+	mtx.unlock();
+	
+	if (!ok){
+		std::int64_t t = now_ns();
+		buffers[CHANNEL_TEMPERATURE].push(t, TELEMETRY_NAN);
+		buffers[CHANNEL_HUMIDITY].push(t, TELEMETRY_NAN);
+	}
+}
+
+void Telemetry::readClimate(){
+	Trace::Span span("telemetry", "read dht11");
+	mtx.lock();
+	climateRequested = false;
+	mtx.unlock();
+	
+	double temperature = TELEMETRY_NAN;
+	double humidity = TELEMETRY_NAN;
+	std::vector<int> r = atmega32->readRegisters(I2C_ATMEGA32_BUFFER_TEMP_DATA0, 6); // DATA0 .. DATA4, READY
+	if (!r.empty() && r[5] == 0x01){ // data ready
+		TempData data(r.data());
+		if (data.isValid()){
+			temperature = data.getTemperature();
+			humidity = data.getHumidity();
+		}
+	}
+	std::int64_t t = now_ns();
+	buffers[CHANNEL_TEMPERATURE].push(t, temperature);
+	buffers[CHANNEL_HUMIDITY].push(t, humidity);
+}
@@ -0,0 +1,70 @@
+#include "TelemetryBuffer.h"
+
+#include <algorithm>
+
+TelemetryBuffer::TelemetryBuffer(std::size_t size): slots(std::max<std::size_t>(size, 2)), count(0){
+	for (std::vector<Slot>::iterator it = slots.begin(); it != slots.end(); it++){
+		it->seq.store(0, std::memory_order_relaxed);
+		it->time_ns.store(0, std::memory_order_relaxed);
+		it->value.store(0, std::memory_order_relaxed);
+	}
+}
+
+void TelemetryBuffer::push(std::int64_t time_ns, double value){
+	unsigned long n = count.load(std::memory_order_relaxed);
+	Slot &s = slots[n % slots.size()];
+	
+	s.seq.store(0, std::memory_order_relaxed); // readers discard the slot while it is changed
+	std::atomic_thread_fence(std::memory_order_release);
+	s.time_ns.store(time_ns, std::memory_order_relaxed);
+	s.value.store(value, std::memory_order_relaxed);
+	s.seq.store(n + 1, std::memory_order_release);
+	count.store(n + 1, std::memory_order_release);
+}
+
+bool TelemetryBuffer::readSlot(unsigned long index, Sample &s) const{
+	const Slot &slot = slots[index % slots.size()];
+	
+	unsigned long seq = slot.seq.load(std::memory_order_acquire);
+	if (seq != index + 1){ // being written or overwritten
+		return false;
+	}
+	s.time_ns = slot.time_ns.load(std::memory_order_relaxed);
+	s.value = slot.value.load(std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	return (slot.seq.load(std::memory_order_relaxed) == seq);
+}
+
+bool TelemetryBuffer::latest(Sample &s) const{
+	while (true){
+		unsigned long n = count.load(std::memory_order_acquire);
+		if (n == 0){
+			return false;
+		}
+		if (readSlot(n - 1, s)){
+			return true;
+		}
+		// the writer has wrapped around the whole buffer in the meantime -> the next sample is the latest
+	}
+}
+
+unsigned long TelemetryBuffer::read(unsigned long cursor, std::vector<Sample> &samples) const{
+	unsigned long n = count.load(std::memory_order_acquire);
+	unsigned long first = (n > slots.size() ? std::max<unsigned long>(cursor, n - slots.size()) : cursor);
+	
+	Sample s;
+	for (unsigned long i = first; i < n; i++){
+		if (readSlot(i, s)){ // overwritten samples are skipped
+			samples.push_back(s);
+		}
+	}
+	return n;
+}
+
+unsigned long TelemetryBuffer::getCount() const{
+	return count.load(std::memory_order_acquire);
+}
+
+std::size_t TelemetryBuffer::getSize() const{
+	return slots.size();
+}
@@ -5,6 +5,7 @@
 #include <iostream>
 #include <vector>
 #include <math.h>
+#include <chrono>
 
 TestTask::TestTask(): Task(){
 	
@@ -17,7 +18,7 @@ TestTask::~TestTask(){
 	
 }
 
-void TestTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext){
+void TestTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token){
 	std::cout << "executing Task " << name << " ..." << std::endl;
 	TransSpect::TransSpect_ptr spectrums = TransSpect::create();
 	data->addTransImpedanceSpectrum(spectrums);
@@ -29,11 +30,13 @@ void TestTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNex
 			double x_val = j+1;
 			double y_val_real = i + (j+1);
 			double y_val_imag = (i + 1) * 0.5 + (j+1) * 4;
-			s.push_back(std::make_shared<DataP>(x_val, y_val_real, y_val_imag));
+			s.add(x_val, y_val_real, y_val_imag);
 			
 		}
 		spectrums->addSpectrum(s);
-		sleep(1);
+		if (!token->sleepFor(std::chrono::seconds(1))){ // stopped
+			break;
+		}
 	}
 }
 
@@ -0,0 +1,211 @@
+#include "Trace.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+
+std::atomic<bool> Trace::running(false);
+std::atomic<unsigned int> Trace::generation(0);
+std::atomic<std::int64_t> Trace::origin_ns(0);
+std::vector<std::shared_ptr<Trace::ThreadBuffer>> Trace::buffers;
+std::mutex Trace::buffersMtx;
+unsigned int Trace::nextTid = 1;
+thread_local Trace::ThreadState Trace::threadState;
+
+Trace::ThreadBuffer::ThreadBuffer(unsigned int tid, const char* threadName): events(TRACE_THREAD_EVENTS), count(0), dropped(0), generation(0), alive(true), tid(tid){
+	copyName(ThreadBuffer::threadName, threadName);
+}
+
+Trace::ThreadState::ThreadState(){
+	threadName[0] = '\0';
+}
+Trace::ThreadState::~ThreadState(){
+	if (buffer != nullptr){
+		buffer->alive = false;
+	}
+}
+
+Trace::Span::Span(const char* category, const char* name, const char* argName, long arg){
+	begin(category, name, argName, arg);
+}
+Trace::Span::Span(const char* category, const std::string &name, const char* argName, long arg){
+	begin(category, name.c_str(), argName, arg);
+}
+void Trace::Span::begin(const char* category, const char* name, const char* argName, long arg){
+	recording = running.load(std::memory_order_relaxed);
+	if (recording){
+		Span::category = category;
+		Span::argName = argName;
+		Span::arg = arg;
+		copyName(Span::name, name);
+		start_ns = now_ns();
+	}
+}
+Trace::Span::~Span(){
+	if (recording){
+		Event e;
+		e.category = category;
+		e.argName = argName;
+		e.arg = arg;
+		e.start_ns = start_ns;
+		e.duration_ns = now_ns() - start_ns;
+		std::memcpy(e.name, name, TRACE_NAME_LENGTH);
+		add(e);
+	}
+}
+
+std::int64_t Trace::now_ns(){
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::copyName(char* dest, const char* src){
+	std::size_t i = 0;
+	for (; i < TRACE_NAME_LENGTH - 1 && src[i] != '\0'; i++){
+		dest[i] = src[i];
+	}
+	dest[i] = '\0';
+}
+
+/*
+ * the buffer is created on the first span of the thread, all later calls do not lock
+ */
+Trace::ThreadBuffer* Trace::getBuffer(){
+	if (threadState.buffer == nullptr){
+		buffersMtx.lock();
+		threadState.buffer = std::make_shared<ThreadBuffer>(nextTid++, threadState.threadName);
+		buffers.push_back(threadState.buffer);
+		buffersMtx.unlock();
+	}
+	return threadState.buffer.get();
+}
+
+void Trace::add(const Event &e){
+	ThreadBuffer* b = getBuffer();
+	unsigned int g = generation.load(std::memory_order_acquire);
+	if (b->generation.load(std::memory_order_relaxed) != g){ // first span since start() -> discard the old spans
+		b->count.store(0, std::memory_order_relaxed);
+		b->dropped.store(0, std::memory_order_relaxed);
+		b->generation.store(g, std::memory_order_release);
+	}
+	
+	std::size_t i = b->count.load(std::memory_order_relaxed);
+	if (i < b->events.size()){
+		b->events[i] = e;
+		b->count.store(i + 1, std::memory_order_release); // the event is complete before it is counted
+	}else{
+		b->dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void Trace::start(){
+	buffersMtx.lock();
+	// buffers of ended threads have been written by the last write()
+	for (std::vector<std::shared_ptr<ThreadBuffer>>::iterator it = buffers.begin(); it != buffers.end();){
+		if (!(*it)->alive){
+			it = buffers.erase(it);
+		}else{
+			it++;
+		}
+	}
+	buffersMtx.unlock();
+	
+	origin_ns = now_ns();
+	generation.fetch_add(1, std::memory_order_release);
+	running = true;
+}
+
+void Trace::stop(){
+	running = false;
+}
+
+bool Trace::isRunning(){
+	return running;
+}
+
+void Trace::setThreadName(const std::string &name){
+	copyName(threadState.threadName, name.c_str());
+	if (threadState.buffer != nullptr){
+		buffersMtx.lock();
+		copyName(threadState.buffer->threadName, threadState.threadName);
+		buffersMtx.unlock();
+	}
+}
+
+unsigned long Trace::getDropped(){
+	unsigned long dropped = 0;
+	unsigned int g = generation;
+	buffersMtx.lock();
+	for (std::vector<std::shared_ptr<ThreadBuffer>>::const_iterator cit = buffers.cbegin(); cit != buffers.cend(); cit++){
+		if ((*cit)->generation.load(std::memory_order_acquire) == g){
+			dropped += (*cit)->dropped;
+		}
+	}
+	buffersMtx.unlock();
+	return dropped;
+}
+
+std::string Trace::escape(const char* s){
+	std::string e;
+	for (; *s != '\0'; s++){
+		if (*s == '"' || *s == '\\'){
+			e += '\\';
+			e += *s;
+		}else if (static_cast<unsigned char>(*s) < 0x20){ // control characters are not allowed in json strings
+			e += ' ';
+		}else{
+			e += *s;
+		}
+	}
+	return e;
+}
+
+/*
+ * Chrome trace event format: complete events (ph X) with ts / dur in microseconds, thread names as metadata events (ph M)
+ */
+void Trace::write(std::string path){
+	std::ofstream file(path);
+	if (!file.is_open()){
+		throw std::runtime_error("Trace::write - the file " + path + " cannot be opened");
+	}
+	
+	unsigned int g = generation;
+	std::int64_t origin = origin_ns;
+	unsigned long dropped = 0;
+	bool first = true;
+	char number[64];
+	
+	file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+	buffersMtx.lock();
+	for (std::vector<std::shared_ptr<ThreadBuffer>>::const_iterator cit = buffers.cbegin(); cit != buffers.cend(); cit++){
+		const ThreadBuffer &b = **cit;
+		if (b.generation.load(std::memory_order_acquire) != g){ // no spans since start()
+			continue;
+		}
+		std::size_t count = b.count.load(std::memory_order_acquire);
+		dropped += b.dropped;
+		
+		if (b.threadName[0] != '\0'){
+			file << (first ? "\n" : ",\n") << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": " << b.tid;
+			file << ", \"args\": {\"name\": \"" << escape(b.threadName) << "\"}}";
+			first = false;
+		}
+		for (std::size_t i = 0; i < count; i++){
+			const Event &e = b.events[i];
+			std::snprintf(number, sizeof(number), "\"ts\": %.3f, \"dur\": %.3f", (e.start_ns - origin) / 1e3, e.duration_ns / 1e3);
+			file << (first ? "\n" : ",\n") << "{\"ph\": \"X\", \"cat\": \"" << escape(e.category) << "\", \"name\": \"" << escape(e.name) << "\", ";
+			file << number << ", \"pid\": 1, \"tid\": " << b.tid;
+			if (e.argName != nullptr){
+				file << ", \"args\": {\"" << escape(e.argName) << "\": " << e.arg << "}";
+			}
+			file << "}";
+			first = false;
+		}
+	}
+	buffersMtx.unlock();
+	file << "\n], \"otherData\": {\"droppedSpans\": " << dropped << "}}\n";
+	
+	if (!file.good()){
+		throw std::runtime_error("Trace::write - writing " + path + " failed");
+	}
+}
@@ -3,48 +3,47 @@
 #include "FSHelper.h"
 #include "Novocontrol.h"
 #include "HP4294A.h"
+#include "Addresses.h"
+#include "Simulator.h"
+#include "Trace.h"
 
 #include <chrono>
+#include <cmath>
+#include <algorithm>
 
 TransImpTask::TransImpTask(ImpAnalyser::ImpAnalyser_ptr analyser, unsigned int termination, TERMINATION_MODE t): Task(), analyser(analyser), termination(termination), termMode(t){
 	setName(to_string());
 }
 
-void TransImpTask::execute(ExperimentData::ExperimentData_ptr data, bool* executeNext) {
-	relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true); //Imp measurement
-	relais->writeRelais();
-	addLogEvent(Log_Event::create("switched relais", "switched relais to imp measurement", Log_Event::LOG_INFO));
-	usleep(51*1000);
-	
-	switch(analyser->getWireMode()){
-	case ImpAnalyser::WIRE_MODE::TWO_WIRE:
-		relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, true);
-		relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, true);
-		break;
-		
-	case ImpAnalyser::WIRE_MODE::THREE_WIRE:
-		relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, false);
-		relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, true);
-		break;
-		
-	default:
-		relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, false);
-		relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, false);
-		break;
+void TransImpTask::execute(ExperimentData::ExperimentData_ptr data, CancellationToken::CancellationToken_ptr token) {
+	if (!hints.impRelaisOn){ // not switched to imp measurement by the previous task
+		relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true); //Imp measurement
+		relais->writeRelais();
+		addLogEvent(Log_Event::create("switched relais", "switched relais to imp measurement", Log_Event::LOG_INFO));
+		usleep(IMP_RELAIS_SETTLE_MS * 1000);
 	}
-	relais->writeRelais();
-	addLogEvent(Log_Event::create("switched relais", "switched relais to configure " + std::to_string(analyser->getWireMode()) + "-wire mode", Log_Event::LOG_INFO));
 	
-	if (analyser->getInternal()){ // internal imp analyser
-//		relais->setRelais(Relais::RELAIS::R_STEUER_BOOST_IN, true); //internal measurement
-		relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, false); //internal measurement
+	if (!hints.wireModeSet){
+		bool re_p_ce, we_p_we_s;
+		ImpAnalyser::getWireModeRelais(analyser->getWireMode(), re_p_ce, we_p_we_s);
+		relais->setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce);
+		relais->setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
 		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to internal imp measurement", Log_Event::LOG_INFO));
-	}else{
-//		relais->setRelais(Relais::RELAIS::R_STEUER_BOOST_IN, false); //external measurement
-		relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
-		relais->writeRelais();
-		addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
+		addLogEvent(Log_Event::create("switched relais", "switched relais to configure " + std::to_string(analyser->getWireMode()) + "-wire mode", Log_Event::LOG_INFO));
+	}
+	
+	if (!hints.sourceSet){
+		if (analyser->getInternal()){ // internal imp analyser
+//			relais->setRelais(Relais::RELAIS::R_STEUER_BOOST_IN, true); //internal measurement
+			relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, false); //internal measurement
+			relais->writeRelais();
+			addLogEvent(Log_Event::create("switched relais", "switched relais to internal imp measurement", Log_Event::LOG_INFO));
+		}else{
+//			relais->setRelais(Relais::RELAIS::R_STEUER_BOOST_IN, false); //external measurement
+			relais->setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, true); //external measurement
+			relais->writeRelais();
+			addLogEvent(Log_Event::create("switched relais", "switched relais to external imp measurement", Log_Event::LOG_INFO));
+		}
 	}
 	
 	
@@ -56,8 +55,17 @@ void TransImpTask::execute(ExperimentData::ExperimentData_ptr data, bool* execut
 	
 	
 	if (termMode == TERMINATION_MODE::TERM_CNT){
-		for (int i = 0; (i < termination) && (*executeNext); i++){
-			spectrums->addSpectrum(analyser->measureSpectrum(executeNext));
+		for (int i = 0; (i < termination) && !token->isCancelled(); i++){
+			Spectrum spectrum;
+			spectrum.reserve(analyser->getPoints());
+			
+			// update the progress after each point, not only after each spectrum
+			Trace::Span span("sweep", analyser->getType(), "points", analyser->getPoints());
+			analyser->streamSpectrum([&](double x, double y_real, double y_imag, unsigned int index){
+				spectrum.add(x, y_real, y_imag);
+				spectrums->progress = (i + ((double) (index+1)) / analyser->getPoints()) / (double (termination));
+			}, token);
+			spectrums->addSpectrum(spectrum);
 			spectrums->progress = ((double) (i+1)) / (double (termination));
 			addLogEvent(Log_Event::create("spectrum captured", "transient measurement - captured spectrum " + std::to_string(i+1) + " of " + std::to_string(termination), Log_Event::TYPE::LOG_INFO));
 		}
@@ -66,8 +74,8 @@ void TransImpTask::execute(ExperimentData::ExperimentData_ptr data, bool* execut
 		double elapsed_secs = 0;
 		int i = 1;
 		
-		while (elapsed_secs < termination && (*executeNext)){
-			spectrums->addSpectrum(analyser->measureSpectrum(executeNext));
+		while (elapsed_secs < termination && !token->isCancelled()){
+			spectrums->addSpectrum(analyser->measureSpectrum(token));
 			
 			const std::chrono::system_clock::time_point current_time = std::chrono::system_clock::now();
 			const std::chrono::duration<double> elapsed_secs_duration = current_time - start_time;
@@ -82,9 +90,11 @@ void TransImpTask::execute(ExperimentData::ExperimentData_ptr data, bool* execut
 	status_leds->impMeasRunning(false);
 	status_leds->write_reg_val();
 	
-	relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, false); //Imp measurement
-	relais->writeRelais();
-	addLogEvent(Log_Event::create("switched relais", "switched relais to ewod mode", Log_Event::LOG_INFO));
+	if (!hints.keepImpRelaisOn){ // the next task does not measure the impedance
+		relais->setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, false); //Imp measurement
+		relais->writeRelais();
+		addLogEvent(Log_Event::create("switched relais", "switched relais to ewod mode", Log_Event::LOG_INFO));
+	}
 }
 
 std::string TransImpTask::getType() const{
@@ -183,4 +193,75 @@ std::list<Task::DEVICES> TransImpTask::getNecessaryDevices(){
 	}
 	
 	return devices;
+}
+std::list<Task::DEVICES> TransImpTask::getUsedDevices(){
+	std::list<Task::DEVICES> devices = Task::getUsedDevices();
+	
+	devices.push_back(Task::DEVICES::DEVICE_ATMEGA_GENERAL);
+	devices.push_back(Task::DEVICES::DEVICE_ELECTRODES);
+	
+	return devices;
+}
+bool TransImpTask::isBarrier(){
+	return false;
+}
+void TransImpTask::compile(DeviceState &state, ExecutionHints &hints, CompileReport &report){
+	bool internal = analyser->getInternal();
+	bool re_p_ce, we_p_we_s;
+	ImpAnalyser::getWireModeRelais(analyser->getWireMode(), re_p_ce, we_p_we_s);
+	
+	hints.impRelaisOn = state.isRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, true);
+	hints.sourceSet = state.isRelais(Relais::RELAIS::R_STEUER_EXT_PICO, !internal);
+	hints.wireModeSet = state.isRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce) && state.isRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
+	// hints.keepImpRelaisOn is set by CompiledRecipe
+	
+	if (hints.impRelaisOn){
+		report.relaisWrites++;
+		report.settleDelays++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS + IMP_RELAIS_SETTLE_MS;
+	}
+	if (hints.sourceSet){
+		report.relaisWrites++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	if (hints.wireModeSet){
+		report.relaisWrites++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	if (hints.keepImpRelaisOn){
+		report.relaisWrites++;
+		report.savedMs += RELAIS_ACCESS_TIME_MS;
+	}
+	
+	state.setRelais(Relais::RELAIS::R_STEUER_RE_P_CE, re_p_ce);
+	state.setRelais(Relais::RELAIS::R_STEUER_WE_P_WE_S, we_p_we_s);
+	state.setRelais(Relais::RELAIS::R_STEUER_EXT_PICO, !internal);
+	state.setRelais(Relais::RELAIS::R_STEUER_IMP_EWOD, hints.keepImpRelaisOn);
+}
+void TransImpTask::simulate(Simulator &sim){
+	const ExecutionHints &h = sim.getHints();
+	const SimulationModel &model = sim.getModel();
+	
+	if (!h.impRelaisOn){
+		sim.wait(model.relaisAccessMs + model.relaisSettleMs);
+	}
+	if (!h.wireModeSet){
+		sim.wait(model.relaisAccessMs);
+	}
+	if (!h.sourceSet){
+		sim.wait(model.relaisAccessMs);
+	}
+	sim.wait(2 * model.i2cAccessMs); // status leds
+	
+	double sweepMs = sim.getSweepMs(*analyser);
+	if (termMode == TERMINATION_MODE::TERM_CNT){
+		sim.wait(termination * sweepMs);
+	}else if (termMode == TERMINATION_MODE::TERM_TIME){ // the last sweep is started before the time has elapsed
+		sim.wait(sweepMs > 0 ? std::max(1.0, std::ceil(termination * 1000.0 / sweepMs)) * sweepMs : termination * 1000.0);
+	}
+	
+	sim.wait(2 * model.i2cAccessMs);
+	if (!h.keepImpRelaisOn){
+		sim.wait(model.relaisAccessMs);
+	}
 }
\ No newline at end of file
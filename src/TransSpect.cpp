@@ -1,15 +1,26 @@
 #include "TransSpect.h"
+#include "TransSpectLoader.h"
 
 #include <iostream>
-#include <fstream>
+#include <cmath>
 
 TransSpect::TransSpect_ptr TransSpect::create(){
 	TransSpect_ptr p = TransSpect_ptr(new TransSpect());
 	p->this_ptr = p;
 	return p;
 }
+TransSpect::TransSpect_ptr TransSpect::create(const std::vector<Spectrum> &spectrums, const std::vector<double> &timediffs){
+	TransSpect_ptr p = create();
+	p->startTime = getCurrentTime();
+	
+	for (std::size_t i = 0; i < spectrums.size(); i++){
+		p->appendSpectrum(spectrums[i], (i < timediffs.size()) ? timediffs[i] - timediffs[0] : 0.0);
+	}
+	return p;
+}
 TransSpect::TransSpect(){
 	on_Spectrum_added = nullptr;
+	seriesNo = 0;
 }
 TransSpect::~TransSpect(){
 	
@@ -18,23 +29,32 @@ TransSpect::~TransSpect(){
 void TransSpect::addSpectrum(Spectrum s){
 	spectMtx.lock();
 	
-	if (transSpect.empty()){ // first spectrum 
-		//read frequencies
-		for (Spectrum::const_iterator cit = s.cbegin(); cit != s.cend(); cit++){
-			frequencies.push_back((*cit)->getX());
-		}
+	TimePoint now = getCurrentTime();
+	if (transSpect.getRows() == 0){ // first spectrum 
+		startTime = now;
 	}
-	timeStamps.push_back(getCurrentTime());
-	transSpect.push_back(s);
-	
-	unsigned int position = timeStamps.size() -1;
-	std::chrono::duration<double> elapsed_seconds = timeStamps.at(position) - timeStamps.at(0);
+	std::chrono::duration<double> elapsed_seconds = now - startTime;
 	double timediff =  elapsed_seconds.count();
+	unsigned int position = appendSpectrum(s, timediff);
 	spectMtx.unlock();
 	
 	if (on_Spectrum_added != nullptr) on_Spectrum_added(this_ptr.lock(), s, position, timediff);
 }
 
+// spectMtx needs to be locked
+unsigned int TransSpect::appendSpectrum(const Spectrum &s, double timediff){
+	if (transSpect.getRows() == 0){ // first spectrum 
+		//read frequencies
+		for (std::size_t i = 0; i < s.size(); i++){
+			frequencies.push_back(s.getX(i));
+		}
+	}
+	transSpect.appendRow(timediff, s);
+	lastSpectrum = s;
+	
+	return transSpect.getRows() - 1;
+}
+
 TransSpect::TimePoint TransSpect::getCurrentTime(){
 	return std::chrono::system_clock::now();
 }
@@ -45,183 +65,100 @@ const std::vector<double> TransSpect::getFrequencies() const{
 
 const TransSpect::Spectrum TransSpect::getTransSpect(unsigned int freqNo, TransSpect::X_VALUE x){
 	Spectrum retSpect;
-	spectMtx.lock();
-	if (freqNo < frequencies.size() && transSpect.size() > 0){
-		double x_val;
-		double y_val_real;
-		double y_val_imag;
+	SpectrumMatrix::Column trace = getTimeTrace(freqNo);
+	
+	retSpect.reserve(trace.size());
+	for (std::size_t i = 0; i < trace.size(); i++){
+		double x_val = 0;
+		double y_val_real = trace.getY(i, DataP::COMPLEX_MODE::COMPLEX_REAL);
+		double y_val_imag = trace.getY(i, DataP::COMPLEX_MODE::COMPLEX_IMAG);
 		
-		for (int i = 0; i < transSpect.size(); i++){
-			y_val_real = transSpect.at(i).at(freqNo)->getY(DataP::COMPLEX_MODE::COMPLEX_REAL);
-			y_val_imag = transSpect.at(i).at(freqNo)->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG);
-			
-			switch (x){
-				case X_VALUE::X_POINT:
-					x_val = i;
-					break;
-				case X_VALUE::X_TIME_DIFF:
-					std::chrono::duration<double> elapsed_seconds = timeStamps.at(i) - timeStamps.at(0);
-					x_val = elapsed_seconds.count();
-					break;
-			}
-			retSpect.push_back(std::make_shared<DataP>(x_val, y_val_real, y_val_imag));
+		if (std::isnan(y_val_real)){ // frequency is missing in this spectrum
+			continue;
 		}
+		
+		switch (x){
+			case X_VALUE::X_POINT:
+				x_val = i;
+				break;
+			case X_VALUE::X_TIME:
+			case X_VALUE::X_TIME_DIFF:
+				x_val = trace.getTime(i);
+				break;
+		}
+		retSpect.add(x_val, y_val_real, y_val_imag);
 	}
-	spectMtx.unlock();
 	return retSpect;
 }
 
+SpectrumMatrix::Column TransSpect::getTimeTrace(unsigned int freqNo){
+	spectMtx.lock();
+	SpectrumMatrix::Column trace = transSpect.getColumn(freqNo);
+	spectMtx.unlock();
+	
+	return trace;
+}
+
 void TransSpect::setOn_Spec_added_listener(void (*listener)(TransSpect::TransSpect_ptr ptr, TransSpect::Spectrum s, unsigned int position, double timediff)){
 	on_Spectrum_added = listener;
 }
 
-void TransSpect::setBasePath(std::string path){
-	basePath = path;
+void TransSpect::setMeasurementWriter(MeasurementWriter::MeasurementWriter_ptr writer, unsigned int series){
+	measurementWriter = writer;
+	seriesNo = series;
 }
 
-const std::string TransSpect::getBasePath() const{
-	return basePath;
+MeasurementWriter::MeasurementWriter_ptr TransSpect::getMeasurementWriter() const{
+	return measurementWriter;
+}
+
+unsigned int TransSpect::getSeriesNo() const{
+	return seriesNo;
 }
 
 const TransSpect::Spectrum TransSpect::getLastSpectrum(){
-	Spectrum s;
-	
 	spectMtx.lock();
-	if (!transSpect.empty()){
-		s = *(transSpect.rbegin());
-	}
+	Spectrum s = lastSpectrum;
 	spectMtx.unlock();
 	
 	return s;
 }
 
 const int TransSpect::getSpectrumCount() const{
-	return transSpect.size();
+	spectMtx.lock();
+	int count = transSpect.getRows();
+	spectMtx.unlock();
+	
+	return count;
 }
 
 const double TransSpect::getTimeDiff(int position) const{
-	if (position >= 0 && position < timeStamps.size()){
-		std::chrono::duration<double> elapsed_seconds = timeStamps.at(position) - timeStamps.at(0);
-		double timediff =  elapsed_seconds.count();
+	double timeDiff = 0.0;
+	spectMtx.lock();
+	if (position >= 0 && (std::size_t) position < transSpect.getRows()){
+		timeDiff = transSpect.getTime(position);
 	}
+	spectMtx.unlock();
+	
+	return timeDiff;
 }
 
 TransSpect::TransSpect_ptr TransSpect::loadTransImpSpectrum(std::vector<std::string> paths){
+	TransSpectLoader::TransSpectLoader_ptr loader = TransSpectLoader::create(paths);
+	loader->start();
+	loader->waitUntilFinished();
+	
+	return loader->getTransSpect();
+}
+
+TransSpect::TransSpect_ptr TransSpect::loadTransImpSpectrum(const MeasurementFileReader &reader, unsigned int series){
 	TransSpect_ptr tSpect = create();
-	TimePoint startTime = getCurrentTime();
+	tSpect->startTime = getCurrentTime();
 	
-	for(std::vector<std::string>::const_iterator cit = paths.cbegin(); cit != paths.cend(); cit++){
-		Spectrum spectrum; // one spectrum will be stored here
-		std::string path = *cit; // path of the file which contains the spectrum data
-		int position = 0; // position of the spectrum in the transient spectrum
-		double timediff = 0.0; // difference of the times between the first and the current spectrum
-		std::ifstream spectrum_file(path); // variable to read the file
-		
-		//read spectrum
-		if (spectrum_file.is_open()){
-			std::string line;
-			short frequency = -1, impedance_real = -1, impedance_imag = -1, impedance_abs = -1, impedance_phase = -1;
-			short i = 0;
-			int lineNo = 1;
-		
-			//overread possible header of transient impedance files
-			while (std::getline(spectrum_file, line) && (line.find("position") == 0 || line.find("timediff") == 0)){
-				lineNo++;
-				
-				if (line.find("position=") != std::string::npos){ // found position information
-					position = std::stoi(line.substr(line.find("=") + 1));
-				}
-				if (line.find("timediff=") != std::string::npos){ // found position information
-					timediff = std::stod(line.substr(line.find("=") + 1));
-				}
-			}
-		
-			
-			if (!line.empty()){ // get header
-			
-			// read header
-			std::string element;
-			while (!line.empty()){ // read header
-				if (line.find_first_of(";") == std::string::npos){ // last element in row
-					element = line;
-					line = "";
-				}else{ // not the last element in row
-					element = line.substr(0, line.find_first_of(";"));
-					line = line.substr(line.find_first_of(";")+1);
-				}
-				if (element.compare("frequency") == 0){
-					frequency = i;
-					i++;
-				}else if (element.compare("impedance_real") == 0){
-					impedance_real = i;
-					i++;
-				}else if (element.compare("impedance_imag") == 0){
-					impedance_imag = i;
-					i++;
-				}else if (element.compare("impedance_abs") == 0){
-					impedance_abs = i;
-					i++;
-				}else if (element.compare("impedance_phase") == 0){
-					impedance_phase = i;
-					i++;
-				}
-			}
-			
-			if (frequency == -1){ // no frequency information found
-				throw std::runtime_error("no freq information found in file" + path);
-			}
-			
-			//read data
-			std::vector<std::string> elementsOfLine;
-			while(std::getline(spectrum_file, line)){ // for the rest of the document
-				lineNo++;
-				elementsOfLine.clear();
-				
-				while (!line.empty()){ // fill elementsOfLineVector
-					if (line.find_first_of(";") == std::string::npos){ // last element in row
-						elementsOfLine.push_back(line);
-						line = "";
-					}else{ // not the last element in row
-						elementsOfLine.push_back(line.substr(0, line.find_first_of(";")));
-						line = line.substr(line.find_first_of(";")+1);
-					}
-				}
-				if (elementsOfLine.size() != i){ // no of elements does not fit the header
-					throw std::runtime_error("line " + std::to_string(lineNo) + " parsing error - no. of elements dismatch header - " + path);
-				}
-				
-				if ((impedance_real != -1) && (impedance_imag != -1)){ // got real and imag information
-					DataP::DataP_ptr p = std::make_shared<DataP>(std::stod(elementsOfLine[frequency]), std::stod(elementsOfLine[impedance_real]), std::stod(elementsOfLine[impedance_imag]));
-					spectrum.push_back(p);
-				}else if ((impedance_phase != -1) && (impedance_abs != -1)){
-					DataP::DataP_ptr p = std::make_shared<DataP>();
-					p->setX(std::stod(elementsOfLine[frequency]));
-					p->setY_AbsPhase(std::stod(elementsOfLine[impedance_abs]), std::stod(elementsOfLine[impedance_phase]), DataP::COMPLEX_MODE::COMPLEX_PHASE_RAD);
-					spectrum.push_back(p);
-				}else { ///@todo add other possible combinations
-					throw std::runtime_error("data combination of real / imag / abs / phase not implemented");
-				}
-			}
-			spectrum_file.close();
-		}
-	}
-		
-		
-		//add spectrum to transient spectrum
-		
-		if (tSpect->transSpect.empty()){ // first spectrum 
-			//read frequencies
-			for (Spectrum::const_iterator cit = spectrum.cbegin(); cit != spectrum.cend(); cit++){
-				tSpect->frequencies.push_back((*cit)->getX());
-			}
-			
-			
-		}
-		
-		tSpect->transSpect.push_back(spectrum);
-		tSpect->timeStamps.push_back(startTime + std::chrono::milliseconds((long)(timediff * 1000)));
-		std::cout << "loading spectrum " << path << std::endl;
+	std::vector<std::size_t> records = reader.getRecords(MeasurementFile::RECORD_TYPE::RECORD_TRANS_IMPEDANCE, series);
+	for (std::vector<std::size_t>::const_iterator cit = records.cbegin(); cit != records.cend(); cit++){
+		tSpect->appendSpectrum(reader.getSpectrum(*cit), reader.getRecord(*cit).timestamp);
 	}
 	
 	return tSpect;
-}
\ No newline at end of file
+}
@@ -0,0 +1,160 @@
+#include "TransSpectLoader.h"
+#include "SpectrumCsvReader.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+TransSpectLoader::TransSpectLoader_ptr TransSpectLoader::create(std::vector<std::string> paths, unsigned int threads){
+	return TransSpectLoader_ptr(new TransSpectLoader(paths, threads));
+}
+TransSpectLoader::TransSpectLoader(std::vector<std::string> paths, unsigned int threads): paths(paths), nextFile(0), loadedFiles(0), lastProgress(0), stop(false), cancelled(false){
+	threadCount = std::max(1u, std::min<unsigned int>(threads, paths.size()));
+	spectrums.resize(paths.size());
+	positions.resize(paths.size());
+	timediffs.resize(paths.size());
+	for (std::size_t i = 0; i < paths.size(); i++){ // files without position=... keep the order of the paths
+		positions[i] = i;
+		timediffs[i] = 0.0;
+	}
+	runningThreads = 0;
+	finished = false;
+}
+TransSpectLoader::~TransSpectLoader(){
+	stop = true;
+	for (std::vector<std::thread>::iterator it = threads.begin(); it != threads.end(); it++){
+		if (it->joinable()){
+			it->join();
+		}
+	}
+}
+
+void TransSpectLoader::start(ProgressListener listener){
+	mtx.lock();
+	if (!threads.empty()){ // already started
+		mtx.unlock();
+		return;
+	}
+	TransSpectLoader::listener = listener;
+	runningThreads = threadCount;
+	for (unsigned int i = 0; i < threadCount; i++){
+		threads.push_back(std::thread(&TransSpectLoader::loadThread, this));
+	}
+	mtx.unlock();
+}
+
+void TransSpectLoader::loadThread(){
+	std::size_t i;
+	while (!stop && (i = nextFile++) < paths.size()){
+		try{
+			spectrums[i] = SpectrumCsvReader::loadImpSpectrum(paths[i], &positions[i], &timediffs[i]);
+		}catch (std::runtime_error &e){
+			mtx.lock();
+			if (error.empty()){
+				error = e.what();
+			}
+			mtx.unlock();
+			stop = true;
+			break;
+		}
+		
+		std::size_t loaded = ++loadedFiles;
+		unsigned int progress = loaded * 100 / paths.size();
+		unsigned int last = lastProgress;
+		if (progress > last && lastProgress.compare_exchange_strong(last, progress) && listener && loaded < paths.size()){
+			listener();
+		}
+	}
+	
+	mtx.lock();
+	bool last = (--runningThreads == 0);
+	mtx.unlock();
+	if (last){
+		finish();
+	}
+}
+
+void TransSpectLoader::finish(){
+	TransSpect::TransSpect_ptr t;
+	mtx.lock();
+	bool failed = !error.empty();
+	mtx.unlock();
+	
+	if (!stop && !failed){
+		// sort by position=..., files with the same position keep their order
+		std::vector<std::size_t> order(paths.size());
+		for (std::size_t i = 0; i < order.size(); i++){
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b){return positions[a] < positions[b];});
+		
+		std::vector<Spectrum> sortedSpectrums;
+		std::vector<double> sortedTimediffs;
+		sortedSpectrums.reserve(order.size());
+		sortedTimediffs.reserve(order.size());
+		for (std::vector<std::size_t>::const_iterator cit = order.cbegin(); cit != order.cend(); cit++){
+			sortedSpectrums.push_back(spectrums[*cit]);
+			sortedTimediffs.push_back(timediffs[*cit]);
+		}
+		t = TransSpect::create(sortedSpectrums, sortedTimediffs);
+	}
+	spectrums.clear();
+	
+	mtx.lock();
+	transSpect = t;
+	finished = true;
+	mtx.unlock();
+	finishedCondition.notify_all();
+	
+	if (listener){
+		listener();
+	}
+}
+
+void TransSpectLoader::cancel(){
+	mtx.lock();
+	if (!finished){
+		cancelled = true;
+		stop = true;
+	}
+	mtx.unlock();
+}
+
+void TransSpectLoader::waitUntilFinished(){
+	std::unique_lock<std::mutex> lock(mtx);
+	if (threads.empty()){ // not started
+		return;
+	}
+	finishedCondition.wait(lock, [this]{return finished;});
+}
+
+bool TransSpectLoader::isFinished(){
+	mtx.lock();
+	bool f = finished;
+	mtx.unlock();
+	
+	return f;
+}
+
+bool TransSpectLoader::isCancelled() const{
+	return cancelled;
+}
+
+std::size_t TransSpectLoader::getLoadedCount() const{
+	return loadedFiles;
+}
+
+std::size_t TransSpectLoader::getFileCount() const{
+	return paths.size();
+}
+
+TransSpect::TransSpect_ptr TransSpectLoader::getTransSpect(){
+	mtx.lock();
+	std::string e = error;
+	TransSpect::TransSpect_ptr t = transSpect;
+	mtx.unlock();
+	
+	if (!e.empty()){
+		throw std::runtime_error(e);
+	}
+	return t;
+}
@@ -55,11 +55,9 @@ void TransientGUIHandler::onTransImpSpecAdded_mainContext(){
 			showTransSpectrum();
 		}else{
 			if (selected_freq_no >= 0 && selected_freq_no < dispatcher_data.lastSpectrum.size()){
-				DataP::DataP_ptr p = dispatcher_data.lastSpectrum.at(selected_freq_no);
-				
 				double x;
-				double y_real = p->getY(DataP::COMPLEX_MODE::COMPLEX_REAL);
-				double y_imag = p->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG);
+				double y_real = dispatcher_data.lastSpectrum.getY(selected_freq_no, DataP::COMPLEX_MODE::COMPLEX_REAL);
+				double y_imag = dispatcher_data.lastSpectrum.getY(selected_freq_no, DataP::COMPLEX_MODE::COMPLEX_IMAG);
 				switch(x_val){
 					case TransSpect::X_VALUE::X_POINT:
 						x = dispatcher_data.position;
@@ -69,7 +67,7 @@ void TransientGUIHandler::onTransImpSpecAdded_mainContext(){
 						x = dispatcher_data.timediff;
 						break;
 				}
-				plotWindow_transSpectr->addData(std::make_shared<DataP>(x, y_real, y_imag));
+				plotWindow_transSpectr->addData(x, y_real, y_imag);
 				setTextViewDataInfo();
 			}
 		}
@@ -108,12 +106,11 @@ void TransientGUIHandler::showTransSpectrum(){
 }
 
 void TransientGUIHandler::showSpectrum(TransSpect::Spectrum s){
-	std::vector<DataP::DataP_ptr> nyquist_data;
+	Spectrum nyquist_data;
+	nyquist_data.reserve(s.size());
 	
-	for (std::vector<DataP::DataP_ptr>::const_iterator cit = s.cbegin(); cit != s.cend(); cit++){
-		DataP::DataP_ptr p = *cit;
-		DataP::DataP_ptr dataPoint = std::make_shared<DataP>(p->getY(DataP::COMPLEX_MODE::COMPLEX_REAL), (-1.0) * p->getY(DataP::COMPLEX_MODE::COMPLEX_IMAG));
-		nyquist_data.push_back(dataPoint);
+	for (std::size_t i = 0; i < s.size(); i++){
+		nyquist_data.add(s.getY(i, DataP::COMPLEX_MODE::COMPLEX_REAL), (-1.0) * s.getY(i, DataP::COMPLEX_MODE::COMPLEX_IMAG));
 	}
 	
 	plotWindow_Abs->autoMax_y = true;
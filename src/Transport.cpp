@@ -0,0 +1,65 @@
+#include "Transport.h"
+#include "SimulatedTransport.h"
+#ifdef USE_WIRINGPI
+#include "WiringPiTransport.h"
+#endif
+
+#include <atomic>
+
+constexpr int Transport::bcmPins[TRANSPORT_GPIO_PINS];
+
+Transport::~Transport(){
+	
+}
+
+Transport::Transport_ptr& Transport::current(){
+	// initialized on first use - connections are already opened during the static initialization (Task::relais)
+#ifdef USE_WIRINGPI
+	static Transport_ptr t = WiringPiTransport::create();
+#else
+	static Transport_ptr t = SimulatedTransport::create();
+#endif
+	return t;
+}
+
+Transport::Transport_ptr Transport::get(){
+	return std::atomic_load(&current());
+}
+
+void Transport::set(Transport_ptr t){
+	std::atomic_store(&current(), t);
+}
+
+void Transport::writePins(std::uint32_t set, std::uint32_t clear){
+	for (int pin = 0; pin < TRANSPORT_GPIO_PINS; pin++){
+		std::uint32_t bit = (1u << toBcm(pin));
+		if ((set & bit) != 0 && (clear & bit) == 0){
+			digitalWrite(pin, true);
+		}else if ((clear & bit) != 0){
+			digitalWrite(pin, false);
+		}
+	}
+}
+
+int Transport::i2cReadBlock(int fd, int reg, unsigned char* data, int count){
+	for (int i = 0; i < count; i++){
+		if (i2cWrite(fd, reg + i) < 0){
+			return -1;
+		}
+		int value = i2cRead(fd);
+		if (value < 0){
+			return -1;
+		}
+		data[i] = value;
+	}
+	return 0;
+}
+
+int Transport::i2cWriteBlock(int fd, int reg, const unsigned char* data, int count){
+	for (int i = 0; i < count; i++){
+		if (i2cWriteReg8(fd, reg + i, data[i]) < 0){
+			return -1;
+		}
+	}
+	return 0;
+}
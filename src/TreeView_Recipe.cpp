@@ -19,6 +19,8 @@ TreeView_Recipe::TreeView_Recipe(Gtk::TreeView* tv, Gtk::Window* mainWindow){
 	treeView_recipe_selection = treeView_recipe->get_selection();
 	treeView_recipe_selection->set_select_function( sigc::mem_fun(*this, &TreeView_Recipe::select_function));
 	
+	//show the tasks of recipes which have not been loaded when the row is expanded
+	treeView_recipe->signal_test_expand_row().connect(sigc::mem_fun(*this, &TreeView_Recipe::on_test_expand_row), false);
 }
 
 TreeView_Recipe::~TreeView_Recipe(){
@@ -76,10 +78,42 @@ void TreeView_Recipe::addTaskToView(Task::Task_ptr t){
 	//add child recipes to view if task is a recipe
 	Recipe::Recipe_ptr r = std::dynamic_pointer_cast<Recipe>(t);
 	if (r != nullptr){
-		addChildRecipesToView(r, &recipeRow);
+		if (r->isBodyLoaded()){
+			addChildRecipesToView(r, &recipeRow);
+		}else{ // load the tasks when the row is expanded @see on_test_expand_row
+			Gtk::TreeModel::Row placeholderRow = *(treeModel->append(recipeRow.children()));
+			placeholderRow[treeModel->columns.m_col_name] = TREEVIEW_RECIPE_PLACEHOLDER;
+			placeholderRow[treeModel->columns.m_draggable] = false;
+		}
 	} 
 }
 
+bool TreeView_Recipe::on_test_expand_row(const Gtk::TreeModel::iterator& iter, const Gtk::TreeModel::Path& path){
+	Gtk::TreeModel::Row row = *iter;
+	
+	if (path.size() == 1 && !row.children().empty()){ //toplayer
+		Glib::ustring firstChildName = (*row.children().begin())[treeModel->columns.m_col_name];
+		if (firstChildName == TREEVIEW_RECIPE_PLACEHOLDER){
+			Recipe::Recipe_ptr r;
+			int task_id = row[treeModel->columns.m_col_id];
+			
+			//search recipe in list
+			for (std::vector<Task::Task_ptr>::const_iterator cit = tasks.cbegin(); cit != tasks.cend(); cit++){
+				if ((*cit)->getID() == task_id){ // found the recipe
+					r = std::dynamic_pointer_cast<Recipe>(*cit);
+					break;
+				}
+			}
+			
+			if (r != nullptr){
+				treeModel->erase(row.children().begin()); // remove placeholder
+				addChildRecipesToView(r, &row);
+			}
+		}
+	}
+	return false; // expand the row
+}
+
 void TreeView_Recipe::addChildRecipesToView(Recipe::Recipe_ptr recipe, Gtk::TreeModel::Row* motherRow){
 	std::vector<Task::Task_ptr> tasks = recipe->getTasks();
 	
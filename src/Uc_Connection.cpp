@@ -1,6 +1,6 @@
 #include "Uc_Connection.h"
+#include "Trace.h"
 
-#include <wiringPiI2C.h>
 #include <iostream>
 #include <unistd.h>
 
@@ -32,7 +32,9 @@ Uc_Connection::Uc_Connection_ptr Uc_Connection::create(int slaveAddress){
 
 
 Uc_Connection::Uc_Connection(int deviceID): deviceID(deviceID){
-	Uc_Connection::fd = wiringPiI2CSetup(deviceID); // 7 bit slave address
+	i2cMutex.lock();
+	open();
+	i2cMutex.unlock();
 }
 Uc_Connection::~Uc_Connection(){
 	
@@ -58,8 +60,9 @@ Uc_Connection::~Uc_Connection(){
 int Uc_Connection::sendByte(int data) const{
 	int retval = 0;
 	
+	Trace::Span span("i2c", "sendByte", "address", deviceID);
 	i2cMutex.lock();
-	retval = wiringPiI2CWrite(Uc_Connection::fd, data);
+	retval = open()->i2cWrite(Uc_Connection::fd, data);
 	//std::cout << "Uc_Connection::sendByte - sending "  << data << std::endl;
 	i2cMutex.unlock();
 	
@@ -69,10 +72,13 @@ int Uc_Connection::sendByte(int data) const{
 int Uc_Connection::readRegister(int reg) const{
 	int retval = 0;
 	
+	Trace::Span span("i2c", "readRegister", "address", deviceID);
 	i2cMutex.lock();
-	wiringPiI2CWrite(fd, reg);
+	Transport::Transport_ptr t = open();
+	t->i2cWrite(fd, reg);
 	usleep(5);
-	retval = wiringPiI2CRead(fd);
+	retval = t->i2cRead(fd);
+	shadow[reg & 0xFF] = (retval < 0 ? -1 : retval);
 	i2cMutex.unlock();
 	
 //	std::cout << "r\tslave " << deviceID << "\t- reg " << reg << "\t- data " << retval << std::endl;
@@ -82,31 +88,108 @@ int Uc_Connection::readRegister(int reg) const{
 int Uc_Connection::writeRegister(int reg, int data) const{
 	int retval = 0;
 	
+	Trace::Span span("i2c", "writeRegister", "address", deviceID);
 	i2cMutex.lock();
-	retval = wiringPiI2CWriteReg8(fd, reg, data);
+	retval = open()->i2cWriteReg8(fd, reg, data);
+	shadow[reg & 0xFF] = (retval < 0 ? -1 : (data & 0xFF));
 	i2cMutex.unlock();
 	
 //	std::cout << "w\tslave " << deviceID << "\t- reg " << reg << "\t- data " << data << std::endl;
 	return retval;
 }
 
+std::vector<int> Uc_Connection::readRegisters(int reg, int count) const{
+	std::vector<int> values;
+	std::vector<unsigned char> data(count);
+	
+	Trace::Span span("i2c", "readRegisters", "address", deviceID);
+	i2cMutex.lock();
+	if (open()->i2cReadBlock(fd, reg, data.data(), count) == 0){
+		for (int i = 0; i < count; i++){
+			values.push_back(data[i]);
+			shadow[(reg + i) & 0xFF] = data[i];
+		}
+	}else{
+		for (int i = 0; i < count; i++){
+			shadow[(reg + i) & 0xFF] = -1;
+		}
+	}
+	i2cMutex.unlock();
+	
+	return values;
+}
+
+int Uc_Connection::writeRegisters(int reg, const std::vector<int> &data, bool onlyChanged) const{
+	int retval = 0;
+	
+	Trace::Span span("i2c", "writeRegisters", "address", deviceID);
+	i2cMutex.lock();
+	int first = 0;
+	int last = ((int) data.size()) - 1;
+	if (onlyChanged){ // skip the unchanged registers at the beginning and the end
+		while (first <= last && shadow[(reg + first) & 0xFF] == (data[first] & 0xFF)){
+			first++;
+		}
+		while (last >= first && shadow[(reg + last) & 0xFF] == (data[last] & 0xFF)){
+			last--;
+		}
+	}
+	
+	if (first <= last){
+		std::vector<unsigned char> bytes;
+		for (int i = first; i <= last; i++){
+			bytes.push_back(data[i] & 0xFF);
+		}
+		retval = open()->i2cWriteBlock(fd, reg + first, bytes.data(), bytes.size());
+		for (int i = first; i <= last; i++){
+			shadow[(reg + i) & 0xFF] = (retval < 0 ? -1 : (data[i] & 0xFF));
+		}
+	}
+	i2cMutex.unlock();
+	
+	return retval;
+}
+
 /*
 * receives one byte from the slave
 */
 int Uc_Connection::receiveByte() const{
 	int retval = 0;
 	
+	Trace::Span span("i2c", "receiveByte", "address", deviceID);
 	i2cMutex.lock();
-	retval = wiringPiI2CRead(Uc_Connection::fd);
+	retval = open()->i2cRead(Uc_Connection::fd);
 	i2cMutex.unlock();
 	
 	return retval;
 }
 
+Transport::Transport_ptr Uc_Connection::open() const{
+	Transport::Transport_ptr t = Transport::get();
+	if (t != transport){
+		fd = t->i2cSetup(deviceID); // 7 bit slave address
+		transport = t;
+		invalidateShadow();
+	}
+	return t;
+}
+
+void Uc_Connection::invalidateShadow() const{
+	for (int i = 0; i < 256; i++){
+		shadow[i] = -1;
+	}
+}
+
 int Uc_Connection::getSlaveAddress() const{
 	return deviceID;
 }
 
 bool Uc_Connection::isConnected(){
-	return (readRegister(0x00) == deviceID);
+	bool connected = (readRegister(0x00) == deviceID);
+	if (!connected){ // the microcontroller may have been reset
+		i2cMutex.lock();
+		invalidateShadow();
+		i2cMutex.unlock();
+	}
+	return connected;
 }
@@ -0,0 +1,219 @@
+#include "VoltageSettler.h"
+#include "Addresses.h"
+
+#include <cmath>
+#include <algorithm>
+
+VoltageSettler::VoltageSettler(double target, double tolerance): target(target), band(std::fabs(target) * tolerance), trim(0){
+	reset();
+}
+
+void VoltageSettler::reset(){
+	samples.clear();
+	sampleCount = 0;
+	inBandSinceMs = -1;
+	inBandSamples = 0;
+	interval = VOLTAGE_SETTLE_MIN_INTERVAL_MS;
+	nextPollMs = VOLTAGE_SETTLE_MIN_INTERVAL_MS;
+	slope = 0;
+	timeConstantMs = 0;
+	driftV = band;
+}
+
+void VoltageSettler::addSample(double ms, double v){
+	samples.push_back(Sample{ms, v});
+	if (samples.size() > VOLTAGE_SETTLE_FIT_SAMPLES){
+		samples.pop_front();
+	}
+	sampleCount++;
+	
+	if (isInBand(v)){
+		if (inBandSinceMs < 0){ // entered the band
+			inBandSinceMs = ms;
+			inBandSamples = 0;
+			interval = VOLTAGE_SETTLE_MIN_INTERVAL_MS;
+		}
+		inBandSamples++;
+	}else{
+		inBandSinceMs = -1;
+		inBandSamples = 0;
+	}
+	fit();
+	
+	double remaining = (inBandSinceMs < 0 ? estimateRemainingMs() : -1);
+	if (samples.size() < 2){ // no slope yet
+		nextPollMs = VOLTAGE_SETTLE_MIN_INTERVAL_MS;
+	}else if (remaining >= 0){ // approaching the band - measure when it should be reached
+		nextPollMs = std::min(std::max(remaining, (double) VOLTAGE_SETTLE_MIN_INTERVAL_MS), (double) VOLTAGE_SETTLE_MAX_INTERVAL_MS);
+		interval = VOLTAGE_SETTLE_MIN_INTERVAL_MS;
+	}else{ // inside the band or not approaching - back off
+		nextPollMs = interval;
+		interval = std::min(interval * VOLTAGE_SETTLE_BACKOFF, (double) VOLTAGE_SETTLE_MAX_INTERVAL_MS);
+	}
+}
+
+void VoltageSettler::fit(){
+	slope = 0;
+	timeConstantMs = 0;
+	driftV = band;
+	std::size_t n = samples.size();
+	if (n < 2){
+		return;
+	}
+	
+	// local slope of the last 3 samples
+	slope = fitLine(n - std::min<std::size_t>(n, 3));
+	
+	// first order response towards the target: ln|e| = a - t / tau, samples on the other side of the target are skipped
+	double eLast = target - samples.back().v;
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	unsigned int count = 0;
+	for (std::deque<Sample>::const_iterator cit = samples.cbegin(); cit != samples.cend(); cit++){
+		double e = target - cit->v;
+		if ((e > 0) == (eLast > 0) && std::fabs(e) > 1e-3){
+			double x = cit->ms - samples.back().ms; // relative to the last sample for numerical stability
+			double y = std::log(std::fabs(e));
+			sx += x;
+			sy += y;
+			sxx += x * x;
+			sxy += x * y;
+			count++;
+		}
+	}
+	double d = count * sxx - sx * sx;
+	if (count >= 3 && d > 0){
+		double k = (count * sxy - sx * sy) / d;
+		if (k < 0){ // error decreases
+			timeConstantMs = -1.0 / k;
+		}
+	}
+	
+	if (inBandSinceMs >= 0 && inBandSamples >= 2){
+		driftV = std::fabs(fitLine(n - std::min<std::size_t>(n, inBandSamples))) * VOLTAGE_SETTLE_HOLD_MS;
+	}
+}
+
+double VoltageSettler::fitLine(std::size_t first) const{
+	std::size_t n = samples.size() - first;
+	if (n < 2){
+		return 0;
+	}
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	for (std::size_t i = first; i < samples.size(); i++){
+		double x = samples[i].ms - samples.back().ms;
+		sx += x;
+		sy += samples[i].v;
+		sxx += x * x;
+		sxy += x * samples[i].v;
+	}
+	double d = n * sxx - sx * sx;
+	return (d > 0 ? (n * sxy - sx * sy) / d : 0);
+}
+
+bool VoltageSettler::isInBand(double v) const{
+	return (std::fabs(v - target) <= band);
+}
+
+bool VoltageSettler::isSettled() const{
+	return (inBandSinceMs >= 0 && inBandSamples >= VOLTAGE_SETTLE_HOLD_SAMPLES && samples.back().ms - inBandSinceMs >= VOLTAGE_SETTLE_HOLD_MS && driftV <= band / 2);
+}
+
+bool VoltageSettler::isSteady() const{
+	std::size_t n = samples.size();
+	if (n < VOLTAGE_SETTLE_HOLD_SAMPLES){
+		return false;
+	}
+	std::size_t first = n - VOLTAGE_SETTLE_HOLD_SAMPLES;
+	double span = samples.back().ms - samples[first].ms;
+	return (span >= VOLTAGE_SETTLE_HOLD_MS / 2.0 && std::fabs(fitLine(first)) * VOLTAGE_SETTLE_HOLD_MS <= band / 2);
+}
+
+double VoltageSettler::getNextPollMs() const{
+	return nextPollMs;
+}
+
+double VoltageSettler::estimateTimeToMs(double level) const{
+	if (samples.empty()){
+		return -1;
+	}
+	double v = samples.back().v;
+	if (v == level){
+		return 0;
+	}
+	
+	double t = -1;
+	if (slope != 0 && (level > v) == (slope > 0)){ // line
+		t = (level - v) / slope;
+	}
+	double e = target - v;
+	double eLevel = target - level;
+	if (timeConstantMs > 0 && (e > 0) == (eLevel > 0) && std::fabs(eLevel) < std::fabs(e)){ // first order, the level is between the voltage and the target
+		double tFirstOrder = timeConstantMs * std::log(std::fabs(e) / std::fabs(eLevel));
+		t = (t < 0 ? tFirstOrder : std::min(t, tFirstOrder));
+	}
+	return t;
+}
+
+double VoltageSettler::estimateRemainingMs() const{
+	if (samples.empty()){
+		return -1;
+	}
+	double v = samples.back().v;
+	if (isInBand(v)){
+		return 0;
+	}
+	return estimateTimeToMs(v < target ? target - band : target + band);
+}
+
+double VoltageSettler::getTimeConstantMs() const{
+	return timeConstantMs;
+}
+
+double VoltageSettler::getSlope() const{
+	return slope * 1000.0;
+}
+
+bool VoltageSettler::updateCommand(){
+	if (samples.empty() || isInBand(samples.back().v) || !isSteady()){
+		return false;
+	}
+	
+	double mean = 0;
+	for (std::size_t i = samples.size() - VOLTAGE_SETTLE_HOLD_SAMPLES; i < samples.size(); i++){
+		mean += samples[i].v;
+	}
+	mean /= VOLTAGE_SETTLE_HOLD_SAMPLES;
+	
+	double maxTrim = std::fabs(target) * VOLTAGE_SETTLE_TRIM_MAX;
+	trim = std::min(std::max(trim + VOLTAGE_SETTLE_TRIM_GAIN * (target - mean), -maxTrim), maxTrim);
+	reset(); // the voltage follows the new command
+	return true;
+}
+
+double VoltageSettler::getCommand() const{
+	return target + trim;
+}
+
+int VoltageSettler::toSetpointAdc(double v){
+	return ((double) VOLTAGE_ATTINY45_R2) / (((double) VOLTAGE_ATTINY45_R1) + ((double) VOLTAGE_ATTINY45_R2)) * ((double) VOLTAGE_ATTINY45_R_CORR) * 1024.0 / 5.0 * v;
+}
+
+double VoltageSettler::toSetpointVoltage(int adc){
+	return (((double)VOLTAGE_ATTINY45_R2) + ((double) VOLTAGE_ATTINY45_R1)) / ((double) VOLTAGE_ATTINY45_R2) / ((double) VOLTAGE_ATTINY45_R_CORR) * ((double) adc) / 1024.0 * 5.0;
+}
+
+double VoltageSettler::toVoltage(int adc){
+	return (((double)VOLTAGE_ATTINY45_R2) + ((double) VOLTAGE_ATTINY45_R1)) / ((double) VOLTAGE_ATTINY45_R2) / ((double) VOLTAGE_ATTINY45_R_CORR) * ((double) adc) / 1023.0 * 5.0;
+}
+
+double VoltageSettler::getTarget() const{
+	return target;
+}
+
+double VoltageSettler::getBand() const{
+	return band;
+}
+
+unsigned int VoltageSettler::getSamples() const{
+	return sampleCount;
+}
@@ -0,0 +1,155 @@
+#include "WiringPiTransport.h"
+
+#include <wiringPi.h>
+#include <wiringPiI2C.h>
+#include <wiringSerial.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+WiringPiTransport::WiringPiTransport_ptr WiringPiTransport::create(){
+	return WiringPiTransport_ptr(new WiringPiTransport());
+}
+WiringPiTransport::WiringPiTransport(){
+	gpioRegisters = nullptr;
+}
+WiringPiTransport::~WiringPiTransport(){
+	if (gpioRegisters != nullptr){
+		munmap((void*) gpioRegisters, WIRINGPI_GPIO_MAP_SIZE);
+	}
+}
+
+void WiringPiTransport::setup(){
+	wiringPiSetup();
+	
+	if (gpioRegisters == nullptr){
+		int fd = open("/dev/gpiomem", O_RDWR | O_SYNC);
+		if (fd >= 0){
+			void *map = mmap(nullptr, WIRINGPI_GPIO_MAP_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			close(fd); // the mapping stays valid
+			if (map != MAP_FAILED){
+				gpioRegisters = static_cast<volatile std::uint32_t*>(map);
+			}
+		}
+		if (gpioRegisters == nullptr){
+			std::cout << "cannot map /dev/gpiomem, the pads are written pin by pin" << std::endl;
+		}
+	}
+}
+
+void WiringPiTransport::setOutput(int pin){
+	::pinMode(pin, OUTPUT);
+}
+
+void WiringPiTransport::digitalWrite(int pin, bool value){
+	::digitalWrite(pin, (value ? HIGH : LOW));
+}
+
+bool WiringPiTransport::digitalRead(int pin){
+	return (::digitalRead(pin) == HIGH);
+}
+
+void WiringPiTransport::writePins(std::uint32_t set, std::uint32_t clear){
+	if (gpioRegisters == nullptr){
+		Transport::writePins(set, clear);
+		return;
+	}
+	if (set != 0){
+		gpioRegisters[WIRINGPI_GPIO_GPSET0] = set;
+	}
+	if (clear != 0){
+		gpioRegisters[WIRINGPI_GPIO_GPCLR0] = clear;
+	}
+}
+
+void WiringPiTransport::delayMicroseconds(unsigned int us){
+	::delayMicroseconds(us);
+}
+
+int WiringPiTransport::i2cSetup(int address){
+	int fd = wiringPiI2CSetup(address);
+	if (fd >= 0){
+		addressesMtx.lock();
+		addresses[fd] = address;
+		addressesMtx.unlock();
+	}
+	return fd;
+}
+
+int WiringPiTransport::i2cWrite(int fd, int data){
+	return wiringPiI2CWrite(fd, data);
+}
+
+int WiringPiTransport::i2cRead(int fd){
+	return wiringPiI2CRead(fd);
+}
+
+int WiringPiTransport::i2cWriteReg8(int fd, int reg, int data){
+	return wiringPiI2CWriteReg8(fd, reg, data);
+}
+
+int WiringPiTransport::i2cReadBlock(int fd, int reg, unsigned char* data, int count){
+	unsigned char regByte = reg;
+	struct i2c_msg messages[2];
+	
+	messages[0].flags = 0; // write the register no
+	messages[0].len = 1;
+	messages[0].buf = &regByte;
+	
+	messages[1].flags = I2C_M_RD; // read the registers
+	messages[1].len = count;
+	messages[1].buf = data;
+	
+	return transfer(fd, messages, 2);
+}
+
+int WiringPiTransport::i2cWriteBlock(int fd, int reg, const unsigned char* data, int count){
+	std::vector<unsigned char> buffer(count + 1);
+	buffer[0] = reg;
+	std::copy(data, data + count, buffer.begin() + 1);
+	
+	struct i2c_msg message;
+	message.flags = 0;
+	message.len = buffer.size();
+	message.buf = buffer.data();
+	
+	return transfer(fd, &message, 1);
+}
+
+int WiringPiTransport::transfer(int fd, struct i2c_msg* messages, int count){
+	addressesMtx.lock();
+	std::map<int, int>::const_iterator cit = addresses.find(fd);
+	int address = (cit != addresses.cend() ? cit->second : -1);
+	addressesMtx.unlock();
+	
+	if (address < 0){ // fd has not been opened by i2cSetup
+		return -1;
+	}
+	
+	for (int i = 0; i < count; i++){
+		messages[i].addr = address;
+	}
+	
+	struct i2c_rdwr_ioctl_data transaction;
+	transaction.msgs = messages;
+	transaction.nmsgs = count;
+	return (ioctl(fd, I2C_RDWR, &transaction) < 0 ? -1 : 0);
+}
+
+int WiringPiTransport::serialOpen(const std::string &device, int baud){
+	return ::serialOpen(device.c_str(), baud);
+}
+
+void WiringPiTransport::serialPuts(int fd, const std::string &s){
+	::serialPuts(fd, s.c_str());
+}
+
+void WiringPiTransport::serialClose(int fd){
+	::serialClose(fd);
+}
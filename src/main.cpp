@@ -1,7 +1,8 @@
 #include "Logbook.h"
 #include "GUI.h"
+#include "Transport.h"
+#include "SimulatedTransport.h"
 
-#include <wiringPi.h>
 #include <iostream>
 #include <string>
 
@@ -13,7 +14,10 @@ void onLogEventAdded(Log_Event::Log_Event_ptr event){
 
 int main (int argc, char **argv){
 	
-	wiringPiSetup(); //init wiring pi
+	if (argc > 1 && std::string(argv[1]).compare("--simulate") == 0){ // run with the simulated microcontrollers
+		Transport::set(SimulatedTransport::create());
+	}
+	Transport::get()->setup(); //init wiring pi
 	Logbook::Logbook_ptr logfile = Logbook::create();
 	gui = new GUI(logfile);
 	